@@ -3,7 +3,7 @@ import os
 import platform
 
 # (1)==================== COMMON CONFIGURATION OPTIONS ======================= #
-COMPILER="g++ -g -std=c++17"   # The compiler we want to use 
+COMPILER="g++ -g -O2 -std=c++20 -pthread" # The compiler we want to use 
                                 #(You may try g++ if you have trouble)
 SOURCE="./src/*.cpp"    # Where the source code lives
 EXECUTABLE="lab"        # Name of the final executable
@@ -0,0 +1,57 @@
+/** @file BakeCoordinator.hpp
+ *  @brief Bakes a region with several worker processes, fed from a ShardQueue.
+ *
+ *  The coordinator cuts the region into shards of a few chunks a side,
+ *  queues them in the output directory and starts worker processes:
+ *  this same program, run again with --bake-worker. Each worker claims
+ *  shards until none are left and bakes them with a RegionBaker into
+ *  shards/shard_N of the output directory. The coordinator prints the
+ *  progress, puts back the shards of any worker that dies and starts a
+ *  new one in its place, and at the end writes manifest.txt, which lists
+ *  every shard, where it is and what it took.
+ *
+ *  Workers only share the output directory with the coordinator, so
+ *  the worker processes stand in for machines on a shared mount.
+ *  Starting and watching processes needs POSIX.
+ */
+#ifndef BAKECOORDINATOR_HPP
+#define BAKECOORDINATOR_HPP
+
+#include "RegionBaker.hpp"
+#include "ShardQueue.hpp"
+
+#include <string>
+#include <vector>
+
+class BakeCoordinator{
+public:
+    // The region of settings, cut into shards of shardSize chunks a side and baked by workerCount processes
+    BakeCoordinator(const BakeSettings& settings, unsigned int shardSize, unsigned int workerCount);
+
+    // Runs the bake, starting workers as: executable workerArguments... --bake-worker=<output directory>
+    // Returns false if a shard failed every attempt, or workers could not be started.
+    bool Run(const std::string& executable, const std::vector<std::string>& workerArguments);
+
+    // Worker side: bakes shards from the queue in directory until none are left.
+    // Returns false if a shard could not be written.
+    static bool RunWorker(const std::string& directory, JobScheduler& scheduler, const NoiseContext& noise,
+                          const TerrainRamp& ramp);
+
+    // Times a shard is handed out before the bake gives up on it, and workers that
+    // fail to start in a row, with none running, before it gives up on the bake
+    static constexpr unsigned int MaxAttempts = 3;
+
+private:
+    // Cuts the region into shards, row by row
+    std::vector<Shard> MakeShards() const;
+    // Starts a worker, returns its process id or -1
+    int StartWorker(const std::string& executable, const std::vector<std::string>& arguments) const;
+    // Writes manifest.txt from the done shards
+    bool WriteManifest(const std::vector<std::pair<Shard, std::string>>& done) const;
+
+    BakeSettings m_settings;
+    unsigned int m_shardSize;
+    unsigned int m_workerCount;
+};
+
+#endif
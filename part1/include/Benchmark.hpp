@@ -0,0 +1,83 @@
+/** @file Benchmark.hpp
+ *  @brief Micro-benchmarks for the terrain generation code.
+ *
+ *  Run with ./lab --bench. No window or OpenGL context is created,
+ *  each benchmark times one piece of the generation path on a full
+ *  chunk and prints the result.
+ */
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+namespace Benchmark{
+    // Runs every benchmark. Returns false if any of the checks failed.
+    bool RunAll();
+    // Original per-layer octave2D_01 loop against siv::FractalLayers
+    void LayeredOctaveNoise(unsigned int chunkSize);
+    // The native 2D kernel against the noise3D slice noise2D used to forward to
+    void Noise2DKernel(unsigned int chunkSize);
+    // Every supported PerlinNoiseBatch kernel, checked against the scalar noise2D and noise2DGradient
+    // Returns false if a kernel is further than tolerance from it (a few times that for the derivatives)
+    bool BatchNoise(unsigned int chunkSize, float tolerance);
+    // Cost of a full chunk with each NoiseSource backend, and a few quality numbers
+    void NoiseBackends(unsigned int chunkSize);
+    // Generic BasicFractalLayers loops against the unrolled FractalKernel for the default octaves
+    void FixedFractalKernel(unsigned int chunkSize);
+    // Cost of the value + gradient chunk path against value only, and the gradient
+    // checked against central differences
+    void NoiseGradient(unsigned int chunkSize);
+    // Re-blending a chunk from its cached octave planes against sampling it again
+    void OctaveReblend(unsigned int chunkSize);
+    // Error against time of sampling the smooth octaves on coarse grids, for a few error bounds
+    void MultiresSampling(unsigned int chunkSize);
+    // Every supported Worley kernel against the scalar one, and their rate against Perlin
+    // Returns false if a kernel is further than tolerance from it
+    bool WorleyKernels(unsigned int chunkSize, float tolerance);
+    // A 10 module noise graph evaluated one tile at a time against one module at a time
+    // over the whole chunk. Returns false if the two disagree anywhere, or a broken module is accepted.
+    bool NoiseGraphFusion(unsigned int chunkSize);
+    // The height and colour lookup tables against the if/else transfer functions they replaced
+    // Returns false if a kernel is off by more than a table step
+    bool TerrainRampPass(unsigned int chunkSize);
+    // A whole chunk, noise to mesh, on 1 to 16 threads. Returns false if any
+    // thread count changes a bit of the heights, colours or mesh.
+    bool ParallelChunk(unsigned int chunkSize);
+    // A camera flying over streamed chunks: latency, queue depth and cancelled work, then a noise
+    // slider dragged over them, then levels switched on. Returns false if the region never fills, a streamed
+    // chunk differs from a direct build, or a resident chunk is not rebuilt for the last noise settings or with skirts.
+    bool ChunkStreaming(unsigned int chunkSize);
+    // Streamed chunks staged in a ring too small for all of them, spans held a few frames.
+    // Returns false if a span differs from its chunk or is never given back.
+    bool StagedChunks(unsigned int chunkSize);
+    // The lock-free handoffs between the simulation and render threads, under contention.
+    // Returns false if a snapshot is torn or goes back in time, or a command is lost.
+    bool SnapshotHandoff(unsigned int count);
+    // Shader files, PPM images and a chunk loaded one after the other, then as a
+    // coroutine graph on the job workers. Returns false if the two load different data.
+    bool StartupGraph(unsigned int chunkSize);
+    // A small region baked to disk by RegionBaker, read back tile by tile. Returns false if the bake
+    // fails, a tile differs by a bit from a TerrainBuilder chunk, or neighbouring tiles disagree on their shared edge.
+    bool RegionBake(unsigned int chunkSize);
+    // A region cut into shards and baked from a ShardQueue by a worker, after another one died holding a shard.
+    // Returns false if a shard is not done, comes back wrong or differs from TerrainBuilder chunks,
+    // or a shard that keeps failing is not given up on.
+    bool ShardedBake(unsigned int chunkSize);
+    // A chunk in the compact vertex format against the float one: size, build time and
+    // decode error. Returns false if the grid differs or a decode is off by more than the quantization.
+    bool CompactVertices(unsigned int chunkSize);
+    // A chunk's tiles drawn with the shared 16-bit lists and strips against its own 32-bit list:
+    // index memory and vertex cache misses. Returns false if a topology draws other triangles.
+    bool GridIndexing(unsigned int chunkSize);
+    // A chunk as a height texture for vertex pulling against its vertex buffers: upload size,
+    // build time, and the vertices heightfield_vert.glsl would pull. Returns false if one differs.
+    bool HeightTexturePull(unsigned int chunkSize);
+    // A chunk at every level of detail: samples, triangles and build time, the cracks between
+    // levels against the skirts, and level changes with and without hysteresis.
+    // Returns false if a level samples other points than the full chunk, a crack is wider than the skirts,
+    // or two neighbours disagree by a bit on a vertex they share.
+    bool LevelOfDetail(unsigned int chunkSize);
+    // A geometry clipmap of levels rings under a flying camera: vertices and upload per frame.
+    // Returns false if a window updated in place differs from a fresh one, or the rings do not nest.
+    bool ClipmapStreaming(unsigned int levels);
+}
+
+#endif
@@ -0,0 +1,179 @@
+/** @file ChunkStreamer.hpp
+ *  @brief Keeps the terrain chunks around the camera generated, nearest first.
+ *
+ *  Update() looks at the chunks within a radius of the camera, submits a
+ *  job for each one that is missing and orders the waiting jobs by their
+ *  distance to the eye. A chunk that leaves the radius has its job
+ *  cancelled, and a resident chunk one more chunk away is unloaded.
+ *
+ *  With a level of detail distance, chunks further away are built at
+ *  coarser levels (see TerrainBuilder), one more level every time the
+ *  distance doubles. A resident chunk whose level should change is built
+ *  again at the new one and handed out once more; the caller swaps it in.
+ *  Levels change a margin past their boundary, so a camera hovering on
+ *  one does not rebuild the chunk back and forth. New noise settings
+ *  rebuild every resident chunk the same way, as jobs, so the old one
+ *  stays drawn until the new one is uploaded.
+ *
+ *  Jobs only do CPU work (noise, colours, mesh). With a staging ring they
+ *  also copy the vertices (or height texels) and colours into it, so the upload can
+ *  start from there. Whoever owns the OpenGL context takes the finished
+ *  chunks with TakeReady() and uploads them, and drops the ones
+ *  TakeUnloaded() returns.
+ */
+#ifndef CHUNKSTREAMER_HPP
+#define CHUNKSTREAMER_HPP
+
+#include "JobScheduler.hpp"
+#include "TerrainBuilder.hpp"
+#include "TerrainMesh.hpp"
+#include "StagingRing.hpp"
+#include "glm/vec3.hpp"
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <vector>
+
+// Chunk position, in chunks from the origin
+struct ChunkCoord{
+    int x;
+    int z;
+
+    bool operator<(const ChunkCoord& other) const{
+        return x < other.x || (x == other.x && z < other.z);
+    }
+};
+
+// A chunk whose CPU work is done, ready to be uploaded
+struct ReadyChunk{
+    ChunkCoord coord;
+    std::unique_ptr<TerrainBuilder> builder;
+    TerrainMesh mesh;
+    // Vertices or height texels, then colour texels at their offset. Empty if the ring was full
+    // (or there is none), the data is then only in builder and mesh.
+    StagingRing::Span staged;
+    std::size_t texelOffset = 0;
+};
+
+class ChunkStreamer{
+public:
+    // What the streamer has done so far
+    struct Stats{
+        // Chunks waiting for or in a job, and chunks handed out by TakeReady()
+        std::size_t pending = 0;
+        std::size_t resident = 0;
+        std::size_t requested = 0;
+        // Resident chunks requested again at another level of detail, and for new noise or skirts
+        std::size_t levelChanges = 0;
+        std::size_t regenerations = 0;
+        // Seconds from a chunk's request to TakeReady() handing it out
+        double averageLatency = 0.0;
+        double maxLatency = 0.0;
+    };
+
+    // Chunks are chunkSize vertices a side, sharing their edges (chunkSize - 1 apart),
+    // generated from noise through ramp.
+    // The scheduler, cache and ramp are shared and must outlive the streamer.
+    ChunkStreamer(JobScheduler& scheduler, unsigned int chunkSize, const NoiseContext& noise,
+                  OctaveCache* octaveCache = nullptr, const TerrainRamp* ramp = nullptr);
+    // Cancels every pending chunk, and waits for the ones already running
+    ~ChunkStreamer();
+
+    // Chunks up to radius chunks away from the camera's one are kept, 1 is a 3x3 block
+    void SetRadius(int radius);
+    int GetRadius() const;
+    // New noise settings. Pending chunks start again, and every resident chunk is requested again
+    // at its level (the ones kept past the region are unloaded); TakeReady() hands them out like
+    // level changes. Calling it again before they
+    // are done cancels them, so only the newest settings are ever built.
+    void SetNoise(const NoiseContext& noise);
+    // Jobs stage their chunk in ring when it has room, nullptr to never stage.
+    // The ring must outlive the streamer.
+    void SetStagingRing(StagingRing* ring);
+    // Whether jobs build vertices or height texels (TerrainBuilder::BuildHeightTexels()).
+    // Only chunks requested from now on change.
+    void SetDrawPath(TerrainDrawPath drawPath);
+    TerrainDrawPath GetDrawPath() const;
+    // Chunks nearer than distance (in vertices, to the nearest point of the chunk) are built at
+    // level 0, each level after that starts at twice the distance. 0 builds every chunk at level 0,
+    // without skirts: neighbours at one level share their edge samples bit for bit. Switching between
+    // 0 and a distance requests every resident chunk again, like SetNoise().
+    void SetLODDistance(float distance);
+    float GetLODDistance() const;
+
+    // How far past a level's boundary the distance has to go for the level to change, as a fraction of it
+    static constexpr float LODHysteresis = 0.25f;
+    // The level a chunk at distance gets, for lodDistance as in SetLODDistance() and levels up to maxLOD
+    static unsigned int GetLOD(float distance, float lodDistance, unsigned int maxLOD);
+    // The level a chunk at current moves to at distance, current unless it went past the hysteresis
+    static unsigned int SelectLOD(float distance, unsigned int current, float lodDistance, unsigned int maxLOD);
+
+    // Requests, re-prioritizes and cancels chunks for the camera at eye
+    void Update(const glm::vec3& eye);
+    // Finished chunks, nearest first, at most maxCount. They count as resident from now on;
+    // one that already was is at a new level of detail or has new noise, and replaces the old one.
+    std::vector<ReadyChunk> TakeReady(std::size_t maxCount);
+    // Resident chunks that left the region, the caller drops them
+    std::vector<ChunkCoord> TakeUnloaded();
+    // True once every chunk of the region is resident
+    bool IsSettled() const;
+
+    Stats GetStats() const;
+    // Returns the chunk the point is in
+    ChunkCoord GetChunk(const glm::vec3& point) const;
+
+private:
+    // What a job hands back
+    struct ChunkResult{
+        std::unique_ptr<TerrainBuilder> builder;
+        TerrainMesh mesh;
+        StagingRing::Span staged;
+        std::size_t texelOffset = 0;
+    };
+    struct PendingChunk{
+        JobScheduler::JobHandle job;
+        std::shared_ptr<ChunkResult> result;
+        double requestTime;
+        unsigned int lod;
+    };
+
+    // Squared distance from the eye to the centre of a chunk, in world units
+    float Priority(const ChunkCoord& coord, const glm::vec3& eye) const;
+    // Distance from the eye to the nearest point of a chunk, along the ground
+    float Distance(const ChunkCoord& coord, const glm::vec3& eye) const;
+    void Request(const ChunkCoord& coord, const glm::vec3& eye, unsigned int lod);
+    // Cancels a chunk's job and gives back its staged span, now or once the job stops
+    void Cancel(const PendingChunk& chunk);
+    // Cancels every pending chunk and requests the resident ones again at their level,
+    // unloading the ones kept past the region
+    void RebuildResidents();
+
+    JobScheduler& m_scheduler;
+    unsigned int m_chunkSize;
+    NoiseContext m_noise;
+    OctaveCache* m_octaveCache;
+    const TerrainRamp* m_ramp;
+    StagingRing* m_staging = nullptr;
+    TerrainDrawPath m_drawPath = TerrainDrawPath::VertexBuffer;
+    float m_lodDistance = 0.0f;
+    int m_radius = 1;
+    // Where the camera was at the last Update()
+    glm::vec3 m_eye;
+
+    std::map<ChunkCoord, PendingChunk> m_pending;
+    // By the level of detail they were handed out at
+    std::map<ChunkCoord, unsigned int> m_resident;
+    std::vector<ChunkCoord> m_unloaded;
+    // Cancelled chunks whose jobs were still running
+    std::vector<PendingChunk> m_cancelled;
+
+    std::size_t m_requested = 0;
+    std::size_t m_levelChanges = 0;
+    std::size_t m_regenerations = 0;
+    std::size_t m_delivered = 0;
+    double m_totalLatency = 0.0;
+    double m_maxLatency = 0.0;
+};
+
+#endif
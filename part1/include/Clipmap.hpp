@@ -0,0 +1,156 @@
+/** @file Clipmap.hpp
+ *  @brief Nested grids of terrain centred on the camera, for view distances far past the chunks.
+ *
+ *  A geometry clipmap keeps a square window of size vertices a side per
+ *  level, every window centred on the camera. Level l has its vertices
+ *  2^l full resolution vertices apart, so each level covers twice the
+ *  ground of the one inside it for the same vertex count. Level 0 is
+ *  drawn whole, every other level as the ring around the window inside
+ *  it, so a frame always draws the same number of vertices.
+ *
+ *  A level's heights, normals and colours are a size^2 texture addressed
+ *  toroidally: grid position g of the level is texel g mod size. When
+ *  the camera moves, a window slides by whole steps and only the rows
+ *  and columns that came into view are sampled and written, over the
+ *  ones that left. The work and upload of a frame follow how far the
+ *  camera moved, not how far it sees.
+ *
+ *  Windows snap to every other vertex of their level, so they start on
+ *  a vertex of the level around them. Near its outer edge a level morphs
+ *  its odd vertices onto the line between their even neighbours, which
+ *  is the coarser level's edge, so the rings meet without cracks and
+ *  nothing pops when a window slides (see clipmap_vert.glsl).
+ *
+ *  The samples come from the same noise and ramp as the chunks, at the
+ *  same points: chunkSize only sets the noise scale. Nothing here needs
+ *  OpenGL; ClipmapTerrain draws a clipmap from the frames it hands out.
+ */
+#ifndef CLIPMAP_HPP
+#define CLIPMAP_HPP
+
+#include "NoiseContext.hpp"
+#include "TerrainRamp.hpp"
+#include "TerrainMesh.hpp"
+#include "ThreadPool.hpp"
+#include "glm/glm.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Where a level's window is
+struct ClipmapLevel{
+    // Full resolution vertices between two vertices of the level, 2^level
+    int spacing = 1;
+    // Grid position of the window's first vertex, in vertices of the level; always even
+    int gridX = 0;
+    int gridZ = 0;
+};
+
+// New texels for a rectangle of one level's texture. The rectangle never wraps.
+struct ClipmapUpdate{
+    unsigned int level = 0;
+    // First texel and size, in texels
+    unsigned int x = 0;
+    unsigned int z = 0;
+    unsigned int width = 0;
+    unsigned int height = 0;
+    // Row-major, width * height of each
+    std::vector<TerrainTexel> texels;
+    std::vector<std::uint32_t> colors;
+};
+
+// Everything the render thread needs to bring its textures up to date and draw the clipmap
+struct ClipmapFrame{
+    unsigned int size = 0;
+    // The heights a texel's 0 and 65535 stand for, the same for every level
+    float minHeight = 0.0f;
+    float maxHeight = 0.0f;
+    // Where the camera was when the windows were placed, along the ground
+    glm::vec2 centre{0.0f, 0.0f};
+    // Grid distance from the centre where a level starts and ends its morph to the next one
+    float morphStart = 0.0f;
+    float morphEnd = 0.0f;
+    std::vector<ClipmapLevel> levels;
+    // Applied in order, before the windows above are drawn
+    std::vector<ClipmapUpdate> updates;
+};
+
+class Clipmap{
+public:
+    // Vertices along a side of a window: level 0 is one tile of the shared grid indices
+    static constexpr unsigned int DefaultSize = 255;
+    // Levels unless told otherwise, level 9 is 512 vertices a step and sees 65000 away
+    static constexpr unsigned int DefaultLevels = 10;
+    // Levels at most, level 15 is 32768 vertices a step; more would overflow the grid positions
+    static constexpr unsigned int MaxLevels = 16;
+
+    // What the last Update() did
+    struct Stats{
+        // Texels sampled and handed out, and in how many rectangles
+        std::size_t texels = 0;
+        std::size_t updates = 0;
+        // Levels whose window moved, or that were sampled whole
+        std::size_t levelsMoved = 0;
+        double seconds = 0.0;
+    };
+
+    // levelCount windows (1 to MaxLevels) of size vertices a side (made odd, 31 to GridIndices::MaxTileVertices),
+    // sampled from noise through ramp as chunkSize chunks would be. The ramp and pool are shared
+    // and must outlive the clipmap; no ramp is the default one, no pool samples on the caller.
+    Clipmap(unsigned int levelCount, unsigned int size, unsigned int chunkSize, const NoiseContext& noise,
+            const TerrainRamp* ramp = nullptr, ThreadPool* threadPool = nullptr);
+    // Switches to new noise settings, the next Update() samples every level again
+    void SetNoise(const NoiseContext& noise);
+
+    // Slides the windows for the camera at eye and samples what came into view
+    void Update(const glm::vec3& eye);
+    // The windows, and the updates since the last call
+    ClipmapFrame TakeFrame();
+
+    unsigned int GetSize() const;
+    unsigned int GetLevelCount() const;
+    const ClipmapLevel& GetLevel(unsigned int level) const;
+    // The heights a texel's 0 and 65535 stand for
+    float GetMinHeight() const;
+    float GetMaxHeight() const;
+    // Grid distance from the camera where a level starts and ends its morph to the next one
+    float GetMorphStart() const;
+    float GetMorphEnd() const;
+    // How far the outermost window reaches from the camera at least, in full resolution vertices
+    float GetViewDistance() const;
+    const Stats& GetStats() const;
+
+    // Samples width by height vertices of a level from grid position (gridX, gridZ) into
+    // row-major texels and colours, exactly as Update() does
+    void Sample(unsigned int level, int gridX, int gridZ, unsigned int width, unsigned int height,
+                TerrainTexel* texels, std::uint32_t* colors) const;
+    // The texel grid position g of a window of size lands on
+    static unsigned int Wrap(int g, unsigned int size);
+    // The tiles drawing a level: the whole window without an inner one, else the ring
+    // around it. Tile positions are grid vertices within the window.
+    static std::vector<TerrainTile> GetTiles(const ClipmapLevel& level, const ClipmapLevel* inner, unsigned int size);
+
+private:
+    // First grid vertex of a level's window for the camera at eye, along one axis
+    int SnapGrid(float eye, int spacing) const;
+    // Samples a rectangle of grid positions of a level, cut where it wraps around the texture
+    void QueueRect(unsigned int level, int gridX, int gridZ, unsigned int width, unsigned int height);
+
+    unsigned int m_size;
+    unsigned int m_chunkSize;
+    NoiseContext m_noise;
+    const TerrainRamp* m_ramp;
+    ThreadPool* m_threadPool;
+    float m_minHeight = 0.0f;
+    float m_maxHeight = 0.0f;
+
+    std::vector<ClipmapLevel> m_levels;
+    // False until every level was sampled whole with the current noise
+    bool m_valid = false;
+    glm::vec2 m_centre{0.0f, 0.0f};
+    std::vector<ClipmapUpdate> m_updates;
+    Stats m_stats;
+};
+
+#endif
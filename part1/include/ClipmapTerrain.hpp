@@ -0,0 +1,71 @@
+/** @file ClipmapTerrain.hpp
+ *  @brief Draws a Clipmap's levels with clipmap_vert.glsl.
+ *
+ *  Every level has a height texture and a colour texture of the window's
+ *  size, written a rectangle at a time from the frames the Clipmap hands
+ *  out. Level 0 is drawn as one tile, every other level as the four tiles
+ *  of its ring, all with the shared grid indices and no vertex buffer.
+ */
+#ifndef CLIPMAPTERRAIN_HPP
+#define CLIPMAPTERRAIN_HPP
+
+#include "Clipmap.hpp"
+#include "GridIndexCache.hpp"
+#include "Object.hpp"
+#include "Shader.hpp"
+#include "Texture.hpp"
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+class ClipmapTerrain : public Object {
+public:
+    // Empty textures for levelCount windows of size vertices a side. The tiles are
+    // drawn with gridIndices' shared index buffers, which must outlive the terrain.
+    ClipmapTerrain(unsigned int size, unsigned int levelCount, GridIndexCache& gridIndices);
+    // Writes the frame's updates into the textures and takes its windows for drawing
+    void Apply(const ClipmapFrame& frame);
+    // Draws every level's tiles, finest first
+    void Render() override;
+    // The height range, morph and texture units clipmap_vert.glsl needs
+    void SetUniforms(Shader& shader) override;
+
+    unsigned int GetSize() const;
+    unsigned int GetLevelCount() const;
+    // Texture bytes of every level together
+    std::size_t GetTextureBytes() const;
+
+private:
+    struct Level{
+        // TerrainTexels on unit 1, and the colours on unit 0
+        Texture heights;
+        Texture colors;
+        ClipmapLevel window;
+        std::vector<TerrainTile> tiles;
+    };
+
+    unsigned int m_size;
+    // Textures must not be copied, so the levels stay where they were made
+    std::vector<std::unique_ptr<Level>> m_levels;
+    float m_minHeight = 0.0f;
+    float m_maxHeight = 0.0f;
+    glm::vec2 m_centre{0.0f, 0.0f};
+    float m_morphStart = 0.0f;
+    float m_morphEnd = 1.0f;
+
+    // Per level and per tile uniforms of the shader SetUniforms() was given
+    struct LevelUniforms{
+        GLint grid = -1;
+        GLint wrap = -1;
+        GLint spacing = -1;
+        GLint tileOrigin = -1;
+        GLint tileVerticesX = -1;
+    };
+    LevelUniforms m_uniforms;
+    // Index buffers shared with the chunks
+    GridIndexCache& m_gridIndices;
+};
+
+#endif
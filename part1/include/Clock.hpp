@@ -0,0 +1,21 @@
+/** @file Clock.hpp
+ *  @brief The clock every time in the program is taken on.
+ *
+ *  Timings from different threads and modules (job latencies, snapshot
+ *  ages, startup steps, benchmarks) are compared with each other, so they
+ *  all come from this one steady clock, in seconds.
+ */
+#ifndef CLOCK_HPP
+#define CLOCK_HPP
+
+#include <chrono>
+
+namespace Clock{
+    // Seconds since some fixed point
+    inline double Now(){
+        using namespace std::chrono;
+        return duration<double>(steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+#endif
@@ -0,0 +1,45 @@
+/** @file FractalKernel.hpp
+ *  @brief fBm kernels specialized for a fixed number of layers.
+ *
+ *  The layer count, start octave and lacunarity are template arguments,
+ *  so the octave loops are fully unrolled and the sample arrays have a
+ *  fixed size. The weights still come from a siv::BasicFractalLayers,
+ *  because persistence and amplitude can change at runtime.
+ *  FindFractalKernel() maps a runtime layer count to an instantiation,
+ *  and returns nullptr for unusual counts so the caller can fall back
+ *  to the generic loops in BasicFractalLayers.
+ */
+#ifndef FRACTALKERNEL_HPP
+#define FRACTALKERNEL_HPP
+
+#include "PerlinNoise.hpp"
+#include "NoiseSource.hpp"
+
+#include <cstddef>
+
+struct FractalKernel{
+    // Number of layers and first octave this kernel was built for
+    int layers;
+    int startOctave;
+    // Number of distinct octaves it samples
+    int sampleCount;
+    // Samples every octave of one grid row into rows[i], each octave scaled by the lacunarity:
+    // rows[i][j] = source.Noise2D((xStart + j) * scale * L^i, y * L^i)
+    void (*sampleRows)(const NoiseSource& source, float xStart, float scale, float y, std::size_t count, float* const* rows);
+    // Same as BasicFractalLayers<float>::blendRows
+    void (*blendRows)(const siv::BasicFractalLayers<float>& layers, const float* const* rows, std::size_t count, float* out);
+    // sampleRows() plus the derivatives of every sample, with respect to its own noise coordinates
+    void (*sampleRowsGradient)(const NoiseSource& source, float xStart, float scale, float y, std::size_t count,
+                               float* const* rows, float* const* dxRows, float* const* dyRows);
+    // Same as BasicFractalLayers<float>::blendRowsGradient (with lacunarity 2). The gradient is
+    // with respect to the coordinates of the first octave, multiply it by scale for grid steps.
+    void (*blendRowsGradient)(const siv::BasicFractalLayers<float>& layers, const float* const* rows, const float* const* dxRows,
+                              const float* const* dyRows, std::size_t count, float* out, float* outDx, float* outDy);
+    // Same as PerlinNoise::layeredOctave2D_01, bit for bit
+    double (*layeredNoise)(const siv::PerlinNoise& perlin, double x, double y, const siv::FractalLayers& layers);
+};
+
+// Returns the kernel for a layer count and start octave (lacunarity 2), or nullptr if there is none
+const FractalKernel* FindFractalKernel(int layers, int startOctave);
+
+#endif
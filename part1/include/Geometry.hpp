@@ -15,6 +15,15 @@
 // Purpose of this class is to store vertice and triangle information
 class Geometry{
 public:
+	// Floats per vertex of the interleaved buffer
+	static constexpr unsigned int VertexFloats = 14;
+	// Where each attribute starts within a vertex
+	static constexpr unsigned int PositionOffset = 0;
+	static constexpr unsigned int NormalOffset = 3;
+	static constexpr unsigned int TexCoordOffset = 6;
+	static constexpr unsigned int TangentOffset = 8;
+	static constexpr unsigned int BiTangentOffset = 11;
+
 	// Constructor
 	Geometry();
 	// Destructor
@@ -0,0 +1,55 @@
+/** @file GridIndexCache.hpp
+ *  @brief Index buffers of grid tiles, one per tile size, shared by every chunk.
+ *
+ *  The triangles of a terrain tile only depend on its size, so instead of
+ *  an index buffer per chunk there is one buffer per size, built the first
+ *  time a tile of that size is drawn. A tile is drawn from its own first
+ *  vertex with glDrawElementsBaseVertex. A 512 chunk cuts into tiles of
+ *  171 and 172 vertices a side, so all of them share four small buffers.
+ *
+ *  The buffers belong to the context the cache is used on; Clear() them
+ *  before it goes away.
+ */
+#ifndef GRIDINDEXCACHE_HPP
+#define GRIDINDEXCACHE_HPP
+
+#include "GridIndices.hpp"
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <map>
+#include <tuple>
+
+class GridIndexCache{
+public:
+    // Draws every tile as topology
+    explicit GridIndexCache(GridTopology topology = GridTopology::TriangleStrips);
+    // Deletes the buffers, the context must still be current
+    ~GridIndexCache();
+    GridIndexCache(const GridIndexCache&) = delete;
+    GridIndexCache& operator=(const GridIndexCache&) = delete;
+
+    // Draws the triangles of a verticesX by verticesZ tile whose first vertex is baseVertex
+    // of the bound vertex array, building its index buffer on first use
+    void Draw(unsigned int verticesX, unsigned int verticesZ, GLint baseVertex);
+    // Deletes every buffer
+    void Clear();
+
+    GridTopology GetTopology() const;
+    // Buffers made so far, and the bytes they hold
+    std::size_t GetBufferCount() const;
+    std::size_t GetBufferBytes() const;
+
+private:
+    struct Buffer{
+        GLuint id = 0;
+        GLsizei count = 0;
+    };
+
+    GridTopology m_topology;
+    // By vertices along x and z
+    std::map<std::tuple<unsigned int, unsigned int>, Buffer> m_buffers;
+    std::size_t m_bufferBytes = 0;
+};
+
+#endif
@@ -0,0 +1,46 @@
+/** @file GridIndices.hpp
+ *  @brief The triangles of a regular grid of vertices, as 16-bit indices.
+ *
+ *  Every terrain tile of the same size has the same triangles, so their
+ *  indices are built once per size and shared (see GridIndexCache).
+ *  Tiles are at most MaxTileVertices a side so every index fits in 16
+ *  bits with 0xFFFF left over for primitive restart.
+ *
+ *  The quads are walked in stripes StripeQuads wide, row by row within a
+ *  stripe. The vertices below a row are the vertices above the next one,
+ *  and a stripe is narrow enough that they are still in the GPU's vertex
+ *  cache by then. Vertices are row-major within the tile.
+ */
+#ifndef GRIDINDICES_HPP
+#define GRIDINDICES_HPP
+
+#include <cstdint>
+#include <vector>
+
+// How the grid's triangles are drawn
+enum class GridTopology{
+    // GL_TRIANGLES, 6 indices per quad
+    Triangles,
+    // GL_TRIANGLE_STRIP, one strip per stripe row, ended by RestartIndex
+    TriangleStrips
+};
+
+class GridIndices{
+public:
+    // Vertices along a side of a tile: 255^2 keeps 0xFFFF out of the vertex range
+    static constexpr unsigned int MaxTileVertices = 255;
+    // Ends a strip when primitive restart is on
+    static constexpr std::uint16_t RestartIndex = 0xFFFF;
+    // Quads across a stripe, the last one may be narrower. Two rows of a stripe are
+    // 16 vertices, which still fit a 16-entry FIFO cache; one quad more and it thrashes.
+    static constexpr unsigned int StripeQuads = 7;
+
+    // The triangles of a grid of verticesX by verticesZ vertices, two per quad,
+    // wound like the per-chunk index list chunks used to upload
+    static std::vector<std::uint16_t> Build(unsigned int verticesX, unsigned int verticesZ, GridTopology topology);
+    // Cuts a side of quads into as few tiles as fit MaxTileVertices, as even as possible.
+    // Returns the first quad of every tile and then quads; neighbouring tiles share the vertices between them.
+    static std::vector<unsigned int> SplitSide(unsigned int quads);
+};
+
+#endif
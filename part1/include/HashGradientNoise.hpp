@@ -0,0 +1,44 @@
+/** @file HashGradientNoise.hpp
+ *  @brief Perlin style gradient noise without a permutation table.
+ *
+ *  The gradient of each lattice corner comes from an integer hash of
+ *  its coordinates and the seed. There are no table lookups, so the
+ *  SIMD kernels need no gathers, and the noise never repeats.
+ */
+#ifndef HASHGRADIENTNOISE_HPP
+#define HASHGRADIENTNOISE_HPP
+
+#include "NoiseSource.hpp"
+#include "PerlinNoiseBatch.hpp"
+
+#include <cstdint>
+
+class HashGradientNoise : public NoiseSource{
+public:
+    // Uses the best kernel for this CPU
+    HashGradientNoise(std::uint32_t seed);
+    // Same as above, but forces a kernel (unsupported ones fall back to scalar)
+    HashGradientNoise(std::uint32_t seed, PerlinNoiseBatch::Kernel kernel);
+    // Destructor
+    ~HashGradientNoise();
+    // Evaluates a single point, in [-1, 1]
+    float Noise2D(float x, float y) const override;
+    // Evaluates a row of a regular grid with the SIMD kernel
+    void Noise2DRow(float xStart, float xScale, float y, std::size_t count, float* out) const override;
+    // Evaluates arbitrary points with the SIMD kernel
+    void Noise2DPoints(const float* xs, const float* ys, std::size_t count, float* out) const override;
+    // Evaluates a single point and its analytic derivatives (scalar)
+    float Noise2DGradient(float x, float y, float& dx, float& dy) const override;
+    // Returns NoiseBackend::HashGradient
+    NoiseBackend GetBackend() const override;
+    // Returns the kernel we run
+    PerlinNoiseBatch::Kernel GetKernel() const;
+
+private:
+    // Mixed into every corner hash
+    std::uint32_t m_seed;
+    // Which kernel we dispatch to
+    PerlinNoiseBatch::Kernel m_kernel;
+};
+
+#endif
@@ -9,6 +9,7 @@
 #ifndef IMAGE_HPP
 #define IMAGE_HPP
 
+#include <cstdint>
 #include <string>
 
 class Image {
@@ -20,6 +21,10 @@ public:
     ~Image();
     // Loads a PPM from memory.
     void LoadPPM(bool flip);
+    // Parses the contents of a P3 (text) or P6 (binary) PPM file. Comments and any
+    // whitespace are allowed between values. Does no file or OpenGL work, so it
+    // can run on any thread. Returns false if the header is broken.
+    bool ParsePPM(const std::string& contents, bool flip);
     // Return the width
     inline int GetWidth(){
         return m_width;
@@ -57,7 +62,7 @@ private:
     // Filepath to the image loaded
     std::string m_filepath;
     // Raw pixel data
-    uint8_t* m_pixelData;
+    uint8_t* m_pixelData{nullptr};
     // Size and format of image
     int m_width{0}; // Width of the image
     int m_height{0}; // Height of the image
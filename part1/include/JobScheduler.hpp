@@ -0,0 +1,126 @@
+/** @file JobScheduler.hpp
+ *  @brief Work-stealing scheduler for independent jobs, cheapest priority first.
+ *
+ *  Every worker has its own queue, ordered by priority (lower runs
+ *  first). Submit() deals jobs out round robin, a worker runs the best
+ *  job of its own queue and, once that is empty, steals the best job of
+ *  the other queues. Priorities can change while jobs wait: set them on
+ *  the jobs and call Resort().
+ *
+ *  A job can be cancelled at any time. A queued job is dropped without
+ *  running, a running one sees IsCancelled() and may stop early, and the
+ *  time spent on a job that ends up cancelled is counted as wasted.
+ */
+#ifndef JOBSCHEDULER_HPP
+#define JOBSCHEDULER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobScheduler{
+public:
+    class Job{
+    public:
+        enum State{ Queued, Running, Finished, Cancelled };
+
+        // Lower runs first, picked up by the next Resort()
+        void SetPriority(float priority);
+        float GetPriority() const;
+        // True once the job has been cancelled, long running work checks it between steps
+        bool IsCancelled() const;
+        // Finished means the work ran to the end and was not cancelled
+        State GetState() const;
+        // Seconds from Submit() to the end of the work, 0 until then
+        double GetLatency() const;
+
+    private:
+        friend class JobScheduler;
+
+        std::function<void(Job&)> m_work;
+        std::atomic<float> m_priority{0.0f};
+        std::atomic<bool> m_cancelled{false};
+        std::atomic<int> m_state{Queued};
+        // Seconds since some fixed point
+        double m_submitTime = 0.0;
+        double m_runSeconds = 0.0;
+        double m_latency = 0.0;
+    };
+    typedef std::shared_ptr<Job> JobHandle;
+
+    // What the scheduler has done so far
+    struct Stats{
+        // Jobs waiting for a worker, and jobs being worked on
+        std::size_t queued = 0;
+        std::size_t running = 0;
+        std::size_t finished = 0;
+        // Cancelled jobs that never ran, and ones that ran (or had run) for nothing
+        std::size_t cancelledQueued = 0;
+        std::size_t cancelledRunning = 0;
+        // Jobs taken from another worker's queue
+        std::size_t steals = 0;
+        // Seconds spent working on jobs that were cancelled
+        double wastedSeconds = 0.0;
+    };
+
+    // 0 starts one worker per hardware thread
+    JobScheduler(unsigned int threadCount = 0);
+    // Cancels what is left and joins the workers
+    ~JobScheduler();
+    JobScheduler(const JobScheduler&) = delete;
+    JobScheduler& operator=(const JobScheduler&) = delete;
+
+    // Queues work, which is called on a worker with its own job
+    JobHandle Submit(std::function<void(Job&)> work, float priority);
+    // Cancels a job. Returns false if it had already finished, its result is then wasted.
+    bool Cancel(const JobHandle& job);
+    // Re-orders every queue by the current job priorities
+    void Resort();
+    // Blocks until job is neither queued nor running
+    void Wait(const JobHandle& job);
+
+    Stats GetStats() const;
+    unsigned int GetThreadCount() const;
+
+private:
+    // A job and the priority its queue is ordered by
+    struct Entry{
+        float priority;
+        JobHandle job;
+    };
+    struct Queue{
+        std::mutex mutex;
+        // A heap, best priority at the front
+        std::vector<Entry> entries;
+    };
+
+    // Takes the best job of queue, nullptr if it is empty
+    JobHandle PopBest(Queue& queue);
+    // Takes a job for worker index, from its own queue first
+    JobHandle TakeJob(unsigned int index);
+    void Run(const JobHandle& job);
+    void WorkerLoop(unsigned int index);
+
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_workers;
+    std::atomic<unsigned int> m_nextQueue{0};
+    // Jobs in the queues that still have to run, guarded by m_mutex for the sleep
+    std::atomic<std::size_t> m_queued{0};
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stop = false;
+
+    // Stats and job states, guarded by m_statsMutex
+    mutable std::mutex m_statsMutex;
+    // Signalled whenever a job stops running
+    std::condition_variable m_jobDone;
+    Stats m_stats;
+};
+
+#endif
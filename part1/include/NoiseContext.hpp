@@ -0,0 +1,75 @@
+/** @file NoiseContext.hpp
+ *  @brief Seeded noise state shared by all terrain chunks.
+ *
+ *  Seeding a siv::PerlinNoise runs an mt19937 and shuffles a 256
+ *  entry permutation table. A NoiseContext looks the table up in a
+ *  registry instead, so it is built once per seed and then shared
+ *  read-only between chunks and threads. The other noise backends
+ *  are built from the same seed and handed out as a NoiseSource.
+ */
+#ifndef NOISECONTEXT_HPP
+#define NOISECONTEXT_HPP
+
+#include "PerlinNoise.hpp"
+#include "PerlinNoiseBatch.hpp"
+#include "NoiseSource.hpp"
+
+#include <memory>
+#include <cstddef>
+
+// The inputs of the layered noise used to build the terrain.
+// The defaults reproduce the original hard-coded terrain.
+struct NoiseSettings{
+    // Seed used to shuffle the permutation table
+    siv::PerlinNoise::seed_type seed = 123456u;
+    // Which noise function the terrain is built from
+    NoiseBackend backend = NoiseBackend::Perlin;
+    // Number of octaves to layer, and the first octave to use
+    int numOctaves = 6;
+    int startOctave = 1;
+    // Starting values for the octave loop
+    float persistence = 0.3f;
+    float amplitude = 1.0f;
+    float frequency = 4.0f;
+    // How persistence and amplitude change from one octave to the next
+    float persistenceStep = 0.05f;
+    float gain = 0.5f;
+    // Largest height error (in [0, 1]) allowed from sampling the smooth octaves on a
+    // coarser grid and interpolating them. 0 samples every octave at every vertex.
+    // The app leaves it at 0: within a visible error it saves a few percent at most
+    // (Benchmark::MultiresSampling in ./lab --bench), the fine octaves and the blend cost the same.
+    float multiresTolerance = 0.0f;
+};
+
+class NoiseContext{
+public:
+    // Looks up (or builds) the permutation table for settings.seed
+    NoiseContext(const NoiseSettings& settings = NoiseSettings());
+    // Destructor
+    ~NoiseContext();
+    // Returns the shared, read-only Perlin noise for our seed
+    const siv::PerlinNoise& GetPerlin() const;
+    // Returns the batch (SIMD) evaluator for the same noise
+    const PerlinNoiseBatch& GetPerlinBatch() const;
+    // Returns the noise function selected by settings.backend
+    const NoiseSource& GetSource() const;
+    // Returns any of the noise functions for our seed
+    const NoiseSource& GetSource(NoiseBackend backend) const;
+    // Returns the settings this context was created with
+    const NoiseSettings& GetSettings() const;
+    // Returns how many seeds have a table in the registry
+    static std::size_t GetRegistrySize();
+
+    // Everything that is built from a seed
+    struct SeedTables;
+
+private:
+    // Finds the tables for a seed, building them the first time they are asked for
+    static std::shared_ptr<const SeedTables> AcquireTables(siv::PerlinNoise::seed_type seed);
+    // The settings we were created with
+    NoiseSettings m_settings;
+    // Tables shared with every other context using the same seed
+    std::shared_ptr<const SeedTables> m_tables;
+};
+
+#endif
@@ -0,0 +1,174 @@
+/** @file NoiseGraph.hpp
+ *  @brief libnoise style module graphs, compiled into a fused evaluator.
+ *
+ *  A NoiseGraph describes a terrain function as a DAG of modules: fractal
+ *  and ridged sources, arithmetic, select/blend by a mask, curves, terraces
+ *  and domain warps. CompiledNoiseGraph flattens it into a list of
+ *  instructions over tile sized registers, and runs the whole list on one
+ *  tile of samples before moving to the next. Registers are reused as soon
+ *  as their last reader has run, so a graph needs a few KB of scratch that
+ *  stays in L1, instead of one full chunk buffer per module. Every
+ *  instruction is a loop over the samples of the tile, so the arithmetic
+ *  is SIMD across samples and the sources use their batch kernels.
+ */
+#ifndef NOISEGRAPH_HPP
+#define NOISEGRAPH_HPP
+
+#include "NoiseContext.hpp"
+#include "NoiseSource.hpp"
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+class NoiseGraph{
+public:
+    // Index of a module in the graph
+    typedef int Node;
+    // What a builder returns for a module it rejected
+    static constexpr Node InvalidNode = -1;
+
+    // The kinds of module
+    enum class Op{
+        Constant,
+        Fractal,    // fBm of a NoiseSource, normalized to about [-1, 1]
+        Ridged,     // ridged multifractal (libnoise's RidgedMulti)
+        Add,
+        Multiply,
+        Min,
+        Max,
+        ScaleBias,  // a * scale + bias
+        Abs,
+        Clamp,
+        Blend,      // lerp(a, b, mask * 0.5 + 0.5)
+        Select,     // a below threshold of control, b above, smoothstep over +-falloff
+        Curve,      // piecewise linear through control points
+        Terrace,    // libnoise Terrace: flat steps at the levels, quadratic in between
+        Warp        // a evaluated at (x + strength * dx, y + strength * dy)
+    };
+
+    // One module. Inputs are other nodes, parameters depend on the op.
+    struct Module{
+        Op op;
+        Node inputs[3];
+        float params[4];
+        NoiseBackend backend;
+        int octaves;
+        // Control points of Curve (x, y pairs) and Terrace (levels)
+        std::vector<float> points;
+    };
+
+    // Constructor
+    NoiseGraph();
+    // Destructor
+    ~NoiseGraph();
+
+    // Every builder checks its module as it is added: inputs have to be modules added before it,
+    // and points as described. A module that fails is not added, the builder returns InvalidNode
+    // and the graph stays invalid (see IsValid()).
+
+    // Sources. Coordinates are multiplied by frequency, and by lacunarity for each further octave.
+    Node Constant(float value);
+    Node Fractal(NoiseBackend backend, float frequency, int octaves, float gain = 0.5f, float lacunarity = 2.0f);
+    Node Ridged(NoiseBackend backend, float frequency, int octaves, float gain = 2.0f, float lacunarity = 2.0f);
+    // Combiners
+    Node Add(Node a, Node b);
+    Node Multiply(Node a, Node b);
+    Node Min(Node a, Node b);
+    Node Max(Node a, Node b);
+    Node ScaleBias(Node a, float scale, float bias);
+    Node Abs(Node a);
+    Node Clamp(Node a, float lower, float upper);
+    Node Blend(Node a, Node b, Node mask);
+    Node Select(Node a, Node b, Node control, float threshold, float falloff);
+    // points are (input, output) pairs, at least one, sorted by input
+    Node Curve(Node a, const std::vector<std::pair<float, float>>& points);
+    // levels sorted from low to high, at least one
+    Node Terrace(Node a, const std::vector<float>& levels);
+    Node Warp(Node a, Node dx, Node dy, float strength);
+
+    // Picks the node the graph evaluates to (the last one added by default).
+    // Returns false, and keeps the output, if node is not in the graph.
+    bool SetOutput(Node node);
+    Node GetOutput() const;
+    // False once a module was rejected, GetError() says why
+    bool IsValid() const;
+    // Why the first module was rejected, empty for a valid graph
+    const std::string& GetError() const;
+    // Returns the number of modules
+    std::size_t GetModuleCount() const;
+    // Returns a module
+    const Module& GetModule(Node node) const;
+
+private:
+    // Adds a module reading its first inputCount inputs and returns its node, or InvalidNode if an input is not in the graph
+    Node AddModule(const Module& module, int inputCount);
+    // Marks the graph invalid, keeping the first error, and returns InvalidNode
+    Node Reject(const std::string& error);
+
+    std::vector<Module> m_modules;
+    Node m_output = -1;
+    std::string m_error;
+};
+
+class CompiledNoiseGraph{
+public:
+    // Samples per tile: the registers of a graph fit in L1 at this size
+    static constexpr std::size_t TileSize = 256;
+
+    // Flattens graph into instructions and allocates its registers.
+    // The noise functions come from noise, which is kept alive with the program.
+    // An empty graph evaluates to 0, and so does an invalid one.
+    CompiledNoiseGraph(const NoiseGraph& graph, const NoiseContext& noise);
+    // Destructor
+    ~CompiledNoiseGraph();
+
+    // Evaluates the graph on a width x height grid, one tile at a time:
+    // out[j * width + i] = graph(xStart + i * step, yStart + j * step)
+    void EvaluateGrid(float xStart, float yStart, float step, unsigned int width, unsigned int height, float* out) const;
+    // Evaluates the graph at arbitrary points, one tile at a time
+    void EvaluatePoints(const float* xs, const float* ys, std::size_t count, float* out) const;
+    // Runs every instruction over all the points before the next one, with a full size
+    // buffer per instruction: what evaluating module by module costs. Same results.
+    void EvaluateNodeByNode(const float* xs, const float* ys, std::size_t count, float* out) const;
+
+    // Returns the number of instructions (modules, plus a coordinate pair per warp)
+    std::size_t GetInstructionCount() const;
+    // Returns the number of tile registers the fused evaluator needs, coordinates included
+    std::size_t GetRegisterCount() const;
+
+    // One step of the program. Registers are virtual until allocation.
+    struct Instruction{
+        NoiseGraph::Op op;
+        // For a warp: which coordinate it writes, 0 for x and 1 for y
+        int axis;
+        int dst;
+        int a, b, c;
+        // Coordinate registers a source reads
+        int x, y;
+        float params[4];
+        const NoiseSource* source;
+        int octaves;
+        // Offset and count of the op's control points in m_points
+        int pointsOffset;
+        int pointsCount;
+    };
+
+private:
+    // Runs one instruction over count samples of the given registers
+    void Execute(const Instruction& instruction, float* const* registers, std::size_t count, float* scratch) const;
+
+    // Keeps the noise tables alive
+    NoiseContext m_noise;
+    // The program with virtual registers (node by node) and with tile registers (fused)
+    std::vector<Instruction> m_virtual;
+    std::vector<Instruction> m_fused;
+    std::vector<float> m_points;
+    int m_virtualCount = 0;
+    int m_registerCount = 0;
+    int m_outputVirtual = 0;
+    int m_outputRegister = 0;
+};
+
+#endif
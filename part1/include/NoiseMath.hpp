@@ -0,0 +1,35 @@
+/** @file NoiseMath.hpp
+ *  @brief Scalar pieces the noise kernels share: lattice hashing, floor and interpolation.
+ *
+ *  Only the noise sources include this. The hash constants have to be the
+ *  same in every kernel of a source, or its SIMD and scalar paths would
+ *  pick different gradients and cells.
+ */
+#ifndef NOISEMATH_HPP
+#define NOISEMATH_HPP
+
+#include <cstdint>
+
+namespace NoiseMath{
+    // Multipliers for the lattice hashes
+    constexpr std::uint32_t PrimeX = 0x8da6b343u;
+    constexpr std::uint32_t PrimeY = 0xd8163841u;
+    constexpr std::uint32_t Mix = 0x5bd1e995u;
+
+    // Rounds towards minus infinity, faster than std::floor for the range noise coordinates take
+    inline std::int32_t FastFloor(float x){
+        const std::int32_t i = static_cast<std::int32_t>(x);
+        return (x < static_cast<float>(i)) ? (i - 1) : i;
+    }
+
+    // Perlin's quintic, 0 and 1 with no slope or curvature at either end
+    inline float Fade(float t){
+        return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+    }
+
+    inline float Lerp(float a, float b, float t){
+        return a + (b - a) * t;
+    }
+}
+
+#endif
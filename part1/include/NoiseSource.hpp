@@ -0,0 +1,50 @@
+/** @file NoiseSource.hpp
+ *  @brief Common interface of the 2D noise functions the terrain can use.
+ *
+ *  Every backend returns values in roughly [-1, 1] and is sampled with
+ *  the same coordinates, so the fractal layering in Terrain does not
+ *  need to know which one it is using. Every backend can also return
+ *  its analytic gradient, which the terrain turns into normals.
+ */
+#ifndef NOISESOURCE_HPP
+#define NOISESOURCE_HPP
+
+#include <cstddef>
+#include <string>
+
+// The noise functions a NoiseContext can hand out
+enum class NoiseBackend{
+    Perlin = 0,     // siv::PerlinNoise (4 corners, permutation table)
+    Simplex,        // 2D simplex (3 corners, permutation table)
+    HashGradient,   // Perlin style gradient noise, corners hashed without a table
+    Worley,         // Cellular noise, distance to the closest hashed feature point
+    Count
+};
+
+class NoiseSource{
+public:
+    // Destructor
+    virtual ~NoiseSource();
+    // Evaluates a single point
+    virtual float Noise2D(float x, float y) const = 0;
+    // Evaluates a row of a regular grid:
+    // out[i] = Noise2D((xStart + i) * xScale, y) for every i < count
+    virtual void Noise2DRow(float xStart, float xScale, float y, std::size_t count, float* out) const;
+    // Evaluates arbitrary points:
+    // out[i] = Noise2D(xs[i], ys[i]) for every i < count
+    virtual void Noise2DPoints(const float* xs, const float* ys, std::size_t count, float* out) const;
+    // Evaluates a single point and its analytic derivatives
+    virtual float Noise2DGradient(float x, float y, float& dx, float& dy) const = 0;
+    // Noise2DRow() plus the derivatives along x and y of every sample.
+    // The derivatives are with respect to the noise coordinates, not the grid index.
+    virtual void Noise2DRowGradient(float xStart, float xScale, float y, std::size_t count, float* out, float* dx, float* dy) const;
+    // Returns which backend this is
+    virtual NoiseBackend GetBackend() const = 0;
+
+    // Returns the name used for a backend on the command line
+    static const char* GetBackendName(NoiseBackend backend);
+    // Turns a command line name back into a backend. Returns false if the name is unknown.
+    static bool ParseBackend(const std::string& name, NoiseBackend& backend);
+};
+
+#endif
@@ -32,7 +32,7 @@ public:
     // Object Constructor
     Object();
     // Object destructor
-    ~Object();
+    virtual ~Object();
     // Load a texture
     void LoadTexture(std::string fileName);
     // Create a textured quad
@@ -40,6 +40,8 @@ public:
     void MakeTexturedCube(std::string fileName);
     // How to draw the object
     virtual void Render();
+    // Sets the uniforms only this object needs, with shader bound
+    virtual void SetUniforms(Shader& shader);
 protected: // Classes that inherit from Object are intended to be overridden.
 
 	// Helper method for when we are ready to draw or update our object
@@ -0,0 +1,125 @@
+/** @file OctaveCache.hpp
+ *  @brief Per-chunk cache of the raw octave samples behind the terrain.
+ *
+ *  Every fractal layer of a chunk is a weighted sum of the same few
+ *  octave planes, and only the weights depend on persistence and
+ *  amplitude. Keeping the planes (value and gradient) around lets the
+ *  tuning panel re-blend a chunk instead of sampling it again. Only a
+ *  change of seed, backend, frequency or octave count needs new samples.
+ *
+ *  Octaves may have been sampled on a coarse grid (see OctaveSampler.hpp),
+ *  so the planes remember their strides and the caller checks they are
+ *  still fine enough for the new weights.
+ *
+ *  Planes are large (3 floats per octave per vertex), so the cache has
+ *  a byte budget and drops the least recently used chunk when it is full.
+ */
+#ifndef OCTAVECACHE_HPP
+#define OCTAVECACHE_HPP
+
+#include "NoiseContext.hpp"
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Every octave of one chunk: value, d/dx and d/dy planes, chunkSize * chunkSize floats each
+class OctavePlanes{
+public:
+    // Allocates octaveCount planes of each kind
+    OctavePlanes(int octaveCount, unsigned int chunkSize);
+    // Returns the number of octaves stored
+    int GetOctaveCount() const { return m_octaveCount; }
+    // Returns the width (and height) of a plane
+    unsigned int GetChunkSize() const { return m_chunkSize; }
+    // Returns the first sample of an octave plane
+    float* Value(int octave) { return Plane(0, octave); }
+    float* Dx(int octave) { return Plane(1, octave); }
+    float* Dy(int octave) { return Plane(2, octave); }
+    const float* Value(int octave) const { return Plane(0, octave); }
+    const float* Dx(int octave) const { return Plane(1, octave); }
+    const float* Dy(int octave) const { return Plane(2, octave); }
+    // Returns how much memory the planes use
+    std::size_t GetBytes() const { return m_data.size() * sizeof(float); }
+    // Spacing, in vertices, of the grid an octave was sampled on before upsampling
+    unsigned int GetStride(int octave) const { return m_strides[octave]; }
+    void SetStride(int octave, unsigned int stride) { m_strides[octave] = stride; }
+    // Returns true if no octave was sampled coarser than strides asks for
+    bool IsWithinStrides(const std::vector<unsigned int>& strides) const;
+
+private:
+    float* Plane(int kind, int octave) { return m_data.data() + (static_cast<std::size_t>(kind * m_octaveCount + octave) * m_chunkSize * m_chunkSize); }
+    const float* Plane(int kind, int octave) const { return m_data.data() + (static_cast<std::size_t>(kind * m_octaveCount + octave) * m_chunkSize * m_chunkSize); }
+
+    int m_octaveCount;
+    unsigned int m_chunkSize;
+    std::vector<float> m_data;
+    std::vector<unsigned int> m_strides;
+};
+
+class OctaveCache{
+public:
+    // Everything the octave samples of a chunk depend on
+    struct Key{
+        siv::PerlinNoise::seed_type seed;
+        NoiseBackend backend;
+        float frequency;
+        unsigned int chunkSize;
+        float xOffset;
+        float zOffset;
+        int octaveCount;
+        // Level of detail grid stride, coarser levels sample fewer points of the same chunk
+        unsigned int gridStride;
+
+        bool operator<(const Key& other) const;
+    };
+
+    // Enough for the 3x3 chunks around the camera at 512x512 and the default 6 layers
+    static constexpr std::size_t DefaultMaxBytes = std::size_t(320) << 20;
+
+    // Creates an empty cache that holds at most maxBytes of planes
+    OctaveCache(std::size_t maxBytes = DefaultMaxBytes);
+    // Destructor
+    ~OctaveCache();
+    // Returns the planes for key and marks them as recently used, or nullptr on a miss
+    std::shared_ptr<const OctavePlanes> Find(const Key& key);
+    // Stores planes for key, evicting old chunks until they fit.
+    // Planes bigger than the whole budget are not kept.
+    void Insert(const Key& key, std::shared_ptr<const OctavePlanes> planes);
+    // Drops every chunk
+    void Clear();
+    // Changes the budget, evicting right away if needed
+    void SetMaxBytes(std::size_t maxBytes);
+    std::size_t GetMaxBytes() const;
+    // Returns the memory held by the cached planes
+    std::size_t GetBytes() const;
+    // Returns the number of cached chunks
+    std::size_t GetEntryCount() const;
+    // Lookup statistics since the cache was created
+    std::size_t GetHits() const;
+    std::size_t GetMisses() const;
+
+    // Builds the key for a chunk
+    static Key MakeKey(const NoiseSettings& settings, float frequency, unsigned int chunkSize, float xOffset, float zOffset, int octaveCount,
+                       unsigned int gridStride = 1);
+
+private:
+    // Evicts least recently used chunks until the cache holds at most maxBytes. Caller holds m_mutex.
+    void EvictTo(std::size_t maxBytes);
+
+    // Most recently used chunk at the front
+    typedef std::list<std::pair<Key, std::shared_ptr<const OctavePlanes>>> EntryList;
+    EntryList m_entries;
+    std::map<Key, EntryList::iterator> m_index;
+    std::size_t m_maxBytes;
+    std::size_t m_bytes = 0;
+    std::size_t m_hits = 0;
+    std::size_t m_misses = 0;
+    // Chunks may be generated from several threads
+    mutable std::mutex m_mutex;
+};
+
+#endif
@@ -0,0 +1,77 @@
+/** @file OctaveSampler.hpp
+ *  @brief Samples whole octave planes, each on the coarsest grid its error allows.
+ *
+ *  The low octaves of the terrain change over dozens of vertices, so a
+ *  grid that is much coarser than the vertex grid, bilinearly upsampled,
+ *  is indistinguishable from sampling every vertex. The error of bilinear
+ *  interpolation grows with the square of the node spacing (in noise
+ *  units) times the curvature of the noise. The curvature of each backend
+ *  was measured, so a stride can be picked per octave for an error bound
+ *  on the final height. The high octaves still get one sample per vertex.
+ *  Rows are produced one at a time, like FractalKernel::sampleRowsGradient,
+ *  so the coarse octaves only keep two rows of nodes around.
+ */
+#ifndef OCTAVESAMPLER_HPP
+#define OCTAVESAMPLER_HPP
+
+#include "PerlinNoise.hpp"
+#include "NoiseSource.hpp"
+
+#include <cstddef>
+#include <vector>
+
+// Coarsest spacing, in vertices, an octave is ever sampled at
+static constexpr unsigned int MaxOctaveStride = 64;
+
+// Returns c such that bilinear interpolation of the backend over nodes h noise units
+// apart is off by at most about c * h * h
+float GetInterpolationErrorScale(NoiseBackend backend);
+
+// Picks a power of two stride for every octave of layers, so that the blended height
+// (in [0, 1]) is at most tolerance away from sampling every vertex.
+// scale is the noise step between two vertices of the first octave.
+// A tolerance of 0 or less samples every vertex.
+std::vector<unsigned int> ChooseOctaveStrides(const siv::BasicFractalLayers<float>& layers, NoiseBackend backend,
+                                              float scale, float tolerance, unsigned int chunkSize);
+
+class OctaveRowSampler{
+public:
+    // Samples the octaves of a chunk row by row, octave i at scale * 2^i, every strides[i] vertices.
+    // Vertex x of row z of octave i is source.Noise2D((x + xOffset) * scale * 2^i, (z + zOffset) * scale * 2^i),
+    // exactly for stride 1 and at the nodes, bilinearly interpolated between them.
+    // Nothing is sampled until the first SampleRow().
+    OctaveRowSampler(const NoiseSource& source, float xOffset, float zOffset, float scale,
+                     const std::vector<unsigned int>& strides, unsigned int chunkSize);
+    // Fills rows[i], dxRows[i] and dyRows[i] with row z of every octave.
+    // Rows are cheapest in increasing order from any first row, each node row is then sampled once.
+    void SampleRow(unsigned int z, float* const* rows, float* const* dxRows, float* const* dyRows);
+    // Returns the number of noise evaluations so far
+    std::size_t GetEvaluations() const { return m_evaluations; }
+
+private:
+    // A coarse octave keeps the two node rows around the current row (value, dx, dy of each),
+    // already interpolated along x, so every vertex row is one lerp between them
+    struct CoarseOctave{
+        unsigned int stride;
+        unsigned int nodes;
+        // Index of the node row in slot lowerSlot, the other slot holds the next one.
+        // Neither is valid before the first row.
+        unsigned int firstNode = 0;
+        int lowerSlot = 0;
+        bool primed = false;
+        std::vector<float> nodeRows;
+        std::vector<float> nodes3;
+    };
+    // Samples node row k of octave i and interpolates it along x into slot
+    void SampleNodeRow(int octave, unsigned int k, int slot);
+
+    const NoiseSource& m_source;
+    float m_xOffset;
+    float m_zOffset;
+    unsigned int m_chunkSize;
+    std::vector<float> m_octaveScales;
+    std::vector<CoarseOctave> m_octaves;
+    std::size_t m_evaluations = 0;
+};
+
+#endif
@@ -26,6 +26,7 @@
 //----------------------------------------------------------------------------------------
 
 # pragma once
+# include <cstddef>
 # include <cstdint>
 # include <algorithm>
 # include <array>
@@ -83,6 +84,22 @@
 
 namespace siv
 {
+	template <class Float, class Amplitude = Float>
+	class BasicFractalLayers;
+
+	// A noise value and its partial derivatives
+	template <class Float>
+	struct BasicNoiseGradient2D
+	{
+		Float value;
+
+		Float dx;
+
+		Float dy;
+	};
+
+	using NoiseGradient2D = BasicNoiseGradient2D<double>;
+
 	template <class Float>
 	class BasicPerlinNoise
 	{
@@ -236,13 +253,132 @@ namespace siv
 		[[nodiscard]]
 		value_type normalizedOctave3D_01(value_type x, value_type y, value_type z, std::int32_t octaves, value_type persistence = value_type(0.5)) const noexcept;
 
+		///////////////////////////////////////
+		//
+		//	Layered octave noise (Each octave is sampled once, the result is in the range [0, 1])
+		//
+
+		template <class Amplitude>
+		[[nodiscard]]
+		value_type layeredOctave2D_01(value_type x, value_type y, const BasicFractalLayers<Float, Amplitude>& layers) const noexcept;
+
+		///////////////////////////////////////
+		//
+		//	Noise with its analytic gradient (value is the same as the functions above)
+		//
+
+		[[nodiscard]]
+		BasicNoiseGradient2D<value_type> noise2DGradient(value_type x, value_type y) const noexcept;
+
+		template <class Amplitude>
+		[[nodiscard]]
+		BasicNoiseGradient2D<value_type> layeredOctave2DGradient_01(value_type x, value_type y, const BasicFractalLayers<Float, Amplitude>& layers) const noexcept;
+
 	private:
 
+		// Copies m_permutation twice into m_permutation2D
+		constexpr void updateLookup2D() noexcept;
+
 		state_type m_permutation;
+
+		// m_permutation repeated, so noise2D() can index it with (p[x] + y + 1) without masking
+		std::array<std::uint8_t, 512> m_permutation2D{};
 	};
 
 	using PerlinNoise = BasicPerlinNoise<double>;
 
+	///////////////////////////////////////
+	//
+	//	Layer schedule for layeredOctave2D_01()
+	//
+	//	Layer i is octave2D_01(x * 2^i, y * 2^i, startOctave + i, persistence_i) scaled by
+	//	amplitude_i, and the result is the weighted mean of the layers.
+	//	Layer i therefore shares all but its top octave with layer i + 1, so only
+	//	sampleCount() distinct octaves exist. Each one is sampled once and the
+	//	per-octave weights (persistence_i^k) are computed up front in addLayer().
+	//
+	//	Amplitude is the type the layers are summed in, so a float schedule
+	//	gives the same result as a float loop over octave2D_01().
+	//
+	template <class Float, class Amplitude>
+	class BasicFractalLayers
+	{
+	public:
+
+		static_assert(std::is_floating_point_v<Float>);
+
+		static_assert(std::is_floating_point_v<Amplitude>);
+
+		using value_type = Float;
+
+		using amplitude_type = Amplitude;
+
+		// Most layers a schedule can hold
+		static constexpr std::int32_t MaxLayers = 16;
+
+		// Most octaves a single layer can sum
+		static constexpr std::int32_t MaxOctaves = 16;
+
+		// Most distinct octaves a schedule can sample
+		static constexpr std::int32_t MaxSamples = (MaxLayers + MaxOctaves - 1);
+
+		SIVPERLIN_NODISCARD_CXX20
+		explicit BasicFractalLayers(std::int32_t startOctave = 1) noexcept;
+
+		// Appends a layer one octave above the previous one. Returns false if the schedule is full.
+		bool addLayer(amplitude_type amplitude, value_type persistence) noexcept;
+
+		[[nodiscard]]
+		std::int32_t layerCount() const noexcept;
+
+		[[nodiscard]]
+		std::int32_t sampleCount() const noexcept;
+
+		[[nodiscard]]
+		amplitude_type weightSum() const noexcept;
+
+		[[nodiscard]]
+		std::int32_t startOctave() const noexcept;
+
+		[[nodiscard]]
+		amplitude_type amplitude(std::int32_t layer) const noexcept;
+
+		// Weight of octave k of a layer, k < (startOctave() + layer)
+		[[nodiscard]]
+		value_type weight(std::int32_t layer, std::int32_t k) const noexcept;
+
+		// samples[i] must hold noise2D(x * 2^i, y * 2^i) for every i < sampleCount()
+		[[nodiscard]]
+		value_type blend(const value_type* samples) const noexcept;
+
+		// Same as blend() for a run of count points, where rows[i][j] holds octave i of point j
+		void blendRows(const value_type* const* rows, std::size_t count, value_type* out) const noexcept;
+
+		// blend(), plus the gradient of the result with respect to (x, y).
+		// dx[i] and dy[i] are the derivatives of noise2D() at the sample point of octave i,
+		// the 2^i chain rule factor is applied here.
+		[[nodiscard]]
+		BasicNoiseGradient2D<value_type> blendGradient(const value_type* samples, const value_type* dx, const value_type* dy) const noexcept;
+
+		// Same as blendGradient() for a run of count points, laid out like blendRows()
+		void blendRowsGradient(const value_type* const* rows, const value_type* const* dxRows, const value_type* const* dyRows,
+			std::size_t count, value_type* out, value_type* outDx, value_type* outDy) const noexcept;
+
+	private:
+
+		std::int32_t m_startOctave;
+
+		std::int32_t m_layerCount = 0;
+
+		amplitude_type m_weightSum = 0;
+
+		std::array<amplitude_type, MaxLayers> m_amplitudes{};
+
+		std::array<std::array<value_type, MaxOctaves>, MaxLayers> m_weights{};
+	};
+
+	using FractalLayers = BasicFractalLayers<double, float>;
+
 	namespace perlin_detail
 	{
 		////////////////////////////////////////////////
@@ -300,6 +436,42 @@ namespace siv
 			return ((h & 1) == 0 ? u : -u) + ((h & 2) == 0 ? v : -v);
 		}
 
+		// Gradients for the 2D lattice: the four diagonals and the four axes
+		template <class Float>
+		[[nodiscard]]
+		inline constexpr Float Grad2D(const std::uint8_t hash, const Float x, const Float y) noexcept
+		{
+			const std::uint8_t h = hash & 7;
+			const Float u = h < 6 ? x : y;
+			const Float v = h < 4 ? y : Float(0);
+			return ((h & 1) == 0 ? u : -u) + ((h & 2) == 0 ? v : -v);
+		}
+
+		// Derivative of Fade()
+		template <class Float>
+		[[nodiscard]]
+		inline constexpr Float FadeDerivative(const Float t) noexcept
+		{
+			return t * t * (t * (t * 30 - 60) + 30);
+		}
+
+		// Derivative of RemapClamp_01()
+		template <class Float>
+		[[nodiscard]]
+		inline constexpr Float RemapClampDerivative_01(const Float x) noexcept
+		{
+			return ((Float(-1.0) < x) && (x < Float(1.0))) ? Float(0.5) : Float(0.0);
+		}
+
+		// Truncation only equals std::floor() for positive values, so correct the negative ones
+		template <class Float>
+		[[nodiscard]]
+		inline constexpr std::int32_t FastFloor(const Float x) noexcept
+		{
+			const std::int32_t i = static_cast<std::int32_t>(x);
+			return (x < static_cast<Float>(i)) ? (i - 1) : i;
+		}
+
 		template <class Float>
 		[[nodiscard]]
 		inline constexpr Float Remap_01(const Float x) noexcept
@@ -421,7 +593,10 @@ namespace siv
 				129,22,39,253, 19,98,108,110,79,113,224,232,178,185, 112,104,218,246,97,228,
 				251,34,242,193,238,210,144,12,191,179,162,241, 81,51,145,235,249,14,239,107,
 				49,192,214, 31,181,199,106,157,184, 84,204,176,115,121,50,45,127, 4,150,254,
-				138,236,205,93,222,114,67,29,24,72,243,141,128,195,78,66,215,61,156,180 } {}
+				138,236,205,93,222,114,67,29,24,72,243,141,128,195,78,66,215,61,156,180 }
+	{
+		updateLookup2D();
+	}
 
 	template <class Float>
 	inline BasicPerlinNoise<Float>::BasicPerlinNoise(const seed_type seed)
@@ -451,6 +626,17 @@ namespace siv
 		std::iota(m_permutation.begin(), m_permutation.end(), uint8_t{ 0 });
 
 		perlin_detail::Shuffle(m_permutation.begin(), m_permutation.end(), std::forward<URBG>(urbg));
+
+		updateLookup2D();
+	}
+
+	template <class Float>
+	inline constexpr void BasicPerlinNoise<Float>::updateLookup2D() noexcept
+	{
+		for (std::size_t i = 0; i < m_permutation2D.size(); ++i)
+		{
+			m_permutation2D[i] = m_permutation[i & 255];
+		}
 	}
 
 	///////////////////////////////////////
@@ -465,6 +651,8 @@ namespace siv
 	inline constexpr void BasicPerlinNoise<Float>::deserialize(const state_type& state) noexcept
 	{
 		m_permutation = state;
+
+		updateLookup2D();
 	}
 
 	///////////////////////////////////////
@@ -480,9 +668,85 @@ namespace siv
 	template <class Float>
 	inline typename BasicPerlinNoise<Float>::value_type BasicPerlinNoise<Float>::noise2D(const value_type x, const value_type y) const noexcept
 	{
-		return noise3D(x,
-			y,
-			static_cast<value_type>(SIVPERLIN_DEFAULT_Z));
+		// A native 2D lattice: 4 corners instead of the 8 of a noise3D() slice
+		const std::int32_t _x = perlin_detail::FastFloor(x);
+		const std::int32_t _y = perlin_detail::FastFloor(y);
+
+		const std::int32_t ix = _x & 255;
+		const std::int32_t iy = _y & 255;
+
+		const value_type fx = (x - static_cast<value_type>(_x));
+		const value_type fy = (y - static_cast<value_type>(_y));
+
+		const value_type u = perlin_detail::Fade(fx);
+		const value_type v = perlin_detail::Fade(fy);
+
+		// Indices stay below 512, so the doubled table needs no masking
+		const std::int32_t A = (m_permutation2D[ix] + iy);
+		const std::int32_t B = (m_permutation2D[ix + 1] + iy);
+
+		const value_type p0 = perlin_detail::Grad2D(m_permutation2D[A], fx, fy);
+		const value_type p1 = perlin_detail::Grad2D(m_permutation2D[B], fx - 1, fy);
+		const value_type p2 = perlin_detail::Grad2D(m_permutation2D[A + 1], fx, fy - 1);
+		const value_type p3 = perlin_detail::Grad2D(m_permutation2D[B + 1], fx - 1, fy - 1);
+
+		const value_type q0 = perlin_detail::Lerp(p0, p1, u);
+		const value_type q1 = perlin_detail::Lerp(p2, p3, u);
+
+		return perlin_detail::Lerp(q0, q1, v);
+	}
+
+	template <class Float>
+	inline BasicNoiseGradient2D<typename BasicPerlinNoise<Float>::value_type> BasicPerlinNoise<Float>::noise2DGradient(const value_type x, const value_type y) const noexcept
+	{
+		const std::int32_t _x = perlin_detail::FastFloor(x);
+		const std::int32_t _y = perlin_detail::FastFloor(y);
+
+		const std::int32_t ix = _x & 255;
+		const std::int32_t iy = _y & 255;
+
+		const value_type fx = (x - static_cast<value_type>(_x));
+		const value_type fy = (y - static_cast<value_type>(_y));
+
+		const value_type u = perlin_detail::Fade(fx);
+		const value_type v = perlin_detail::Fade(fy);
+
+		const std::int32_t A = (m_permutation2D[ix] + iy);
+		const std::int32_t B = (m_permutation2D[ix + 1] + iy);
+
+		const std::uint8_t h0 = m_permutation2D[A];
+		const std::uint8_t h1 = m_permutation2D[B];
+		const std::uint8_t h2 = m_permutation2D[A + 1];
+		const std::uint8_t h3 = m_permutation2D[B + 1];
+
+		const value_type p0 = perlin_detail::Grad2D(h0, fx, fy);
+		const value_type p1 = perlin_detail::Grad2D(h1, fx - 1, fy);
+		const value_type p2 = perlin_detail::Grad2D(h2, fx, fy - 1);
+		const value_type p3 = perlin_detail::Grad2D(h3, fx - 1, fy - 1);
+
+		const value_type q0 = perlin_detail::Lerp(p0, p1, u);
+		const value_type q1 = perlin_detail::Lerp(p2, p3, u);
+
+		// Grad2D() is linear, so the gradient vectors are Grad2D(h, 1, 0) and Grad2D(h, 0, 1)
+		const value_type gx0 = perlin_detail::Grad2D(h0, value_type(1), value_type(0));
+		const value_type gx1 = perlin_detail::Grad2D(h1, value_type(1), value_type(0));
+		const value_type gx2 = perlin_detail::Grad2D(h2, value_type(1), value_type(0));
+		const value_type gx3 = perlin_detail::Grad2D(h3, value_type(1), value_type(0));
+		const value_type gy0 = perlin_detail::Grad2D(h0, value_type(0), value_type(1));
+		const value_type gy1 = perlin_detail::Grad2D(h1, value_type(0), value_type(1));
+		const value_type gy2 = perlin_detail::Grad2D(h2, value_type(0), value_type(1));
+		const value_type gy3 = perlin_detail::Grad2D(h3, value_type(0), value_type(1));
+
+		// Product rule on the two lerps: the blended gradients plus the change of the fade weights
+		const value_type du = perlin_detail::FadeDerivative(fx);
+		const value_type dv = perlin_detail::FadeDerivative(fy);
+
+		const value_type dx = perlin_detail::Lerp(perlin_detail::Lerp(gx0, gx1, u), perlin_detail::Lerp(gx2, gx3, u), v)
+			+ du * perlin_detail::Lerp(p1 - p0, p3 - p2, v);
+		const value_type dy = perlin_detail::Lerp(perlin_detail::Lerp(gy0, gy1, u), perlin_detail::Lerp(gy2, gy3, u), v)
+			+ dv * (q1 - q0);
+
+		return{ perlin_detail::Lerp(q0, q1, v), dx, dy };
 	}
 
 	template <class Float>
@@ -652,6 +916,284 @@ namespace siv
 	{
 		return perlin_detail::Remap_01(normalizedOctave3D(x, y, z, octaves, persistence));
 	}
+
+	///////////////////////////////////////
+
+	template <class Float>
+	template <class Amplitude>
+	inline typename BasicPerlinNoise<Float>::value_type BasicPerlinNoise<Float>::layeredOctave2D_01(value_type x, value_type y, const BasicFractalLayers<Float, Amplitude>& layers) const noexcept
+	{
+		std::array<value_type, BasicFractalLayers<Float, Amplitude>::MaxSamples> samples;
+
+		const std::int32_t count = layers.sampleCount();
+
+		for (std::int32_t i = 0; i < count; ++i)
+		{
+			samples[i] = noise2D(x, y);
+			x *= 2;
+			y *= 2;
+		}
+
+		return layers.blend(samples.data());
+	}
+
+	template <class Float>
+	template <class Amplitude>
+	inline BasicNoiseGradient2D<typename BasicPerlinNoise<Float>::value_type> BasicPerlinNoise<Float>::layeredOctave2DGradient_01(value_type x, value_type y, const BasicFractalLayers<Float, Amplitude>& layers) const noexcept
+	{
+		std::array<value_type, BasicFractalLayers<Float, Amplitude>::MaxSamples> samples;
+
+		std::array<value_type, BasicFractalLayers<Float, Amplitude>::MaxSamples> dx;
+
+		std::array<value_type, BasicFractalLayers<Float, Amplitude>::MaxSamples> dy;
+
+		const std::int32_t count = layers.sampleCount();
+
+		for (std::int32_t i = 0; i < count; ++i)
+		{
+			const BasicNoiseGradient2D<value_type> sample = noise2DGradient(x, y);
+			samples[i] = sample.value;
+			dx[i] = sample.dx;
+			dy[i] = sample.dy;
+			x *= 2;
+			y *= 2;
+		}
+
+		return layers.blendGradient(samples.data(), dx.data(), dy.data());
+	}
+
+	///////////////////////////////////////
+
+	template <class Float, class Amplitude>
+	inline BasicFractalLayers<Float, Amplitude>::BasicFractalLayers(const std::int32_t startOctave) noexcept
+		: m_startOctave{ std::clamp(startOctave, std::int32_t(1), MaxOctaves) } {}
+
+	template <class Float, class Amplitude>
+	inline bool BasicFractalLayers<Float, Amplitude>::addLayer(const amplitude_type amplitude, const value_type persistence) noexcept
+	{
+		const std::int32_t octaves = (m_startOctave + m_layerCount);
+
+		if ((MaxLayers <= m_layerCount) || (MaxOctaves < octaves))
+		{
+			return false;
+		}
+
+		// Same sequence of multiplications as Octave2D(), so the weights match it exactly
+		value_type weight = 1;
+
+		for (std::int32_t k = 0; k < octaves; ++k)
+		{
+			m_weights[m_layerCount][k] = weight;
+			weight *= persistence;
+		}
+
+		m_amplitudes[m_layerCount] = amplitude;
+		m_weightSum += amplitude;
+		++m_layerCount;
+
+		return true;
+	}
+
+	template <class Float, class Amplitude>
+	inline std::int32_t BasicFractalLayers<Float, Amplitude>::layerCount() const noexcept
+	{
+		return m_layerCount;
+	}
+
+	template <class Float, class Amplitude>
+	inline std::int32_t BasicFractalLayers<Float, Amplitude>::sampleCount() const noexcept
+	{
+		return (m_layerCount == 0) ? 0 : (2 * m_layerCount + m_startOctave - 2);
+	}
+
+	template <class Float, class Amplitude>
+	inline typename BasicFractalLayers<Float, Amplitude>::amplitude_type BasicFractalLayers<Float, Amplitude>::weightSum() const noexcept
+	{
+		return m_weightSum;
+	}
+
+	template <class Float, class Amplitude>
+	inline std::int32_t BasicFractalLayers<Float, Amplitude>::startOctave() const noexcept
+	{
+		return m_startOctave;
+	}
+
+	template <class Float, class Amplitude>
+	inline typename BasicFractalLayers<Float, Amplitude>::amplitude_type BasicFractalLayers<Float, Amplitude>::amplitude(const std::int32_t layer) const noexcept
+	{
+		return m_amplitudes[layer];
+	}
+
+	template <class Float, class Amplitude>
+	inline typename BasicFractalLayers<Float, Amplitude>::value_type BasicFractalLayers<Float, Amplitude>::weight(const std::int32_t layer, const std::int32_t k) const noexcept
+	{
+		return m_weights[layer][k];
+	}
+
+	template <class Float, class Amplitude>
+	inline typename BasicFractalLayers<Float, Amplitude>::value_type BasicFractalLayers<Float, Amplitude>::blend(const value_type* samples) const noexcept
+	{
+		amplitude_type result = 0;
+
+		for (std::int32_t i = 0; i < m_layerCount; ++i)
+		{
+			const std::int32_t octaves = (m_startOctave + i);
+			value_type layer = 0;
+
+			for (std::int32_t k = 0; k < octaves; ++k)
+			{
+				layer += (samples[i + k] * m_weights[i][k]);
+			}
+
+			result += m_amplitudes[i] * perlin_detail::RemapClamp_01(layer);
+		}
+
+		return static_cast<value_type>(result / m_weightSum);
+	}
+
+	template <class Float, class Amplitude>
+	inline void BasicFractalLayers<Float, Amplitude>::blendRows(const value_type* const* rows, const std::size_t count, value_type* out) const noexcept
+	{
+		// Work through the row in small blocks that stay in cache
+		constexpr std::size_t BlockSize = 64;
+
+		std::array<amplitude_type, BlockSize> result;
+
+		std::array<value_type, BlockSize> layer;
+
+		for (std::size_t begin = 0; begin < count; begin += BlockSize)
+		{
+			const std::size_t n = std::min(BlockSize, (count - begin));
+
+			std::fill_n(result.begin(), n, amplitude_type(0));
+
+			for (std::int32_t i = 0; i < m_layerCount; ++i)
+			{
+				const std::int32_t octaves = (m_startOctave + i);
+
+				std::fill_n(layer.begin(), n, value_type(0));
+
+				for (std::int32_t k = 0; k < octaves; ++k)
+				{
+					const value_type weight = m_weights[i][k];
+					const value_type* row = (rows[i + k] + begin);
+
+					for (std::size_t j = 0; j < n; ++j)
+					{
+						layer[j] += (row[j] * weight);
+					}
+				}
+
+				for (std::size_t j = 0; j < n; ++j)
+				{
+					result[j] += m_amplitudes[i] * perlin_detail::RemapClamp_01(layer[j]);
+				}
+			}
+
+			for (std::size_t j = 0; j < n; ++j)
+			{
+				out[begin + j] = static_cast<value_type>(result[j] / m_weightSum);
+			}
+		}
+	}
+
+	template <class Float, class Amplitude>
+	inline BasicNoiseGradient2D<typename BasicFractalLayers<Float, Amplitude>::value_type> BasicFractalLayers<Float, Amplitude>::blendGradient(const value_type* samples, const value_type* dx, const value_type* dy) const noexcept
+	{
+		amplitude_type result = 0;
+
+		value_type resultDx = 0;
+
+		value_type resultDy = 0;
+
+		for (std::int32_t i = 0; i < m_layerCount; ++i)
+		{
+			const std::int32_t octaves = (m_startOctave + i);
+			value_type layer = 0;
+			value_type layerDx = 0;
+			value_type layerDy = 0;
+			value_type frequency = static_cast<value_type>(std::int64_t(1) << i);
+
+			for (std::int32_t k = 0; k < octaves; ++k)
+			{
+				layer += (samples[i + k] * m_weights[i][k]);
+				layerDx += (dx[i + k] * (m_weights[i][k] * frequency));
+				layerDy += (dy[i + k] * (m_weights[i][k] * frequency));
+				frequency *= 2;
+			}
+
+			result += m_amplitudes[i] * perlin_detail::RemapClamp_01(layer);
+
+			// A clamped layer is flat
+			const value_type slope = m_amplitudes[i] * perlin_detail::RemapClampDerivative_01(layer);
+			resultDx += slope * layerDx;
+			resultDy += slope * layerDy;
+		}
+
+		return{ static_cast<value_type>(result / m_weightSum), static_cast<value_type>(resultDx / m_weightSum), static_cast<value_type>(resultDy / m_weightSum) };
+	}
+
+	template <class Float, class Amplitude>
+	inline void BasicFractalLayers<Float, Amplitude>::blendRowsGradient(const value_type* const* rows, const value_type* const* dxRows, const value_type* const* dyRows,
+		const std::size_t count, value_type* out, value_type* outDx, value_type* outDy) const noexcept
+	{
+		// The value goes through blendRows(), so it is identical to it
+		blendRows(rows, count, out);
+
+		constexpr std::size_t BlockSize = 64;
+
+		std::array<value_type, BlockSize> layer, layerDx, layerDy;
+
+		for (std::size_t begin = 0; begin < count; begin += BlockSize)
+		{
+			const std::size_t n = std::min(BlockSize, (count - begin));
+
+			std::fill_n(outDx + begin, n, value_type(0));
+			std::fill_n(outDy + begin, n, value_type(0));
+
+			for (std::int32_t i = 0; i < m_layerCount; ++i)
+			{
+				const std::int32_t octaves = (m_startOctave + i);
+
+				std::fill_n(layer.begin(), n, value_type(0));
+				std::fill_n(layerDx.begin(), n, value_type(0));
+				std::fill_n(layerDy.begin(), n, value_type(0));
+
+				value_type frequency = static_cast<value_type>(std::int64_t(1) << i);
+
+				for (std::int32_t k = 0; k < octaves; ++k)
+				{
+					const value_type weight = m_weights[i][k];
+					const value_type weightD = (m_weights[i][k] * frequency);
+					const value_type* row = (rows[i + k] + begin);
+					const value_type* rowDx = (dxRows[i + k] + begin);
+					const value_type* rowDy = (dyRows[i + k] + begin);
+
+					for (std::size_t j = 0; j < n; ++j)
+					{
+						layer[j] += (row[j] * weight);
+						layerDx[j] += (rowDx[j] * weightD);
+						layerDy[j] += (rowDy[j] * weightD);
+					}
+
+					frequency *= 2;
+				}
+
+				for (std::size_t j = 0; j < n; ++j)
+				{
+					const value_type slope = static_cast<value_type>(m_amplitudes[i]) * perlin_detail::RemapClampDerivative_01(layer[j]);
+					outDx[begin + j] += slope * layerDx[j];
+					outDy[begin + j] += slope * layerDy[j];
+				}
+			}
+
+			for (std::size_t j = 0; j < n; ++j)
+			{
+				outDx[begin + j] = static_cast<value_type>(outDx[begin + j] / m_weightSum);
+				outDy[begin + j] = static_cast<value_type>(outDy[begin + j] / m_weightSum);
+			}
+		}
+	}
 }
 
 # undef SIVPERLIN_NODISCARD_CXX20
@@ -0,0 +1,62 @@
+/** @file PerlinNoiseBatch.hpp
+ *  @brief Evaluates siv::PerlinNoise::noise2D for many points at once.
+ *
+ *  The kernels work in float precision and evaluate 4 (SSE2), 8 (AVX2)
+ *  or 16 (AVX-512) samples per step. The widest kernel the CPU supports
+ *  is picked once at startup; other platforms use a scalar float kernel.
+ */
+#ifndef PERLINNOISEBATCH_HPP
+#define PERLINNOISEBATCH_HPP
+
+#include "PerlinNoise.hpp"
+#include "NoiseSource.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+class PerlinNoiseBatch : public NoiseSource{
+public:
+    // The available kernels, narrowest first
+    enum Kernel{
+        Scalar = 0,
+        SSE2,
+        AVX2,
+        AVX512
+    };
+    // Copies the permutation table of perlin, and uses the best kernel for this CPU
+    PerlinNoiseBatch(const siv::PerlinNoise& perlin);
+    // Same as above, but forces a kernel (it must be supported)
+    PerlinNoiseBatch(const siv::PerlinNoise& perlin, Kernel kernel);
+    // Destructor
+    ~PerlinNoiseBatch();
+    // Evaluates a single point with the scalar float kernel
+    float Noise2D(float x, float y) const override;
+    // Evaluates a row of a regular grid:
+    // out[i] = noise2D((xStart + i) * xScale, y) for every i < count
+    void Noise2DRow(float xStart, float xScale, float y, std::size_t count, float* out) const override;
+    // Evaluates arbitrary points:
+    // out[i] = noise2D(xs[i], ys[i]) for every i < count
+    void Noise2DPoints(const float* xs, const float* ys, std::size_t count, float* out) const override;
+    // Evaluates a single point and its derivatives with the scalar float kernel
+    float Noise2DGradient(float x, float y, float& dx, float& dy) const override;
+    // Noise2DRow() plus derivatives (AVX2 and AVX-512 kernels, scalar otherwise)
+    void Noise2DRowGradient(float xStart, float xScale, float y, std::size_t count, float* out, float* dx, float* dy) const override;
+    // Returns NoiseBackend::Perlin
+    NoiseBackend GetBackend() const override;
+    // Returns the kernel this batch runs
+    Kernel GetKernel() const;
+    // Returns the widest kernel this CPU supports (detected once)
+    static Kernel GetBestKernel();
+    // Returns true if the CPU can run the kernel
+    static bool IsSupported(Kernel kernel);
+    // Returns a printable name for a kernel
+    static const char* GetKernelName(Kernel kernel);
+
+private:
+    // The permutation table twice over, widened to 32 bits for the gathers
+    alignas(64) std::int32_t m_permutation[512];
+    // Which kernel we dispatch to
+    Kernel m_kernel;
+};
+
+#endif
@@ -0,0 +1,81 @@
+/** @file RegionBaker.hpp
+ *  @brief Bakes a rectangle of chunks to disk without a window or OpenGL context.
+ *
+ *  Every chunk is a job on the JobScheduler, generated by the same
+ *  TerrainBuilder the interactive program uses. Finished chunks are
+ *  written by the thread that called Bake() as they come in, so only a
+ *  few chunks are in memory at once however large the region is.
+ *
+ *  The output directory holds heights.f32 (one float per vertex) and
+ *  colors.rgba (one packed RGBA colour per vertex), both in tiles: chunk
+ *  (i, j) of the region is the (j * chunksX + i)th block of chunkSize^2
+ *  values, its rows in order. Neighbouring chunks share their edge row
+ *  and column, so each is in both tiles. region.txt describes the layout.
+ */
+#ifndef REGIONBAKER_HPP
+#define REGIONBAKER_HPP
+
+#include "JobScheduler.hpp"
+#include "NoiseContext.hpp"
+#include "TerrainRamp.hpp"
+
+#include <cstddef>
+#include <string>
+
+// What to bake
+struct BakeSettings{
+    // Chunks along x and z
+    unsigned int chunksX = 8;
+    unsigned int chunksZ = 8;
+    // Vertices along each side of a chunk
+    unsigned int chunkSize = 512;
+    // Chunk coordinate of the first chunk
+    int originX = 0;
+    int originZ = 0;
+    std::string outputDirectory = "bake";
+    // Chunks generated but not written yet, 0 for two per worker
+    unsigned int maxInFlight = 0;
+    // Prints how far along the bake is every tenth of the region
+    bool reportProgress = true;
+};
+
+class RegionBaker{
+public:
+    // What a bake did
+    struct Stats{
+        std::size_t chunks = 0;
+        std::size_t bytesWritten = 0;
+        // Wall clock time of the whole bake
+        double seconds = 0.0;
+        // Summed over the workers: noise, heights and colours
+        double generateSeconds = 0.0;
+        // On the baking thread
+        double writeSeconds = 0.0;
+        // Waiting for a chunk to finish, with nothing to write
+        double waitSeconds = 0.0;
+        std::size_t maxInFlight = 0;
+        // Peak resident set of the process, 0 where it is unknown
+        std::size_t peakResidentBytes = 0;
+    };
+
+    // Chunks are generated on scheduler with noise through ramp, which must outlive the baker
+    RegionBaker(JobScheduler& scheduler, const NoiseContext& noise, const TerrainRamp& ramp);
+
+    // Bakes the region of settings. Returns false if the output could not be written.
+    bool Bake(const BakeSettings& settings, Stats& stats);
+
+    // Peak resident set of this process so far, in bytes, 0 where it is unknown
+    static std::size_t GetPeakResidentBytes();
+    // Prints stats
+    static void PrintStats(const Stats& stats);
+
+private:
+    // Writes region.txt
+    bool WriteDescription(const BakeSettings& settings) const;
+
+    JobScheduler& m_scheduler;
+    NoiseContext m_noise;
+    const TerrainRamp& m_ramp;
+};
+
+#endif
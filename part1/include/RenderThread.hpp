@@ -0,0 +1,163 @@
+/** @file RenderThread.hpp
+ *  @brief Draws scene snapshots on a thread of its own, which owns the OpenGL context.
+ *
+ *  The simulation thread handles input, moves the camera, streams chunks
+ *  and builds its Dear ImGui frame, then publishes a SceneSnapshot. The
+ *  render thread draws the newest snapshot it has, so a slow simulation
+ *  frame never holds up command submission and a slow draw never holds
+ *  up input. Both handoffs are lock-free: snapshots (and the render
+ *  stats going back) through SnapshotBuffers, chunk changes through a
+ *  SpscQueue of commands, since those must not be dropped.
+ *
+ *  Every OpenGL object of the chunks is created, filled and deleted on
+ *  the render thread. The context has to be released by the thread that
+ *  made it before Start(), and is released again by Stop().
+ */
+#ifndef RENDERTHREAD_HPP
+#define RENDERTHREAD_HPP
+
+#include "Renderer.hpp"
+#include "SceneSnapshot.hpp"
+#include "SnapshotBuffer.hpp"
+#include "SpscQueue.hpp"
+#include "ChunkStreamer.hpp"
+#include "Clipmap.hpp"
+#include "UploadQueue.hpp"
+#include "GridIndexCache.hpp"
+
+#if defined(LINUX) || defined(MINGW)
+    #include <SDL2/SDL.h>
+#else // This works for Mac
+    #include <SDL.h>
+#endif
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <thread>
+
+class Terrain;
+class ClipmapTerrain;
+
+class RenderThread{
+public:
+    // A change to the chunks the render thread holds
+    struct Command{
+        enum Type{
+            // Create the buffers of chunk and start its upload
+            AddChunk,
+            // Delete the chunk at coord
+            RemoveChunk,
+            // New upload budget, in bytes per frame
+            SetUploadBudget,
+            // Write clipmap's updates and draw its windows from now on
+            UpdateClipmap
+        };
+        Type type = AddChunk;
+        ReadyChunk chunk;
+        ChunkCoord coord;
+        std::size_t uploadBudget = 0;
+        ClipmapFrame clipmap;
+    };
+
+    // What the render thread did, sent back to the simulation
+    struct Stats{
+        std::uint64_t framesDrawn = 0;
+        // When the first frame was swapped (steady clock seconds), 0 before that
+        double firstFrameTime = 0.0;
+        // Simulation frames it never drew, because a newer one was already there
+        std::uint64_t snapshotsSkipped = 0;
+        // CPU time of the last frame, swap included
+        double frameSeconds = 0.0;
+        // From publishing the snapshot drawn last to the start of its frame
+        double snapshotAge = 0.0;
+        std::size_t chunks = 0;
+        std::size_t chunksUploading = 0;
+        UploadQueue::Stats uploads;
+    };
+
+    // The chunks are chunkSize vertices a side (chunkSize - 1 apart), uploaded through uploads.
+    // Chunks are only ever built on the simulation side, new noise arrives as AddChunk replacements.
+    RenderThread(SDL_Window* window, SDL_GLContext context, Renderer* renderer, UploadQueue& uploads,
+                 unsigned int chunkSize);
+    // Stops the thread if it is still running
+    ~RenderThread();
+    RenderThread(const RenderThread&) = delete;
+    RenderThread& operator=(const RenderThread&) = delete;
+
+    // Before Start(): the shader every chunk node is drawn with, compiled once
+    void SetShader(std::shared_ptr<Shader> shader);
+    // Before Start(): the shader the clipmap is drawn with, if there is one
+    void SetClipmapShader(std::shared_ptr<Shader> shader);
+    // Before Start(), on the thread that has the context: creates and uploads chunk
+    // right away instead of through the upload queue
+    void AddChunkNow(ReadyChunk&& chunk);
+    // Starts drawing on the render thread
+    void Start();
+    // Deletes the chunks and joins the thread, which releases the context
+    void Stop();
+
+    // Simulation side: the snapshot to fill, then Publish() it
+    SceneSnapshot& GetSnapshot();
+    void Publish();
+    // Simulation side: queues a command, it is kept here and sent later if the queue is full
+    void Send(Command&& command);
+    // Simulation side: the newest stats the render thread sent
+    const Stats& GetStats();
+
+private:
+    struct Chunk{
+        Terrain* terrain;
+        SceneNode* node;
+        // The level of detail terrain replaces, drawn until terrain is uploaded
+        Terrain* previousTerrain = nullptr;
+        SceneNode* previousNode = nullptr;
+    };
+
+    // Runs on the render thread
+    void Run();
+    // Applies the commands that came in
+    void ProcessCommands();
+    // Creates the buffers and node of chunk, filled through uploads or right away if it is nullptr.
+    // A chunk already there is at another level of detail or had other noise, it is drawn until the new one is uploaded.
+    void AddChunk(ReadyChunk&& chunk, UploadQueue* uploads);
+    // Deletes the chunk that was replaced, if any
+    static void DropPrevious(Chunk& chunk);
+    // Draws one snapshot
+    void DrawFrame(SceneSnapshot& snapshot);
+    // Creates the clipmap's textures on the first frame, or again if its size changed, then applies frame
+    void UpdateClipmap(const ClipmapFrame& frame);
+    // Deletes every chunk, and the clipmap
+    void ClearChunks();
+
+    SDL_Window* m_window;
+    SDL_GLContext m_context;
+    Renderer* m_renderer;
+    UploadQueue& m_uploads;
+    unsigned int m_chunkSize;
+    std::shared_ptr<Shader> m_shader;
+    std::shared_ptr<Shader> m_clipmapShader;
+
+    SnapshotBuffer<SceneSnapshot> m_snapshots;
+    SnapshotBuffer<Stats> m_stats;
+    SpscQueue<Command> m_commands;
+    // Commands that did not fit in the queue yet, simulation side
+    std::deque<Command> m_unsent;
+
+    // Render side
+    std::map<ChunkCoord, Chunk> m_chunks;
+    // Drawn before the chunks when the simulation sends clipmap frames
+    ClipmapTerrain* m_clipmap = nullptr;
+    SceneNode* m_clipmapNode = nullptr;
+    // The index buffers every chunk's tiles are drawn with
+    GridIndexCache m_gridIndices;
+    std::uint64_t m_lastFrame = 0;
+    Stats m_renderStats;
+
+    std::thread m_thread;
+    std::atomic<bool> m_stop{false};
+};
+
+#endif
@@ -21,6 +21,7 @@
 #include <vector>
 
 #include "SceneNode.hpp"
+#include "SceneSnapshot.hpp"
 #include "Camera.hpp"
 
 class Renderer{
@@ -30,13 +31,19 @@ public:
     Renderer(unsigned int w, unsigned int h);
     // Destructor
     ~Renderer();
-    // Update the scene
-    void Update();
+    // Fills the camera, lights and render state of a snapshot from the camera
+    // and keyboard, on the thread that moves the camera
+    void FillSnapshot(SceneSnapshot& snapshot);
+    // Update the scene for a snapshot
+    void Update(const SceneSnapshot& snapshot);
     // Render the scene
-    void Render();
+    void Render(const SceneSnapshot& snapshot);
     // Sets the root of our renderer to some node to
     // draw an entire scene graph
     void setRoot(SceneNode* startingNode);
+    // Sets the near and far clipping planes, 0.1 and 512 unless told otherwise.
+    // The lights fade over the same share of the far plane whatever it is.
+    void SetClipPlanes(float nearPlane, float farPlane);
     // Returns the camera at an index
     Camera*& GetCamera(unsigned int index){
         if(index > m_cameras.size()-1){
@@ -52,6 +59,9 @@ public:
     glm::mat4 m_projectionMatrix;
     int m_screenWidth;
     int m_screenHeight;
+    // Clipping planes of the projection
+    float m_nearPlane = 0.1f;
+    float m_farPlane = 512.0f;
 
 // TODO: maybe write getter/setter methods
 protected:
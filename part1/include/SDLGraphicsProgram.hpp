@@ -26,6 +26,18 @@
 // Include the 'Renderer.hpp' which deteremines what
 // the graphics API is going to be for OpenGL
 #include "Renderer.hpp"
+#include "NoiseContext.hpp"
+#include "TerrainRamp.hpp"
+#include "ThreadPool.hpp"
+#include "JobScheduler.hpp"
+#include "ChunkStreamer.hpp"
+#include "Clipmap.hpp"
+#include "StartupTimeline.hpp"
+#include "Task.hpp"
+
+#include <set>
+
+class RenderThread;
 
 
 // Purpose:
@@ -37,7 +49,17 @@ class SDLGraphicsProgram{
 public:
 
     // Constructor
-    SDLGraphicsProgram(int w, int h);
+    // The terrain heights and colours come from rampStops.
+    // The terrain is generated on threadCount threads in all, 0 for every hardware thread.
+    // At most uploadBudget bytes of new chunks are copied to the GPU per frame.
+    // drawPath picks between a vertex buffer and a height texture per chunk.
+    // Chunks further than lodDistance are built coarser, 0 builds them all at full resolution.
+    // With clipmapLevels the terrain is a geometry clipmap of that many levels instead of chunks.
+    SDLGraphicsProgram(int w, int h, const NoiseSettings& noiseSettings = NoiseSettings(),
+                       const std::vector<RampStop>& rampStops = TerrainRamp::GetDefaultStops(),
+                       unsigned int threadCount = 0, std::size_t uploadBudget = 8u << 20,
+                       TerrainDrawPath drawPath = TerrainDrawPath::VertexBuffer, float lodDistance = 768.0f,
+                       unsigned int clipmapLevels = 0);
     // Destructor
     ~SDLGraphicsProgram();
     // Setup OpenGL
@@ -50,6 +72,14 @@ public:
     void GetOpenGLVersionInfo();
 
 private:
+    // Everything before the first frame, as a task graph: shader files are read and the
+    // nearest chunks generated on the workers while the GL steps run on this thread,
+    // which resumes the graph from mainThread. Done once the chunk under the camera is
+    // on the GPU, the other chunks that finished by then are sent to renderThread.
+    // With a clipmap there are no chunks: its first frame is sampled whole and sent instead.
+    Task<void> Startup(MainThreadQueue& mainThread, ChunkStreamer& streamer, RenderThread& renderThread,
+                       std::set<ChunkCoord>& resident, Clipmap* clipmap);
+
 	// The Renderer responsible for drawing objects
 	// in OpenGL (Or whatever Renderer you choose!)
 	Renderer* m_renderer;
@@ -57,6 +87,24 @@ private:
     SDL_Window* m_window ;
     // OpenGL context
     SDL_GLContext m_openGLContext;
+    // Settings the terrain noise is created with
+    NoiseSettings m_noiseSettings;
+    // Noise to height and colour tables shared by every chunk
+    TerrainRamp m_terrainRamp;
+    // Threads the clipmap is sampled on
+    ThreadPool m_threadPool;
+    // Workers new chunks are generated on, one chunk per job
+    JobScheduler m_jobScheduler;
+    // Bytes of new chunks copied to the GPU per frame
+    std::size_t m_uploadBudget;
+    // How chunks get their vertices to the GPU, and so which vertex shader draws them
+    TerrainDrawPath m_drawPath;
+    // Where chunks start to drop to coarser levels of detail
+    float m_lodDistance;
+    // Levels of the geometry clipmap drawn instead of chunks, 0 for chunks
+    unsigned int m_clipmapLevels;
+    // What startup did and when, printed once the first frame is drawn
+    StartupTimeline m_startup;
 };
 
 #endif
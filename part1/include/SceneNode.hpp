@@ -11,11 +11,12 @@
  *  @bug No known bugs.
  */
 
+#include <memory>
 #include <vector>
 
 #include "Object.hpp"
 #include "Transform.hpp"
-#include "Camera.hpp"
+#include "SceneSnapshot.hpp"
 #include "Shader.hpp"
 
 #include "glm/vec3.hpp"
@@ -26,6 +27,9 @@ public:
     // A SceneNode is created by taking
     // a pointer to an object.
     SceneNode(Object* ob);
+    // Same, sharing shader with other nodes instead of compiling its own.
+    // Nodes sharing a shader must each be updated right before they are drawn.
+    SceneNode(Object* ob, std::shared_ptr<Shader> shader);
     // Our destructor takes care of destroying
     // all of the children within the node.
     // Now we do not have to manage deleting
@@ -33,17 +37,19 @@ public:
     ~SceneNode();
     // Adds a child node to our current node.
     void AddChild(SceneNode* n);
+    // Detaches a child node without deleting it
+    void RemoveChild(SceneNode* n);
     // Draws the current SceneNode
     void Draw();
-    // Updates the current SceneNode
-    void Update(glm::mat4 projectionMatrix, Camera* camera);
+    // Updates the current SceneNode with the camera and lights of a snapshot
+    void Update(const SceneSnapshot& snapshot);
     // Returns the local transformation transform
     // Remember that local is local to an object, where it's center is the origin.
     Transform& GetLocalTransform();
     // Returns a SceneNode's world transform
     Transform& GetWorldTransform();
-    // For now we have one shader per Node.
-    Shader m_shader;
+    // One shader per Node, unless it was given a shared one
+    std::shared_ptr<Shader> m_shader;
     
     
     // NOTE: Protected members are accessible by anything
@@ -0,0 +1,67 @@
+/** @file SceneSnapshot.hpp
+ *  @brief Everything the render thread needs to draw one simulated frame.
+ *
+ *  The simulation thread fills a snapshot from the camera, the resident
+ *  chunks and its Dear ImGui frame, and hands it over through a
+ *  SnapshotBuffer. The render thread only reads snapshots, it never
+ *  looks at the camera or the ImGui context that made them.
+ */
+#ifndef SCENESNAPSHOT_HPP
+#define SCENESNAPSHOT_HPP
+
+#include "ChunkStreamer.hpp"
+#include "imgui.h"
+#include "glm/glm.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// The point light parameters of the terrain shader
+struct PointLight{
+    glm::vec3 color{1.0f, 1.0f, 1.0f};
+    glm::vec3 position{0.0f, 0.0f, 0.0f};
+    float ambientIntensity = 1.0f;
+    float specularStrength = 0.5f;
+    float constant = 1.0f;
+    float linear = 0.003f;
+    float quadratic = 0.0f;
+};
+
+// Dear ImGui's draw lists for one frame, copied out of the ImGui context
+// so the next frame can be built while this one is drawn
+class UiSnapshot{
+public:
+    // Copies drawData, reusing the storage of the previous copy
+    void Capture(const ImDrawData* drawData);
+    // The copy, for ImGui_ImplOpenGL3_RenderDrawData
+    ImDrawData* GetDrawData();
+
+private:
+    std::vector<std::unique_ptr<ImDrawList>> m_lists;
+    std::vector<ImDrawList*> m_listPointers;
+    ImDrawData m_drawData;
+};
+
+struct SceneSnapshot{
+    // Simulation frame this came from (0 before the first one) and when it was published,
+    // in seconds since some fixed point
+    std::uint64_t frame = 0;
+    double publishTime = 0.0;
+
+    // Camera
+    glm::mat4 view{1.0f};
+    glm::mat4 projection{1.0f};
+    glm::vec3 eye{0.0f, 0.0f, 0.0f};
+
+    static constexpr int LightCount = 2;
+    PointLight lights[LightCount];
+
+    // Chunks to draw this frame, nearest first
+    std::vector<ChunkCoord> chunks;
+    bool wireframe = false;
+
+    UiSnapshot ui;
+};
+
+#endif
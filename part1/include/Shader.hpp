@@ -29,8 +29,8 @@ public:
     void Bind() const;
     // Remove shader from our pipeline
     void Unbind() const;
-    // Load a shader
-    std::string LoadShader(const std::string& fname);
+    // Load a shader. Only reads the file, so any thread can do it.
+    static std::string LoadShader(const std::string& fname);
     // Create a Shader from a loaded vertex and fragment shader
     void CreateShader(const std::string& vertexShaderSource, const std::string& fragmentShaderSource);
     // return the shader id
@@ -50,7 +50,7 @@ private:
     void PrintProgramLog( GLuint program );
     void PrintShaderLog( GLuint shader );
     // Logs an error message 
-    void Log(const char* system, const char* message);
+    static void Log(const char* system, const char* message);
     // The unique shaderID
     GLuint m_shaderID;
 };
@@ -0,0 +1,68 @@
+/** @file ShardQueue.hpp
+ *  @brief A work queue of bake shards kept as files, shared by processes.
+ *
+ *  Every shard is a small text file that moves between the directories
+ *  pending/, claimed/, done/ and failed/ of the queue. A worker claims a
+ *  shard by renaming it into claimed/ under its own name, which only one
+ *  worker can win, so nothing but the file system is shared and the
+ *  queue works the same for processes on one box or on a shared mount.
+ */
+#ifndef SHARDQUEUE_HPP
+#define SHARDQUEUE_HPP
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+// A rectangle of chunks baked as one piece of work
+struct Shard{
+    unsigned int index = 0;
+    // Chunk coordinate of the first chunk, and chunks along x and z
+    int originX = 0;
+    int originZ = 0;
+    unsigned int chunksX = 0;
+    unsigned int chunksZ = 0;
+    unsigned int chunkSize = 0;
+    // Times it has been handed out before
+    unsigned int attempts = 0;
+};
+
+class ShardQueue{
+public:
+    // Shards in each state
+    struct Counts{
+        std::size_t pending = 0;
+        std::size_t claimed = 0;
+        std::size_t done = 0;
+        std::size_t failed = 0;
+    };
+
+    // The queue lives in directory
+    explicit ShardQueue(const std::string& directory);
+
+    // Empties the queue and fills it with shards. Returns false if it cannot be written.
+    bool Create(const std::vector<Shard>& shards);
+    // Takes a pending shard for worker. Returns false once none is left.
+    bool Claim(const std::string& worker, Shard& shard);
+    // Moves a shard worker claimed to done, with a line of results
+    bool Complete(const Shard& shard, const std::string& worker, const std::string& result);
+    // Puts the shards worker still holds back in pending, or in failed once they were
+    // handed out maxAttempts times. Returns how many it held.
+    std::size_t Requeue(const std::string& worker, unsigned int maxAttempts);
+
+    Counts GetCounts() const;
+    // Every done shard and its result line, by index
+    std::vector<std::pair<Shard, std::string>> GetDone() const;
+
+private:
+    // The file name of a shard, the same in every state
+    static std::string GetName(unsigned int index);
+    // Shard files are a line: index originX originZ chunksX chunksZ chunkSize attempts
+    static bool WriteShard(const std::string& path, const Shard& shard);
+    static bool ReadShard(const std::string& path, Shard& shard, std::string* result = nullptr);
+
+    std::string m_directory;
+};
+
+#endif
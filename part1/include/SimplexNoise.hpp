@@ -0,0 +1,38 @@
+/** @file SimplexNoise.hpp
+ *  @brief 2D simplex noise.
+ *
+ *  Splits the plane into triangles instead of squares, so each sample
+ *  blends 3 corners instead of 4, and uses 12 evenly spread gradients.
+ *  That removes most of the axis aligned streaks Perlin noise shows.
+ *  It uses the permutation table of a siv::PerlinNoise, so the same seed
+ *  gives the same world layout for both.
+ */
+#ifndef SIMPLEXNOISE_HPP
+#define SIMPLEXNOISE_HPP
+
+#include "PerlinNoise.hpp"
+#include "NoiseSource.hpp"
+
+#include <cstdint>
+
+class SimplexNoise : public NoiseSource{
+public:
+    // Copies the permutation table of perlin
+    SimplexNoise(const siv::PerlinNoise& perlin);
+    // Destructor
+    ~SimplexNoise();
+    // Evaluates a single point, in [-1, 1]
+    float Noise2D(float x, float y) const override;
+    // Evaluates a single point and its analytic derivatives
+    float Noise2DGradient(float x, float y, float& dx, float& dy) const override;
+    // Returns NoiseBackend::Simplex
+    NoiseBackend GetBackend() const override;
+
+private:
+    // The permutation table twice over
+    std::uint8_t m_permutation[512];
+    // The same table reduced to one of the 12 gradients
+    std::uint8_t m_gradientIndex[512];
+};
+
+#endif
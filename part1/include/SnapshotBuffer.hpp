@@ -0,0 +1,59 @@
+/** @file SnapshotBuffer.hpp
+ *  @brief Lock-free handoff of the latest snapshot from one thread to another.
+ *
+ *  The writer fills its slot and publishes it, the reader picks up the
+ *  newest published slot and keeps it until it asks again. Each side
+ *  owns one slot and a third one sits between them; publishing and
+ *  acquiring are a single atomic exchange of that spare slot, so
+ *  neither side ever waits for the other. Snapshots published while the
+ *  reader is busy replace each other, the reader only sees the latest.
+ *
+ *  Slots are reused, so a snapshot with vectors keeps their storage and
+ *  filling it again does not allocate. One writer thread, one reader.
+ */
+#ifndef SNAPSHOTBUFFER_HPP
+#define SNAPSHOTBUFFER_HPP
+
+#include <atomic>
+
+template<typename T>
+class SnapshotBuffer{
+public:
+    // Writer: the slot to fill, it holds whatever was in it three publishes ago
+    T& GetWriteSlot(){
+        return m_slots[m_write];
+    }
+    // Writer: hands the filled slot over, and gets the spare one to fill next
+    void Publish(){
+        const unsigned int previous = m_spare.exchange(m_write | FreshBit, std::memory_order_acq_rel);
+        m_write = previous & IndexMask;
+    }
+
+    // Reader: takes the newest published slot. False, keeping the current one, if nothing new came.
+    bool Acquire(){
+        if((m_spare.load(std::memory_order_relaxed) & FreshBit) == 0){
+            return false;
+        }
+        const unsigned int previous = m_spare.exchange(m_read, std::memory_order_acq_rel);
+        m_read = previous & IndexMask;
+        return true;
+    }
+    // Reader: the slot taken by the last Acquire(), default constructed before the first one.
+    // It is the reader's until the next Acquire().
+    T& GetReadSlot(){
+        return m_slots[m_read];
+    }
+
+private:
+    static constexpr unsigned int IndexMask = 3;
+    // Set on the spare slot when the writer published it and the reader has not taken it yet
+    static constexpr unsigned int FreshBit = 4;
+
+    T m_slots[3];
+    // Each index is only touched by its own side
+    unsigned int m_write = 0;
+    unsigned int m_read = 1;
+    std::atomic<unsigned int> m_spare{2};
+};
+
+#endif
@@ -0,0 +1,56 @@
+/** @file SpscQueue.hpp
+ *  @brief Bounded lock-free queue from one producer thread to one consumer thread.
+ *
+ *  Unlike a SnapshotBuffer nothing is ever dropped: every pushed value is
+ *  popped once, in order. The slots are allocated up front, pushing to a
+ *  full queue fails and leaves the value with the caller.
+ */
+#ifndef SPSCQUEUE_HPP
+#define SPSCQUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+template<typename T>
+class SpscQueue{
+public:
+    // Room for capacity values
+    explicit SpscQueue(std::size_t capacity) : m_slots(capacity + 1){
+
+    }
+
+    // Producer: moves value in, or returns false and leaves it alone if the queue is full
+    bool TryPush(T&& value){
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        const std::size_t next = (tail + 1) % m_slots.size();
+        if(next == m_head.load(std::memory_order_acquire)){
+            return false;
+        }
+        m_slots[tail] = std::move(value);
+        m_tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer: moves the oldest value out, false if there is none
+    bool TryPop(T& value){
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        if(head == m_tail.load(std::memory_order_acquire)){
+            return false;
+        }
+        value = std::move(m_slots[head]);
+        m_head.store((head + 1) % m_slots.size(), std::memory_order_release);
+        return true;
+    }
+
+private:
+    // One slot more than the capacity, so full and empty look different
+    std::vector<T> m_slots;
+    // Next value to pop, written by the consumer
+    std::atomic<std::size_t> m_head{0};
+    // Next slot to push into, written by the producer
+    std::atomic<std::size_t> m_tail{0};
+};
+
+#endif
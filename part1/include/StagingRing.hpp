@@ -0,0 +1,61 @@
+/** @file StagingRing.hpp
+ *  @brief Thread-safe ring allocator over a block of staging memory.
+ *
+ *  Workers reserve spans, write their data and hand the spans on; spans
+ *  may be released in any order, and the space is reused once every
+ *  older span has been released too. The memory itself belongs to the
+ *  caller, usually a persistently mapped OpenGL buffer (see UploadQueue).
+ */
+#ifndef STAGINGRING_HPP
+#define STAGINGRING_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+class StagingRing{
+public:
+    // Reserved bytes: offset into the ring, and where to write them
+    struct Span{
+        std::size_t offset = 0;
+        std::size_t size = 0;
+        std::uint8_t* data = nullptr;
+    };
+    // Every span starts on this many bytes, enough for any buffer or pixel copy
+    static constexpr std::size_t Alignment = 256;
+
+    // memory must hold capacity bytes and outlive the ring
+    StagingRing(std::uint8_t* memory, std::size_t capacity);
+    // Destructor
+    ~StagingRing();
+
+    // Reserves size bytes. Returns false, without waiting, if the ring has no room for them now.
+    bool Reserve(std::size_t size, Span& span);
+    // Gives a span back, from any thread and in any order
+    void Release(const Span& span);
+
+    std::size_t GetCapacity() const;
+    // Bytes between the oldest live span and the newest, padding included
+    std::size_t GetUsedBytes() const;
+    // Reserve() calls that found no room
+    std::size_t GetFailedReserves() const;
+
+private:
+    struct Block{
+        std::size_t offset;
+        std::size_t size;
+        bool released;
+    };
+
+    std::uint8_t* m_memory;
+    std::size_t m_capacity;
+    mutable std::mutex m_mutex;
+    // Live blocks, oldest first. Padding at the end of the ring is a released block.
+    std::deque<Block> m_blocks;
+    // Next free byte
+    std::size_t m_head = 0;
+    std::size_t m_failedReserves = 0;
+};
+
+#endif
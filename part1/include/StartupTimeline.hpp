@@ -0,0 +1,53 @@
+/** @file StartupTimeline.hpp
+ *  @brief Records the steps of startup, on any thread, and prints them as a timeline.
+ *
+ *  Times are seconds on the steady clock, relative to when the timeline
+ *  was made. Report() prints every step with its thread and a bar, the
+ *  time to the first frame, and how much the steps overlapped.
+ */
+#ifndef STARTUPTIMELINE_HPP
+#define STARTUPTIMELINE_HPP
+
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class StartupTimeline{
+public:
+    // Starts the clock, the thread making it is called "main"
+    StartupTimeline();
+
+    // Starts a step on this thread, returns its index for End()
+    std::size_t Begin(const std::string& name);
+    void End(std::size_t step);
+    // Adds a step that ran from start to end (Clock::Now() times) on thread, named by the caller
+    void Record(const std::string& name, double start, double end, const std::string& thread);
+    // The first frame was on screen at time (a Clock::Now() time)
+    void MarkFirstFrame(double time);
+    bool HasFirstFrame() const;
+
+    // Prints the timeline
+    void Report() const;
+
+private:
+    struct Step{
+        std::string name;
+        std::string thread;
+        double start;
+        double end;
+    };
+
+    // "main", or "worker N" in the order threads showed up
+    std::string GetThreadName();
+
+    double m_origin;
+    std::thread::id m_mainThread;
+    mutable std::mutex m_mutex;
+    std::vector<Step> m_steps;
+    std::vector<std::thread::id> m_workers;
+    double m_firstFrame = -1.0;
+};
+
+#endif
@@ -0,0 +1,267 @@
+/** @file Task.hpp
+ *  @brief C++20 coroutine tasks, and awaitables that move them between threads.
+ *
+ *  A Task starts running as soon as it is called, up to its first
+ *  suspension, and hands back its result to whoever co_awaits it. Several
+ *  tasks started one after the other therefore run at the same time once
+ *  they have hopped onto workers with co_await ResumeOnJobs(scheduler);
+ *  awaiting them afterwards joins them. A task that is awaited after it
+ *  finished does not suspend at all.
+ *
+ *  Steps that need the OpenGL context co_await a MainThreadQueue, which
+ *  resumes them on the thread that calls RunUntilDone(). After awaiting
+ *  a task the coroutine runs on whichever thread finished that task, so
+ *  hop back explicitly before touching the context.
+ *
+ *  A task must be finished before it is destroyed; await it, or wait for
+ *  it with MainThreadQueue::RunUntilDone().
+ */
+#ifndef TASK_HPP
+#define TASK_HPP
+
+#include "JobScheduler.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+namespace TaskDetail{
+    // Continuation value of a task that finished before anything awaited it
+    inline void* Finished(){
+        static char marker;
+        return &marker;
+    }
+
+    // The hand-off between a finishing task and the coroutine awaiting it, which may
+    // race on two threads: whichever comes second resumes the awaiting coroutine
+    struct PromiseBase{
+        // nullptr while running, the awaiting coroutine, or Finished()
+        std::atomic<void*> continuation{nullptr};
+        std::exception_ptr exception;
+
+        std::suspend_never initial_suspend() noexcept{
+            return {};
+        }
+
+        struct FinalAwaiter{
+            bool await_ready() noexcept{
+                return false;
+            }
+            template<typename Promise>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept{
+                void* awaiting = handle.promise().continuation.exchange(Finished(), std::memory_order_acq_rel);
+                if(awaiting != nullptr){
+                    return std::coroutine_handle<>::from_address(awaiting);
+                }
+                return std::noop_coroutine();
+            }
+            void await_resume() noexcept{
+
+            }
+        };
+        FinalAwaiter final_suspend() noexcept{
+            return {};
+        }
+
+        void unhandled_exception(){
+            exception = std::current_exception();
+        }
+    };
+}
+
+template<typename T = void>
+class Task;
+
+// Shared by Task<T> and Task<void>
+template<typename Promise>
+class TaskBase{
+public:
+    TaskBase(TaskBase&& other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)){
+
+    }
+    TaskBase& operator=(TaskBase&& other) noexcept{
+        if(this != &other){
+            Destroy();
+            m_handle = std::exchange(other.m_handle, nullptr);
+        }
+        return *this;
+    }
+    TaskBase(const TaskBase&) = delete;
+    TaskBase& operator=(const TaskBase&) = delete;
+    // Destructor
+    ~TaskBase(){
+        Destroy();
+    }
+
+    // True once the task has run to the end
+    bool IsDone() const{
+        return m_handle.promise().continuation.load(std::memory_order_acquire) == TaskDetail::Finished();
+    }
+
+    bool await_ready() const{
+        return IsDone();
+    }
+    // Suspends the awaiting coroutine, unless the task finished in the meantime
+    bool await_suspend(std::coroutine_handle<> awaiting){
+        void* expected = nullptr;
+        return m_handle.promise().continuation.compare_exchange_strong(expected, awaiting.address(), std::memory_order_acq_rel);
+    }
+
+protected:
+    explicit TaskBase(std::coroutine_handle<Promise> handle) : m_handle(handle){
+
+    }
+    void Destroy(){
+        if(m_handle){
+            m_handle.destroy();
+            m_handle = nullptr;
+        }
+    }
+    // Rethrows what the task threw
+    void Rethrow() const{
+        if(m_handle.promise().exception){
+            std::rethrow_exception(m_handle.promise().exception);
+        }
+    }
+
+    std::coroutine_handle<Promise> m_handle;
+};
+
+template<typename T>
+struct TaskPromise : TaskDetail::PromiseBase{
+    std::optional<T> value;
+
+    Task<T> get_return_object();
+    void return_value(T result){
+        value = std::move(result);
+    }
+};
+
+template<>
+struct TaskPromise<void> : TaskDetail::PromiseBase{
+    Task<void> get_return_object();
+    void return_void(){
+
+    }
+};
+
+template<typename T>
+class Task : public TaskBase<TaskPromise<T>>{
+public:
+    typedef TaskPromise<T> promise_type;
+
+    // The result, once the task is done
+    T await_resume(){
+        this->Rethrow();
+        return std::move(*this->m_handle.promise().value);
+    }
+
+private:
+    friend struct TaskPromise<T>;
+    explicit Task(std::coroutine_handle<promise_type> handle) : TaskBase<promise_type>(handle){
+
+    }
+};
+
+template<>
+class Task<void> : public TaskBase<TaskPromise<void>>{
+public:
+    typedef TaskPromise<void> promise_type;
+
+    void await_resume(){
+        Rethrow();
+    }
+
+private:
+    friend struct TaskPromise<void>;
+    explicit Task(std::coroutine_handle<promise_type> handle) : TaskBase<promise_type>(handle){
+
+    }
+};
+
+template<typename T>
+Task<T> TaskPromise<T>::get_return_object(){
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object(){
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+// co_await ResumeOnJobs(scheduler) continues the coroutine as a job of scheduler
+struct ResumeOnJobs{
+    JobScheduler& scheduler;
+    // Lower runs first, like every other job
+    float priority = 0.0f;
+
+    bool await_ready() const{
+        return false;
+    }
+    void await_suspend(std::coroutine_handle<> handle){
+        scheduler.Submit([handle](JobScheduler::Job&){ handle.resume(); }, priority);
+    }
+    void await_resume() const{
+
+    }
+};
+
+// Coroutines waiting for the thread that owns the OpenGL context
+class MainThreadQueue{
+public:
+    struct Awaiter{
+        MainThreadQueue& queue;
+
+        bool await_ready() const{
+            return false;
+        }
+        void await_suspend(std::coroutine_handle<> handle){
+            queue.Post(handle);
+        }
+        void await_resume() const{
+
+        }
+    };
+
+    // co_await queue continues the coroutine in the next RunUntilDone() round
+    Awaiter operator co_await(){
+        return Awaiter{ *this };
+    }
+
+    // Queues a coroutine to resume on the main thread
+    void Post(std::coroutine_handle<> handle){
+        // Notified under the lock: once the handle is resumed the graph may finish and
+        // the queue go away, before a notify after the unlock would get to run
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_handles.push_back(handle);
+        m_posted.notify_one();
+    }
+
+    // Resumes queued coroutines on this thread until task is done
+    template<typename Promise>
+    void RunUntilDone(const TaskBase<Promise>& task){
+        while(!task.IsDone()){
+            std::unique_lock<std::mutex> lock(m_mutex);
+            // The task may finish on a worker without posting anything, so look again now and then
+            m_posted.wait_for(lock, std::chrono::milliseconds(1), [this]{ return !m_handles.empty(); });
+            std::deque<std::coroutine_handle<>> handles;
+            handles.swap(m_handles);
+            lock.unlock();
+            for(std::coroutine_handle<> handle : handles){
+                handle.resume();
+            }
+        }
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_posted;
+    std::deque<std::coroutine_handle<>> m_handles;
+};
+
+#endif
@@ -5,49 +5,82 @@
 #include "VertexBufferLayout.hpp"
 #include "Texture.hpp"
 #include "Shader.hpp"
-#include "PerlinNoise.hpp"
+#include "NoiseContext.hpp"
+#include "OctaveCache.hpp"
+#include "TerrainRamp.hpp"
+#include "TerrainBuilder.hpp"
+#include "ChunkStreamer.hpp"
+#include "UploadQueue.hpp"
+#include "GridIndexCache.hpp"
 #include "Image.hpp"
 #include "Object.hpp"
 #include "glm/vec3.hpp"
 
+#include <memory>
 #include <vector>
 #include <string>
 #include <glad/glad.h>
 
 class Terrain : public Object {
 public:
-    // Takes in a Terrain and a filename for the heightmap.
-    Terrain (unsigned int chunkSize,  unsigned int LOD, float xOffset, float zOffset);
+    // Takes a chunk whose noise map and mesh were already built (on another thread, see
+    // ChunkStreamer), only the OpenGL buffers are made here. A mesh of texels is drawn by vertex
+    // pulling from a height texture, with heightfield_vert.glsl. With an upload queue they are filled over
+    // the next frames, from the chunk's staged span if it has one; see IsUploaded().
+    // The tiles are drawn with gridIndices' shared index buffers, which must outlive the chunk.
+    Terrain (ReadyChunk&& chunk, GridIndexCache& gridIndices, UploadQueue* uploads = nullptr);
     // Destructor
     ~Terrain ();
-    // override the initialization routine.
-    void Init();
+    // Creates the OpenGL buffers (or height texture) from m_mesh
+    void Upload();
+    // Draws the chunk's tiles
+    void Render() override;
+    // The chunk size and height range vert.glsl needs to unpack the vertices
+    // (and the height texture unit for heightfield_vert.glsl)
+    void SetUniforms(Shader& shader) override;
+    // True if the chunk is drawn from a height texture instead of a vertex buffer
+    bool UsesHeightTexture() const;
+    // False while the upload queue still has copies to make into the buffers
+    bool IsUploaded() const;
     // Loads a heightmap based on a PPM image
     // This then sets the heights of the terrain.
     void LoadHeightMap(Image image);
-    float LayerPerlinNoise(float x, float z, int numOctaves, int startOctave);
-    void GenerateNoiseMap();
+    float LayerPerlinNoise(float x, float z, int numOctaves, int startOctave = 1);
     void LoadPerlinTexture();
-    // From 1-6
-    unsigned int m_LOD;
-    unsigned int m_scaledSize;
+    // Level of detail the chunk was built at
+    unsigned int GetLOD() const;
 
     // number of tiles from origin
     float m_xOffset;
     float m_zOffset;
-    float m_persistence = 0.3f;
-    float m_amplitude = 1.0f;
-    float m_frequency = 4.0f;
 
 private:
-    // data
-    unsigned int m_chunkSize;
+    // Noise, heights, colours and mesh, everything before OpenGL
+    std::unique_ptr<TerrainBuilder> m_builder;
+    // Drops the queued copies, before the data they read goes away
+    void CancelUpload();
+    // The chunk's vertices in the compact layout, or its height texels; Object's m_geometry stays empty
+    TerrainMesh m_mesh;
+    // Heights and normals for vertex pulling, on texture unit 1
+    Texture m_heightTexture;
+    // Per tile uniforms of the shader SetUniforms() was given: where the tile starts, its width,
+    // the grid step along a row and from one row to the next, and how far each row is lowered
+    struct TileUniforms{
+        GLint origin = -1;
+        GLint verticesX = -1;
+        GLint step = -1;
+        GLint rowStep = -1;
+        GLint rowDrop = -1;
+    };
+    TileUniforms m_tileUniforms;
+    // Index buffers shared with every other chunk
+    GridIndexCache& m_gridIndices;
 
-    // Store the height in a multidimensional array
-    float* m_noiseData;
-    uint8_t* m_terrainColor;
     // Textures for the terrain
     std::vector<Texture> m_textures;
+    // Queue filling the buffers, and its ticket for them (0 once done)
+    UploadQueue* m_uploads = nullptr;
+    UploadQueue::Ticket m_uploadTicket = 0;
 };
 
 #endif
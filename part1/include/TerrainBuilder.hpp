@@ -0,0 +1,157 @@
+/** @file TerrainBuilder.hpp
+ *  @brief The CPU side of a terrain chunk: noise, heights, colours and mesh.
+ *
+ *  Everything a Terrain does before talking to OpenGL lives here, so a
+ *  chunk can be generated on any thread and timed without a window.
+ *  With a thread pool the chunk is cut into bands of rows. Every row only
+ *  depends on its own z, and each band starts its row state from scratch,
+ *  so the result is bit-identical whatever the number of threads.
+ *  Streamed chunks pass no pool: each is built on one JobScheduler worker
+ *  and the parallelism is across chunks, so the two never share threads.
+ *
+ *  Neighbouring chunks share their edge vertices: chunk c starts at
+ *  vertex c * (chunkSize - 1). A chunk can be built at a level of detail
+ *  L, a grid of every 2^L-th vertex of the full chunk, so chunkSize - 1
+ *  has to be a multiple of 2^L (513 allows levels 0 to 4). The samples
+ *  of a level are exactly the full chunk's at those vertices.
+ */
+#ifndef TERRAINBUILDER_HPP
+#define TERRAINBUILDER_HPP
+
+#include "PerlinNoise.hpp"
+#include "NoiseContext.hpp"
+#include "FractalKernel.hpp"
+#include "OctaveCache.hpp"
+#include "TerrainRamp.hpp"
+#include "ThreadPool.hpp"
+#include "TerrainMesh.hpp"
+#include "glm/vec2.hpp"
+
+#include <cstdint>
+#include <vector>
+
+class TerrainBuilder{
+public:
+    // Rows per band handed to a thread: small enough to balance 16 threads on a 512 chunk
+    static constexpr unsigned int RowsPerBand = 8;
+    // Coarsest level of detail, every 16th vertex
+    static constexpr unsigned int MaxLOD = 4;
+    // Rows are sampled from a multiple of this many columns, in whole blocks of it (the widest SIMD kernel)
+    static constexpr unsigned int SampleAlignment = 16;
+
+    // xOffset and zOffset count chunks from the origin.
+    // The cache, ramp and pool are shared and must outlive the builder; the ramp
+    // defaults to the original colours and heights, no pool runs on the caller.
+    // lod is clamped to GetMaxLOD(chunkSize).
+    TerrainBuilder(unsigned int chunkSize, float xOffset, float zOffset, const NoiseContext& noise = NoiseContext(),
+                   OctaveCache* octaveCache = nullptr, const TerrainRamp* ramp = nullptr, ThreadPool* threadPool = nullptr,
+                   unsigned int lod = 0);
+    // Destructor
+    ~TerrainBuilder();
+    // Switches to new noise settings, GenerateNoiseMap() picks them up
+    void SetNoise(const NoiseContext& noise);
+    // The coarsest level a chunk of chunkSize can be built at
+    static unsigned int GetMaxLOD(unsigned int chunkSize);
+    // Meshes get skirts along their edges, deep enough to hide the cracks against a
+    // neighbour whose grid is stride vertices apart. 0 or 1 (the default) builds none.
+    void SetSkirtStride(unsigned int stride);
+
+    // Samples and blends the noise of every vertex, and runs it through the ramp
+    void GenerateNoiseMap();
+    // Fills mesh with the grid of vertices in the compact vertex format chunks are drawn with, in tiles
+    // for GridIndices (the triangles are the same for every chunk and not part of the mesh)
+    void BuildMesh(TerrainMesh& mesh) const;
+    // Fills mesh with the same heights and normals as BuildMesh(), as the texels of a height
+    // texture for vertex pulling. The tiles are the same, the vertices are left empty.
+    void BuildHeightTexels(TerrainMesh& mesh) const;
+
+    // The noise at a single point, with the same octaves as GenerateNoiseMap()
+    float LayerPerlinNoise(float x, float z, int numOctaves, int startOctave = 1);
+    // Builds the per-octave amplitude and persistence schedule of settings used by LayerPerlinNoise
+    // (Layers is siv::FractalLayers, or a float schedule for the batch kernels)
+    template <class Layers>
+    static Layers BuildFractalLayers(const NoiseSettings& settings, int numOctaves, int startOctave);
+    // Samples octaveCount octaves of a row and their derivatives, the first at scale, with kernel if there is one
+    static void SampleOctaveRows(const NoiseSource& source, const FractalKernel* kernel, int octaveCount, float xStart, float scale,
+                                 float y, std::size_t count, float* const* rows, float* const* dxRows, float* const* dyRows);
+    // Blends the octave rows of layers into the noise and its gradient, with kernel if there is one
+    static void BlendOctaveRows(const siv::BasicFractalLayers<float>& layers, const FractalKernel* kernel, const float* const* rows,
+                                const float* const* dxRows, const float* const* dyRows, std::size_t count,
+                                float* noise, float* noiseDx, float* noiseDz);
+    // The slope of the height field from the ramp's slope and the noise gradient, per first octave unit;
+    // noiseScale is the first octave units a vertex
+    static glm::vec2 GetHeightGradient(float heightSlope, float noiseDx, float noiseDz, float noiseScale);
+    // Packs the normal of a height gradient, up for flat ground
+    static void EncodeGradientNormal(const glm::vec2& gradient, std::int8_t normal[2]);
+
+    // Returns the number of vertices along each side at full resolution
+    unsigned int GetChunkSize() const;
+    // Returns the level of detail, the full chunk vertices between two grid vertices,
+    // and the grid vertices along each side (the size of every array below)
+    unsigned int GetLOD() const;
+    unsigned int GetGridStride() const;
+    unsigned int GetGridSize() const;
+    // Returns the offset of the first vertex, in vertices
+    float GetXOffset() const;
+    float GetZOffset() const;
+    // Returns the blended noise, and its gradient along x and z, of every vertex
+    const float* GetNoiseData() const;
+    const float* GetNoiseDx() const;
+    const float* GetNoiseDz() const;
+    // Returns the height of every vertex
+    const float* GetHeightData() const;
+    // Returns the packed RGBA colour of every vertex
+    const std::uint32_t* GetColorData() const;
+    // The slope of the height field at a vertex, along x and z
+    glm::vec2 GetHeightGradient(std::size_t vertex) const;
+
+private:
+    // Runs body over the rows in bands of rowsPerBand, on the pool if there is one
+    void ForEachRowBand(const ThreadPool::RangeFunction& body, unsigned int rowsPerBand = RowsPerBand) const;
+    // How far the skirts hang below the edges, 0 without skirts
+    float GetSkirtDepth() const;
+    // Cuts the chunk into mesh's tiles and skirts, and sets its height range. Returns the vertices the
+    // tiles need, numbered from each tile's firstVertex when withVertices is set (else 0).
+    std::size_t LayoutTiles(TerrainMesh& mesh, bool withVertices) const;
+    // The packed height and normal of a vertex, over mesh's height range
+    void EncodeVertex(std::size_t vertex, const TerrainMesh& mesh, std::uint16_t& height, std::int8_t normal[2]) const;
+
+    unsigned int m_chunkSize;
+    // Level of detail, and the grid it gives
+    unsigned int m_lod;
+    unsigned int m_gridStride;
+    unsigned int m_gridSize;
+    // Coarsest neighbour grid the skirts cover, 0 for none
+    unsigned int m_skirtStride = 0;
+    // Offset of the first vertex, in vertices
+    float m_xOffset;
+    float m_zOffset;
+    // Seeded noise shared with the other chunks
+    NoiseContext m_noise;
+    // First octave frequency, from the settings
+    float m_frequency;
+    // Octave schedule, rebuilt whenever the noise map is generated
+    siv::FractalLayers m_fractalLayers;
+    // Unrolled kernel for the schedule's layer count, nullptr if there is none
+    const FractalKernel* m_fractalKernel = nullptr;
+    int m_fractalOctaves = 0;
+    int m_fractalStartOctave = 0;
+    // Octave samples shared with the other chunks, nullptr to always re-sample
+    OctaveCache* m_octaveCache;
+    // Noise to height and colour tables
+    const TerrainRamp* m_ramp;
+    // Where the rows run, nullptr for the calling thread
+    ThreadPool* m_threadPool;
+
+    // Blended noise of every vertex, and its gradient along x and z
+    std::vector<float> m_noiseData;
+    std::vector<float> m_noiseDx;
+    std::vector<float> m_noiseDz;
+    // Height of every vertex, and its derivative with respect to the noise
+    std::vector<float> m_heightData;
+    std::vector<float> m_heightSlope;
+    // Packed RGBA colour of every vertex
+    std::vector<std::uint32_t> m_terrainColor;
+};
+
+#endif
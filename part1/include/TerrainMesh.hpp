@@ -0,0 +1,109 @@
+/** @file TerrainMesh.hpp
+ *  @brief The compact vertex format terrain chunks are drawn with.
+ *
+ *  A terrain vertex only needs its grid position, its height and its
+ *  normal: texture coordinates follow from the grid position, and the
+ *  tangents of a height field are never read. So a vertex is 8 bytes
+ *  instead of Geometry's 56: x and z as 16-bit grid coordinates, the
+ *  height as unorm16 over the chunk's height range, and the normal
+ *  octahedral-encoded in two snorm8 values. vert.glsl decodes it.
+ *
+ *  The vertices are laid out in tiles small enough for 16-bit indices,
+ *  each row-major, so every tile of a size is drawn with the same shared
+ *  indices (see GridIndexCache) from its own first vertex. Tiles share
+ *  the vertices along their edges, each has its own copy. Between chunks
+ *  of different levels of detail, skirts hanging from the edges hide the
+ *  cracks where a fine edge has vertices the coarse one does not.
+ *
+ *  For vertex pulling the mesh holds texels instead of vertices: a
+ *  grid of heights and normals, 4 bytes each, that
+ *  heightfield_vert.glsl fetches by grid position. x and z come from
+ *  gl_VertexID within the tile, so there is no vertex buffer at all and
+ *  the only per-chunk data is the texture.
+ */
+#ifndef TERRAINMESH_HPP
+#define TERRAINMESH_HPP
+
+#include "glm/vec3.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// One vertex of a terrain chunk, as the vertex buffer holds it
+struct TerrainVertex{
+    // Position within the chunk, in full resolution vertices
+    std::uint16_t x;
+    std::uint16_t z;
+    // 0 is the chunk's lowest height, 65535 its highest
+    std::uint16_t height;
+    // Octahedral normal, y up, each component scaled by 127
+    std::int8_t normal[2];
+};
+
+static_assert(sizeof(TerrainVertex) == 8, "TerrainVertex must stay tightly packed");
+
+// One texel of a terrain chunk's height texture, read as GL_RG16UI: the height is red,
+// the two normal bytes are green (normal[0] in its low byte)
+struct TerrainTexel{
+    // 0 is the chunk's lowest height, 65535 its highest
+    std::uint16_t height;
+    // Octahedral normal, y up, each component scaled by 127
+    std::int8_t normal[2];
+};
+
+static_assert(sizeof(TerrainTexel) == 4, "TerrainTexel must stay tightly packed");
+
+// How terrain chunks get their vertices to the GPU
+enum class TerrainDrawPath{
+    // A buffer of TerrainVertex per chunk, vert.glsl
+    VertexBuffer,
+    // A texture of TerrainTexel per chunk, heightfield_vert.glsl pulls the vertices
+    HeightTexture
+};
+
+// A tile of a terrain chunk's vertices
+struct TerrainTile{
+    // Index of the tile's first vertex in the mesh (0 when the mesh has texels)
+    unsigned int firstVertex;
+    // Grid position of the first vertex within the chunk, in grid vertices of the chunk's level
+    unsigned int x;
+    unsigned int z;
+    // Vertices along x and z
+    unsigned int verticesX;
+    unsigned int verticesZ;
+    // A skirt hangs a stretch of the chunk's edge down by TerrainMesh::skirtDepth:
+    // row 0 is the edge and row 1 the same vertices lowered. An alongZ skirt runs
+    // along z, its verticesX vertices are one after the other in z.
+    bool skirt = false;
+    bool alongZ = false;
+};
+
+// The vertices of a terrain chunk, in tiles. Either vertices or texels is filled.
+struct TerrainMesh{
+    std::vector<TerrainVertex> vertices;
+    // Row-major, the grid size of the chunk's level a side
+    std::vector<TerrainTexel> texels;
+    std::vector<TerrainTile> tiles;
+    // The heights the vertices' 0 and 65535 stand for
+    float minHeight = 0.0f;
+    float maxHeight = 0.0f;
+    // How far the skirts hang below the edge, 0 if there are none
+    float skirtDepth = 0.0f;
+
+    // Size of the vertex buffer, in bytes
+    std::size_t GetVertexBytes() const;
+    // Size of the height texture, in bytes
+    std::size_t GetTexelBytes() const;
+    // Quads of every tile together
+    std::size_t GetQuadCount() const;
+
+    // Height to unorm16 over [minHeight, maxHeight], and back
+    static std::uint16_t EncodeHeight(float height, float minHeight, float maxHeight);
+    static float DecodeHeight(std::uint16_t height, float minHeight, float maxHeight);
+    // Unit normal to its octahedral encoding, and back
+    static void EncodeNormal(const glm::vec3& normal, std::int8_t encoded[2]);
+    static glm::vec3 DecodeNormal(const std::int8_t encoded[2]);
+};
+
+#endif
@@ -0,0 +1,79 @@
+/** @file TerrainRamp.hpp
+ *  @brief Turns blended noise into terrain heights and colours through lookup tables.
+ *
+ *  The ramp is a list of stops, each giving the height and colour at one
+ *  noise value, linearly interpolated in between. The stops are plain
+ *  data (a palette file can replace them at start up), and are baked into
+ *  tables with Resolution entries over [0, 1]. Apply() then maps a whole
+ *  plane of noise to heights, height slopes and packed RGBA colours in one
+ *  branch-free pass, with the gathers done by SIMD kernels where the CPU
+ *  has them.
+ */
+#ifndef TERRAINRAMP_HPP
+#define TERRAINRAMP_HPP
+
+#include "PerlinNoiseBatch.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One stop of the ramp: at this noise value the terrain has this height and colour
+struct RampStop{
+    float noise;
+    float height;
+    std::uint8_t r, g, b;
+};
+
+class TerrainRamp{
+public:
+    // Table entries over [0, 1]. Colours step by less than one unit between entries.
+    static constexpr unsigned int Resolution = 4096;
+
+    // Bakes the stops (sorted by noise) into tables, using the best kernel for this CPU
+    TerrainRamp(const std::vector<RampStop>& stops = GetDefaultStops());
+    // Same as above, but forces a kernel (unsupported ones fall back to scalar)
+    TerrainRamp(const std::vector<RampStop>& stops, PerlinNoiseBatch::Kernel kernel);
+    // Destructor
+    ~TerrainRamp();
+    // Replaces the stops and bakes the tables again
+    void SetStops(const std::vector<RampStop>& stops);
+    // Returns the stops the tables were baked from
+    const std::vector<RampStop>& GetStops() const;
+    // Returns the lowest and highest stop height, the ramp interpolates them so they bound every height
+    float GetMinHeight() const;
+    float GetMaxHeight() const;
+    // Returns the kernel Apply() runs
+    PerlinNoiseBatch::Kernel GetKernel() const;
+
+    // Maps count noise values (in [0, 1], clamped) to heights, the derivative of the height
+    // with respect to the noise, and colours packed as R | G << 8 | B << 16 | A << 24
+    void Apply(const float* noise, std::size_t count, float* heights, float* slopes, std::uint32_t* colors) const;
+    // Interpolates the stops directly, for a single value
+    float Height(float noise) const;
+    float HeightSlope(float noise) const;
+
+    // The deep water to snow ramp the terrain has always had: flat sea up to 0.5, then height = 100 * noise
+    static std::vector<RampStop> GetDefaultStops();
+    // Reads stops from a text file, one "noise height r g b" per line, # starts a comment.
+    // Returns false and leaves stops alone if the file cannot be read or is not sorted.
+    static bool LoadStops(const std::string& path, std::vector<RampStop>& stops);
+
+private:
+    // Fills the tables from m_stops
+    void BuildTables();
+
+    std::vector<RampStop> m_stops;
+    float m_minHeight = 0.0f;
+    float m_maxHeight = 0.0f;
+    // Resolution + 1 heights, so every entry has a next one to lerp to
+    std::vector<float> m_heights;
+    // Slope and colour of the ramp at every entry
+    std::vector<float> m_slopes;
+    std::vector<std::uint32_t> m_colors;
+    // Which kernel we dispatch to
+    PerlinNoiseBatch::Kernel m_kernel;
+};
+
+#endif
@@ -23,20 +23,31 @@ public:
 	// Loads and sets up an actual texture
     void LoadTexture(const std::string filepath);
     void LoadCubemapTexture();
-    void LoadPerlinTexture(unsigned int m_chunkSize, uint8_t* m_noiseData);
+    // Makes an RGBA texture from m_chunkSize * m_chunkSize pixels, 4 bytes each
+    void LoadPerlinTexture(unsigned int m_chunkSize, const uint8_t* m_noiseData);
+    // Makes a GL_RG16UI texture from chunkSize * chunkSize TerrainTexels, for texelFetch only
+    // (nearest, no mipmaps); nullptr leaves it to be filled later
+    void LoadHeightTexture(unsigned int chunkSize, const void* texels);
+    // Makes an empty size * size RGBA texture that repeats, for toroidal updates: linear, no mipmaps
+    void LoadClipmapTexture(unsigned int size);
+    // Replaces a width * height rectangle of level 0 at (x, y), pixels tightly packed in format and type
+    void UpdateRegion(unsigned int x, unsigned int y, unsigned int width, unsigned int height,
+                      GLenum format, GLenum type, const void* pixels);
 	// slot tells us which slot we want to bind to.
     // We can have multiple slots. By default, we
     // will set our slot to 0 if it is not specified.
     void Bind(unsigned int slot=0) const;
     // Be done with our texture
     void Unbind();
+    // The OpenGL texture name
+    GLuint GetID() const;
 private:
     // Store a unique ID for the texture
-    GLuint m_textureID;
+    GLuint m_textureID = 0;
 	// Filepath to the image loaded
     std::string m_filepath;
     // Store whatever image data inside of our texture class.
-    Image* m_image;
+    Image* m_image = nullptr;
 };
 
 
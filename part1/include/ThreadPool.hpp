@@ -0,0 +1,69 @@
+/** @file ThreadPool.hpp
+ *  @brief A fixed set of worker threads for data-parallel loops.
+ *
+ *  ParallelFor() splits a range into chunks and hands them out from an
+ *  atomic counter, so fast threads take more chunks and a chunk is never
+ *  run twice. The calling thread works on the range too and returns when
+ *  every chunk is done. Which thread runs a chunk changes from run to
+ *  run, so callers keep the output of a chunk independent of the others
+ *  to stay deterministic.
+ */
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool{
+public:
+    // The body of a loop, called with [begin, end) of the range
+    typedef std::function<void(std::size_t begin, std::size_t end)> RangeFunction;
+
+    // Starts threadCount - 1 workers, the caller being the last thread.
+    // 0 uses every hardware thread, 1 runs everything on the caller.
+    ThreadPool(unsigned int threadCount = 0);
+    // Stops and joins the workers
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Runs body over [0, count) in chunks of grain, on every thread, and returns when all are done.
+    // Loops from several threads take turns. body must not call ParallelFor on the same pool.
+    void ParallelFor(std::size_t count, std::size_t grain, const RangeFunction& body);
+    // Returns the number of threads a loop runs on, the caller included
+    unsigned int GetThreadCount() const;
+    // Returns the number of hardware threads, at least 1
+    static unsigned int GetHardwareThreads();
+
+private:
+    // Waits for loops and works on them until the pool is stopped
+    void WorkerLoop();
+    // Takes chunks of the current loop until there are none left
+    void RunChunks();
+
+    std::vector<std::thread> m_workers;
+    // One loop at a time
+    std::mutex m_loopMutex;
+    // Guards the loop state below, and wakes the workers
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    bool m_stop = false;
+    // Bumped for every loop, so a worker knows it has not seen it yet
+    std::uint64_t m_generation = 0;
+    // Workers still inside the current loop
+    unsigned int m_active = 0;
+    // The current loop
+    const RangeFunction* m_body = nullptr;
+    std::size_t m_count = 0;
+    std::size_t m_grain = 1;
+    std::atomic<std::size_t> m_next{0};
+};
+
+#endif
@@ -0,0 +1,127 @@
+/** @file UploadQueue.hpp
+ *  @brief Frame-budgeted uploads of buffers and textures through a staging ring.
+ *
+ *  Workers write finished vertex, index and texel data into spans of the
+ *  staging ring. The render thread queues copies from those spans into
+ *  its buffers and textures, and Drain() runs at most a budget of bytes
+ *  of them each frame, so a chunk arriving never stalls a frame on one
+ *  big glBufferData.
+ *
+ *  With GL_ARB_buffer_storage the ring is a persistently mapped buffer:
+ *  copies are glCopyBufferSubData and unpack buffer glTexSubImage2D, a
+ *  fence is placed after them and the span is reused once it has passed.
+ *  Without it the ring is plain memory uploaded with glBufferSubData and
+ *  glTexSubImage2D, which copy it straight away. Data that did not fit
+ *  in the ring can be uploaded from CPU memory with the same budget.
+ */
+#ifndef UPLOADQUEUE_HPP
+#define UPLOADQUEUE_HPP
+
+#include "StagingRing.hpp"
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+class UploadQueue{
+public:
+    // glBufferStorage, which the 3.3 loader does not know about
+    typedef void (APIENTRYP BufferStorageFunction)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+    // Identifies a set of copies queued together
+    typedef std::uint64_t Ticket;
+
+    // One copy into a buffer (at byte 0) or into every row of a texture of 4-byte texels
+    struct Copy{
+        GLuint buffer = 0;
+        GLuint texture = 0;
+        unsigned int textureWidth = 0;
+        // How glTexSubImage2D reads the texels, and whether the mipmaps are remade after
+        GLenum textureFormat = GL_RGBA;
+        GLenum textureType = GL_UNSIGNED_BYTE;
+        bool textureMipmaps = true;
+        std::size_t size = 0;
+        // Where the data is: an offset into the staged span, or memory that outlives the upload
+        std::size_t stagedOffset = 0;
+        const std::uint8_t* source = nullptr;
+    };
+
+    struct Stats{
+        bool persistent = false;
+        // Bytes copied in the last Drain(), and in total
+        std::size_t lastFrameBytes = 0;
+        std::size_t totalBytes = 0;
+        // Bytes waiting in the queue, and fences the GPU has not passed yet
+        std::size_t pendingBytes = 0;
+        std::size_t fencesInFlight = 0;
+        // Bytes that came from CPU memory because they were not staged
+        std::size_t unstagedBytes = 0;
+    };
+
+    // Creates the ring on the current OpenGL context. Pass glBufferStorage if
+    // GL_ARB_buffer_storage is there, nullptr to stage in plain memory.
+    UploadQueue(std::size_t capacity, std::size_t bytesPerFrame, BufferStorageFunction bufferStorage = nullptr);
+    // Waits for the copies in flight, then frees the ring
+    ~UploadQueue();
+    UploadQueue(const UploadQueue&) = delete;
+    UploadQueue& operator=(const UploadQueue&) = delete;
+
+    // Workers reserve their spans here
+    StagingRing& GetRing();
+    bool IsPersistent() const;
+    void SetBytesPerFrame(std::size_t bytesPerFrame);
+    std::size_t GetBytesPerFrame() const;
+
+    // Queues copies from staged (which the queue releases when done), or from their
+    // own source if staged is empty
+    Ticket Upload(const StagingRing::Span& staged, const std::vector<Copy>& copies);
+    // True once every copy of ticket has been issued, the objects can then be drawn
+    bool IsComplete(Ticket ticket) const;
+    // Drops the copies of ticket that have not run yet
+    void Cancel(Ticket ticket);
+    // Runs queued copies up to the byte budget, and frees the ring space the GPU is done with
+    void Drain();
+
+    Stats GetStats() const;
+
+private:
+    struct PendingUpload{
+        Ticket ticket;
+        StagingRing::Span staged;
+        std::vector<Copy> copies;
+        // Copy being run, and bytes of it already copied
+        std::size_t copyIndex;
+        std::size_t copied;
+        bool started;
+    };
+    // Spans the GPU may still read, until their fence passes
+    struct Fence{
+        GLsync sync;
+        std::vector<StagingRing::Span> spans;
+    };
+
+    // Copies up to budget bytes of the current copy of upload, returns how many
+    std::size_t RunCopy(PendingUpload& upload, std::size_t budget);
+    // Hands a span back once nothing can read it any more
+    void Retire(const StagingRing::Span& span, bool started);
+    // Releases the spans of every fence the GPU has passed
+    void PollFences();
+
+    GLuint m_buffer = 0;
+    std::uint8_t* m_mapped = nullptr;
+    // Staging memory when there is no persistent mapping
+    std::vector<std::uint8_t> m_memory;
+    std::unique_ptr<StagingRing> m_ring;
+    std::size_t m_bytesPerFrame;
+
+    std::deque<PendingUpload> m_uploads;
+    Ticket m_nextTicket = 1;
+    std::deque<Fence> m_fences;
+    // Spans whose copies ran this frame, fenced at the end of Drain()
+    std::vector<StagingRing::Span> m_retired;
+    Stats m_stats;
+};
+
+#endif
@@ -12,6 +12,7 @@
 // The glad library helps setup OpenGL extensions.
 #include <glad/glad.h>
 
+#include "TerrainMesh.hpp"
 
 class VertexBufferLayout{ 
 public:
@@ -49,6 +50,21 @@ public:
     // bitangent b_x,b_y,b_z
     void CreateNormalBufferLayout(unsigned int vcount,unsigned int icount, float* vdata, unsigned int* idata );
 
+    // The compact terrain layout, one TerrainVertex per vertex:
+    //
+    // location 0: x,z,height as unsigned integers (uvec3)
+    // location 1: octahedral normal as signed integers (ivec2)
+    //
+    // vcount is in vertices, not floats. vert.glsl decodes both.
+    // There is no index buffer, the tiles are drawn with a GridIndexCache's.
+    void CreateTerrainBufferLayout(unsigned int vcount, const TerrainVertex* vdata);
+    // A vertex array with no attributes and no buffers, for shaders that
+    // make their vertices from gl_VertexID (see heightfield_vert.glsl)
+    void CreateAttributelessLayout();
+    // The buffers made by the Create functions, to fill them some other way
+    GLuint GetVertexBuffer() const;
+    GLuint GetIndexBuffer() const;
+
 private:
     // Vertex Array Object
     GLuint m_VAOId;
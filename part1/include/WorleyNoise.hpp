@@ -0,0 +1,59 @@
+/** @file WorleyNoise.hpp
+ *  @brief Cellular (Worley) noise on a hashed, jittered grid.
+ *
+ *  Every unit cell holds one feature point, placed by an integer hash
+ *  of the cell and the seed. F1 and F2 are the distances from a sample
+ *  to the closest and second closest feature point, found by searching
+ *  the 3x3 cells around the sample. With one point per cell F1 is
+ *  exact; F2 can very rarely belong to a cell two steps away, the usual
+ *  trade-off of a 3x3 search.
+ *
+ *  As a NoiseSource it returns 2 * F1 - 1, which stays in [-1, 1] for
+ *  all but the emptiest cells. F2 - F1 (ridges along the cell borders)
+ *  is available from the cellular calls.
+ */
+#ifndef WORLEYNOISE_HPP
+#define WORLEYNOISE_HPP
+
+#include "NoiseSource.hpp"
+#include "PerlinNoiseBatch.hpp"
+
+#include <cstdint>
+
+class WorleyNoise : public NoiseSource{
+public:
+    // Uses the best kernel for this CPU
+    WorleyNoise(std::uint32_t seed);
+    // Same as above, but forces a kernel (unsupported ones fall back to scalar)
+    WorleyNoise(std::uint32_t seed, PerlinNoiseBatch::Kernel kernel);
+    // Destructor
+    ~WorleyNoise();
+    // Evaluates a single point: 2 * F1 - 1
+    float Noise2D(float x, float y) const override;
+    // Evaluates a row of a regular grid with the SIMD kernel
+    void Noise2DRow(float xStart, float xScale, float y, std::size_t count, float* out) const override;
+    // Evaluates arbitrary points with the SIMD kernel
+    void Noise2DPoints(const float* xs, const float* ys, std::size_t count, float* out) const override;
+    // Evaluates a single point and its derivatives. F1 has creases on the cell borders,
+    // where the derivative jumps from one side's value to the other's.
+    float Noise2DGradient(float x, float y, float& dx, float& dy) const override;
+    // Noise2DRow() plus derivatives, with the SIMD kernel
+    void Noise2DRowGradient(float xStart, float xScale, float y, std::size_t count, float* out, float* dx, float* dy) const override;
+    // Returns NoiseBackend::Worley
+    NoiseBackend GetBackend() const override;
+    // Returns the kernel we run
+    PerlinNoiseBatch::Kernel GetKernel() const;
+
+    // Distances to the closest and second closest feature points
+    void Cellular2D(float x, float y, float& f1, float& f2) const;
+    // Cellular2D() for a row of a regular grid, with the SIMD kernel
+    void Cellular2DRow(float xStart, float xScale, float y, std::size_t count, float* f1, float* f2) const;
+
+private:
+    // Mixed into every cell hash
+    std::uint32_t m_seed;
+    // Which kernel we dispatch to
+    PerlinNoiseBatch::Kernel m_kernel;
+};
+
+#endif
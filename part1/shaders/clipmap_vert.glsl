@@ -0,0 +1,94 @@
+// ==================================================================
+#version 330 core
+// Geometry clipmap levels, by vertex pulling like heightfield_vert.glsl.
+// A level is a window of u_levelSize vertices a side, u_levelSpacing
+// full resolution vertices apart, whose heights and normals sit in a
+// texture addressed toroidally: window vertex g is texel
+// (u_levelWrap + g) mod u_levelSize. Towards its outer edge a level
+// morphs into the next one, see Clipmap.hpp.
+
+// If we are applying our camera, then we need to add some uniforms.
+// Note that the syntax nicely matches glm's mat4!
+uniform mat4 model; // Object space
+uniform mat4 view; // Object space
+uniform mat4 projection; // Object space
+
+// How to unpack the texels, the same for every level
+uniform usampler2D u_HeightMap; // Red is the unorm16 height, green the two normal bytes
+uniform float u_minHeight; // The height of a 0
+uniform float u_maxHeight; // The height of a 65535
+uniform vec2 u_morphCentre; // Where the windows are centred, along the ground
+uniform float u_morphStart; // Level vertices from the centre where the morph starts
+uniform float u_morphEnd; // and where the level looks just like the next one
+
+// The level being drawn
+uniform int u_levelSize; // Vertices along a side of the window and its texture
+uniform ivec2 u_levelGrid; // Grid position of the window's first vertex, in level vertices
+uniform ivec2 u_levelWrap; // The texel that first vertex is in
+uniform int u_levelSpacing; // Full resolution vertices between two level vertices
+
+// The tile being drawn
+uniform ivec2 u_tileOrigin; // Window vertex of its first vertex
+uniform int u_tileVerticesX; // Vertices along a row
+
+// Export our normal data, and read it into our frag shader
+out vec3 myNormal;
+// Export our Fragment Position computed in world space
+out vec3 FragPos;
+// If we have texture coordinates we can now use this as well
+out vec2 v_texCoord;
+
+
+// Undoes TerrainMesh::EncodeNormal(), y is up
+vec3 DecodeNormal(ivec2 encoded){
+    vec2 e = max(vec2(encoded) / 127.0, -1.0);
+    vec3 n = vec3(e.x, 1.0 - abs(e.x) - abs(e.y), e.y);
+    // The lower half was folded over the diagonals
+    if(n.y < 0.0){
+        vec2 s = vec2(n.x >= 0.0 ? 1.0 : -1.0, n.z >= 0.0 ? 1.0 : -1.0);
+        n.xz = (1.0 - abs(n.zx)) * s;
+    }
+    return normalize(n);
+}
+
+// The height and normal of window vertex grid, the normal not yet normalized
+vec4 FetchVertex(ivec2 grid){
+    uvec2 texel = texelFetch(u_HeightMap, (u_levelWrap + grid) % u_levelSize, 0).rg;
+    // The normal's snorm8 bytes, sign extended by the arithmetic shift
+    ivec2 octNormal = ivec2(int(texel.g << 24u) >> 24, int(texel.g << 16u) >> 24);
+    return vec4(DecodeNormal(octNormal), mix(u_minHeight, u_maxHeight, float(texel.r) / 65535.0));
+}
+
+void main()
+{
+    ivec2 grid = u_tileOrigin + ivec2(gl_VertexID % u_tileVerticesX, gl_VertexID / u_tileVerticesX);
+    vec4 fine = FetchVertex(grid);
+
+    vec2 ground = vec2((u_levelGrid + grid) * u_levelSpacing);
+    // 0 inside, 1 where the next level takes over
+    vec2 away = abs(ground - u_morphCentre) / float(u_levelSpacing);
+    float morph = clamp((max(away.x, away.y) - u_morphStart) / (u_morphEnd - u_morphStart), 0.0, 1.0);
+
+    // Windows start on even vertices, so the odd ones are the ones the next level does not have.
+    // Such a vertex lies on the edge or diagonal between two even ones; the diagonal runs
+    // like the triangles of GridIndices, from the quad's (1, 0) corner to its (0, 1) one.
+    ivec2 odd = grid & 1;
+    vec4 coarse = fine;
+    if(morph > 0.0 && (odd.x | odd.y) != 0){
+        ivec2 along = ivec2(odd.x, -odd.y);
+        coarse = 0.5 * (FetchVertex(grid - along) + FetchVertex(grid + along));
+    }
+    vec4 blended = mix(fine, coarse, morph);
+
+    vec3 position = vec3(ground.x, blended.w, ground.y);
+
+    gl_Position = projection * view * model * vec4(position, 1.0f);
+
+    myNormal = normalize(blended.xyz);
+    // Transform normal into world space
+    FragPos = vec3(model* vec4(position,1.0f));
+
+    // The colours wrap like the heights, the texture repeats so this needs no modulo
+    v_texCoord = (vec2(u_levelWrap + grid) + 0.5) / float(u_levelSize);
+}
+// ==================================================================
@@ -0,0 +1,72 @@
+// ==================================================================
+#version 330 core
+// Vertex pulling: there are no vertex attributes. The indices count
+// vertices within a tile (see GridIndices.hpp), gl_VertexID turns into
+// the vertex's grid position, and its height and normal come from the
+// chunk's height texture, one TerrainTexel per grid position. Skirt
+// tiles walk along an edge instead, their second row lowered.
+
+// If we are applying our camera, then we need to add some uniforms.
+// Note that the syntax nicely matches glm's mat4!
+uniform mat4 model; // Object space
+uniform mat4 view; // Object space
+uniform mat4 projection; // Object space
+
+// How to unpack the texels of this chunk
+uniform usampler2D u_HeightMap; // Red is the unorm16 height, green the two normal bytes
+uniform int u_gridStride; // Chunk vertices between two texels, 2^LOD
+uniform float u_chunkSize; // Vertices along a side, for the texture coordinates
+uniform float u_minHeight; // The height of a 0
+uniform float u_maxHeight; // The height of a 65535
+
+// The tile being drawn
+uniform ivec2 u_tileOrigin; // Grid position of its first vertex
+uniform int u_tileVerticesX; // Vertices along a row
+uniform ivec2 u_tileStep; // Grid step from one vertex of a row to the next
+uniform ivec2 u_tileRowStep; // Grid step from one row to the next, 0 for skirts
+uniform float u_tileRowDrop; // How much lower each row is, the skirt depth for skirts
+
+// Export our normal data, and read it into our frag shader
+out vec3 myNormal;
+// Export our Fragment Position computed in world space
+out vec3 FragPos;
+// If we have texture coordinates we can now use this as well
+out vec2 v_texCoord;
+
+
+// Undoes TerrainMesh::EncodeNormal(), y is up
+vec3 DecodeNormal(ivec2 encoded){
+    vec2 e = max(vec2(encoded) / 127.0, -1.0);
+    vec3 n = vec3(e.x, 1.0 - abs(e.x) - abs(e.y), e.y);
+    // The lower half was folded over the diagonals
+    if(n.y < 0.0){
+        vec2 s = vec2(n.x >= 0.0 ? 1.0 : -1.0, n.z >= 0.0 ? 1.0 : -1.0);
+        n.xz = (1.0 - abs(n.zx)) * s;
+    }
+    return normalize(n);
+}
+
+void main()
+{
+    int column = gl_VertexID % u_tileVerticesX;
+    int row = gl_VertexID / u_tileVerticesX;
+    ivec2 grid = u_tileOrigin + column * u_tileStep + row * u_tileRowStep;
+    uvec2 texel = texelFetch(u_HeightMap, grid, 0).rg;
+
+    vec3 position = vec3(float(grid.x * u_gridStride),
+                         mix(u_minHeight, u_maxHeight, float(texel.r) / 65535.0) - float(row) * u_tileRowDrop,
+                         float(grid.y * u_gridStride));
+
+    gl_Position = projection * view * model * vec4(position, 1.0f);
+
+    // The normal's snorm8 bytes, sign extended by the arithmetic shift
+    ivec2 octNormal = ivec2(int(texel.g << 24u) >> 24, int(texel.g << 16u) >> 24);
+    myNormal = DecodeNormal(octNormal);
+    // Transform normal into world space
+    FragPos = vec3(model* vec4(position,1.0f));
+
+    // Store the texture coordinates which we will output to
+    // the next stage in the graphics pipeline.
+    v_texCoord = position.xz / u_chunkSize;
+}
+// ==================================================================
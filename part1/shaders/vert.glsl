@@ -1,13 +1,10 @@
 // ==================================================================
 #version 330 core
 // Read in our attributes stored from our vertex buffer object
-// We explicitly state which is the vertex information
-// (The first 3 floats are positional data, we are putting in our vector)
-layout(location=0)in vec3 position; 
-layout(location=1)in vec3 normals; // Our second attribute - normals.
-layout(location=2)in vec2 texCoord; // Our third attribute - texture coordinates.
-layout(location=3)in vec3 tangents; // Our third attribute - texture coordinates.
-layout(location=4)in vec3 bitangents; // Our third attribute - texture coordinates.
+// Terrain vertices are packed into 8 bytes (see TerrainMesh.hpp):
+// the grid x and z and a unorm16 height, then an octahedral normal.
+layout(location=0)in uvec3 gridHeight;
+layout(location=1)in ivec2 octNormal;
 
 // If we are applying our camera, then we need to add some uniforms.
 // Note that the syntax nicely matches glm's mat4!
@@ -15,6 +12,11 @@ uniform mat4 model; // Object space
 uniform mat4 view; // Object space
 uniform mat4 projection; // Object space
 
+// How to unpack the vertices of this chunk
+uniform float u_chunkSize; // Vertices along a side, for the texture coordinates
+uniform float u_minHeight; // The height of a 0
+uniform float u_maxHeight; // The height of a 65535
+
 // Export our normal data, and read it into our frag shader
 out vec3 myNormal;
 // Export our Fragment Position computed in world space
@@ -23,17 +25,32 @@ out vec3 FragPos;
 out vec2 v_texCoord;
 
 
+// Undoes TerrainMesh::EncodeNormal(), y is up
+vec3 DecodeNormal(ivec2 encoded){
+    vec2 e = max(vec2(encoded) / 127.0, -1.0);
+    vec3 n = vec3(e.x, 1.0 - abs(e.x) - abs(e.y), e.y);
+    // The lower half was folded over the diagonals
+    if(n.y < 0.0){
+        vec2 s = vec2(n.x >= 0.0 ? 1.0 : -1.0, n.z >= 0.0 ? 1.0 : -1.0);
+        n.xz = (1.0 - abs(n.zx)) * s;
+    }
+    return normalize(n);
+}
+
 void main()
 {
+    vec3 position = vec3(float(gridHeight.x),
+                         mix(u_minHeight, u_maxHeight, float(gridHeight.z) / 65535.0),
+                         float(gridHeight.y));
 
     gl_Position = projection * view * model * vec4(position, 1.0f);
 
-    myNormal = normals;
+    myNormal = DecodeNormal(octNormal);
     // Transform normal into world space
     FragPos = vec3(model* vec4(position,1.0f));
 
     // Store the texture coordinates which we will output to
     // the next stage in the graphics pipeline.
-    v_texCoord = texCoord;
+    v_texCoord = vec2(gridHeight.xy) / u_chunkSize;
 }
 // ==================================================================
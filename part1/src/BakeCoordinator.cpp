@@ -0,0 +1,253 @@
+#include "BakeCoordinator.hpp"
+#include "Clock.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <thread>
+
+#if defined(LINUX) || defined(MAC) || defined(__unix__) || defined(__APPLE__)
+    #define BAKE_PROCESSES 1
+    #include <signal.h>
+    #include <sys/types.h>
+    #include <sys/wait.h>
+    #include <unistd.h>
+#endif
+
+// The name a worker claims shards under: its host and process id, as workers on a shared mount
+// may run on several machines. Dots become underscores, a claim ends in a dot and the name.
+static std::string GetWorkerName(int processId){
+    std::string name;
+#if defined(BAKE_PROCESSES)
+    char host[256] = {};
+    if(gethostname(host, sizeof(host) - 1) == 0){
+        name = host;
+        std::replace(name.begin(), name.end(), '.', '_');
+    }
+#endif
+    return (name.empty() ? "local" : name) + "-" + std::to_string(processId);
+}
+
+// Constructor
+BakeCoordinator::BakeCoordinator(const BakeSettings& settings, unsigned int shardSize, unsigned int workerCount) :
+    m_settings(settings), m_shardSize(std::max(shardSize, 1u)), m_workerCount(std::max(workerCount, 1u)){
+
+}
+
+std::vector<Shard> BakeCoordinator::MakeShards() const{
+    std::vector<Shard> shards;
+    for(unsigned int z = 0; z < m_settings.chunksZ; z += m_shardSize){
+        for(unsigned int x = 0; x < m_settings.chunksX; x += m_shardSize){
+            Shard shard;
+            shard.index = static_cast<unsigned int>(shards.size());
+            shard.originX = m_settings.originX + static_cast<int>(x);
+            shard.originZ = m_settings.originZ + static_cast<int>(z);
+            // The last row and column of shards take what is left
+            shard.chunksX = std::min(m_shardSize, m_settings.chunksX - x);
+            shard.chunksZ = std::min(m_shardSize, m_settings.chunksZ - z);
+            shard.chunkSize = m_settings.chunkSize;
+            shards.push_back(shard);
+        }
+    }
+    return shards;
+}
+
+bool BakeCoordinator::Run(const std::string& executable, const std::vector<std::string>& workerArguments){
+#if defined(BAKE_PROCESSES)
+    namespace fs = std::filesystem;
+    const double start = Clock::Now();
+    const fs::path directory(m_settings.outputDirectory);
+    std::error_code error;
+    fs::create_directories(directory, error);
+    ShardQueue queue((directory / "queue").string());
+    const std::vector<Shard> shards = MakeShards();
+    if(!queue.Create(shards)){
+        std::cout << "Could not create the shard queue in '" << m_settings.outputDirectory << "'\n";
+        return false;
+    }
+    std::size_t chunkCount = 0;
+    for(const Shard& shard : shards){
+        chunkCount += static_cast<std::size_t>(shard.chunksX) * shard.chunksZ;
+    }
+    std::printf("%zu shards of up to %ux%u chunks, %u workers\n", shards.size(), m_shardSize, m_shardSize, m_workerCount);
+
+    std::vector<std::string> arguments = workerArguments;
+    arguments.push_back("--bake-worker=" + m_settings.outputDirectory);
+
+    std::set<int> workers;
+    std::size_t deaths = 0, requeued = 0;
+    // Workers that died without holding a shard, so not counted by any retry
+    std::size_t emptyDeaths = 0;
+    // Workers that could not be started since the last one that was
+    unsigned int startFailures = 0;
+    double lastReport = start;
+    for(;;){
+        // Put back the shards of every worker that stopped
+        int status = 0;
+        int processId;
+        while((processId = waitpid(-1, &status, WNOHANG)) > 0){
+            workers.erase(processId);
+            const std::size_t held = queue.Requeue(GetWorkerName(processId), MaxAttempts);
+            const bool clean = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+            if(!clean || held > 0){
+                ++deaths;
+                requeued += held;
+                emptyDeaths += held == 0;
+                if(WIFSIGNALED(status)){
+                    std::printf("  worker %d killed by signal %d, %zu shards back in the queue\n", processId, WTERMSIG(status), held);
+                }
+                else{
+                    std::printf("  worker %d exited with %d, %zu shards back in the queue\n", processId, WEXITSTATUS(status), held);
+                }
+            }
+        }
+
+        const ShardQueue::Counts counts = queue.GetCounts();
+        if(workers.empty() && counts.pending == 0){
+            break;
+        }
+        if(emptyDeaths > static_cast<std::size_t>(m_workerCount) * MaxAttempts){
+            std::cout << "Workers keep dying before they take a shard, giving up\n";
+            break;
+        }
+        // Replace dead workers while there is work left for them
+        while(workers.size() < std::min<std::size_t>(m_workerCount, counts.pending + counts.claimed) && counts.pending > 0){
+            const int worker = StartWorker(executable, arguments);
+            if(worker < 0){
+                ++startFailures;
+                std::cout << "Could not start a worker\n";
+                break;
+            }
+            startFailures = 0;
+            workers.insert(worker);
+        }
+        // Running workers still drain the queue, with none left nothing ever would
+        if(workers.empty() && startFailures >= MaxAttempts){
+            std::cout << "Could not start a worker " << startFailures << " times in a row, giving up\n";
+            break;
+        }
+
+        const double now = Clock::Now();
+        if(now - lastReport >= 1.0){
+            std::printf("  %zu / %zu shards done, %zu baking, %zu failed, %zu workers, %.1f chunks/s\n", counts.done, shards.size(),
+                        counts.claimed, counts.failed, workers.size(), counts.done * chunkCount / static_cast<double>(shards.size()) / (now - start));
+            std::fflush(stdout);
+            lastReport = now;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    // Only left after giving up
+    for(int worker : workers){
+        kill(worker, SIGTERM);
+        waitpid(worker, nullptr, 0);
+        queue.Requeue(GetWorkerName(worker), MaxAttempts);
+    }
+
+    const std::vector<std::pair<Shard, std::string>> done = queue.GetDone();
+    const ShardQueue::Counts counts = queue.GetCounts();
+    const bool written = WriteManifest(done);
+    const double seconds = Clock::Now() - start;
+    std::size_t doneChunks = 0;
+    for(const std::pair<Shard, std::string>& shard : done){
+        doneChunks += static_cast<std::size_t>(shard.first.chunksX) * shard.first.chunksZ;
+    }
+    std::printf("Baked %zu / %zu shards (%zu chunks) in %.2f s, %.1f chunks/s\n", done.size(), shards.size(), doneChunks, seconds,
+                doneChunks / std::max(seconds, 1.0e-9));
+    std::printf("  %zu workers died, %zu shards retried, %zu failed every attempt\n", deaths, requeued, counts.failed);
+    return written && done.size() == shards.size();
+#else
+    (void)executable;
+    (void)workerArguments;
+    std::cout << "Baking with worker processes needs POSIX, use --bake without --bake-workers\n";
+    return false;
+#endif
+}
+
+int BakeCoordinator::StartWorker(const std::string& executable, const std::vector<std::string>& arguments) const{
+#if defined(BAKE_PROCESSES)
+    // Built before the fork, the child only execs
+    std::vector<char*> argv;
+    argv.push_back(const_cast<char*>(executable.c_str()));
+    for(const std::string& argument : arguments){
+        argv.push_back(const_cast<char*>(argument.c_str()));
+    }
+    argv.push_back(nullptr);
+    std::fflush(stdout);
+    std::cout.flush();
+    const pid_t child = fork();
+    if(child == 0){
+        execv(executable.c_str(), argv.data());
+        _exit(127);
+    }
+    return child;
+#else
+    (void)executable;
+    (void)arguments;
+    return -1;
+#endif
+}
+
+bool BakeCoordinator::WriteManifest(const std::vector<std::pair<Shard, std::string>>& done) const{
+    std::ofstream file(std::filesystem::path(m_settings.outputDirectory) / "manifest.txt");
+    file << "chunk_size " << m_settings.chunkSize << "\n"
+         << "chunks_x " << m_settings.chunksX << "\n"
+         << "chunks_z " << m_settings.chunksZ << "\n"
+         << "origin_x " << m_settings.originX << "\n"
+         << "origin_z " << m_settings.originZ << "\n"
+         << "shard_size " << m_shardSize << "\n"
+         << "shards " << done.size() << "\n"
+         << "# each shard directory is a region of its own, see its region.txt\n"
+         << "# shard index origin_x origin_z chunks_x chunks_z directory retries | worker seconds chunks_per_second peak_rss_mb\n";
+    for(const std::pair<Shard, std::string>& entry : done){
+        const Shard& shard = entry.first;
+        char name[32];
+        std::snprintf(name, sizeof(name), "shards/shard_%06u", shard.index);
+        file << "shard " << shard.index << " " << shard.originX << " " << shard.originZ << " " << shard.chunksX << " " << shard.chunksZ
+             << " " << name << " " << shard.attempts << " | " << entry.second << "\n";
+    }
+    return file.good();
+}
+
+bool BakeCoordinator::RunWorker(const std::string& directory, JobScheduler& scheduler, const NoiseContext& noise,
+                                const TerrainRamp& ramp){
+#if defined(BAKE_PROCESSES)
+    const std::string worker = GetWorkerName(getpid());
+#else
+    const std::string worker = GetWorkerName(0);
+#endif
+    ShardQueue queue((std::filesystem::path(directory) / "queue").string());
+    RegionBaker baker(scheduler, noise, ramp);
+    Shard shard;
+    while(queue.Claim(worker, shard)){
+        BakeSettings settings;
+        settings.chunksX = shard.chunksX;
+        settings.chunksZ = shard.chunksZ;
+        settings.chunkSize = shard.chunkSize;
+        settings.originX = shard.originX;
+        settings.originZ = shard.originZ;
+        char name[32];
+        std::snprintf(name, sizeof(name), "shard_%06u", shard.index);
+        settings.outputDirectory = (std::filesystem::path(directory) / "shards" / name).string();
+        settings.reportProgress = false;
+
+        RegionBaker::Stats stats;
+        if(!baker.Bake(settings, stats)){
+            // Leaves the claim for the coordinator to put back
+            return false;
+        }
+        std::ostringstream result;
+        result << worker << " " << stats.seconds << " " << stats.chunks / std::max(stats.seconds, 1.0e-9) << " "
+               << stats.peakResidentBytes / (1024.0 * 1024.0);
+        if(!queue.Complete(shard, worker, result.str())){
+            return false;
+        }
+        std::printf("  worker %s: shard %u, %zu chunks in %.2f s\n", worker.c_str(), shard.index, stats.chunks, stats.seconds);
+        std::fflush(stdout);
+    }
+    return true;
+}
@@ -0,0 +1,2165 @@
+#include "Benchmark.hpp"
+#include "Clock.hpp"
+#include "NoiseContext.hpp"
+#include "FractalKernel.hpp"
+#include "OctaveCache.hpp"
+#include "OctaveSampler.hpp"
+#include "WorleyNoise.hpp"
+#include "NoiseGraph.hpp"
+#include "TerrainRamp.hpp"
+#include "TerrainBuilder.hpp"
+#include "ThreadPool.hpp"
+#include "ChunkStreamer.hpp"
+#include "StagingRing.hpp"
+#include "SnapshotBuffer.hpp"
+#include "SpscQueue.hpp"
+#include "Task.hpp"
+#include "StartupTimeline.hpp"
+#include "Image.hpp"
+#include "GridIndices.hpp"
+#include "Clipmap.hpp"
+#include "RegionBaker.hpp"
+#include "BakeCoordinator.hpp"
+#include "Geometry.hpp"
+#include "glm/glm.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+// Prints one timing line
+static void Report(const char* name, double seconds, unsigned int samples){
+    std::cout << "  " << name << ": " << seconds * 1000.0 << " ms ("
+              << (samples / seconds) / 1.0e6 << " Msamples/s)\n";
+}
+
+// The loop Terrain::LayerPerlinNoise used before FractalLayers.
+// Every layer calls octave2D_01, which re-evaluates all lower octaves.
+static float ReferenceLayerNoise(const siv::PerlinNoise& perlin, const NoiseSettings& settings,
+                                 float x, float z, unsigned int chunkSize){
+    float result = 0;
+    float persistence = settings.persistence;
+    float amplitude = settings.amplitude;
+    float frequency = settings.frequency;
+    float noiseWeight = amplitude;
+
+    for (int i = (settings.startOctave - 1); i < settings.numOctaves; ++i){
+        float sampleX = x * (frequency / chunkSize);
+        float sampleY = z * (frequency / chunkSize);
+
+        result += amplitude * perlin.octave2D_01(sampleX, sampleY, (i + 1), persistence);
+
+        if (i == settings.numOctaves - 1){
+           break;
+        }
+
+        persistence += settings.persistenceStep;
+        frequency *= 2.0f;
+        amplitude *= settings.gain;
+        noiseWeight += amplitude;
+    }
+
+    return result/noiseWeight;
+}
+
+void Benchmark::LayeredOctaveNoise(unsigned int chunkSize){
+    NoiseContext noise;
+    const NoiseSettings& settings = noise.GetSettings();
+    const siv::PerlinNoise& perlin = noise.GetPerlin();
+    const unsigned int samples = chunkSize*chunkSize;
+
+    std::cout << "Layered octave noise, " << chunkSize << "x" << chunkSize << " chunk\n";
+
+    std::vector<float> reference(samples);
+    double start = Clock::Now();
+    for(unsigned int z = 0; z < chunkSize; ++z){
+        for(unsigned int x = 0; x < chunkSize; ++x){
+            reference[x+z*chunkSize] = ReferenceLayerNoise(perlin, settings, (float) x, (float) z, chunkSize);
+        }
+    }
+    double referenceTime = Clock::Now() - start;
+
+    // Same schedule Terrain::BuildFractalLayers makes
+    siv::FractalLayers layers(settings.startOctave);
+    float persistence = settings.persistence;
+    float amplitude = settings.amplitude;
+    for (int i = (settings.startOctave - 1); i < settings.numOctaves; ++i){
+        layers.addLayer(amplitude, persistence);
+        persistence += settings.persistenceStep;
+        amplitude *= settings.gain;
+    }
+
+    std::vector<float> layered(samples);
+    start = Clock::Now();
+    for(unsigned int z = 0; z < chunkSize; ++z){
+        for(unsigned int x = 0; x < chunkSize; ++x){
+            float sampleX = x * (settings.frequency / chunkSize);
+            float sampleY = z * (settings.frequency / chunkSize);
+            layered[x+z*chunkSize] = perlin.layeredOctave2D_01(sampleX, sampleY, layers);
+        }
+    }
+    double layeredTime = Clock::Now() - start;
+
+    float maxError = 0.0f;
+    unsigned int mismatches = 0;
+    for(unsigned int i = 0; i < samples; ++i){
+        float error = std::fabs(reference[i] - layered[i]);
+        maxError = std::max(maxError, error);
+        if(error != 0.0f){
+            ++mismatches;
+        }
+    }
+
+    // Layer i used to cost i + 1 noise2D calls
+    int referenceCalls = 0;
+    for (int i = (settings.startOctave - 1); i < settings.numOctaves; ++i){
+        referenceCalls += i + 1;
+    }
+
+    Report("octave2D_01 per layer", referenceTime, samples);
+    Report("FractalLayers        ", layeredTime, samples);
+    std::cout << "  noise2D calls per sample: " << layers.sampleCount() << " instead of " << referenceCalls << "\n";
+    std::cout << "  speedup: " << referenceTime / layeredTime << "x\n";
+    std::cout << "  max difference: " << maxError << " (" << mismatches << " of " << samples << " samples differ)\n";
+}
+
+void Benchmark::Noise2DKernel(unsigned int chunkSize){
+    NoiseContext noise;
+    const siv::PerlinNoise& perlin = noise.GetPerlin();
+    const unsigned int samples = chunkSize*chunkSize;
+    // The octaves Terrain samples most often
+    const int octaves = 11;
+    const double frequency = 4.0 / chunkSize;
+
+    std::cout << "noise2D kernel, " << chunkSize << "x" << chunkSize << " chunk, " << octaves << " octaves\n";
+
+    // Sum into a value we print, so the loops can not be optimized out
+    double checksum3D = 0.0;
+    double start = Clock::Now();
+    for(unsigned int z = 0; z < chunkSize; ++z){
+        for(unsigned int x = 0; x < chunkSize; ++x){
+            double scale = frequency;
+            for(int i = 0; i < octaves; ++i){
+                checksum3D += perlin.noise3D(x * scale, z * scale, SIVPERLIN_DEFAULT_Z);
+                scale *= 2.0;
+            }
+        }
+    }
+    double time3D = Clock::Now() - start;
+
+    double checksum2D = 0.0;
+    start = Clock::Now();
+    for(unsigned int z = 0; z < chunkSize; ++z){
+        for(unsigned int x = 0; x < chunkSize; ++x){
+            double scale = frequency;
+            for(int i = 0; i < octaves; ++i){
+                checksum2D += perlin.noise2D(x * scale, z * scale);
+                scale *= 2.0;
+            }
+        }
+    }
+    double time2D = Clock::Now() - start;
+
+    Report("noise3D slice ", time3D, samples*octaves);
+    Report("native noise2D", time2D, samples*octaves);
+    std::cout << "  speedup: " << time3D / time2D << "x (checksums " << checksum3D << ", " << checksum2D << ")\n";
+}
+
+bool Benchmark::BatchNoise(unsigned int chunkSize, float tolerance){
+    NoiseContext noise;
+    const siv::PerlinNoise& perlin = noise.GetPerlin();
+    const unsigned int samples = chunkSize*chunkSize;
+    const int octaves = 11;
+    const float scale = 4.0f / chunkSize;
+    // A chunk away from the origin, so negative coordinates are covered too
+    const float offset = -1.5f * chunkSize;
+    bool passed = true;
+
+    std::cout << "PerlinNoiseBatch, " << chunkSize << "x" << chunkSize << " chunk, " << octaves << " octaves, best kernel: "
+              << PerlinNoiseBatch::GetKernelName(PerlinNoiseBatch::GetBestKernel()) << "\n";
+
+    // The double precision scalar reference, on the same float sample points
+    std::vector<float> reference(samples*octaves);
+    double start = Clock::Now();
+    for(int i = 0; i < octaves; ++i){
+        const float octaveScale = scale * (float)(1 << i);
+        for(unsigned int z = 0; z < chunkSize; ++z){
+            const float y = (z + offset) * octaveScale;
+            for(unsigned int x = 0; x < chunkSize; ++x){
+                reference[(i*chunkSize + z)*chunkSize + x] = (float)perlin.noise2D((x + offset) * octaveScale, y);
+            }
+        }
+    }
+    Report("noise2D (double)  ", Clock::Now() - start, samples*octaves);
+
+    std::vector<float> rows(samples*octaves);
+    std::vector<float> points(samples);
+    std::vector<float> xs(samples), ys(samples);
+    std::vector<float> gradientX(samples), gradientY(samples);
+    for(unsigned int z = 0; z < chunkSize; ++z){
+        for(unsigned int x = 0; x < chunkSize; ++x){
+            xs[z*chunkSize + x] = (x + offset) * scale * 7.0f;
+            ys[z*chunkSize + x] = (z + offset) * scale * 3.0f;
+        }
+    }
+
+    for(int k = PerlinNoiseBatch::Scalar; k <= PerlinNoiseBatch::AVX512; ++k){
+        PerlinNoiseBatch::Kernel kernel = (PerlinNoiseBatch::Kernel)k;
+        if(!PerlinNoiseBatch::IsSupported(kernel)){
+            std::cout << "  " << PerlinNoiseBatch::GetKernelName(kernel) << ": not supported\n";
+            continue;
+        }
+        PerlinNoiseBatch batch(perlin, kernel);
+
+        start = Clock::Now();
+        for(int i = 0; i < octaves; ++i){
+            const float octaveScale = scale * (float)(1 << i);
+            for(unsigned int z = 0; z < chunkSize; ++z){
+                batch.Noise2DRow(offset, octaveScale, (z + offset) * octaveScale, chunkSize, &rows[(i*chunkSize + z)*chunkSize]);
+            }
+        }
+        double rowTime = Clock::Now() - start;
+
+        batch.Noise2DPoints(xs.data(), ys.data(), samples, points.data());
+
+        // The value and derivatives of the first octave
+        start = Clock::Now();
+        for(unsigned int z = 0; z < chunkSize; ++z){
+            const std::size_t row = static_cast<std::size_t>(z)*chunkSize;
+            batch.Noise2DRowGradient(offset, scale, (z + offset) * scale, chunkSize, &points[row], &gradientX[row], &gradientY[row]);
+        }
+        const double gradientTime = Clock::Now() - start;
+        float maxGradientError = 0.0f;
+        for(unsigned int z = 0; z < chunkSize; ++z){
+            for(unsigned int x = 0; x < chunkSize; ++x){
+                const std::size_t i = static_cast<std::size_t>(z)*chunkSize + x;
+                const auto expected = perlin.noise2DGradient((x + offset) * scale, (z + offset) * scale);
+                maxGradientError = std::max({ maxGradientError, std::fabs(points[i] - reference[i]),
+                                              std::fabs(gradientX[i] - (float)expected.dx), std::fabs(gradientY[i] - (float)expected.dy) });
+            }
+        }
+        batch.Noise2DPoints(xs.data(), ys.data(), samples, points.data());
+
+        float maxError = 0.0f;
+        for(unsigned int i = 0; i < samples*octaves; ++i){
+            maxError = std::max(maxError, std::fabs(rows[i] - reference[i]));
+        }
+        for(unsigned int i = 0; i < samples; ++i){
+            maxError = std::max(maxError, std::fabs(points[i] - (float)perlin.noise2D(xs[i], ys[i])));
+        }
+
+        std::string name = std::string(PerlinNoiseBatch::GetKernelName(kernel));
+        name.resize(18, ' ');
+        Report(name.c_str(), rowTime, samples*octaves);
+        std::cout << "    max error " << maxError << (maxError <= tolerance ? " (ok)\n" : " (FAILED)\n");
+        name = "  with gradient";
+        name.resize(18, ' ');
+        Report(name.c_str(), gradientTime, samples);
+        // The derivatives reach a few units, so they are allowed a few times the value's error
+        std::cout << "    max error " << maxGradientError << (maxGradientError <= 8.0f * tolerance ? " (ok)\n" : " (FAILED)\n");
+        passed = passed && (maxError <= tolerance) && (maxGradientError <= 8.0f * tolerance);
+    }
+
+    return passed;
+}
+
+void Benchmark::NoiseBackends(unsigned int chunkSize){
+    const unsigned int samples = chunkSize*chunkSize;
+
+    std::cout << "Noise backends, " << chunkSize << "x" << chunkSize << " chunk\n";
+
+    for(int b = 0; b < static_cast<int>(NoiseBackend::Count); ++b){
+        NoiseSettings settings;
+        settings.backend = static_cast<NoiseBackend>(b);
+        NoiseContext noise(settings);
+        const NoiseSource& source = noise.GetSource();
+
+        // The same layer schedule Terrain::GenerateNoiseMap builds
+        siv::BasicFractalLayers<float> layers(settings.startOctave);
+        float persistence = settings.persistence;
+        float amplitude = settings.amplitude;
+        for (int i = (settings.startOctave - 1); i < settings.numOctaves; ++i){
+            layers.addLayer(amplitude, persistence);
+            persistence += settings.persistenceStep;
+            amplitude *= settings.gain;
+        }
+
+        const int octaveCount = layers.sampleCount();
+        std::vector<float> octaveRows(octaveCount*chunkSize);
+        std::vector<const float*> rows(octaveCount);
+        for(int i = 0; i < octaveCount; ++i){
+            rows[i] = &octaveRows[i*chunkSize];
+        }
+        std::vector<float> height(samples);
+        const float scale = settings.frequency / chunkSize;
+
+        double start = Clock::Now();
+        for(unsigned int z = 0; z < chunkSize; ++z){
+            float sampleY = z * scale;
+            float octaveScale = scale;
+            for(int i = 0; i < octaveCount; ++i){
+                source.Noise2DRow(0.0f, octaveScale, sampleY, chunkSize, &octaveRows[i*chunkSize]);
+                sampleY *= 2.0f;
+                octaveScale *= 2.0f;
+            }
+            layers.blendRows(rows.data(), chunkSize, &height[z*chunkSize]);
+        }
+        double seconds = Clock::Now() - start;
+
+        // Spread of the finished heights
+        double mean = 0.0, squares = 0.0;
+        float lowest = height[0], highest = height[0];
+        for(unsigned int i = 0; i < samples; ++i){
+            mean += height[i];
+            squares += (double)height[i] * height[i];
+            lowest = std::min(lowest, height[i]);
+            highest = std::max(highest, height[i]);
+        }
+        mean /= samples;
+        const double deviation = std::sqrt(std::max(0.0, squares / samples - mean * mean));
+
+        // Directional artifacts: how much the raw noise changes over a short step
+        // along the axes, against the same length step along the diagonals.
+        // An isotropic noise gives a ratio of 1.
+        const float step = 0.5f;
+        const float diagonal = step * 0.70710678f;
+        std::vector<float> xs(samples), ys(samples), base(samples), moved(samples);
+        for(unsigned int i = 0; i < samples; ++i){
+            xs[i] = (i % chunkSize) * 0.37f;
+            ys[i] = (i / chunkSize) * 0.37f;
+        }
+        source.Noise2DPoints(xs.data(), ys.data(), samples, base.data());
+        const float offsets[4][2] = { {step, 0.0f}, {0.0f, step}, {diagonal, diagonal}, {diagonal, -diagonal} };
+        double energy[4];
+        for(int d = 0; d < 4; ++d){
+            std::vector<float> mx(samples), my(samples);
+            for(unsigned int i = 0; i < samples; ++i){
+                mx[i] = xs[i] + offsets[d][0];
+                my[i] = ys[i] + offsets[d][1];
+            }
+            source.Noise2DPoints(mx.data(), my.data(), samples, moved.data());
+            energy[d] = 0.0;
+            for(unsigned int i = 0; i < samples; ++i){
+                energy[d] += (double)(moved[i] - base[i]) * (moved[i] - base[i]);
+            }
+        }
+
+        std::string name = NoiseSource::GetBackendName(settings.backend);
+        name.resize(8, ' ');
+        Report(name.c_str(), seconds, samples);
+        std::cout << "    " << octaveCount << " octaves per sample, height range [" << lowest << ", " << highest
+                  << "], mean " << mean << ", std dev " << deviation
+                  << ", axis/diagonal ratio " << (energy[0] + energy[1]) / (energy[2] + energy[3]) << "\n";
+    }
+}
+
+void Benchmark::FixedFractalKernel(unsigned int chunkSize){
+    NoiseContext noise;
+    const NoiseSettings& settings = noise.GetSettings();
+    const siv::PerlinNoise& perlin = noise.GetPerlin();
+    const unsigned int samples = chunkSize*chunkSize;
+
+    // Same schedules Terrain builds
+    siv::FractalLayers pointLayers(settings.startOctave);
+    siv::BasicFractalLayers<float> rowLayers(settings.startOctave);
+    float persistence = settings.persistence;
+    float amplitude = settings.amplitude;
+    for (int i = (settings.startOctave - 1); i < settings.numOctaves; ++i){
+        pointLayers.addLayer(amplitude, persistence);
+        rowLayers.addLayer(amplitude, persistence);
+        persistence += settings.persistenceStep;
+        amplitude *= settings.gain;
+    }
+
+    const FractalKernel* kernel = FindFractalKernel(rowLayers.layerCount(), rowLayers.startOctave());
+    std::cout << "Fixed fractal kernel, " << chunkSize << "x" << chunkSize << " chunk, "
+              << rowLayers.layerCount() << " layers from octave " << rowLayers.startOctave() << "\n";
+    if(kernel == nullptr){
+        std::cout << "  no kernel for this schedule, the generic loops are used\n";
+        return;
+    }
+
+    // Per point, the LayerPerlinNoise path
+    const float scale = settings.frequency / chunkSize;
+    std::vector<float> generic(samples), fixed(samples);
+    double start = Clock::Now();
+    for(unsigned int z = 0; z < chunkSize; ++z){
+        for(unsigned int x = 0; x < chunkSize; ++x){
+            generic[z*chunkSize + x] = (float)perlin.layeredOctave2D_01(x * scale, z * scale, pointLayers);
+        }
+    }
+    const double genericPoints = Clock::Now() - start;
+    start = Clock::Now();
+    for(unsigned int z = 0; z < chunkSize; ++z){
+        for(unsigned int x = 0; x < chunkSize; ++x){
+            fixed[z*chunkSize + x] = (float)kernel->layeredNoise(perlin, x * scale, z * scale, pointLayers);
+        }
+    }
+    const double fixedPoints = Clock::Now() - start;
+    unsigned int differ = 0;
+    for(unsigned int i = 0; i < samples; ++i){
+        differ += (generic[i] != fixed[i]) ? 1 : 0;
+    }
+    Report("layeredOctave2D_01  ", genericPoints, samples);
+    Report("FractalKernel point ", fixedPoints, samples);
+    std::cout << "    speedup " << genericPoints / fixedPoints << "x, " << differ << " samples differ\n";
+
+    // Per row, the GenerateNoiseMap path. The octave rows are sampled once up front
+    // so only the blend is timed.
+    const PerlinNoiseBatch& batch = noise.GetPerlinBatch();
+    const int octaveCount = kernel->sampleCount;
+    std::vector<float> octaveRows(octaveCount*samples);
+    std::vector<float*> writeRows(octaveCount);
+    std::vector<const float*> rows(octaveCount);
+    for(unsigned int z = 0; z < chunkSize; ++z){
+        for(int i = 0; i < octaveCount; ++i){
+            writeRows[i] = &octaveRows[(i*chunkSize + z)*chunkSize];
+        }
+        kernel->sampleRows(batch, 0.0f, scale, z * scale, chunkSize, writeRows.data());
+    }
+
+    start = Clock::Now();
+    for(unsigned int z = 0; z < chunkSize; ++z){
+        for(int i = 0; i < octaveCount; ++i){
+            rows[i] = &octaveRows[(i*chunkSize + z)*chunkSize];
+        }
+        rowLayers.blendRows(rows.data(), chunkSize, &generic[z*chunkSize]);
+    }
+    const double genericRows = Clock::Now() - start;
+    start = Clock::Now();
+    for(unsigned int z = 0; z < chunkSize; ++z){
+        for(int i = 0; i < octaveCount; ++i){
+            rows[i] = &octaveRows[(i*chunkSize + z)*chunkSize];
+        }
+        kernel->blendRows(rowLayers, rows.data(), chunkSize, &fixed[z*chunkSize]);
+    }
+    const double fixedRows = Clock::Now() - start;
+    differ = 0;
+    for(unsigned int i = 0; i < samples; ++i){
+        differ += (generic[i] != fixed[i]) ? 1 : 0;
+    }
+    Report("blendRows           ", genericRows, samples);
+    Report("FractalKernel rows  ", fixedRows, samples);
+    std::cout << "    speedup " << genericRows / fixedRows << "x, " << differ << " samples differ\n";
+}
+
+void Benchmark::NoiseGradient(unsigned int chunkSize){
+    const unsigned int samples = chunkSize*chunkSize;
+
+    std::cout << "Noise gradient, " << chunkSize << "x" << chunkSize << " chunk\n";
+
+    // Central differences of the single octave noise against the analytic derivatives
+    const float h = 1.0e-3f;
+    for(int b = 0; b < static_cast<int>(NoiseBackend::Count); ++b){
+        NoiseSettings settings;
+        settings.backend = static_cast<NoiseBackend>(b);
+        NoiseContext noise(settings);
+        const NoiseSource& source = noise.GetSource();
+
+        double worst = 0.0;
+        unsigned int outliers = 0;
+        for(unsigned int i = 0; i < 10000; ++i){
+            const float x = (i % 100) * 0.173f - 7.3f;
+            const float y = (i / 100) * 0.191f - 9.1f;
+            float dx, dy;
+            source.Noise2DGradient(x, y, dx, dy);
+            const float fx = (source.Noise2D(x + h, y) - source.Noise2D(x - h, y)) / (2.0f * h);
+            const float fy = (source.Noise2D(x, y + h) - source.Noise2D(x, y - h)) / (2.0f * h);
+            const double difference = std::max(std::fabs(fx - dx), std::fabs(fy - dy));
+            worst = std::max(worst, difference);
+            // Worley has creases, where the two sides of a difference see different feature points
+            outliers += (difference > 0.01) ? 1 : 0;
+        }
+        std::cout << "  " << NoiseSource::GetBackendName(settings.backend)
+                  << ": max difference to central differences " << worst << " (" << outliers << " of 10000 above 0.01)\n";
+    }
+
+    // The same for the layered noise, summed in double so the differences are not just float rounding
+    NoiseContext noise;
+    const NoiseSettings& settings = noise.GetSettings();
+    const siv::PerlinNoise& perlin = noise.GetPerlin();
+    siv::BasicFractalLayers<double> pointLayers(settings.startOctave);
+    siv::BasicFractalLayers<float> rowLayers(settings.startOctave);
+    float persistence = settings.persistence;
+    float amplitude = settings.amplitude;
+    for (int i = (settings.startOctave - 1); i < settings.numOctaves; ++i){
+        pointLayers.addLayer(amplitude, persistence);
+        rowLayers.addLayer(amplitude, persistence);
+        persistence += settings.persistenceStep;
+        amplitude *= settings.gain;
+    }
+    double worst = 0.0;
+    const double dh = 1.0e-6;
+    for(unsigned int i = 0; i < 10000; ++i){
+        const double x = (i % 100) * 0.0173;
+        const double y = (i / 100) * 0.0191;
+        const siv::NoiseGradient2D g = perlin.layeredOctave2DGradient_01(x, y, pointLayers);
+        const double fx = (perlin.layeredOctave2D_01(x + dh, y, pointLayers) - perlin.layeredOctave2D_01(x - dh, y, pointLayers)) / (2.0 * dh);
+        const double fy = (perlin.layeredOctave2D_01(x, y + dh, pointLayers) - perlin.layeredOctave2D_01(x, y - dh, pointLayers)) / (2.0 * dh);
+        // Relative to the size of the gradient, the top octaves are steep
+        worst = std::max(worst, std::max(std::fabs(fx - g.dx), std::fabs(fy - g.dy)) / (1.0 + std::fabs(fx) + std::fabs(fy)));
+    }
+    std::cout << "  layeredOctave2DGradient_01: max relative difference to central differences " << worst << "\n";
+
+    // Cost of a chunk, value only against value and gradient
+    const FractalKernel* kernel = FindFractalKernel(rowLayers.layerCount(), rowLayers.startOctave());
+    if(kernel == nullptr){
+        return;
+    }
+    const NoiseSource& source = noise.GetSource();
+    const int octaveCount = kernel->sampleCount;
+    std::vector<float> octaveRows(3*octaveCount*chunkSize);
+    std::vector<float*> writeRows(3*octaveCount);
+    for(int i = 0; i < 3*octaveCount; ++i){
+        writeRows[i] = &octaveRows[i*chunkSize];
+    }
+    std::vector<const float*> rows(writeRows.begin(), writeRows.end());
+    std::vector<float> height(samples), heightDx(samples), heightDz(samples);
+    const float scale = settings.frequency / chunkSize;
+
+    double start = Clock::Now();
+    for(unsigned int z = 0; z < chunkSize; ++z){
+        kernel->sampleRows(source, 0.0f, scale, z * scale, chunkSize, writeRows.data());
+        kernel->blendRows(rowLayers, rows.data(), chunkSize, &height[z*chunkSize]);
+    }
+    const double valueOnly = Clock::Now() - start;
+
+    std::vector<float> gradientHeight(samples);
+    start = Clock::Now();
+    for(unsigned int z = 0; z < chunkSize; ++z){
+        kernel->sampleRowsGradient(source, 0.0f, scale, z * scale, chunkSize,
+                                   writeRows.data(), writeRows.data() + octaveCount, writeRows.data() + 2*octaveCount);
+        kernel->blendRowsGradient(rowLayers, rows.data(), rows.data() + octaveCount, rows.data() + 2*octaveCount,
+                                  chunkSize, &gradientHeight[z*chunkSize], &heightDx[z*chunkSize], &heightDz[z*chunkSize]);
+    }
+    const double withGradient = Clock::Now() - start;
+
+    unsigned int differ = 0;
+    for(unsigned int i = 0; i < samples; ++i){
+        differ += (height[i] != gradientHeight[i]) ? 1 : 0;
+    }
+    Report("value            ", valueOnly, samples);
+    Report("value + gradient ", withGradient, samples);
+    std::cout << "    gradient costs " << (withGradient / valueOnly - 1.0) * 100.0 << "% extra, "
+              << differ << " heights differ from the value only path\n";
+}
+
+void Benchmark::OctaveReblend(unsigned int chunkSize){
+    const unsigned int samples = chunkSize*chunkSize;
+
+    std::cout << "Octave cache, " << chunkSize << "x" << chunkSize << " chunk\n";
+
+    NoiseContext noise;
+    const NoiseSettings& settings = noise.GetSettings();
+    siv::BasicFractalLayers<float> layers(settings.startOctave);
+    siv::BasicFractalLayers<float> tunedLayers(settings.startOctave);
+    float persistence = settings.persistence;
+    float amplitude = settings.amplitude;
+    for (int i = (settings.startOctave - 1); i < settings.numOctaves; ++i){
+        layers.addLayer(amplitude, persistence);
+        // What a slider drag on persistence would ask for
+        tunedLayers.addLayer(amplitude, persistence + 0.1f);
+        persistence += settings.persistenceStep;
+        amplitude *= settings.gain;
+    }
+    const FractalKernel* kernel = FindFractalKernel(layers.layerCount(), layers.startOctave());
+    if(kernel == nullptr){
+        return;
+    }
+    const NoiseSource& source = noise.GetSource();
+    const int octaveCount = kernel->sampleCount;
+    const float scale = settings.frequency / chunkSize;
+
+    std::vector<float*> writeRows(3*octaveCount);
+    std::vector<const float*> rows(3*octaveCount);
+    std::vector<float> height(samples), heightDx(samples), heightDz(samples);
+
+    // Re-sample: what every tweak cost without the cache, sampled straight into the planes
+    OctavePlanes planes(octaveCount, chunkSize);
+    double start = Clock::Now();
+    for(unsigned int z = 0; z < chunkSize; ++z){
+        for(int i = 0; i < octaveCount; ++i){
+            writeRows[i] = planes.Value(i) + z*chunkSize;
+            writeRows[octaveCount + i] = planes.Dx(i) + z*chunkSize;
+            writeRows[2*octaveCount + i] = planes.Dy(i) + z*chunkSize;
+            rows[i] = writeRows[i];
+            rows[octaveCount + i] = writeRows[octaveCount + i];
+            rows[2*octaveCount + i] = writeRows[2*octaveCount + i];
+        }
+        kernel->sampleRowsGradient(source, 0.0f, scale, z * scale, chunkSize,
+                                   writeRows.data(), writeRows.data() + octaveCount, writeRows.data() + 2*octaveCount);
+        kernel->blendRowsGradient(tunedLayers, rows.data(), rows.data() + octaveCount, rows.data() + 2*octaveCount,
+                                  chunkSize, &height[z*chunkSize], &heightDx[z*chunkSize], &heightDz[z*chunkSize]);
+    }
+    const double resample = Clock::Now() - start;
+
+    // Re-blend: the same result from the cached planes
+    std::vector<float> reblended(samples), reblendedDx(samples), reblendedDz(samples);
+    start = Clock::Now();
+    for(unsigned int z = 0; z < chunkSize; ++z){
+        for(int i = 0; i < octaveCount; ++i){
+            rows[i] = planes.Value(i) + z*chunkSize;
+            rows[octaveCount + i] = planes.Dx(i) + z*chunkSize;
+            rows[2*octaveCount + i] = planes.Dy(i) + z*chunkSize;
+        }
+        kernel->blendRowsGradient(tunedLayers, rows.data(), rows.data() + octaveCount, rows.data() + 2*octaveCount,
+                                  chunkSize, &reblended[z*chunkSize], &reblendedDx[z*chunkSize], &reblendedDz[z*chunkSize]);
+    }
+    const double reblend = Clock::Now() - start;
+
+    unsigned int differ = 0;
+    for(unsigned int i = 0; i < samples; ++i){
+        differ += (height[i] != reblended[i] || heightDx[i] != reblendedDx[i] || heightDz[i] != reblendedDz[i]) ? 1 : 0;
+    }
+    Report("re-sample + blend", resample, samples);
+    Report("re-blend cached  ", reblend, samples);
+    std::cout << "    re-blend is " << resample / reblend << "x faster, " << differ << " samples differ, "
+              << planes.GetBytes() / (1024.0 * 1024.0) << " MB of planes per chunk\n";
+
+    // Least recently used eviction under a budget of two chunks
+    OctaveCache cache(2 * planes.GetBytes());
+    for(int i = 0; i < 3; ++i){
+        cache.Insert(OctaveCache::MakeKey(settings, settings.frequency, chunkSize, static_cast<float>(i), 0.0f, octaveCount),
+                     std::make_shared<OctavePlanes>(octaveCount, chunkSize));
+    }
+    const bool firstEvicted = cache.Find(OctaveCache::MakeKey(settings, settings.frequency, chunkSize, 0.0f, 0.0f, octaveCount)) == nullptr;
+    const bool lastKept = cache.Find(OctaveCache::MakeKey(settings, settings.frequency, chunkSize, 2.0f, 0.0f, octaveCount)) != nullptr;
+    std::cout << "    budget of 2 chunks after 3 inserts: " << cache.GetEntryCount() << " cached, oldest "
+              << (firstEvicted ? "evicted" : "kept") << ", newest " << (lastKept ? "kept" : "evicted") << "\n";
+}
+
+void Benchmark::MultiresSampling(unsigned int chunkSize){
+    const unsigned int samples = chunkSize*chunkSize;
+
+    std::cout << "Multiresolution octaves, " << chunkSize << "x" << chunkSize << " chunk\n";
+
+    // The curvature constants the strides are picked with, against the measured bilinear error
+    for(int b = 0; b < static_cast<int>(NoiseBackend::Count); ++b){
+        NoiseSettings settings;
+        settings.backend = static_cast<NoiseBackend>(b);
+        NoiseContext noise(settings);
+        const NoiseSource& source = noise.GetSource();
+        double worst = 0.0;
+        for(float h = 0.5f; h >= 0.0625f; h *= 0.5f){
+            for(unsigned int i = 0; i < 20000; ++i){
+                const float x0 = std::floor((i % 200) * 0.37f / h) * h;
+                const float y0 = std::floor((i / 200) * 0.41f / h) * h;
+                const float tx = ((i * 7) % 13) / 13.0f;
+                const float ty = ((i * 5) % 11) / 11.0f;
+                const float top = source.Noise2D(x0, y0) * (1.0f - tx) + source.Noise2D(x0 + h, y0) * tx;
+                const float bottom = source.Noise2D(x0, y0 + h) * (1.0f - tx) + source.Noise2D(x0 + h, y0 + h) * tx;
+                const float error = std::fabs(top * (1.0f - ty) + bottom * ty - source.Noise2D(x0 + tx * h, y0 + ty * h));
+                worst = std::max(worst, static_cast<double>(error) / (h * h));
+            }
+        }
+        std::cout << "  " << NoiseSource::GetBackendName(settings.backend) << ": bilinear error " << worst
+                  << " * h^2 measured, " << GetInterpolationErrorScale(settings.backend) << " * h^2 assumed\n";
+    }
+
+    NoiseContext noise;
+    const NoiseSettings& settings = noise.GetSettings();
+    siv::BasicFractalLayers<float> layers(settings.startOctave);
+    float persistence = settings.persistence;
+    float amplitude = settings.amplitude;
+    for (int i = (settings.startOctave - 1); i < settings.numOctaves; ++i){
+        layers.addLayer(amplitude, persistence);
+        persistence += settings.persistenceStep;
+        amplitude *= settings.gain;
+    }
+    const FractalKernel* kernel = FindFractalKernel(layers.layerCount(), layers.startOctave());
+    if(kernel == nullptr){
+        return;
+    }
+    const NoiseSource& source = noise.GetSource();
+    const int octaveCount = kernel->sampleCount;
+    const float scale = settings.frequency / chunkSize;
+    // Away from the origin, like the chunks around it
+    const float xOffset = static_cast<float>(chunkSize);
+    const float zOffset = -static_cast<float>(chunkSize);
+
+    // Samples and blends a chunk a row at a time, returns the time and noise evaluations it took
+    std::vector<float> octaveRows(3*octaveCount*chunkSize);
+    std::vector<float*> writeRows(3*octaveCount);
+    for(int i = 0; i < 3*octaveCount; ++i){
+        writeRows[i] = &octaveRows[i*chunkSize];
+    }
+    std::vector<const float*> rows(writeRows.begin(), writeRows.end());
+    // The differences are small, so the best of a few runs is reported
+    auto generate = [&](float tolerance, std::vector<float>& height, std::vector<float>& dx, std::vector<float>& dz,
+                        std::size_t& evaluations, std::vector<unsigned int>& strides){
+        double best = 0.0;
+        for(int run = 0; run < 5; ++run){
+            const double start = Clock::Now();
+            strides = ChooseOctaveStrides(layers, settings.backend, scale, tolerance, chunkSize);
+            OctaveRowSampler sampler(source, xOffset, zOffset, scale, strides, chunkSize);
+            for(unsigned int z = 0; z < chunkSize; ++z){
+                if(tolerance > 0.0f){
+                    sampler.SampleRow(z, writeRows.data(), writeRows.data() + octaveCount, writeRows.data() + 2*octaveCount);
+                }else{
+                    // The plain path GenerateNoiseMap() takes
+                    kernel->sampleRowsGradient(source, xOffset, scale, (z + zOffset) * scale, chunkSize,
+                                               writeRows.data(), writeRows.data() + octaveCount, writeRows.data() + 2*octaveCount);
+                }
+                kernel->blendRowsGradient(layers, rows.data(), rows.data() + octaveCount, rows.data() + 2*octaveCount,
+                                          chunkSize, &height[z*chunkSize], &dx[z*chunkSize], &dz[z*chunkSize]);
+            }
+            evaluations = tolerance > 0.0f ? sampler.GetEvaluations() : static_cast<std::size_t>(octaveCount) * samples;
+            const double time = Clock::Now() - start;
+            best = (run == 0) ? time : std::min(best, time);
+        }
+        return best;
+    };
+
+    std::vector<float> exact(samples), exactDx(samples), exactDz(samples);
+    std::vector<unsigned int> strides;
+    std::size_t exactEvaluations = 0;
+    const double exactTime = generate(0.0f, exact, exactDx, exactDz, exactEvaluations, strides);
+    Report("every vertex     ", exactTime, samples);
+
+    // Error against time for a range of bounds. The gradient error is in height per vertex,
+    // the unit Terrain turns into normals (before the x100 height scale).
+    std::vector<float> height(samples), heightDx(samples), heightDz(samples);
+    for(float tolerance : { 1.0e-4f, 3.0e-4f, 1.0e-3f, 3.0e-3f, 1.0e-2f, 3.0e-2f, 1.0e-1f }){
+        std::size_t evaluations = 0;
+        const double time = generate(tolerance, height, heightDx, heightDz, evaluations, strides);
+        double worst = 0.0, worstSlope = 0.0;
+        for(unsigned int i = 0; i < samples; ++i){
+            worst = std::max(worst, static_cast<double>(std::fabs(height[i] - exact[i])));
+            worstSlope = std::max(worstSlope, static_cast<double>(scale * std::max(std::fabs(heightDx[i] - exactDx[i]), std::fabs(heightDz[i] - exactDz[i]))));
+        }
+        std::cout << "  tolerance " << tolerance << ": strides";
+        for(unsigned int stride : strides){
+            std::cout << " " << stride;
+        }
+        std::cout << "\n    " << time * 1000.0 << " ms (" << exactTime / time << "x), "
+                  << 100.0 * evaluations / exactEvaluations << "% of the noise evaluations, max height error "
+                  << worst << ", max slope error " << worstSlope << "\n";
+    }
+}
+
+bool Benchmark::WorleyKernels(unsigned int chunkSize, float tolerance){
+    const unsigned int samples = chunkSize*chunkSize;
+    const float scale = 16.0f / chunkSize;
+
+    std::cout << "Worley noise, " << chunkSize << "x" << chunkSize << " chunk, one octave\n";
+
+    // The Perlin row kernel on the same grid, for comparison
+    NoiseContext noise;
+    std::vector<float> out(samples), dx(samples), dy(samples), f2(samples);
+    double start = Clock::Now();
+    for(unsigned int z = 0; z < chunkSize; ++z){
+        noise.GetPerlinBatch().Noise2DRow(0.0f, scale, z * scale, chunkSize, &out[z*chunkSize]);
+    }
+    const double perlinSeconds = Clock::Now() - start;
+    Report("perlin (batch)            ", perlinSeconds, samples);
+
+    const WorleyNoise reference(123456u, PerlinNoiseBatch::Scalar);
+    bool passed = true;
+    for(int k = PerlinNoiseBatch::Scalar; k <= PerlinNoiseBatch::AVX512; ++k){
+        const PerlinNoiseBatch::Kernel kernel = static_cast<PerlinNoiseBatch::Kernel>(k);
+        if(kernel == PerlinNoiseBatch::SSE2 || !PerlinNoiseBatch::IsSupported(kernel)){
+            continue;
+        }
+        const WorleyNoise worley(123456u, kernel);
+
+        start = Clock::Now();
+        for(unsigned int z = 0; z < chunkSize; ++z){
+            worley.Noise2DRow(0.0f, scale, z * scale, chunkSize, &out[z*chunkSize]);
+        }
+        const double valueSeconds = Clock::Now() - start;
+
+        // Every kernel against the scalar single point path
+        float worst = 0.0f;
+        for(unsigned int i = 0; i < samples; i += 7){
+            const float x = static_cast<float>(i % chunkSize) * scale;
+            const float y = static_cast<float>(i / chunkSize) * scale;
+            worst = std::max(worst, std::fabs(out[i] - reference.Noise2D(x, y)));
+        }
+
+        start = Clock::Now();
+        for(unsigned int z = 0; z < chunkSize; ++z){
+            worley.Noise2DRowGradient(0.0f, scale, z * scale, chunkSize, &out[z*chunkSize], &dx[z*chunkSize], &dy[z*chunkSize]);
+        }
+        const double gradientSeconds = Clock::Now() - start;
+
+        start = Clock::Now();
+        for(unsigned int z = 0; z < chunkSize; ++z){
+            worley.Cellular2DRow(0.0f, scale, z * scale, chunkSize, &out[z*chunkSize], &f2[z*chunkSize]);
+        }
+        const double cellularSeconds = Clock::Now() - start;
+
+        std::string name = std::string("worley ") + PerlinNoiseBatch::GetKernelName(kernel);
+        name.resize(26, ' ');
+        Report(name.c_str(), valueSeconds, samples);
+        std::string gradientName = "  + gradient";
+        gradientName.resize(26, ' ');
+        Report(gradientName.c_str(), gradientSeconds, samples);
+        std::string cellularName = "  F1 and F2";
+        cellularName.resize(26, ' ');
+        Report(cellularName.c_str(), cellularSeconds, samples);
+        std::cout << "    " << perlinSeconds / valueSeconds << "x the Perlin rate, max difference to scalar " << worst
+                  << (worst <= tolerance ? "" : "  FAILED") << "\n";
+        passed = passed && worst <= tolerance;
+    }
+
+    // F1 of a jittered grid stays below one cell diagonal, most of it below 1
+    float highest = 0.0f;
+    double mean = 0.0;
+    for(unsigned int i = 0; i < samples; ++i){
+        highest = std::max(highest, out[i]);
+        mean += out[i];
+    }
+    std::cout << "  F1 mean " << mean / samples << ", max " << highest << "\n";
+    return passed;
+}
+
+bool Benchmark::NoiseGraphFusion(unsigned int chunkSize){
+    const unsigned int samples = chunkSize*chunkSize;
+    const float frequency = 4.0f / chunkSize;
+
+    // Domain warped plains, ridged mountains where a low frequency mask is high,
+    // reshaped by a curve, and blended with terraced ridges by the same mask
+    NoiseGraph graph;
+    const NoiseGraph::Node base = graph.Fractal(NoiseBackend::Perlin, frequency, 6);
+    const NoiseGraph::Node ridged = graph.Ridged(NoiseBackend::Perlin, frequency * 0.5f, 5);
+    const NoiseGraph::Node mask = graph.Fractal(NoiseBackend::HashGradient, frequency * 0.25f, 3);
+    const NoiseGraph::Node warpX = graph.Fractal(NoiseBackend::Perlin, frequency, 2);
+    const NoiseGraph::Node warpY = graph.Fractal(NoiseBackend::HashGradient, frequency, 2);
+    const NoiseGraph::Node warped = graph.Warp(base, warpX, warpY, chunkSize / 16.0f);
+    const NoiseGraph::Node mountains = graph.Select(warped, ridged, mask, 0.1f, 0.2f);
+    const NoiseGraph::Node shaped = graph.Curve(mountains, { {-1.0f, -0.6f}, {0.0f, -0.1f}, {0.5f, 0.4f}, {1.0f, 1.0f} });
+    const NoiseGraph::Node steps = graph.Terrace(ridged, { -1.0f, -0.3f, 0.2f, 0.6f, 1.0f });
+    graph.Blend(shaped, steps, mask);
+    const CompiledNoiseGraph program(graph, NoiseContext());
+
+    std::cout << "Noise graph, " << chunkSize << "x" << chunkSize << " chunk, " << graph.GetModuleCount() << " modules, "
+              << program.GetInstructionCount() << " instructions, " << program.GetRegisterCount() << " tile registers ("
+              << program.GetRegisterCount() * CompiledNoiseGraph::TileSize * sizeof(float) / 1024 << " KB)\n";
+
+    std::vector<float> xs(samples), ys(samples);
+    for(unsigned int i = 0; i < samples; ++i){
+        xs[i] = static_cast<float>(i % chunkSize);
+        ys[i] = static_cast<float>(i / chunkSize);
+    }
+
+    // Best of a few runs, the sources dominate and timings are noisy
+    std::vector<float> fused(samples), grid(samples), separate(samples);
+    double fusedSeconds = 1.0e30, gridSeconds = 1.0e30, separateSeconds = 1.0e30;
+    for(int run = 0; run < 3; ++run){
+        double start = Clock::Now();
+        program.EvaluateNodeByNode(xs.data(), ys.data(), samples, separate.data());
+        separateSeconds = std::min(separateSeconds, Clock::Now() - start);
+
+        start = Clock::Now();
+        program.EvaluatePoints(xs.data(), ys.data(), samples, fused.data());
+        fusedSeconds = std::min(fusedSeconds, Clock::Now() - start);
+
+        start = Clock::Now();
+        program.EvaluateGrid(0.0f, 0.0f, 1.0f, chunkSize, chunkSize, grid.data());
+        gridSeconds = std::min(gridSeconds, Clock::Now() - start);
+    }
+    Report("node by node              ", separateSeconds, samples);
+    Report("fused tiles, points       ", fusedSeconds, samples);
+    Report("fused tiles, grid         ", gridSeconds, samples);
+
+    float worst = 0.0f;
+    for(unsigned int i = 0; i < samples; ++i){
+        worst = std::max(worst, std::max(std::fabs(fused[i] - separate[i]), std::fabs(grid[i] - separate[i])));
+    }
+    std::cout << "    " << separateSeconds / fusedSeconds << "x faster fused, node by node keeps "
+              << (program.GetInstructionCount() + 6) * samples * sizeof(float) / (1024 * 1024)
+              << " MB of buffers, max difference " << worst << (worst == 0.0f ? "" : "  FAILED") << "\n";
+
+    // Broken modules are turned away as they are added, and a broken graph compiles to 0
+    NoiseGraph broken;
+    const NoiseGraph::Node source = broken.Fractal(NoiseBackend::Perlin, frequency, 2);
+    bool rejected = broken.IsValid() && broken.Add(source, source + 1) == NoiseGraph::InvalidNode
+                    && broken.Curve(source, { {1.0f, 0.0f}, {-1.0f, 1.0f} }) == NoiseGraph::InvalidNode
+                    && broken.Terrace(source, {}) == NoiseGraph::InvalidNode
+                    && broken.Abs(NoiseGraph::InvalidNode) == NoiseGraph::InvalidNode
+                    && !broken.SetOutput(7) && broken.GetModuleCount() == 1 && !broken.IsValid();
+    float brokenValue = 1.0f;
+    CompiledNoiseGraph(broken, NoiseContext()).EvaluatePoints(xs.data(), ys.data(), 1, &brokenValue);
+    rejected = rejected && brokenValue == 0.0f;
+    std::cout << "    " << (graph.IsValid() ? "graph valid" : "graph invalid: " + graph.GetError() + "  FAILED") << ", "
+              << (rejected ? "broken modules rejected (" + broken.GetError() + ")" : "a broken module was accepted  FAILED") << "\n";
+    return worst == 0.0f && graph.IsValid() && rejected;
+}
+
+// The branchy transfer functions TerrainRamp replaced, for comparison
+static float ReferenceNoiseToHeight(float noiseval){
+    return noiseval <= 0.5f ? 50.0f : noiseval * 100.0f;
+}
+
+static void ReferenceNoiseToColor(float noiseval, std::uint8_t* rgb){
+    static const float stops[8] = { 0.0f, 0.0375f, 0.5f, 0.53125f, 0.5625f, 0.6875f, 0.875f, 1.0f };
+    static const float colors[8][3] = { {0, 0, 128}, {0, 0, 255}, {0, 128, 255}, {240, 240, 64},
+                                        {32, 160, 0}, {64, 64, 64}, {128, 128, 128}, {255, 255, 255} };
+    int k = 6;
+    while(k > 0 && noiseval < stops[k]){
+        --k;
+    }
+    const float frac = (noiseval - stops[k]) / (stops[k + 1] - stops[k]);
+    for(int c = 0; c < 3; ++c){
+        rgb[c] = static_cast<std::uint8_t>(static_cast<unsigned int>((colors[k + 1][c] - colors[k][c]) * frac + colors[k][c]));
+    }
+}
+
+bool Benchmark::TerrainRampPass(unsigned int chunkSize){
+    const unsigned int samples = chunkSize*chunkSize;
+
+    // A real chunk of blended noise
+    NoiseContext noise;
+    const siv::PerlinNoise& perlin = noise.GetPerlin();
+    std::vector<float> values(samples);
+    for(unsigned int i = 0; i < samples; ++i){
+        values[i] = static_cast<float>(perlin.octave2D_01((i % chunkSize) * 4.0f / chunkSize, (i / chunkSize) * 4.0f / chunkSize, 6, 0.5));
+    }
+
+    std::cout << "Noise to height and colour, " << chunkSize << "x" << chunkSize << " chunk\n";
+
+    std::vector<float> heights(samples), slopes(samples);
+    std::vector<std::uint8_t> rgb(3 * samples);
+    double start = Clock::Now();
+    for(unsigned int i = 0; i < samples; ++i){
+        heights[i] = ReferenceNoiseToHeight(values[i]);
+        ReferenceNoiseToColor(values[i], &rgb[3 * i]);
+    }
+    const double referenceSeconds = Clock::Now() - start;
+    Report("if/else chain             ", referenceSeconds, samples);
+
+    bool passed = true;
+    std::vector<float> rampHeights(samples);
+    std::vector<std::uint32_t> colors(samples);
+    for(int k = PerlinNoiseBatch::Scalar; k <= PerlinNoiseBatch::AVX512; ++k){
+        const PerlinNoiseBatch::Kernel kernel = static_cast<PerlinNoiseBatch::Kernel>(k);
+        if(kernel == PerlinNoiseBatch::SSE2 || !PerlinNoiseBatch::IsSupported(kernel)){
+            continue;
+        }
+        const TerrainRamp ramp(TerrainRamp::GetDefaultStops(), kernel);
+        double seconds = 1.0e30;
+        for(int run = 0; run < 3; ++run){
+            start = Clock::Now();
+            ramp.Apply(values.data(), samples, rampHeights.data(), slopes.data(), colors.data());
+            seconds = std::min(seconds, Clock::Now() - start);
+        }
+
+        // The tables are exact on the height ramp, and colours are one table step away at most
+        float worstHeight = 0.0f;
+        int worstColor = 0;
+        for(unsigned int i = 0; i < samples; ++i){
+            worstHeight = std::max(worstHeight, std::fabs(rampHeights[i] - heights[i]));
+            for(int c = 0; c < 3; ++c){
+                const int channel = static_cast<int>((colors[i] >> (8 * c)) & 0xffu);
+                worstColor = std::max(worstColor, std::abs(channel - static_cast<int>(rgb[3 * i + c])));
+            }
+        }
+        std::string name = std::string("ramp ") + PerlinNoiseBatch::GetKernelName(kernel);
+        name.resize(26, ' ');
+        Report(name.c_str(), seconds, samples);
+        const bool ok = worstHeight <= 1.0e-3f && worstColor <= 2;
+        std::cout << "    " << referenceSeconds / seconds << "x faster, max height difference " << worstHeight
+                  << ", max colour difference " << worstColor << (ok ? "" : "  FAILED") << "\n";
+        passed = passed && ok;
+    }
+    return passed;
+}
+
+// Copies everything a chunk produces, to compare runs bit for bit
+struct ChunkOutput{
+    std::vector<float> heights;
+    std::vector<std::uint32_t> colors;
+    std::vector<TerrainVertex> vertices;
+};
+
+static ChunkOutput CopyChunk(const TerrainBuilder& builder, const TerrainMesh& mesh){
+    const std::size_t count = static_cast<std::size_t>(builder.GetChunkSize())*builder.GetChunkSize();
+    ChunkOutput output;
+    output.heights.assign(builder.GetHeightData(), builder.GetHeightData() + count);
+    output.colors.assign(builder.GetColorData(), builder.GetColorData() + count);
+    output.vertices = mesh.vertices;
+    return output;
+}
+
+// The chunk in Geometry's float layout, with an index list of its own, the way chunks were
+// built before the compact vertices. The compact formats are checked against it.
+static void BuildReferenceGeometry(const TerrainBuilder& builder, Geometry& geometry){
+    const unsigned int gridSize = builder.GetGridSize();
+    const float chunkSize = static_cast<float>(builder.GetChunkSize());
+    const float* heights = builder.GetHeightData();
+    for(unsigned int z = 0; z < gridSize; ++z){
+        for(unsigned int x = 0; x < gridSize; ++x){
+            const unsigned int vertex = x + z * gridSize;
+            const float chunkX = static_cast<float>(x * builder.GetGridStride());
+            const float chunkZ = static_cast<float>(z * builder.GetGridStride());
+            const glm::vec2 gradient = builder.GetHeightGradient(vertex);
+            const glm::vec3 normal = glm::normalize(glm::vec3(-gradient.x, 1.0f, -gradient.y));
+            geometry.AddVertex2(chunkX, heights[vertex], chunkZ, normal.x, normal.y, normal.z, chunkX / chunkSize, chunkZ / chunkSize);
+        }
+    }
+    // Two triangles per quad
+    for(unsigned int z = 0; z + 1 < gridSize; ++z){
+        for(unsigned int x = 0; x + 1 < gridSize; ++x){
+            const unsigned int vertex = x + z * gridSize;
+            geometry.AddIndex(vertex);
+            geometry.AddIndex(vertex + gridSize);
+            geometry.AddIndex(vertex + 1);
+            geometry.AddIndex(vertex + 1);
+            geometry.AddIndex(vertex + gridSize);
+            geometry.AddIndex(vertex + gridSize + 1);
+        }
+    }
+    geometry.Gen();
+}
+
+template <class T>
+static bool SameBits(const std::vector<T>& a, const std::vector<T>& b){
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0;
+}
+
+bool Benchmark::ParallelChunk(unsigned int chunkSize){
+    const unsigned int samples = chunkSize*chunkSize;
+    std::cout << "Chunk generation in bands of " << TerrainBuilder::RowsPerBand << " rows, " << chunkSize << "x" << chunkSize
+              << " chunk, " << ThreadPool::GetHardwareThreads() << " hardware threads\n";
+
+    // Every vertex sampled, then the smooth octaves on coarse grids, which keeps row state in
+    // the multires sampler, then the same into an octave cache, which writes whole planes
+    NoiseSettings multiresSettings;
+    multiresSettings.multiresTolerance = 0.001f;
+    const NoiseContext contexts[3] = { NoiseContext(), NoiseContext(multiresSettings), NoiseContext(multiresSettings) };
+    const char* contextNames[3] = { "every vertex", "multires", "multires, cached" };
+
+    bool passed = true;
+    for(int c = 0; c < 3; ++c){
+        ChunkOutput reference;
+        double referenceSeconds = 0.0;
+        for(unsigned int threads = 1; threads <= 16; threads *= 2){
+            ThreadPool pool(threads);
+            double seconds = 1.0e30;
+            ChunkOutput output;
+            for(int run = 0; run < 3; ++run){
+                // A fresh cache every run, so it is always a miss
+                OctaveCache cache;
+                TerrainBuilder builder(chunkSize, 1.0f, -2.0f, contexts[c], c == 2 ? &cache : nullptr, nullptr, &pool);
+                TerrainMesh mesh;
+                const double start = Clock::Now();
+                builder.GenerateNoiseMap();
+                builder.BuildMesh(mesh);
+                seconds = std::min(seconds, Clock::Now() - start);
+                output = CopyChunk(builder, mesh);
+            }
+            if(threads == 1){
+                reference = output;
+                referenceSeconds = seconds;
+            }
+
+            std::string name = std::string(contextNames[c]) + ", " + std::to_string(threads) + " thread" + (threads == 1 ? "" : "s");
+            name.resize(30, ' ');
+            Report(name.c_str(), seconds, samples);
+            const bool identical = SameBits(output.heights, reference.heights) && SameBits(output.colors, reference.colors) &&
+                                   SameBits(output.vertices, reference.vertices);
+            std::cout << "    " << referenceSeconds / seconds << "x speed-up, "
+                      << (identical ? "bit-identical to 1 thread" : "differs from 1 thread  FAILED") << "\n";
+            passed = passed && identical;
+        }
+    }
+    return passed;
+}
+
+bool Benchmark::ChunkStreaming(unsigned int chunkSize){
+    JobScheduler scheduler;
+    OctaveCache cache;
+    const NoiseContext noise;
+    ChunkStreamer streamer(scheduler, chunkSize, noise, &cache);
+    streamer.SetRadius(2);
+    std::cout << "Chunk streaming, " << chunkSize << "x" << chunkSize << " chunks, radius " << streamer.GetRadius()
+              << ", " << scheduler.GetThreadCount() << " workers, camera flying a chunk every 10 frames\n";
+
+    // The camera flies along x for 200 frames of 2 ms, then waits for the region to fill
+    glm::vec3 eye(0.5f * chunkSize, 100.0f, 0.5f * chunkSize);
+    std::size_t delivered = 0, unloaded = 0, deepestQueue = 0;
+    int checked = 0;
+    bool identical = true;
+    int frame = 0;
+    const double start = Clock::Now();
+    for(; frame < 2000; ++frame){
+        if(frame < 200){
+            eye.x += 0.1f * chunkSize;
+        }else if(streamer.IsSettled()){
+            break;
+        }
+        streamer.Update(eye);
+        unloaded += streamer.TakeUnloaded().size();
+        std::vector<ReadyChunk> ready = streamer.TakeReady(2);
+        delivered += ready.size();
+        deepestQueue = std::max(deepestQueue, scheduler.GetStats().queued);
+
+        // A few chunks against the same chunk built right here
+        for(ReadyChunk& chunk : ready){
+            if(checked < 4){
+                TerrainBuilder direct(chunkSize, static_cast<float>(chunk.coord.x), static_cast<float>(chunk.coord.z), noise);
+                direct.GenerateNoiseMap();
+                TerrainMesh mesh;
+                direct.BuildMesh(mesh);
+                identical = identical && SameBits(chunk.mesh.vertices, mesh.vertices) && chunk.mesh.tiles.size() == mesh.tiles.size();
+                ++checked;
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    const double seconds = Clock::Now() - start;
+    const bool settled = streamer.IsSettled();
+
+    // A noise slider dragged for 10 frames: the resident chunks are rebuilt as jobs, and once
+    // the slider stops every one of them is handed out again with the last settings
+    NoiseSettings settings;
+    std::size_t rebuilt = 0;
+    bool regenerated = true;
+    const double dragStart = Clock::Now();
+    for(int drag = 0; drag < 10; ++drag){
+        settings.persistence += 0.01f;
+        streamer.SetNoise(NoiseContext(settings));
+        streamer.Update(eye);
+        streamer.TakeReady(2);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    const NoiseContext dragged(settings);
+    for(int wait = 0; wait < 2000 && !streamer.IsSettled(); ++wait){
+        streamer.Update(eye);
+        for(ReadyChunk& chunk : streamer.TakeReady(2)){
+            TerrainBuilder direct(chunkSize, static_cast<float>(chunk.coord.x), static_cast<float>(chunk.coord.z), dragged);
+            direct.GenerateNoiseMap();
+            TerrainMesh mesh;
+            direct.BuildMesh(mesh);
+            regenerated = regenerated && SameBits(chunk.mesh.vertices, mesh.vertices);
+            ++rebuilt;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    const double dragSeconds = Clock::Now() - dragStart;
+    regenerated = regenerated && streamer.IsSettled() && rebuilt == streamer.GetStats().resident;
+
+    // Levels switched on, far enough that every chunk stays at level 0: the chunks built
+    // without skirts are built again, with them if the chunk size has coarser levels at all
+    streamer.SetLODDistance(1.0e6f);
+    const bool hasLevels = TerrainBuilder::GetMaxLOD(chunkSize) > 0;
+    std::size_t skirted = 0;
+    bool withSkirts = true;
+    for(int wait = 0; wait < 2000 && !streamer.IsSettled(); ++wait){
+        streamer.Update(eye);
+        for(ReadyChunk& chunk : streamer.TakeReady(2)){
+            withSkirts = withSkirts && (chunk.mesh.skirtDepth > 0.0f) == hasLevels;
+            ++skirted;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    withSkirts = withSkirts && streamer.IsSettled() && skirted == streamer.GetStats().resident;
+
+    const JobScheduler::Stats jobStats = scheduler.GetStats();
+    const ChunkStreamer::Stats streamStats = streamer.GetStats();
+    std::cout << "  " << frame << " frames in " << seconds * 1000.0 << " ms, " << streamStats.requested << " requested, "
+              << delivered << " ready, " << unloaded << " unloaded, " << streamStats.resident << " resident\n";
+    std::cout << "  request to ready: " << streamStats.averageLatency * 1000.0 << " ms average, "
+              << streamStats.maxLatency * 1000.0 << " ms worst, deepest queue " << deepestQueue << "\n";
+    std::cout << "  cancelled " << jobStats.cancelledQueued << " queued and " << jobStats.cancelledRunning << " started jobs, "
+              << jobStats.wastedSeconds * 1000.0 << " ms of work wasted, " << jobStats.steals << " steals\n";
+    std::cout << "  noise dragged over 10 frames: " << streamStats.regenerations << " chunk rebuilds requested, "
+              << rebuilt << " handed out with the last settings, " << dragSeconds * 1000.0 << " ms\n";
+    std::cout << "    " << (settled ? "region filled" : "region not filled  FAILED") << ", "
+              << (identical ? "streamed chunks match direct builds" : "streamed chunks differ  FAILED") << ", "
+              << (regenerated ? "every resident chunk rebuilt for the new noise" : "rebuilt chunks missing or stale  FAILED") << ", "
+              << (withSkirts ? "and with skirts once levels are on" : "chunks left without skirts  FAILED") << "\n";
+    return settled && identical && regenerated && withSkirts;
+}
+
+bool Benchmark::StagedChunks(unsigned int chunkSize){
+    JobScheduler scheduler;
+    const NoiseContext noise;
+    // Room for about three chunks (a vertex and a texel per vertex), so some have to go unstaged
+    const std::size_t chunkBytes = static_cast<std::size_t>(chunkSize) * chunkSize * (sizeof(TerrainVertex) + 4);
+    std::vector<std::uint8_t> memory(3 * chunkBytes);
+    StagingRing ring(memory.data(), memory.size());
+    std::size_t ringHighWater = 0, staged = 0, unstaged = 0;
+    bool identical = true;
+    {
+        ChunkStreamer streamer(scheduler, chunkSize, noise);
+        streamer.SetStagingRing(&ring);
+        streamer.SetRadius(2);
+        std::cout << "Staged chunks, " << chunkSize << "x" << chunkSize << " chunks, " << memory.size() / (1024.0 * 1024.0)
+                  << " MB ring, spans held for 3 frames like fenced copies\n";
+
+        // Spans go back 3 frames after the chunk arrived, as if the GPU copied them
+        std::deque<std::vector<StagingRing::Span>> inFlight(3);
+        glm::vec3 eye(0.5f * chunkSize, 100.0f, 0.5f * chunkSize);
+        for(int frame = 0; frame < 2000; ++frame){
+            if(frame < 200){
+                eye.x += 0.1f * chunkSize;
+            }else if(streamer.IsSettled()){
+                break;
+            }
+            streamer.Update(eye);
+            streamer.TakeUnloaded();
+            inFlight.push_back(std::vector<StagingRing::Span>());
+            for(ReadyChunk& chunk : streamer.TakeReady(2)){
+                if(chunk.staged.size == 0){
+                    ++unstaged;
+                    continue;
+                }
+                ++staged;
+                // The span must hold exactly what the upload would read from the chunk
+                const std::size_t vertexBytes = chunk.mesh.GetVertexBytes();
+                const std::size_t texelBytes = static_cast<std::size_t>(chunkSize) * chunkSize * sizeof(std::uint32_t);
+                identical = identical && chunk.staged.offset % StagingRing::Alignment == 0
+                            && chunk.texelOffset % StagingRing::Alignment == 0
+                            && std::memcmp(chunk.staged.data, chunk.mesh.vertices.data(), vertexBytes) == 0
+                            && std::memcmp(chunk.staged.data + chunk.texelOffset, chunk.builder->GetColorData(), texelBytes) == 0;
+                inFlight.back().push_back(chunk.staged);
+            }
+            for(const StagingRing::Span& span : inFlight.front()){
+                ring.Release(span);
+            }
+            inFlight.pop_front();
+            ringHighWater = std::max(ringHighWater, ring.GetUsedBytes());
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        for(const std::vector<StagingRing::Span>& spans : inFlight){
+            for(const StagingRing::Span& span : spans){
+                ring.Release(span);
+            }
+        }
+    }
+    // The streamer gave back the spans of every chunk it dropped
+    const bool empty = ring.GetUsedBytes() == 0;
+
+    std::cout << "  " << staged << " chunks staged, " << unstaged << " unstaged, " << ring.GetFailedReserves()
+              << " reserves found the ring full, high water " << ringHighWater / (1024.0 * 1024.0) << " MB\n";
+    std::cout << "    " << (identical ? "staged bytes match the chunks" : "staged bytes differ  FAILED") << ", "
+              << (empty ? "ring empty at the end" : "ring leaked spans  FAILED") << "\n";
+    return identical && empty;
+}
+
+bool Benchmark::SnapshotHandoff(unsigned int count){
+    std::cout << "Snapshot handoff, " << count << " snapshots and commands between two threads\n";
+
+    // Snapshots: every element carries the frame number, a torn snapshot would mix two
+    struct Snapshot{
+        std::uint64_t frame = 0;
+        std::vector<std::uint64_t> payload;
+    };
+    SnapshotBuffer<Snapshot> snapshots;
+    std::atomic<bool> writerDone{false};
+    double writerSeconds = 0.0;
+    std::thread writer([&]{
+        const double start = Clock::Now();
+        for(std::uint64_t frame = 1; frame <= count; ++frame){
+            Snapshot& snapshot = snapshots.GetWriteSlot();
+            snapshot.frame = frame;
+            snapshot.payload.assign(64, frame);
+            snapshots.Publish();
+        }
+        writerSeconds = Clock::Now() - start;
+        writerDone.store(true);
+    });
+    std::uint64_t acquired = 0, lastFrame = 0;
+    bool consistent = true;
+    for(;;){
+        const bool done = writerDone.load();
+        if(snapshots.Acquire()){
+            const Snapshot& snapshot = snapshots.GetReadSlot();
+            consistent = consistent && snapshot.frame > lastFrame
+                         && std::count(snapshot.payload.begin(), snapshot.payload.end(), snapshot.frame) == 64;
+            lastFrame = snapshot.frame;
+            ++acquired;
+        }else if(done){
+            break;
+        }else{
+            std::this_thread::yield();
+        }
+    }
+    writer.join();
+    consistent = consistent && lastFrame == count;
+
+    // Commands: all of them, in order
+    SpscQueue<std::uint64_t> queue(256);
+    std::thread producer([&]{
+        for(std::uint64_t i = 1; i <= count; ++i){
+            std::uint64_t value = i;
+            while(!queue.TryPush(std::move(value))){
+                std::this_thread::yield();
+            }
+        }
+    });
+    const double start = Clock::Now();
+    std::uint64_t expected = 1;
+    bool ordered = true;
+    while(expected <= count){
+        std::uint64_t value;
+        if(queue.TryPop(value)){
+            ordered = ordered && value == expected;
+            ++expected;
+        }else{
+            std::this_thread::yield();
+        }
+    }
+    const double queueSeconds = Clock::Now() - start;
+    producer.join();
+
+    std::cout << "  publish: " << writerSeconds * 1.0e9 / count << " ns each, " << acquired << " acquired, "
+              << count - acquired << " replaced before the reader got to them\n";
+    std::cout << "  command queue: " << queueSeconds * 1.0e9 / count << " ns per command\n";
+    std::cout << "    " << (consistent ? "no torn or stale snapshots" : "torn or stale snapshot  FAILED") << ", "
+              << (ordered ? "commands in order" : "commands lost or reordered  FAILED") << "\n";
+    return consistent && ordered;
+}
+
+// What the startup steps produce, to check the graph against the serial run
+struct StartupOutput{
+    std::vector<std::string> sources;
+    std::vector<std::vector<std::uint8_t>> images;
+    ChunkOutput chunk;
+};
+
+// The whole file, empty if it could not be opened; opened says which
+static std::string ReadFile(const std::string& path, bool* opened = nullptr){
+    std::ifstream file(path.c_str(), std::ios::binary);
+    if(opened != nullptr){
+        *opened = file.is_open();
+    }
+    return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+// Reads and parses a PPM, empty if it is missing or broken
+static std::vector<std::uint8_t> LoadImagePixels(const std::string& path, StartupTimeline& timeline){
+    std::size_t step = timeline.Begin("read " + path);
+    bool opened = false;
+    const std::string contents = ReadFile(path, &opened);
+    timeline.End(step);
+    std::vector<std::uint8_t> pixels;
+    if(!opened){
+        // Not a parse error, there is nothing to parse
+        std::cout << "Unable to open ppm file:" << path << std::endl;
+        return pixels;
+    }
+    step = timeline.Begin("parse " + path);
+    Image image(path);
+    if(image.ParsePPM(contents, true)){
+        pixels.assign(image.GetPixelDataPtr(), image.GetPixelDataPtr() + image.GetWidth() * image.GetHeight() * 3);
+    }
+    timeline.End(step);
+    return pixels;
+}
+
+static ChunkOutput BuildStartupChunk(unsigned int chunkSize, StartupTimeline& timeline){
+    const std::size_t step = timeline.Begin("generate chunk");
+    TerrainBuilder builder(chunkSize, 0.0f, 0.0f);
+    builder.GenerateNoiseMap();
+    TerrainMesh mesh;
+    builder.BuildMesh(mesh);
+    ChunkOutput output = CopyChunk(builder, mesh);
+    timeline.End(step);
+    return output;
+}
+
+static Task<std::string> ReadFileOnJobs(JobScheduler& jobs, StartupTimeline& timeline, std::string path){
+    co_await ResumeOnJobs{ jobs };
+    const std::size_t step = timeline.Begin("read " + path);
+    std::string contents = ReadFile(path);
+    timeline.End(step);
+    co_return contents;
+}
+
+static Task<std::vector<std::uint8_t>> LoadImageOnJobs(JobScheduler& jobs, StartupTimeline& timeline, std::string path){
+    co_await ResumeOnJobs{ jobs };
+    co_return LoadImagePixels(path, timeline);
+}
+
+static Task<ChunkOutput> BuildChunkOnJobs(JobScheduler& jobs, StartupTimeline& timeline, unsigned int chunkSize){
+    co_await ResumeOnJobs{ jobs };
+    co_return BuildStartupChunk(chunkSize, timeline);
+}
+
+// The graph: every file and the chunk start at once, the results are taken on the main thread
+static Task<void> RunStartupGraph(JobScheduler& jobs, MainThreadQueue& mainThread, StartupTimeline& timeline,
+                               const std::vector<std::string>& shaders, const std::vector<std::string>& images,
+                               unsigned int chunkSize, StartupOutput& output){
+    Task<ChunkOutput> chunk = BuildChunkOnJobs(jobs, timeline, chunkSize);
+    std::vector<Task<std::string>> sources;
+    for(const std::string& path : shaders){
+        sources.push_back(ReadFileOnJobs(jobs, timeline, path));
+    }
+    std::vector<Task<std::vector<std::uint8_t>>> pixels;
+    for(const std::string& path : images){
+        pixels.push_back(LoadImageOnJobs(jobs, timeline, path));
+    }
+    for(Task<std::string>& source : sources){
+        output.sources.push_back(co_await source);
+    }
+    for(Task<std::vector<std::uint8_t>>& image : pixels){
+        output.images.push_back(co_await image);
+    }
+    output.chunk = co_await chunk;
+    co_await mainThread;
+}
+
+bool Benchmark::StartupGraph(unsigned int chunkSize){
+    const std::vector<std::string> shaders = { "./shaders/vert.glsl", "./shaders/frag.glsl" };
+    const std::vector<std::string> images = { "../common/textures/big_buck_bunny_blender3d.ppm",
+                                              "../common/textures/big_buck_bunny_blender3d_with_weird_formatting.ppm" };
+    std::cout << "Startup loading, " << shaders.size() << " shaders, " << images.size() << " PPM images and a "
+              << chunkSize << "x" << chunkSize << " chunk\n";
+
+    // One step after the other, as startup used to be
+    const double start = Clock::Now();
+    StartupTimeline serialTimeline;
+    StartupOutput serial;
+    for(const std::string& path : shaders){
+        const std::size_t step = serialTimeline.Begin("read " + path);
+        serial.sources.push_back(ReadFile(path));
+        serialTimeline.End(step);
+    }
+    for(const std::string& path : images){
+        serial.images.push_back(LoadImagePixels(path, serialTimeline));
+    }
+    serial.chunk = BuildStartupChunk(chunkSize, serialTimeline);
+    const double serialSeconds = Clock::Now() - start;
+
+    // The same steps as a task graph on the workers
+    JobScheduler jobs;
+    MainThreadQueue mainThread;
+    StartupTimeline timeline;
+    StartupOutput graph;
+    const double graphStart = Clock::Now();
+    {
+        Task<void> startup = RunStartupGraph(jobs, mainThread, timeline, shaders, images, chunkSize, graph);
+        mainThread.RunUntilDone(startup);
+        startup.await_resume();
+    }
+    const double graphSeconds = Clock::Now() - graphStart;
+    timeline.MarkFirstFrame(Clock::Now());
+    timeline.Report();
+
+    bool loaded = !serial.sources.empty();
+    for(std::size_t i = 0; i < serial.sources.size(); ++i){
+        loaded = loaded && !serial.sources[i].empty();
+    }
+    for(std::size_t i = 0; i < serial.images.size(); ++i){
+        loaded = loaded && !serial.images[i].empty();
+    }
+    // Both images are the same 512x512 picture, written differently
+    const std::size_t imageBytes = 512 * 512 * 3;
+    const bool parsed = serial.images.size() == 2 && serial.images[0].size() == imageBytes
+                        && serial.images[1].size() == imageBytes && serial.images[0] == serial.images[1];
+    const bool identical = graph.sources == serial.sources && graph.images == serial.images
+                           && SameBits(graph.chunk.vertices, serial.chunk.vertices) && SameBits(graph.chunk.colors, serial.chunk.colors);
+
+    std::cout << "  serial: " << serialSeconds * 1000.0 << " ms, task graph on " << jobs.GetThreadCount() << " threads: "
+              << graphSeconds * 1000.0 << " ms, " << serialSeconds / graphSeconds << "x\n";
+    std::cout << "    " << (loaded ? "every file loaded" : "missing or broken file  FAILED") << ", "
+              << (parsed ? "both PPM layouts parse the same" : "PPM layouts differ  FAILED") << ", "
+              << (identical ? "graph matches the serial run" : "graph differs from the serial run  FAILED") << "\n";
+    return loaded && parsed && identical;
+}
+
+bool Benchmark::RegionBake(unsigned int chunkSize){
+    namespace fs = std::filesystem;
+    BakeSettings settings;
+    settings.chunksX = 3;
+    settings.chunksZ = 2;
+    settings.chunkSize = chunkSize;
+    // Negative chunks too, so the offsets go through the sign
+    settings.originX = -1;
+    settings.originZ = -1;
+    settings.outputDirectory = (fs::temp_directory_path() / "terrain_bake_check").string();
+    settings.reportProgress = false;
+    std::cout << "Region bake, " << settings.chunksX << "x" << settings.chunksZ << " chunks of " << chunkSize << "x" << chunkSize
+              << " from chunk (" << settings.originX << ", " << settings.originZ << ")\n";
+
+    const TerrainRamp ramp(TerrainRamp::GetDefaultStops());
+    JobScheduler scheduler;
+    RegionBaker baker(scheduler, NoiseContext(), ramp);
+    RegionBaker::Stats stats;
+    const bool baked = baker.Bake(settings, stats);
+    std::cout << "  " << stats.chunks << " chunks in " << stats.seconds * 1000.0 << " ms, "
+              << stats.generateSeconds * 1000.0 / std::max<std::size_t>(stats.chunks, 1) << " ms a chunk on the workers\n";
+
+    // Every tile read back against a chunk built directly
+    const std::size_t tileValues = static_cast<std::size_t>(chunkSize) * chunkSize;
+    const std::size_t tileCount = static_cast<std::size_t>(settings.chunksX) * settings.chunksZ;
+    std::vector<std::vector<float>> heights(tileCount, std::vector<float>(tileValues));
+    std::vector<std::vector<std::uint32_t>> colors(tileCount, std::vector<std::uint32_t>(tileValues));
+    std::ifstream heightFile(fs::path(settings.outputDirectory) / "heights.f32", std::ios::binary);
+    std::ifstream colorFile(fs::path(settings.outputDirectory) / "colors.rgba", std::ios::binary);
+    for(std::size_t tile = 0; tile < tileCount; ++tile){
+        heightFile.read(reinterpret_cast<char*>(heights[tile].data()), tileValues * sizeof(float));
+        colorFile.read(reinterpret_cast<char*>(colors[tile].data()), tileValues * sizeof(std::uint32_t));
+    }
+    const bool readBack = baked && heightFile.good() && colorFile.good();
+
+    bool identical = readBack;
+    for(std::size_t tile = 0; tile < tileCount && identical; ++tile){
+        const int x = settings.originX + static_cast<int>(tile % settings.chunksX);
+        const int z = settings.originZ + static_cast<int>(tile / settings.chunksX);
+        TerrainBuilder builder(chunkSize, static_cast<float>(x), static_cast<float>(z), NoiseContext(), nullptr, &ramp);
+        builder.GenerateNoiseMap();
+        identical = std::memcmp(heights[tile].data(), builder.GetHeightData(), tileValues * sizeof(float)) == 0
+                    && std::memcmp(colors[tile].data(), builder.GetColorData(), tileValues * sizeof(std::uint32_t)) == 0;
+    }
+
+    // The last column of a tile is the first of the one to its right, the last row the first of the one below
+    bool edgesMatch = readBack;
+    for(std::size_t tile = 0; tile < tileCount; ++tile){
+        const bool hasRight = tile % settings.chunksX + 1 < settings.chunksX;
+        const bool hasBelow = tile + settings.chunksX < tileCount;
+        for(std::size_t i = 0; i < chunkSize; ++i){
+            if(hasRight){
+                edgesMatch = edgesMatch && heights[tile][chunkSize-1 + i * chunkSize] == heights[tile+1][i * chunkSize];
+            }
+            if(hasBelow){
+                edgesMatch = edgesMatch && heights[tile][i + (chunkSize-1) * chunkSize] == heights[tile+settings.chunksX][i];
+            }
+        }
+    }
+    std::error_code error;
+    fs::remove_all(settings.outputDirectory, error);
+
+    std::cout << "    " << (readBack ? "bake read back" : "bake failed  FAILED") << ", "
+              << (identical ? "tiles bit-identical to direct chunks" : "a tile differs from its chunk  FAILED") << ", "
+              << (edgesMatch ? "shared edges match" : "shared edges differ  FAILED") << "\n";
+    return readBack && identical && edgesMatch;
+}
+
+bool Benchmark::ShardedBake(unsigned int chunkSize){
+    namespace fs = std::filesystem;
+    const fs::path directory = fs::temp_directory_path() / "terrain_shard_check";
+    // A 4x3 region in shards of 2x2 chunks, the last row of shards one chunk high
+    std::vector<Shard> shards;
+    for(int z = 0; z < 3; z += 2){
+        for(int x = 0; x < 4; x += 2){
+            Shard shard;
+            shard.index = static_cast<unsigned int>(shards.size());
+            shard.originX = x - 2;
+            shard.originZ = z;
+            shard.chunksX = 2;
+            shard.chunksZ = std::min(2, 3 - z);
+            shard.chunkSize = chunkSize;
+            shards.push_back(shard);
+        }
+    }
+    std::cout << "Sharded bake, " << shards.size() << " shards of 4x3 chunks of " << chunkSize << "x" << chunkSize
+              << ", one worker lost holding a shard\n";
+
+    std::error_code error;
+    fs::remove_all(directory, error);
+    ShardQueue queue((directory / "queue").string());
+    bool queued = queue.Create(shards);
+
+    // A worker that dies with its claim: the shard goes back, once handed out
+    Shard lost;
+    queued = queued && queue.Claim("lost-worker", lost) && queue.Requeue("lost-worker", BakeCoordinator::MaxAttempts) == 1;
+
+    const TerrainRamp ramp(TerrainRamp::GetDefaultStops());
+    JobScheduler scheduler;
+    const double start = Clock::Now();
+    const bool worked = queued && BakeCoordinator::RunWorker(directory.string(), scheduler, NoiseContext(), ramp);
+    const double seconds = Clock::Now() - start;
+
+    const ShardQueue::Counts counts = queue.GetCounts();
+    const std::vector<std::pair<Shard, std::string>> done = queue.GetDone();
+    bool complete = worked && counts.pending == 0 && counts.claimed == 0 && counts.failed == 0 && done.size() == shards.size();
+    for(std::size_t i = 0; i < done.size() && complete; ++i){
+        const Shard& shard = done[i].first;
+        complete = shard.index == i && shard.originX == shards[i].originX && shard.originZ == shards[i].originZ
+                   && shard.chunksX == shards[i].chunksX && shard.chunksZ == shards[i].chunksZ
+                   && shard.attempts == (shard.index == lost.index ? 1u : 0u) && !done[i].second.empty();
+    }
+    std::cout << "  " << done.size() << " shards in " << seconds * 1000.0 << " ms\n";
+
+    // Every chunk of every shard against one built directly
+    const std::size_t tileValues = static_cast<std::size_t>(chunkSize) * chunkSize;
+    bool identical = complete;
+    std::vector<float> heights(tileValues);
+    for(const Shard& shard : shards){
+        char name[32];
+        std::snprintf(name, sizeof(name), "shard_%06u", shard.index);
+        std::ifstream file(directory / "shards" / name / "heights.f32", std::ios::binary);
+        for(unsigned int tile = 0; tile < shard.chunksX * shard.chunksZ && identical; ++tile){
+            file.read(reinterpret_cast<char*>(heights.data()), tileValues * sizeof(float));
+            TerrainBuilder builder(chunkSize, static_cast<float>(shard.originX + static_cast<int>(tile % shard.chunksX)),
+                                   static_cast<float>(shard.originZ + static_cast<int>(tile / shard.chunksX)), NoiseContext(), nullptr, &ramp);
+            builder.GenerateNoiseMap();
+            identical = file.good() && std::memcmp(heights.data(), builder.GetHeightData(), tileValues * sizeof(float)) == 0;
+        }
+    }
+
+    // A shard every worker dies on ends in failed, and is not handed out again
+    ShardQueue poisoned((directory / "poisoned").string());
+    bool givenUp = poisoned.Create({ shards[0] });
+    Shard shard;
+    for(unsigned int attempt = 0; attempt < BakeCoordinator::MaxAttempts && givenUp; ++attempt){
+        givenUp = poisoned.Claim("lost-worker", shard) && poisoned.Requeue("lost-worker", BakeCoordinator::MaxAttempts) == 1;
+    }
+    givenUp = givenUp && !poisoned.Claim("lost-worker", shard) && poisoned.GetCounts().failed == 1;
+    fs::remove_all(directory, error);
+
+    std::cout << "    " << (complete ? "every shard done once, the lost one retried" : "the queue did not complete  FAILED") << ", "
+              << (identical ? "shards bit-identical to direct chunks" : "a shard differs from its chunks  FAILED") << ", "
+              << (givenUp ? "a failing shard is given up on" : "a failing shard is retried forever  FAILED") << "\n";
+    return complete && identical && givenUp;
+}
+
+bool Benchmark::CompactVertices(unsigned int chunkSize){
+    std::cout << "Compact terrain vertices, " << chunkSize << "x" << chunkSize << " vertices\n";
+    TerrainBuilder builder(chunkSize, 0.0f, 0.0f);
+    builder.GenerateNoiseMap();
+    const int repeats = 3;
+
+    Geometry reference;
+    double start = Clock::Now();
+    for(int r = 0; r < repeats; ++r){
+        reference = Geometry();
+        BuildReferenceGeometry(builder, reference);
+    }
+    const double geometrySeconds = (Clock::Now() - start) / repeats;
+
+    TerrainMesh mesh;
+    start = Clock::Now();
+    for(int r = 0; r < repeats; ++r){
+        mesh = TerrainMesh();
+        builder.BuildMesh(mesh);
+    }
+    const double meshSeconds = (Clock::Now() - start) / repeats;
+
+    // Decoded the way vert.glsl does, against the float vertices
+    const float* attributes = reference.GetBufferDataPtr();
+    const float heightStep = (mesh.maxHeight - mesh.minHeight) / 65535.0f;
+    float maxHeightError = 0.0f, maxNormalDegrees = 0.0f;
+    // Every tile holds its part of the grid, and together they cover all of it
+    bool sameGrid = mesh.GetQuadCount() == static_cast<std::size_t>(chunkSize - 1) * (chunkSize - 1);
+    for(const TerrainTile& tile : mesh.tiles){
+        for(unsigned int z = 0; z < tile.verticesZ && sameGrid; ++z){
+            for(unsigned int x = 0; x < tile.verticesX && sameGrid; ++x){
+                const TerrainVertex& vertex = mesh.vertices[tile.firstVertex + x + z * tile.verticesX];
+                sameGrid = vertex.x == tile.x + x && vertex.z == tile.z + z;
+            }
+        }
+    }
+    for(std::size_t i = 0; i < mesh.vertices.size() && sameGrid; ++i){
+        const TerrainVertex& vertex = mesh.vertices[i];
+        const float* v = attributes + (vertex.x + static_cast<std::size_t>(vertex.z) * chunkSize) * Geometry::VertexFloats;
+        sameGrid = vertex.x == v[Geometry::PositionOffset] && vertex.z == v[Geometry::PositionOffset + 2]
+                   && vertex.x / static_cast<float>(chunkSize) == v[Geometry::TexCoordOffset]
+                   && vertex.z / static_cast<float>(chunkSize) == v[Geometry::TexCoordOffset + 1];
+        const float height = TerrainMesh::DecodeHeight(vertex.height, mesh.minHeight, mesh.maxHeight);
+        maxHeightError = std::max(maxHeightError, std::abs(height - v[Geometry::PositionOffset + 1]));
+        const glm::vec3 normal = TerrainMesh::DecodeNormal(vertex.normal);
+        const glm::vec3 expected(v[Geometry::NormalOffset], v[Geometry::NormalOffset + 1], v[Geometry::NormalOffset + 2]);
+        const float cosine = std::clamp(normal.x * expected.x + normal.y * expected.y + normal.z * expected.z, -1.0f, 1.0f);
+        maxNormalDegrees = std::max(maxNormalDegrees, std::acos(cosine) * 57.29578f);
+    }
+
+    // Every direction round trips, the folded lower half included
+    float maxSphereDegrees = 0.0f;
+    for(int i = 0; i < 64; ++i){
+        for(int j = 0; j < 128; ++j){
+            const float theta = 3.14159265f * (i + 0.5f) / 64.0f;
+            const float phi = 6.2831853f * j / 128.0f;
+            const glm::vec3 normal(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+            std::int8_t encoded[2];
+            TerrainMesh::EncodeNormal(normal, encoded);
+            const glm::vec3 decoded = TerrainMesh::DecodeNormal(encoded);
+            const float cosine = std::clamp(normal.x * decoded.x + normal.y * decoded.y + normal.z * decoded.z, -1.0f, 1.0f);
+            maxSphereDegrees = std::max(maxSphereDegrees, std::acos(cosine) * 57.29578f);
+        }
+    }
+
+    const double floatBytes = static_cast<double>(reference.GetBufferSizeInBytes());
+    const double compactBytes = static_cast<double>(mesh.GetVertexBytes());
+    std::cout << "  vertex buffer: " << Geometry::VertexFloats * sizeof(float) << " -> " << sizeof(TerrainVertex) << " bytes per vertex, "
+              << floatBytes / (1024.0 * 1024.0) << " -> " << compactBytes / (1024.0 * 1024.0) << " MB (" << mesh.tiles.size()
+              << " tiles, edges repeated), " << floatBytes / compactBytes << "x smaller\n";
+    std::cout << "  float vertices and index list: " << geometrySeconds * 1000.0 << " ms, BuildMesh(): " << meshSeconds * 1000.0 << " ms\n";
+    std::cout << "  height error " << maxHeightError << " (step " << heightStep << "), normal error " << maxNormalDegrees
+              << " degrees, any direction " << maxSphereDegrees << " degrees\n";
+    // Rounding is half a step, plus the float error of the decode
+    const bool accurate = maxHeightError <= 0.5f * heightStep + 1.0e-5f * std::max(std::abs(mesh.minHeight), std::abs(mesh.maxHeight))
+                          && maxNormalDegrees < 1.0f && maxSphereDegrees < 1.0f;
+    std::cout << "    " << (sameGrid ? "same grid and texture coordinates" : "grid differs  FAILED") << ", "
+              << (accurate ? "within the quantization error" : "decodes too far off  FAILED") << "\n";
+    return sameGrid && accurate;
+}
+
+// Vertices a FIFO post-transform cache of cacheSize entries would shade for the vertex stream
+static std::size_t CountCacheMisses(const std::vector<unsigned int>& vertices, std::size_t cacheSize){
+    std::deque<unsigned int> cache;
+    std::size_t misses = 0;
+    for(unsigned int vertex : vertices){
+        if(std::find(cache.begin(), cache.end(), vertex) != cache.end()){
+            continue;
+        }
+        ++misses;
+        cache.push_back(vertex);
+        if(cache.size() > cacheSize){
+            cache.pop_front();
+        }
+    }
+    return misses;
+}
+
+// Triangles with their smallest vertex first, winding kept, in order
+static std::vector<std::array<unsigned int, 3>> SortTriangles(std::vector<std::array<unsigned int, 3>> triangles){
+    for(std::array<unsigned int, 3>& triangle : triangles){
+        std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+bool Benchmark::GridIndexing(unsigned int chunkSize){
+    std::cout << "Shared grid indices, " << chunkSize << "x" << chunkSize << " chunk in tiles of at most "
+              << GridIndices::MaxTileVertices << " vertices a side, stripes of " << GridIndices::StripeQuads << " quads\n";
+    TerrainBuilder builder(chunkSize, 0.0f, 0.0f);
+    builder.GenerateNoiseMap();
+    Geometry reference;
+    BuildReferenceGeometry(builder, reference);
+    TerrainMesh mesh;
+    builder.BuildMesh(mesh);
+
+    // The per-chunk 32-bit list every chunk used to upload, row by row
+    const std::vector<unsigned int> referenceIndices(reference.GetIndicesDataPtr(), reference.GetIndicesDataPtr() + reference.GetIndicesSize());
+    std::vector<std::array<unsigned int, 3>> referenceTriangles;
+    for(std::size_t i = 0; i + 2 < referenceIndices.size(); i += 3){
+        referenceTriangles.push_back({ referenceIndices[i], referenceIndices[i + 1], referenceIndices[i + 2] });
+    }
+    const std::size_t triangleCount = referenceTriangles.size();
+    referenceTriangles = SortTriangles(referenceTriangles);
+    std::cout << "  per chunk 32-bit list: " << referenceIndices.size() * sizeof(unsigned int) / (1024.0 * 1024.0) << " MB per chunk, "
+              << "vertex cache misses per triangle " << CountCacheMisses(referenceIndices, 16) / static_cast<double>(triangleCount)
+              << " (16 entries), " << CountCacheMisses(referenceIndices, 32) / static_cast<double>(triangleCount) << " (32)\n";
+
+    bool identical = true;
+    const GridTopology topologies[2] = { GridTopology::Triangles, GridTopology::TriangleStrips };
+    const char* topologyNames[2] = { "16-bit lists", "16-bit strips" };
+    for(int t = 0; t < 2; ++t){
+        // One buffer per tile size, every tile of the chunk drawn from it
+        std::map<std::pair<unsigned int, unsigned int>, std::vector<std::uint16_t>> shared;
+        const double start = Clock::Now();
+        for(const TerrainTile& tile : mesh.tiles){
+            std::vector<std::uint16_t>& indices = shared[std::make_pair(tile.verticesX, tile.verticesZ)];
+            if(indices.empty()){
+                indices = GridIndices::Build(tile.verticesX, tile.verticesZ, topologies[t]);
+            }
+        }
+        const double buildSeconds = Clock::Now() - start;
+        std::size_t sharedBytes = 0, drawnIndices = 0;
+        for(const auto& entry : shared){
+            sharedBytes += entry.second.size() * sizeof(std::uint16_t);
+        }
+
+        // The triangles GL would assemble, as grid vertices of the chunk, and the vertex stream
+        std::vector<std::array<unsigned int, 3>> triangles;
+        std::vector<unsigned int> stream;
+        for(const TerrainTile& tile : mesh.tiles){
+            const std::vector<std::uint16_t>& indices = shared[std::make_pair(tile.verticesX, tile.verticesZ)];
+            drawnIndices += indices.size();
+            auto gridVertex = [&](std::uint16_t index){
+                const TerrainVertex& vertex = mesh.vertices[tile.firstVertex + index];
+                return vertex.x + static_cast<unsigned int>(vertex.z) * chunkSize;
+            };
+            if(topologies[t] == GridTopology::Triangles){
+                for(std::size_t i = 0; i + 2 < indices.size(); i += 3){
+                    triangles.push_back({ gridVertex(indices[i]), gridVertex(indices[i + 1]), gridVertex(indices[i + 2]) });
+                }
+            }else{
+                // Every odd triangle of a strip has its first two vertices swapped
+                std::size_t stripStart = 0;
+                for(std::size_t i = 0; i <= indices.size(); ++i){
+                    if(i < indices.size() && indices[i] != GridIndices::RestartIndex){
+                        continue;
+                    }
+                    for(std::size_t j = stripStart; j + 2 < i; ++j){
+                        const bool odd = (j - stripStart) % 2 == 1;
+                        triangles.push_back({ gridVertex(indices[odd ? j + 1 : j]), gridVertex(indices[odd ? j : j + 1]), gridVertex(indices[j + 2]) });
+                    }
+                    stripStart = i + 1;
+                }
+            }
+            for(std::uint16_t index : indices){
+                if(index != GridIndices::RestartIndex){
+                    stream.push_back(tile.firstVertex + index);
+                }
+            }
+        }
+        const std::size_t drawnTriangles = triangles.size();
+        identical = identical && drawnTriangles == triangleCount && SortTriangles(triangles) == referenceTriangles;
+
+        std::string name = topologyNames[t];
+        name.resize(14, ' ');
+        std::cout << "  " << name << ": " << shared.size() << " shared buffers, " << sharedBytes / 1024.0 << " KB for every chunk, built in "
+                  << buildSeconds * 1000.0 << " ms, " << drawnIndices << " indices drawn per chunk\n";
+        std::cout << "    vertex cache misses per triangle " << CountCacheMisses(stream, 16) / static_cast<double>(drawnTriangles)
+                  << " (16 entries), " << CountCacheMisses(stream, 32) / static_cast<double>(drawnTriangles) << " (32)\n";
+    }
+    std::cout << "    " << (identical ? "every topology draws the chunk's triangles, same winding" : "triangles differ  FAILED") << "\n";
+    return identical;
+}
+
+bool Benchmark::HeightTexturePull(unsigned int chunkSize){
+    std::cout << "Vertex pulling from a height texture, " << chunkSize << "x" << chunkSize << " vertices\n";
+    TerrainBuilder builder(chunkSize, 0.0f, 0.0f);
+    builder.GenerateNoiseMap();
+    const int repeats = 3;
+
+    Geometry reference;
+    BuildReferenceGeometry(builder, reference);
+    TerrainMesh mesh;
+    double start = Clock::Now();
+    for(int r = 0; r < repeats; ++r){
+        mesh = TerrainMesh();
+        builder.BuildMesh(mesh);
+    }
+    const double meshSeconds = (Clock::Now() - start) / repeats;
+    TerrainMesh texels;
+    start = Clock::Now();
+    for(int r = 0; r < repeats; ++r){
+        texels = TerrainMesh();
+        builder.BuildHeightTexels(texels);
+    }
+    const double texelSeconds = (Clock::Now() - start) / repeats;
+
+    // Every vertex heightfield_vert.glsl makes, against the one the vertex buffer holds
+    bool identical = texels.vertices.empty() && texels.tiles.size() == mesh.tiles.size()
+                     && texels.minHeight == mesh.minHeight && texels.maxHeight == mesh.maxHeight;
+    std::size_t pulled = 0;
+    for(std::size_t t = 0; t < texels.tiles.size() && identical; ++t){
+        const TerrainTile& tile = texels.tiles[t];
+        const TerrainTile& meshTile = mesh.tiles[t];
+        identical = tile.x == meshTile.x && tile.z == meshTile.z && tile.verticesX == meshTile.verticesX && tile.verticesZ == meshTile.verticesZ;
+        for(unsigned int id = 0; id < tile.verticesX * tile.verticesZ && identical; ++id){
+            const unsigned int x = tile.x + id % tile.verticesX;
+            const unsigned int z = tile.z + id / tile.verticesX;
+            const TerrainTexel& texel = texels.texels[x + static_cast<std::size_t>(z) * chunkSize];
+            // The green channel as the shader sees it, and its bytes sign extended
+            std::uint16_t green;
+            std::memcpy(&green, texel.normal, sizeof(green));
+            const std::int8_t normal[2] = { static_cast<std::int8_t>(static_cast<std::int32_t>(static_cast<std::uint32_t>(green) << 24) >> 24),
+                                            static_cast<std::int8_t>(static_cast<std::int32_t>(static_cast<std::uint32_t>(green) << 16) >> 24) };
+            const TerrainVertex& vertex = mesh.vertices[meshTile.firstVertex + id];
+            identical = vertex.x == x && vertex.z == z && vertex.height == texel.height
+                        && vertex.normal[0] == normal[0] && vertex.normal[1] == normal[1];
+            ++pulled;
+        }
+    }
+
+    const double floatBytes = static_cast<double>(reference.GetBufferSizeInBytes() + reference.GetIndicesSize() * sizeof(unsigned int));
+    const double vertexBytes = static_cast<double>(mesh.GetVertexBytes());
+    const double texelBytes = static_cast<double>(texels.GetTexelBytes());
+    std::cout << "  per chunk upload: float vertices and indices " << floatBytes / (1024.0 * 1024.0) << " MB, compact vertices "
+              << vertexBytes / (1024.0 * 1024.0) << " MB, height texture " << texelBytes / (1024.0 * 1024.0) << " MB\n";
+    std::cout << "    the texture is " << floatBytes / texelBytes << "x smaller than the float chunk, " << vertexBytes / texelBytes
+              << "x smaller than the compact vertices (no repeated tile edges, " << sizeof(TerrainTexel) << " bytes each)\n";
+    std::cout << "  BuildMesh(): " << meshSeconds * 1000.0 << " ms, BuildHeightTexels(): " << texelSeconds * 1000.0 << " ms\n";
+    std::cout << "    " << (identical ? "every pulled vertex matches the vertex buffer" : "pulled vertices differ  FAILED")
+              << ", " << pulled << " vertices\n";
+    return identical;
+}
+
+bool Benchmark::LevelOfDetail(unsigned int chunkSize){
+    const unsigned int maxLOD = TerrainBuilder::GetMaxLOD(chunkSize);
+    std::cout << "Level of detail, " << chunkSize << "x" << chunkSize << " chunks, levels 0 to " << maxLOD << "\n";
+    const unsigned int skirtStride = 1u << maxLOD;
+    // Chunk (0, 0) and its neighbours along x and z, at every level
+    std::vector<std::unique_ptr<TerrainBuilder>> centre, right, below;
+    bool samplesMatch = true;
+    for(unsigned int lod = 0; lod <= maxLOD; ++lod){
+        centre.emplace_back(new TerrainBuilder(chunkSize, 0.0f, 0.0f, NoiseContext(), nullptr, nullptr, nullptr, lod));
+        right.emplace_back(new TerrainBuilder(chunkSize, 1.0f, 0.0f, NoiseContext(), nullptr, nullptr, nullptr, lod));
+        below.emplace_back(new TerrainBuilder(chunkSize, 0.0f, 1.0f, NoiseContext(), nullptr, nullptr, nullptr, lod));
+        TerrainBuilder& builder = *centre.back();
+        builder.SetSkirtStride(skirtStride);
+        double start = Clock::Now();
+        builder.GenerateNoiseMap();
+        const double noiseSeconds = Clock::Now() - start;
+        TerrainMesh mesh;
+        start = Clock::Now();
+        builder.BuildMesh(mesh);
+        const double meshSeconds = Clock::Now() - start;
+        for(TerrainBuilder* neighbour : { right.back().get(), below.back().get() }){
+            neighbour->SetSkirtStride(skirtStride);
+            neighbour->GenerateNoiseMap();
+        }
+
+        // A level's samples are the full chunk's at every stride-th vertex
+        const TerrainBuilder& full = *centre.front();
+        const unsigned int grid = builder.GetGridSize();
+        const unsigned int stride = builder.GetGridStride();
+        for(unsigned int z = 0; z < grid && samplesMatch; ++z){
+            for(unsigned int x = 0; x < grid; ++x){
+                const std::size_t fullVertex = static_cast<std::size_t>(z) * stride * chunkSize + x * stride;
+                if(builder.GetHeightData()[x + static_cast<std::size_t>(z) * grid] != full.GetHeightData()[fullVertex]){
+                    samplesMatch = false;
+                    break;
+                }
+            }
+        }
+        std::cout << "  level " << lod << ": " << grid << "^2 samples, " << mesh.vertices.size() << " vertices, "
+                  << mesh.GetQuadCount() * 2 << " triangles, " << mesh.GetVertexBytes() / 1024.0 << " KB, noise "
+                  << noiseSeconds * 1000.0 << " ms, mesh " << meshSeconds * 1000.0 << " ms, skirts " << mesh.skirtDepth << " deep\n";
+    }
+
+    // Where a fine chunk meets a coarse one, the coarse edge is the chord between its samples and the
+    // fine edge strays from it. The skirts of both have to reach further down than it strays.
+    bool covered = true;
+    float worstCrack = 0.0f;
+    float worstRatio = 0.0f;
+    float worstShared = 0.0f;
+    for(unsigned int lod = 1; lod <= maxLOD; ++lod){
+        const unsigned int stride = 1u << lod;
+        // Each pair is a fine chunk's edge and its coarse neighbour's, read as heights along the edge
+        const TerrainBuilder* pairs[2][2] = { { centre[0].get(), right[lod].get() }, { centre[0].get(), below[lod].get() } };
+        for(int pair = 0; pair < 2; ++pair){
+            const TerrainBuilder& fine = *pairs[pair][0];
+            const TerrainBuilder& coarse = *pairs[pair][1];
+            const unsigned int coarseGrid = coarse.GetGridSize();
+            auto fineHeight = [&](unsigned int i){
+                return pair == 0 ? fine.GetHeightData()[chunkSize-1 + static_cast<std::size_t>(i) * chunkSize]
+                                 : fine.GetHeightData()[i + static_cast<std::size_t>(chunkSize-1) * chunkSize];
+            };
+            auto coarseHeight = [&](unsigned int i){
+                return pair == 0 ? coarse.GetHeightData()[static_cast<std::size_t>(i) * coarseGrid] : coarse.GetHeightData()[i];
+            };
+            float crack = 0.0f;
+            for(unsigned int i = 0; i < chunkSize; ++i){
+                const unsigned int sample = std::min(i / stride, coarseGrid-2);
+                const float t = static_cast<float>(i - sample * stride) / stride;
+                const float chord = coarseHeight(sample) * (1.0f - t) + coarseHeight(sample+1) * t;
+                // The shared samples are the same bits, rows are sampled in aligned SIMD blocks
+                if(i % stride == 0){
+                    worstShared = std::max(worstShared, std::abs(fineHeight(i) - coarseHeight(i / stride)));
+                }
+                crack = std::max(crack, std::abs(fineHeight(i) - chord));
+            }
+            TerrainMesh fineMesh, coarseMesh;
+            fine.BuildHeightTexels(fineMesh);
+            coarse.BuildHeightTexels(coarseMesh);
+            const float depth = std::min(fineMesh.skirtDepth, coarseMesh.skirtDepth);
+            covered = covered && crack <= depth;
+            worstCrack = std::max(worstCrack, crack);
+            if(depth > 0.0f){
+                worstRatio = std::max(worstRatio, crack / depth);
+            }
+        }
+    }
+    std::cout << "  widest crack between levels " << worstCrack << ", at most " << worstRatio * 100.0f
+              << "% of the skirt depth, shared samples " << worstShared << " apart\n";
+
+    // Neighbours at the same level share every edge vertex, without skirts they must not crack at all
+    bool edgesMatch = worstShared == 0.0f;
+    for(unsigned int lod = 0; lod <= maxLOD; ++lod){
+        const unsigned int grid = centre[lod]->GetGridSize();
+        const float* heights = centre[lod]->GetHeightData();
+        for(unsigned int i = 0; i < grid; ++i){
+            edgesMatch = edgesMatch && heights[grid-1 + static_cast<std::size_t>(i) * grid] == right[lod]->GetHeightData()[static_cast<std::size_t>(i) * grid]
+                         && heights[i + static_cast<std::size_t>(grid-1) * grid] == below[lod]->GetHeightData()[i];
+        }
+    }
+
+    // A distance wandering across the level 1 boundary, with and without the hysteresis
+    const float lodDistance = 768.0f;
+    unsigned int plain = ChunkStreamer::GetLOD(lodDistance, lodDistance, maxLOD);
+    unsigned int held = plain;
+    std::size_t plainChanges = 0, heldChanges = 0;
+    std::uint32_t state = 12345;
+    for(int frame = 0; frame < 10000; ++frame){
+        state = state * 1664525u + 1013904223u;
+        const float jitter = (static_cast<float>(state >> 8) / 16777216.0f - 0.5f) * 0.2f;
+        const float distance = lodDistance * (1.0f + jitter);
+        const unsigned int nextPlain = ChunkStreamer::GetLOD(distance, lodDistance, maxLOD);
+        const unsigned int nextHeld = ChunkStreamer::SelectLOD(distance, held, lodDistance, maxLOD);
+        plainChanges += nextPlain != plain;
+        heldChanges += nextHeld != held;
+        plain = nextPlain;
+        held = nextHeld;
+    }
+    std::cout << "  distance jittering 10% around a level boundary for 10000 frames: " << plainChanges
+              << " rebuilds without hysteresis, " << heldChanges << " with\n";
+
+    const bool passed = samplesMatch && covered && edgesMatch;
+    std::cout << "    " << (samplesMatch ? "every level samples the full chunk" : "a level samples other points  FAILED") << ", "
+              << (covered ? "every crack is inside the skirts" : "a crack is wider than the skirts  FAILED") << ", "
+              << (edgesMatch ? "shared edges bit-identical" : "shared edges differ  FAILED") << "\n";
+    return passed;
+}
+
+bool Benchmark::ClipmapStreaming(unsigned int levels){
+    const unsigned int chunkSize = 513;
+    Clipmap clipmap(levels, Clipmap::DefaultSize, chunkSize, NoiseContext());
+    const unsigned int size = clipmap.GetSize();
+    std::cout << "Geometry clipmap, " << levels << " levels of " << size << "x" << size << " vertices, sees "
+              << clipmap.GetViewDistance() << " away, camera flying 10 units a frame\n";
+
+    // The level textures as the GPU would hold them, written only through the updates
+    std::vector<std::vector<TerrainTexel>> textures(levels, std::vector<TerrainTexel>(static_cast<std::size_t>(size) * size));
+    std::vector<std::vector<std::uint32_t>> colors(levels, std::vector<std::uint32_t>(textures[0].size()));
+    auto apply = [&](const ClipmapFrame& frame){
+        for(const ClipmapUpdate& update : frame.updates){
+            for(unsigned int z = 0; z < update.height; ++z){
+                const std::size_t to = update.x + static_cast<std::size_t>(update.z + z) * size;
+                std::copy_n(&update.texels[z * update.width], update.width, &textures[update.level][to]);
+                std::copy_n(&update.colors[z * update.width], update.width, &colors[update.level][to]);
+            }
+        }
+    };
+
+    glm::vec3 eye(0.0f, 100.0f, 0.0f);
+    double start = Clock::Now();
+    clipmap.Update(eye);
+    const double fullSeconds = Clock::Now() - start;
+    ClipmapFrame frame = clipmap.TakeFrame();
+    apply(frame);
+
+    // Every window against the same window sampled from scratch, texel for texel
+    std::vector<TerrainTexel> fresh(textures[0].size());
+    std::vector<std::uint32_t> freshColors(fresh.size());
+    auto matches = [&](){
+        for(unsigned int l = 0; l < levels; ++l){
+            const ClipmapLevel& level = clipmap.GetLevel(l);
+            clipmap.Sample(l, level.gridX, level.gridZ, size, size, fresh.data(), freshColors.data());
+            for(unsigned int z = 0; z < size; ++z){
+                for(unsigned int x = 0; x < size; ++x){
+                    const std::size_t texel = Clipmap::Wrap(level.gridX + x, size) + static_cast<std::size_t>(Clipmap::Wrap(level.gridZ + z, size)) * size;
+                    const TerrainTexel& a = fresh[x + static_cast<std::size_t>(z) * size];
+                    const TerrainTexel& b = textures[l][texel];
+                    if(a.height != b.height || a.normal[0] != b.normal[0] || a.normal[1] != b.normal[1]
+                       || freshColors[x + static_cast<std::size_t>(z) * size] != colors[l][texel]){
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    };
+    // Every ring starts on a vertex of the level around it, within it, and reaches the end of the morph
+    auto nested = [&](){
+        for(unsigned int l = 1; l < levels; ++l){
+            const ClipmapLevel& inner = clipmap.GetLevel(l-1);
+            const ClipmapLevel& outer = clipmap.GetLevel(l);
+            const int holeX = inner.gridX / 2 - outer.gridX;
+            const int holeZ = inner.gridZ / 2 - outer.gridZ;
+            const int hole = static_cast<int>(size-1) / 2;
+            if(inner.gridX % 2 != 0 || inner.gridZ % 2 != 0 || holeX < 1 || holeZ < 1
+               || holeX + hole > static_cast<int>(size) - 2 || holeZ + hole > static_cast<int>(size) - 2){
+                return false;
+            }
+        }
+        for(unsigned int l = 0; l < levels; ++l){
+            const ClipmapLevel& level = clipmap.GetLevel(l);
+            const float first[2] = { static_cast<float>(level.gridX * level.spacing), static_cast<float>(level.gridZ * level.spacing) };
+            const float centre[2] = { eye.x, eye.z };
+            for(int axis = 0; axis < 2; ++axis){
+                const float nearEdge = std::min(centre[axis] - first[axis], first[axis] + (size-1) * level.spacing - centre[axis]);
+                if(nearEdge / level.spacing < clipmap.GetMorphEnd()){
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+    bool identical = matches();
+    bool crackFree = nested();
+
+    // Constant geometry: every frame draws the same tiles, whatever the windows' positions
+    std::size_t minVertices = std::numeric_limits<std::size_t>::max(), maxVertices = 0, triangles = 0;
+    std::size_t maxTexels = 0, totalTexels = 0, maxUpdates = 0;
+    double maxSeconds = 0.0, totalSeconds = 0.0;
+    const int frames = 600;
+    for(int f = 0; f < frames; ++f){
+        eye.x += 10.0f;
+        eye.z += 10.0f * std::sin(f * 0.02f);
+        clipmap.Update(eye);
+        frame = clipmap.TakeFrame();
+        apply(frame);
+        const Clipmap::Stats& stats = clipmap.GetStats();
+        maxTexels = std::max(maxTexels, stats.texels);
+        totalTexels += stats.texels;
+        maxUpdates = std::max(maxUpdates, stats.updates);
+        maxSeconds = std::max(maxSeconds, stats.seconds);
+        totalSeconds += stats.seconds;
+
+        std::size_t vertices = 0;
+        triangles = 0;
+        for(unsigned int l = 0; l < levels; ++l){
+            for(const TerrainTile& tile : Clipmap::GetTiles(frame.levels[l], l == 0 ? nullptr : &frame.levels[l-1], size)){
+                vertices += static_cast<std::size_t>(tile.verticesX) * tile.verticesZ;
+                triangles += 2 * static_cast<std::size_t>(tile.verticesX - 1) * (tile.verticesZ - 1);
+            }
+        }
+        minVertices = std::min(minVertices, vertices);
+        maxVertices = std::max(maxVertices, vertices);
+        if(f % 100 == 99){
+            identical = identical && matches();
+            crackFree = crackFree && nested();
+        }
+    }
+
+    const double texelBytes = sizeof(TerrainTexel) + sizeof(std::uint32_t);
+    std::cout << "  whole clipmap: " << fullSeconds * 1000.0 << " ms, " << levels * static_cast<double>(size) * size * texelBytes / (1024.0 * 1024.0)
+              << " MB of textures\n";
+    std::cout << "  per frame: " << maxVertices << " vertices (" << (minVertices == maxVertices ? "every frame" : "varies  FAILED")
+              << "), " << triangles << " triangles\n";
+    std::cout << "  per frame update: " << totalTexels / static_cast<double>(frames) << " texels average, " << maxTexels << " worst ("
+              << maxTexels * texelBytes / 1024.0 << " KB) in at most " << maxUpdates << " rectangles, "
+              << totalSeconds / frames * 1000.0 << " ms average, " << maxSeconds * 1000.0 << " ms worst\n";
+    // The chunks it would take to see as far at full resolution
+    const double chunksAcross = std::ceil(2.0 * clipmap.GetViewDistance() / (chunkSize - 1));
+    std::cout << "    as 513 chunks: " << chunksAcross * chunksAcross << " chunks, "
+              << chunksAcross * chunksAcross * chunkSize * chunkSize / 1.0e6 << " M vertices\n";
+    std::cout << "    " << (identical ? "every window matches a fresh sample" : "a window differs from a fresh sample  FAILED") << ", "
+              << (crackFree ? "rings nest and morph out before their edge" : "a ring is misplaced  FAILED") << "\n";
+    return identical && crackFree && minVertices == maxVertices;
+}
+
+bool Benchmark::RunAll(){
+    // Every check runs, even after one failed
+    bool passed = true;
+    LayeredOctaveNoise(512);
+    Noise2DKernel(512);
+    passed = BatchNoise(512, 1.0e-5f) && passed;
+    NoiseBackends(512);
+    FixedFractalKernel(512);
+    NoiseGradient(512);
+    OctaveReblend(512);
+    MultiresSampling(512);
+    passed = WorleyKernels(512, 1.0e-5f) && passed;
+    passed = NoiseGraphFusion(512) && passed;
+    passed = TerrainRampPass(512) && passed;
+    passed = ParallelChunk(512) && passed;
+    passed = ChunkStreaming(128) && passed;
+    passed = StagedChunks(128) && passed;
+    passed = SnapshotHandoff(1000000) && passed;
+    passed = StartupGraph(256) && passed;
+    passed = RegionBake(128) && passed;
+    passed = ShardedBake(128) && passed;
+    passed = CompactVertices(512) && passed;
+    passed = GridIndexing(512) && passed;
+    passed = HeightTexturePull(512) && passed;
+    passed = LevelOfDetail(513) && passed;
+    passed = ClipmapStreaming(Clipmap::DefaultLevels) && passed;
+    return passed;
+}
+
@@ -0,0 +1,323 @@
+#include "ChunkStreamer.hpp"
+#include "Clock.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+// Chunks apart along the furthest axis
+static int ChunkDistance(const ChunkCoord& a, const ChunkCoord& b){
+    return std::max(std::abs(a.x - b.x), std::abs(a.z - b.z));
+}
+
+// Constructor
+ChunkStreamer::ChunkStreamer(JobScheduler& scheduler, unsigned int chunkSize, const NoiseContext& noise,
+                             OctaveCache* octaveCache, const TerrainRamp* ramp) :
+    m_scheduler(scheduler), m_chunkSize(chunkSize), m_noise(noise), m_octaveCache(octaveCache), m_ramp(ramp), m_eye(0.0f){
+
+}
+
+// Destructor
+ChunkStreamer::~ChunkStreamer(){
+    for(auto& pending : m_pending){
+        Cancel(pending.second);
+    }
+    // Running jobs still use the cache, ramp and staging ring
+    for(PendingChunk& chunk : m_cancelled){
+        m_scheduler.Wait(chunk.job);
+        if(m_staging != nullptr){
+            m_staging->Release(chunk.result->staged);
+        }
+    }
+}
+
+void ChunkStreamer::SetRadius(int radius){
+    m_radius = std::max(radius, 0);
+}
+
+int ChunkStreamer::GetRadius() const{
+    return m_radius;
+}
+
+void ChunkStreamer::SetNoise(const NoiseContext& noise){
+    m_noise = noise;
+    RebuildResidents();
+}
+
+void ChunkStreamer::RebuildResidents(){
+    // Anything still being built uses the old settings
+    for(auto& pending : m_pending){
+        Cancel(pending.second);
+    }
+    m_pending.clear();
+    // The resident chunks are built again at the level they are drawn at, nearest first.
+    // The ones kept a chunk past the region would never be, they go now instead.
+    const ChunkCoord centre = GetChunk(m_eye);
+    for(auto it = m_resident.begin(); it != m_resident.end();){
+        if(ChunkDistance(it->first, centre) > m_radius){
+            m_unloaded.push_back(it->first);
+            it = m_resident.erase(it);
+        }else{
+            Request(it->first, m_eye, it->second);
+            ++m_regenerations;
+            ++it;
+        }
+    }
+    m_scheduler.Resort();
+}
+
+void ChunkStreamer::SetStagingRing(StagingRing* ring){
+    m_staging = ring;
+}
+
+void ChunkStreamer::SetDrawPath(TerrainDrawPath drawPath){
+    m_drawPath = drawPath;
+}
+
+TerrainDrawPath ChunkStreamer::GetDrawPath() const{
+    return m_drawPath;
+}
+
+void ChunkStreamer::SetLODDistance(float distance){
+    const bool hadSkirts = m_lodDistance > 0.0f;
+    m_lodDistance = std::max(distance, 0.0f);
+    // Chunks built without skirts would crack against a coarser neighbour, and the skirts
+    // are not needed once every chunk is at level 0
+    if((m_lodDistance > 0.0f) != hadSkirts){
+        RebuildResidents();
+    }
+}
+
+float ChunkStreamer::GetLODDistance() const{
+    return m_lodDistance;
+}
+
+unsigned int ChunkStreamer::GetLOD(float distance, float lodDistance, unsigned int maxLOD){
+    unsigned int lod = 0;
+    // Level L starts at lodDistance * 2^(L-1)
+    for(float boundary = lodDistance; lodDistance > 0.0f && lod < maxLOD && distance >= boundary; boundary *= 2.0f){
+        ++lod;
+    }
+    return lod;
+}
+
+unsigned int ChunkStreamer::SelectLOD(float distance, unsigned int current, float lodDistance, unsigned int maxLOD){
+    // Coarser once well past the boundary, finer once well back inside it
+    const unsigned int coarser = GetLOD(distance / (1.0f + LODHysteresis), lodDistance, maxLOD);
+    const unsigned int finer = GetLOD(distance * (1.0f + LODHysteresis), lodDistance, maxLOD);
+    if(coarser > current){
+        return coarser;
+    }
+    if(finer < current){
+        return finer;
+    }
+    return current;
+}
+
+ChunkCoord ChunkStreamer::GetChunk(const glm::vec3& point) const{
+    // Chunks share their edge vertices
+    const float pitch = static_cast<float>(m_chunkSize - 1);
+    return { static_cast<int>(std::floor(point.x / pitch)), static_cast<int>(std::floor(point.z / pitch)) };
+}
+
+float ChunkStreamer::Priority(const ChunkCoord& coord, const glm::vec3& eye) const{
+    const float pitch = static_cast<float>(m_chunkSize - 1);
+    const float dx = (coord.x + 0.5f) * pitch - eye.x;
+    const float dz = (coord.z + 0.5f) * pitch - eye.z;
+    return dx * dx + dz * dz;
+}
+
+float ChunkStreamer::Distance(const ChunkCoord& coord, const glm::vec3& eye) const{
+    const float pitch = static_cast<float>(m_chunkSize - 1);
+    const float dx = std::max({ coord.x * pitch - eye.x, 0.0f, eye.x - (coord.x + 1) * pitch });
+    const float dz = std::max({ coord.z * pitch - eye.z, 0.0f, eye.z - (coord.z + 1) * pitch });
+    return std::sqrt(dx * dx + dz * dz);
+}
+
+void ChunkStreamer::Cancel(const PendingChunk& chunk){
+    m_scheduler.Cancel(chunk.job);
+    if(chunk.job->GetState() == JobScheduler::Job::Running){
+        m_cancelled.push_back(chunk);
+    }else if(m_staging != nullptr){
+        // A finished job may have staged its chunk already
+        m_staging->Release(chunk.result->staged);
+    }
+}
+
+void ChunkStreamer::Request(const ChunkCoord& coord, const glm::vec3& eye, unsigned int lod){
+    std::shared_ptr<ChunkResult> result = std::make_shared<ChunkResult>();
+    const unsigned int chunkSize = m_chunkSize;
+    const NoiseContext noise = m_noise;
+    OctaveCache* const octaveCache = m_octaveCache;
+    const TerrainRamp* const ramp = m_ramp;
+    StagingRing* const staging = m_staging;
+    const TerrainDrawPath drawPath = m_drawPath;
+    // Any neighbour may be as coarse as the coarsest level, the skirts cover that.
+    // With every chunk at level 0 the shared edges match exactly and need none.
+    const unsigned int skirtStride = m_lodDistance > 0.0f ? 1u << TerrainBuilder::GetMaxLOD(chunkSize) : 0;
+
+    // The chunk is built on one worker, the parallelism is across chunks
+    JobScheduler::JobHandle job = m_scheduler.Submit([=](JobScheduler::Job& self){
+        std::unique_ptr<TerrainBuilder> builder(new TerrainBuilder(chunkSize, static_cast<float>(coord.x), static_cast<float>(coord.z),
+                                                                   noise, octaveCache, ramp, nullptr, lod));
+        builder->SetSkirtStride(skirtStride);
+        builder->GenerateNoiseMap();
+        if(self.IsCancelled()){
+            return;
+        }
+        if(drawPath == TerrainDrawPath::HeightTexture){
+            builder->BuildHeightTexels(result->mesh);
+        }else{
+            builder->BuildMesh(result->mesh);
+        }
+
+        // Vertices (or height texels) and colour texels in one span, each part aligned
+        // for its copy. The indices are the same for every chunk and already on the GPU.
+        const bool heightTexels = !result->mesh.texels.empty();
+        const std::size_t vertexBytes = heightTexels ? result->mesh.GetTexelBytes() : result->mesh.GetVertexBytes();
+        const void* const vertexData = heightTexels ? static_cast<const void*>(result->mesh.texels.data())
+                                                    : static_cast<const void*>(result->mesh.vertices.data());
+        const std::size_t texelBytes = static_cast<std::size_t>(builder->GetGridSize()) * builder->GetGridSize() * sizeof(std::uint32_t);
+        const std::size_t texelOffset = (vertexBytes + StagingRing::Alignment - 1) / StagingRing::Alignment * StagingRing::Alignment;
+        StagingRing::Span span;
+        if(staging != nullptr && !self.IsCancelled() && staging->Reserve(texelOffset + texelBytes, span)){
+            std::memcpy(span.data, vertexData, vertexBytes);
+            std::memcpy(span.data + texelOffset, builder->GetColorData(), texelBytes);
+            result->staged = span;
+            result->texelOffset = texelOffset;
+        }
+        result->builder = std::move(builder);
+    }, Priority(coord, eye));
+
+    m_pending[coord] = PendingChunk{ job, result, Clock::Now(), lod };
+    ++m_requested;
+}
+
+void ChunkStreamer::Update(const glm::vec3& eye){
+    m_eye = eye;
+    const ChunkCoord centre = GetChunk(eye);
+
+    const unsigned int maxLOD = TerrainBuilder::GetMaxLOD(m_chunkSize);
+
+    // Cancel what left the region or should be built at another level now, the rest gets its new distance
+    for(auto it = m_pending.begin(); it != m_pending.end();){
+        if(ChunkDistance(it->first, centre) > m_radius
+           || SelectLOD(Distance(it->first, eye), it->second.lod, m_lodDistance, maxLOD) != it->second.lod){
+            Cancel(it->second);
+            it = m_pending.erase(it);
+        }else{
+            it->second.job->SetPriority(Priority(it->first, eye));
+            ++it;
+        }
+    }
+    m_scheduler.Resort();
+    // Cancelled jobs that stopped give their span back
+    for(auto it = m_cancelled.begin(); it != m_cancelled.end();){
+        if(it->job->GetState() != JobScheduler::Job::Running){
+            if(m_staging != nullptr){
+                m_staging->Release(it->result->staged);
+            }
+            it = m_cancelled.erase(it);
+        }else{
+            ++it;
+        }
+    }
+
+    // Resident chunks stay one chunk longer, so the camera on a border does not reload them
+    for(auto it = m_resident.begin(); it != m_resident.end();){
+        if(ChunkDistance(it->first, centre) > m_radius + 1){
+            m_unloaded.push_back(it->first);
+            it = m_resident.erase(it);
+        }else{
+            ++it;
+        }
+    }
+
+    for(int z = centre.z - m_radius; z <= centre.z + m_radius; ++z){
+        for(int x = centre.x - m_radius; x <= centre.x + m_radius; ++x){
+            const ChunkCoord coord{ x, z };
+            if(m_pending.count(coord) != 0){
+                continue;
+            }
+            const float distance = Distance(coord, eye);
+            auto resident = m_resident.find(coord);
+            if(resident == m_resident.end()){
+                Request(coord, eye, GetLOD(distance, m_lodDistance, maxLOD));
+            }else{
+                // The resident chunk stays drawn until its new level is in
+                const unsigned int lod = SelectLOD(distance, resident->second, m_lodDistance, maxLOD);
+                if(lod != resident->second){
+                    Request(coord, eye, lod);
+                    ++m_levelChanges;
+                }
+            }
+        }
+    }
+}
+
+std::vector<ReadyChunk> ChunkStreamer::TakeReady(std::size_t maxCount){
+    // Finished chunks, nearest first
+    std::vector<std::pair<float, ChunkCoord>> finished;
+    for(auto& pending : m_pending){
+        if(pending.second.job->GetState() == JobScheduler::Job::Finished){
+            finished.push_back({ Priority(pending.first, m_eye), pending.first });
+        }
+    }
+    std::sort(finished.begin(), finished.end(), [](const std::pair<float, ChunkCoord>& a, const std::pair<float, ChunkCoord>& b){
+        return a.first < b.first;
+    });
+    if(finished.size() > maxCount){
+        finished.resize(maxCount);
+    }
+
+    std::vector<ReadyChunk> ready;
+    const double now = Clock::Now();
+    for(const std::pair<float, ChunkCoord>& entry : finished){
+        PendingChunk& pending = m_pending[entry.second];
+        const double latency = now - pending.requestTime;
+        m_totalLatency += latency;
+        m_maxLatency = std::max(m_maxLatency, latency);
+        ++m_delivered;
+
+        ChunkResult& result = *pending.result;
+        ready.push_back(ReadyChunk{ entry.second, std::move(result.builder), std::move(result.mesh),
+                                    result.staged, result.texelOffset });
+        m_resident[entry.second] = pending.lod;
+        m_pending.erase(entry.second);
+    }
+    return ready;
+}
+
+std::vector<ChunkCoord> ChunkStreamer::TakeUnloaded(){
+    std::vector<ChunkCoord> unloaded;
+    unloaded.swap(m_unloaded);
+    return unloaded;
+}
+
+bool ChunkStreamer::IsSettled() const{
+    if(!m_pending.empty()){
+        return false;
+    }
+    const ChunkCoord centre = GetChunk(m_eye);
+    for(int z = centre.z - m_radius; z <= centre.z + m_radius; ++z){
+        for(int x = centre.x - m_radius; x <= centre.x + m_radius; ++x){
+            if(m_resident.count(ChunkCoord{ x, z }) == 0){
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+ChunkStreamer::Stats ChunkStreamer::GetStats() const{
+    Stats stats;
+    stats.pending = m_pending.size();
+    stats.resident = m_resident.size();
+    stats.requested = m_requested;
+    stats.levelChanges = m_levelChanges;
+    stats.regenerations = m_regenerations;
+    stats.averageLatency = m_delivered > 0 ? m_totalLatency / m_delivered : 0.0;
+    stats.maxLatency = m_maxLatency;
+    return stats;
+}
@@ -0,0 +1,254 @@
+#include "Clipmap.hpp"
+#include "Clock.hpp"
+#include "GridIndices.hpp"
+#include "TerrainBuilder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+// Shared by every clipmap created without a ramp
+static const TerrainRamp& GetDefaultRamp(){
+    static const TerrainRamp ramp(TerrainRamp::GetDefaultStops());
+    return ramp;
+}
+
+// Rectangles smaller than this are sampled on the caller, a pool is not worth waking for a strip
+static constexpr std::size_t MinParallelTexels = 16384;
+
+// Constructor
+Clipmap::Clipmap(unsigned int levelCount, unsigned int size, unsigned int chunkSize, const NoiseContext& noise,
+                 const TerrainRamp* ramp, ThreadPool* threadPool) :
+    m_chunkSize(chunkSize), m_noise(noise), m_ramp(ramp), m_threadPool(threadPool){
+    // Odd, so a window has a middle vertex and the inner one lands on its grid; one tile at most
+    m_size = std::clamp(size, 31u, GridIndices::MaxTileVertices) | 1u;
+    if(m_ramp == nullptr){
+        m_ramp = &GetDefaultRamp();
+    }
+    m_minHeight = m_ramp->GetMinHeight();
+    m_maxHeight = m_ramp->GetMaxHeight();
+    m_levels.resize(std::clamp(levelCount, 1u, MaxLevels));
+    for(std::size_t l = 0; l < m_levels.size(); ++l){
+        m_levels[l].spacing = 1 << l;
+    }
+}
+
+void Clipmap::SetNoise(const NoiseContext& noise){
+    m_noise = noise;
+    m_valid = false;
+}
+
+int Clipmap::SnapGrid(float eye, int spacing) const{
+    // The window's middle as near the eye as an even first vertex allows
+    const float half = static_cast<float>((m_size-1) / 2);
+    return 2 * static_cast<int>(std::floor((eye / spacing - half) * 0.5f));
+}
+
+void Clipmap::Update(const glm::vec3& eye){
+    const double start = Clock::Now();
+    m_stats = Stats();
+    m_centre = glm::vec2(eye.x, eye.z);
+    const int size = static_cast<int>(m_size);
+
+    for(unsigned int l = 0; l < m_levels.size(); ++l){
+        ClipmapLevel& level = m_levels[l];
+        const int gridX = SnapGrid(eye.x, level.spacing);
+        const int gridZ = SnapGrid(eye.z, level.spacing);
+        const int dx = gridX - level.gridX;
+        const int dz = gridZ - level.gridZ;
+        if(m_valid && dx == 0 && dz == 0){
+            continue;
+        }
+        ++m_stats.levelsMoved;
+
+        if(!m_valid || std::abs(dx) >= size || std::abs(dz) >= size){
+            QueueRect(l, gridX, gridZ, m_size, m_size);
+        }else{
+            // The columns that came into view, every row of the new window
+            if(dx != 0){
+                QueueRect(l, dx > 0 ? level.gridX + size : gridX, gridZ, std::abs(dx), m_size);
+            }
+            // The rows that came into view, only the columns both windows have
+            if(dz != 0){
+                QueueRect(l, std::max(gridX, level.gridX), dz > 0 ? level.gridZ + size : gridZ,
+                          m_size - std::abs(dx), std::abs(dz));
+            }
+        }
+        level.gridX = gridX;
+        level.gridZ = gridZ;
+    }
+    m_valid = true;
+    m_stats.seconds = Clock::Now() - start;
+}
+
+void Clipmap::QueueRect(unsigned int level, int gridX, int gridZ, unsigned int width, unsigned int height){
+    // At most two pieces each way: up to the texture's edge, and on from its start
+    const unsigned int firstWidth = std::min(width, m_size - Wrap(gridX, m_size));
+    const unsigned int firstHeight = std::min(height, m_size - Wrap(gridZ, m_size));
+    const unsigned int widths[2] = { firstWidth, width - firstWidth };
+    const unsigned int heights[2] = { firstHeight, height - firstHeight };
+    for(int j = 0; j < 2; ++j){
+        for(int i = 0; i < 2; ++i){
+            if(widths[i] == 0 || heights[j] == 0){
+                continue;
+            }
+            const int pieceX = gridX + (i == 0 ? 0 : static_cast<int>(firstWidth));
+            const int pieceZ = gridZ + (j == 0 ? 0 : static_cast<int>(firstHeight));
+            ClipmapUpdate update;
+            update.level = level;
+            update.x = Wrap(pieceX, m_size);
+            update.z = Wrap(pieceZ, m_size);
+            update.width = widths[i];
+            update.height = heights[j];
+            update.texels.resize(static_cast<std::size_t>(update.width) * update.height);
+            update.colors.resize(update.texels.size());
+            Sample(level, pieceX, pieceZ, update.width, update.height, update.texels.data(), update.colors.data());
+            m_stats.texels += update.texels.size();
+            ++m_stats.updates;
+            m_updates.push_back(std::move(update));
+        }
+    }
+}
+
+void Clipmap::Sample(unsigned int level, int gridX, int gridZ, unsigned int width, unsigned int height,
+                     TerrainTexel* texels, std::uint32_t* colors) const{
+    const NoiseSettings& settings = m_noise.GetSettings();
+
+    // The same layers, sampling and normals as the chunks
+    const siv::BasicFractalLayers<float> layers =
+        TerrainBuilder::BuildFractalLayers<siv::BasicFractalLayers<float>>(settings, settings.numOctaves, settings.startOctave);
+    const FractalKernel* kernel = FindFractalKernel(layers.layerCount(), layers.startOctave());
+    const int octaveCount = layers.sampleCount();
+    const NoiseSource& source = m_noise.GetSource();
+
+    // The sample points of a chunk built at this level's stride: grid position times the scale
+    const float scale = settings.frequency / m_chunkSize * m_levels[level].spacing;
+    // The noise gradient is per first octave unit, this makes it per full resolution vertex
+    const float gradientScale = settings.frequency / m_chunkSize;
+
+    // The aligned row around the rectangle's columns, rounded down below 0 too. Every sample then comes out of
+    // a SIMD lane, never a kernel's scalar tail, and has the same bits whichever rectangle it was sampled in;
+    // otherwise a strip and the window around it disagree in the last bit.
+    const int alignment = static_cast<int>(TerrainBuilder::SampleAlignment);
+    const int rowX = static_cast<int>(std::floor(gridX / static_cast<float>(alignment))) * alignment;
+    const unsigned int skip = static_cast<unsigned int>(gridX - rowX);
+    const std::size_t rowWidth = (skip + width + alignment - 1) / alignment * alignment;
+
+    auto sampleRows = [&](std::size_t zBegin, std::size_t zEnd){
+        std::vector<float> octaveRows(3*octaveCount*rowWidth);
+        std::vector<float*> rows(3*octaveCount);
+        for(int i = 0; i < 3*octaveCount; ++i){
+            rows[i] = &octaveRows[i*rowWidth];
+        }
+        float* const* dxRows = rows.data() + octaveCount;
+        float* const* dyRows = rows.data() + 2*octaveCount;
+        std::vector<float> noise(rowWidth), noiseDx(rowWidth), noiseDz(rowWidth), heights(rowWidth), slopes(rowWidth);
+        std::vector<std::uint32_t> rowColors(rowWidth);
+
+        for(std::size_t z = zBegin; z < zEnd; ++z){
+            if(layers.layerCount() == 0){
+                std::fill(noise.begin(), noise.end(), 0.0f);
+                std::fill(noiseDx.begin(), noiseDx.end(), 0.0f);
+                std::fill(noiseDz.begin(), noiseDz.end(), 0.0f);
+            }else{
+                const float sampleY = static_cast<float>(gridZ + static_cast<int>(z)) * scale;
+                TerrainBuilder::SampleOctaveRows(source, kernel, octaveCount, static_cast<float>(rowX), scale, sampleY, rowWidth,
+                                                 rows.data(), dxRows, dyRows);
+                TerrainBuilder::BlendOctaveRows(layers, kernel, rows.data(), dxRows, dyRows, rowWidth,
+                                                noise.data(), noiseDx.data(), noiseDz.data());
+            }
+
+            m_ramp->Apply(noise.data(), rowWidth, heights.data(), slopes.data(), rowColors.data());
+            std::copy_n(&rowColors[skip], width, colors + z*width);
+            TerrainTexel* rowTexels = texels + z*width;
+            for(unsigned int x = 0; x < width; ++x){
+                const unsigned int i = skip + x;
+                TerrainBuilder::EncodeGradientNormal(TerrainBuilder::GetHeightGradient(slopes[i], noiseDx[i], noiseDz[i], gradientScale),
+                                                     rowTexels[x].normal);
+                rowTexels[x].height = TerrainMesh::EncodeHeight(heights[i], m_minHeight, m_maxHeight);
+            }
+        }
+    };
+
+    if(m_threadPool != nullptr && static_cast<std::size_t>(width) * height >= MinParallelTexels){
+        m_threadPool->ParallelFor(height, 8, sampleRows);
+    }else{
+        sampleRows(0, height);
+    }
+}
+
+ClipmapFrame Clipmap::TakeFrame(){
+    ClipmapFrame frame;
+    frame.size = m_size;
+    frame.minHeight = m_minHeight;
+    frame.maxHeight = m_maxHeight;
+    frame.centre = m_centre;
+    frame.morphStart = GetMorphStart();
+    frame.morphEnd = GetMorphEnd();
+    frame.levels = m_levels;
+    frame.updates = std::move(m_updates);
+    m_updates.clear();
+    return frame;
+}
+
+unsigned int Clipmap::GetSize() const{
+    return m_size;
+}
+
+unsigned int Clipmap::GetLevelCount() const{
+    return static_cast<unsigned int>(m_levels.size());
+}
+
+const ClipmapLevel& Clipmap::GetLevel(unsigned int level) const{
+    return m_levels[level];
+}
+
+float Clipmap::GetMinHeight() const{
+    return m_minHeight;
+}
+
+float Clipmap::GetMaxHeight() const{
+    return m_maxHeight;
+}
+
+float Clipmap::GetMorphEnd() const{
+    // A window's edge is never nearer the camera than this, see SnapGrid()
+    return static_cast<float>((m_size-1) / 2) - 2.0f;
+}
+
+float Clipmap::GetMorphStart() const{
+    // Wide enough to hide the change, and clear of the inner window's edge (half as far, plus a step)
+    const float half = static_cast<float>((m_size-1) / 2);
+    const float width = std::max(1.0f, std::min(m_size / 10.0f, half / 2.0f - 4.0f));
+    return GetMorphEnd() - width;
+}
+
+float Clipmap::GetViewDistance() const{
+    return GetMorphEnd() * m_levels.back().spacing;
+}
+
+const Clipmap::Stats& Clipmap::GetStats() const{
+    return m_stats;
+}
+
+unsigned int Clipmap::Wrap(int g, unsigned int size){
+    const int wrapped = g % static_cast<int>(size);
+    return static_cast<unsigned int>(wrapped < 0 ? wrapped + static_cast<int>(size) : wrapped);
+}
+
+std::vector<TerrainTile> Clipmap::GetTiles(const ClipmapLevel& level, const ClipmapLevel* inner, unsigned int size){
+    if(inner == nullptr){
+        return { TerrainTile{ 0, 0, 0, size, size } };
+    }
+    // The inner window is half as wide, starting on one of this level's vertices
+    const unsigned int hole = (size-1) / 2;
+    const unsigned int holeX = static_cast<unsigned int>(inner->gridX / 2 - level.gridX);
+    const unsigned int holeZ = static_cast<unsigned int>(inner->gridZ / 2 - level.gridZ);
+    // Above and below the hole the full width, beside it only its height; the tiles share their edges
+    return {
+        TerrainTile{ 0, 0, 0, size, holeZ + 1 },
+        TerrainTile{ 0, 0, holeZ + hole, size, size - holeZ - hole },
+        TerrainTile{ 0, 0, holeZ, holeX + 1, hole + 1 },
+        TerrainTile{ 0, holeX + hole, holeZ, size - holeX - hole, hole + 1 }
+    };
+}
@@ -0,0 +1,88 @@
+#include "ClipmapTerrain.hpp"
+
+ClipmapTerrain::ClipmapTerrain(unsigned int size, unsigned int levelCount, GridIndexCache& gridIndices) :
+    m_size(size), m_gridIndices(gridIndices){
+    // Nothing per vertex, the shader fetches everything from the textures
+    m_vertexBufferLayout.CreateAttributelessLayout();
+    m_levels.reserve(levelCount);
+    for(unsigned int l = 0; l < levelCount; ++l){
+        std::unique_ptr<Level> level(new Level());
+        level->heights.LoadHeightTexture(size, nullptr);
+        level->colors.LoadClipmapTexture(size);
+        m_levels.push_back(std::move(level));
+    }
+}
+
+void ClipmapTerrain::Apply(const ClipmapFrame& frame){
+    for(const ClipmapUpdate& update : frame.updates){
+        if(update.level >= m_levels.size()){
+            continue;
+        }
+        Level& level = *m_levels[update.level];
+        level.heights.UpdateRegion(update.x, update.z, update.width, update.height,
+                                   GL_RG_INTEGER, GL_UNSIGNED_SHORT, update.texels.data());
+        level.colors.UpdateRegion(update.x, update.z, update.width, update.height,
+                                  GL_RGBA, GL_UNSIGNED_BYTE, update.colors.data());
+    }
+
+    m_minHeight = frame.minHeight;
+    m_maxHeight = frame.maxHeight;
+    m_centre = frame.centre;
+    m_morphStart = frame.morphStart;
+    m_morphEnd = frame.morphEnd;
+    for(std::size_t l = 0; l < m_levels.size() && l < frame.levels.size(); ++l){
+        m_levels[l]->window = frame.levels[l];
+        // The ring's hole is wherever the window inside it ended up
+        m_levels[l]->tiles = Clipmap::GetTiles(frame.levels[l], l > 0 ? &frame.levels[l - 1] : nullptr, m_size);
+    }
+}
+
+void ClipmapTerrain::Render(){
+    Bind();
+    for(const std::unique_ptr<Level>& level : m_levels){
+        level->heights.Bind(1);
+        // Last, so texture unit 0 is left active like Bind() does
+        level->colors.Bind(0);
+        const ClipmapLevel& window = level->window;
+        glUniform2i(m_uniforms.grid, window.gridX, window.gridZ);
+        glUniform2i(m_uniforms.wrap, static_cast<GLint>(Clipmap::Wrap(window.gridX, m_size)),
+                    static_cast<GLint>(Clipmap::Wrap(window.gridZ, m_size)));
+        glUniform1i(m_uniforms.spacing, window.spacing);
+        for(const TerrainTile& tile : level->tiles){
+            glUniform2i(m_uniforms.tileOrigin, static_cast<GLint>(tile.x), static_cast<GLint>(tile.z));
+            glUniform1i(m_uniforms.tileVerticesX, static_cast<GLint>(tile.verticesX));
+            m_gridIndices.Draw(tile.verticesX, tile.verticesZ, 0);
+        }
+    }
+}
+
+void ClipmapTerrain::SetUniforms(Shader& shader){
+    shader.SetUniform1i("u_HeightMap", 1);
+    // The heights the unorm16 0 and 1 stand for, the same for every level
+    shader.SetUniform1f("u_minHeight", m_minHeight);
+    shader.SetUniform1f("u_maxHeight", m_maxHeight);
+    shader.SetUniform1i("u_levelSize", static_cast<int>(m_size));
+    GLint centre = glGetUniformLocation(shader.GetID(), "u_morphCentre");
+    glUniform2f(centre, m_centre.x, m_centre.y);
+    shader.SetUniform1f("u_morphStart", m_morphStart);
+    shader.SetUniform1f("u_morphEnd", m_morphEnd);
+    // Render() sets these once per level and tile, right after
+    m_uniforms.grid = glGetUniformLocation(shader.GetID(), "u_levelGrid");
+    m_uniforms.wrap = glGetUniformLocation(shader.GetID(), "u_levelWrap");
+    m_uniforms.spacing = glGetUniformLocation(shader.GetID(), "u_levelSpacing");
+    m_uniforms.tileOrigin = glGetUniformLocation(shader.GetID(), "u_tileOrigin");
+    m_uniforms.tileVerticesX = glGetUniformLocation(shader.GetID(), "u_tileVerticesX");
+}
+
+unsigned int ClipmapTerrain::GetSize() const{
+    return m_size;
+}
+
+unsigned int ClipmapTerrain::GetLevelCount() const{
+    return static_cast<unsigned int>(m_levels.size());
+}
+
+std::size_t ClipmapTerrain::GetTextureBytes() const{
+    // A TerrainTexel and an RGBA colour per texel
+    return m_levels.size() * m_size * m_size * (sizeof(TerrainTexel) + sizeof(std::uint32_t));
+}
@@ -0,0 +1,213 @@
+#include "FractalKernel.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// Unrolls a loop with a compile time trip count (GCC and clang both read this)
+#define FRACTAL_UNROLL _Pragma("GCC unroll 32")
+
+// Points blended together, so the inner loop has a fixed trip count the compiler can vectorize
+static constexpr std::size_t BlockSize = 8;
+
+template <int Layers, int StartOctave, int Lacunarity = 2>
+struct FixedFractal{
+    static_assert(Layers >= 1 && StartOctave >= 1, "a fractal needs at least one layer and octave");
+
+    // Octaves summed by the top layer, and distinct octaves sampled
+    static constexpr int MaxOctaves = Layers + StartOctave - 1;
+    static constexpr int Samples = 2 * Layers + StartOctave - 2;
+
+    static void SampleRows(const NoiseSource& source, float xStart, float scale, float y, std::size_t count, float* const* rows){
+        FRACTAL_UNROLL
+        for(int i = 0; i < Samples; ++i){
+            source.Noise2DRow(xStart, scale, y, count, rows[i]);
+            scale *= static_cast<float>(Lacunarity);
+            y *= static_cast<float>(Lacunarity);
+        }
+    }
+
+    static void SampleRowsGradient(const NoiseSource& source, float xStart, float scale, float y, std::size_t count,
+                                   float* const* rows, float* const* dxRows, float* const* dyRows){
+        FRACTAL_UNROLL
+        for(int i = 0; i < Samples; ++i){
+            source.Noise2DRowGradient(xStart, scale, y, count, rows[i], dxRows[i], dyRows[i]);
+            scale *= static_cast<float>(Lacunarity);
+            y *= static_cast<float>(Lacunarity);
+        }
+    }
+
+    // RemapClamp_01 without branches
+    static inline float Remap(float x){
+        return std::min(std::max(x * 0.5f + 0.5f, 0.0f), 1.0f);
+    }
+
+    static void BlendRows(const siv::BasicFractalLayers<float>& layers, const float* const* rows, std::size_t count, float* out){
+        // Local copies of the schedule, so they can live in registers
+        float weights[Layers][MaxOctaves];
+        float amplitudes[Layers];
+        const float* row[Samples];
+        FRACTAL_UNROLL
+        for(int i = 0; i < Layers; ++i){
+            amplitudes[i] = layers.amplitude(i);
+            FRACTAL_UNROLL
+            for(int k = 0; k < StartOctave + i; ++k){
+                weights[i][k] = layers.weight(i, k);
+            }
+        }
+        FRACTAL_UNROLL
+        for(int i = 0; i < Samples; ++i){
+            row[i] = rows[i];
+        }
+        const float weightSum = layers.weightSum();
+
+        // Same order of operations as blendRows, so the result is identical
+        std::size_t j = 0;
+        for(; j + BlockSize <= count; j += BlockSize){
+            float result[BlockSize] = {};
+            FRACTAL_UNROLL
+            for(int i = 0; i < Layers; ++i){
+                float layer[BlockSize] = {};
+                FRACTAL_UNROLL
+                for(int k = 0; k < StartOctave + i; ++k){
+                    for(std::size_t b = 0; b < BlockSize; ++b){
+                        layer[b] += row[i + k][j + b] * weights[i][k];
+                    }
+                }
+                for(std::size_t b = 0; b < BlockSize; ++b){
+                    result[b] += amplitudes[i] * Remap(layer[b]);
+                }
+            }
+            for(std::size_t b = 0; b < BlockSize; ++b){
+                out[j + b] = result[b] / weightSum;
+            }
+        }
+        for(; j < count; ++j){
+            float result = 0.0f;
+            FRACTAL_UNROLL
+            for(int i = 0; i < Layers; ++i){
+                float layer = 0.0f;
+                FRACTAL_UNROLL
+                for(int k = 0; k < StartOctave + i; ++k){
+                    layer += row[i + k][j] * weights[i][k];
+                }
+                result += amplitudes[i] * Remap(layer);
+            }
+            out[j] = result / weightSum;
+        }
+    }
+
+    // Derivative of Remap, a single compare so the block loops stay branch free
+    static inline float RemapSlope(float x){
+        return 0.5f * static_cast<float>(std::fabs(x) < 1.0f);
+    }
+
+    // Blends N points starting at j, value summed in the same order as BlendRows
+    template <std::size_t N>
+    static inline void BlendGradientBlock(const float (&weights)[Layers][MaxOctaves], const float (&weightsD)[Layers][MaxOctaves],
+                                          const float (&amplitudes)[Layers], float weightSum,
+                                          const float* const* rows, const float* const* dxRows, const float* const* dyRows,
+                                          std::size_t j, float* out, float* outDx, float* outDy){
+        float result[N] = {}, resultDx[N] = {}, resultDy[N] = {};
+        FRACTAL_UNROLL
+        for(int i = 0; i < Layers; ++i){
+            float layer[N] = {}, layerDx[N] = {}, layerDy[N] = {};
+            FRACTAL_UNROLL
+            for(int k = 0; k < StartOctave + i; ++k){
+                for(std::size_t b = 0; b < N; ++b){
+                    layer[b] += rows[i + k][j + b] * weights[i][k];
+                    layerDx[b] += dxRows[i + k][j + b] * weightsD[i][k];
+                    layerDy[b] += dyRows[i + k][j + b] * weightsD[i][k];
+                }
+            }
+            for(std::size_t b = 0; b < N; ++b){
+                result[b] += amplitudes[i] * Remap(layer[b]);
+                // A clamped layer is flat
+                const float slope = amplitudes[i] * RemapSlope(layer[b]);
+                resultDx[b] += slope * layerDx[b];
+                resultDy[b] += slope * layerDy[b];
+            }
+        }
+        for(std::size_t b = 0; b < N; ++b){
+            out[j + b] = result[b] / weightSum;
+            outDx[j + b] = resultDx[b] / weightSum;
+            outDy[j + b] = resultDy[b] / weightSum;
+        }
+    }
+
+    static void BlendRowsGradient(const siv::BasicFractalLayers<float>& layers, const float* const* rows, const float* const* dxRows,
+                                  const float* const* dyRows, std::size_t count, float* out, float* outDx, float* outDy){
+        // weightsD carries the chain rule factor of each octave, L^(i + k)
+        float weights[Layers][MaxOctaves];
+        float weightsD[Layers][MaxOctaves];
+        float amplitudes[Layers];
+        FRACTAL_UNROLL
+        for(int i = 0; i < Layers; ++i){
+            amplitudes[i] = layers.amplitude(i);
+            float frequency = 1.0f;
+            for(int f = 0; f < i; ++f){
+                frequency *= static_cast<float>(Lacunarity);
+            }
+            FRACTAL_UNROLL
+            for(int k = 0; k < StartOctave + i; ++k){
+                weights[i][k] = layers.weight(i, k);
+                weightsD[i][k] = weights[i][k] * frequency;
+                frequency *= static_cast<float>(Lacunarity);
+            }
+        }
+        const float weightSum = layers.weightSum();
+
+        std::size_t j = 0;
+        for(; j + BlockSize <= count; j += BlockSize){
+            BlendGradientBlock<BlockSize>(weights, weightsD, amplitudes, weightSum, rows, dxRows, dyRows, j, out, outDx, outDy);
+        }
+        for(; j < count; ++j){
+            BlendGradientBlock<1>(weights, weightsD, amplitudes, weightSum, rows, dxRows, dyRows, j, out, outDx, outDy);
+        }
+    }
+
+    static double LayeredNoise(const siv::PerlinNoise& perlin, double x, double y, const siv::FractalLayers& layers){
+        double samples[Samples];
+        FRACTAL_UNROLL
+        for(int i = 0; i < Samples; ++i){
+            samples[i] = perlin.noise2D(x, y);
+            x *= Lacunarity;
+            y *= Lacunarity;
+        }
+
+        float result = 0.0f;
+        FRACTAL_UNROLL
+        for(int i = 0; i < Layers; ++i){
+            double layer = 0.0;
+            FRACTAL_UNROLL
+            for(int k = 0; k < StartOctave + i; ++k){
+                layer += samples[i + k] * layers.weight(i, k);
+            }
+            result += layers.amplitude(i) * siv::perlin_detail::RemapClamp_01(layer);
+        }
+        return static_cast<double>(result / layers.weightSum());
+    }
+
+    static constexpr FractalKernel Kernel(){
+        return FractalKernel{ Layers, StartOctave, Samples, &SampleRows, &BlendRows, &SampleRowsGradient, &BlendRowsGradient, &LayeredNoise };
+    }
+};
+
+// Every combination up to 8 layers starting at one of the first 3 octaves.
+// The terrain uses 6 layers from octave 1.
+static const FractalKernel s_kernels[] = {
+    FixedFractal<1, 1>::Kernel(), FixedFractal<2, 1>::Kernel(), FixedFractal<3, 1>::Kernel(), FixedFractal<4, 1>::Kernel(),
+    FixedFractal<5, 1>::Kernel(), FixedFractal<6, 1>::Kernel(), FixedFractal<7, 1>::Kernel(), FixedFractal<8, 1>::Kernel(),
+    FixedFractal<1, 2>::Kernel(), FixedFractal<2, 2>::Kernel(), FixedFractal<3, 2>::Kernel(), FixedFractal<4, 2>::Kernel(),
+    FixedFractal<5, 2>::Kernel(), FixedFractal<6, 2>::Kernel(), FixedFractal<7, 2>::Kernel(), FixedFractal<8, 2>::Kernel(),
+    FixedFractal<1, 3>::Kernel(), FixedFractal<2, 3>::Kernel(), FixedFractal<3, 3>::Kernel(), FixedFractal<4, 3>::Kernel(),
+    FixedFractal<5, 3>::Kernel(), FixedFractal<6, 3>::Kernel(), FixedFractal<7, 3>::Kernel(), FixedFractal<8, 3>::Kernel()
+};
+
+const FractalKernel* FindFractalKernel(int layers, int startOctave){
+    for(const FractalKernel& kernel : s_kernels){
+        if(kernel.layers == layers && kernel.startOctave == startOctave){
+            return &kernel;
+        }
+    }
+    return nullptr;
+}
@@ -93,6 +93,7 @@ unsigned int Geometry::GetBufferSizeInBytes(){
 // with the corresponding vertices
 void Geometry::Gen(){
 	assert((m_vertexPositions.size()/3) == (m_textureCoords.size()/2));
+	m_bufferData.reserve(m_bufferData.size() + m_vertexPositions.size()/3*VertexFloats);
 
 	int coordsPos =0;
 	for(int i =0; i < m_vertexPositions.size()/3; ++i){
@@ -0,0 +1,56 @@
+#include "GridIndexCache.hpp"
+
+#include <cstdint>
+#include <vector>
+
+// Constructor
+GridIndexCache::GridIndexCache(GridTopology topology) : m_topology(topology){
+
+}
+
+// Destructor
+GridIndexCache::~GridIndexCache(){
+    Clear();
+}
+
+void GridIndexCache::Draw(unsigned int verticesX, unsigned int verticesZ, GLint baseVertex){
+    Buffer& buffer = m_buffers[std::make_tuple(verticesX, verticesZ)];
+    if(buffer.id == 0){
+        const std::vector<std::uint16_t> indices = GridIndices::Build(verticesX, verticesZ, m_topology);
+        glGenBuffers(1, &buffer.id);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer.id);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(std::uint16_t), indices.data(), GL_STATIC_DRAW);
+        buffer.count = static_cast<GLsizei>(indices.size());
+        m_bufferBytes += indices.size() * sizeof(std::uint16_t);
+    }
+    // Part of the bound vertex array's state, so it is bound again for every tile
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer.id);
+    if(m_topology == GridTopology::TriangleStrips){
+        glEnable(GL_PRIMITIVE_RESTART);
+        glPrimitiveRestartIndex(GridIndices::RestartIndex);
+        glDrawElementsBaseVertex(GL_TRIANGLE_STRIP, buffer.count, GL_UNSIGNED_SHORT, nullptr, baseVertex);
+        glDisable(GL_PRIMITIVE_RESTART);
+    }else{
+        glDrawElementsBaseVertex(GL_TRIANGLES, buffer.count, GL_UNSIGNED_SHORT, nullptr, baseVertex);
+    }
+}
+
+void GridIndexCache::Clear(){
+    for(auto& entry : m_buffers){
+        glDeleteBuffers(1, &entry.second.id);
+    }
+    m_buffers.clear();
+    m_bufferBytes = 0;
+}
+
+GridTopology GridIndexCache::GetTopology() const{
+    return m_topology;
+}
+
+std::size_t GridIndexCache::GetBufferCount() const{
+    return m_buffers.size();
+}
+
+std::size_t GridIndexCache::GetBufferBytes() const{
+    return m_bufferBytes;
+}
@@ -0,0 +1,68 @@
+#include "GridIndices.hpp"
+
+#include <algorithm>
+
+std::vector<std::uint16_t> GridIndices::Build(unsigned int verticesX, unsigned int verticesZ, GridTopology topology){
+    std::vector<std::uint16_t> indices;
+    if(verticesX < 2 || verticesZ < 2 || verticesX > MaxTileVertices || verticesZ > MaxTileVertices){
+        return indices;
+    }
+    const unsigned int quadsX = verticesX - 1;
+    const unsigned int quadsZ = verticesZ - 1;
+    const unsigned int stripes = (quadsX + StripeQuads - 1) / StripeQuads;
+    if(topology == GridTopology::Triangles){
+        indices.reserve(6 * quadsX * quadsZ);
+    }else{
+        indices.reserve(stripes * quadsZ * (2 * (StripeQuads + 1) + 1));
+    }
+
+    for(unsigned int stripe = 0; stripe < stripes; ++stripe){
+        const unsigned int xBegin = stripe * StripeQuads;
+        const unsigned int xEnd = std::min(xBegin + StripeQuads, quadsX);
+        for(unsigned int z = 0; z < quadsZ; ++z){
+            if(topology == GridTopology::Triangles){
+                for(unsigned int x = xBegin; x < xEnd; ++x){
+                    const unsigned int vertex = x + z * verticesX;
+                    const std::uint16_t quad[6] = {
+                        static_cast<std::uint16_t>(vertex),
+                        static_cast<std::uint16_t>(vertex + verticesX),
+                        static_cast<std::uint16_t>(vertex + 1),
+                        static_cast<std::uint16_t>(vertex + 1),
+                        static_cast<std::uint16_t>(vertex + verticesX),
+                        static_cast<std::uint16_t>(vertex + verticesX + 1)
+                    };
+                    indices.insert(indices.end(), quad, quad + 6);
+                }
+            }else{
+                // Down and across: every odd triangle is flipped by GL, which
+                // gives both triangles of a quad the list's winding
+                for(unsigned int x = xBegin; x <= xEnd; ++x){
+                    const unsigned int vertex = x + z * verticesX;
+                    indices.push_back(static_cast<std::uint16_t>(vertex));
+                    indices.push_back(static_cast<std::uint16_t>(vertex + verticesX));
+                }
+                indices.push_back(RestartIndex);
+            }
+        }
+    }
+    // A restart at the very end does nothing
+    if(!indices.empty() && indices.back() == RestartIndex){
+        indices.pop_back();
+    }
+    return indices;
+}
+
+std::vector<unsigned int> GridIndices::SplitSide(unsigned int quads){
+    const unsigned int maxQuads = MaxTileVertices - 1;
+    const unsigned int tiles = std::max((quads + maxQuads - 1) / maxQuads, 1u);
+    std::vector<unsigned int> starts;
+    starts.reserve(tiles + 1);
+    // The first quads % tiles tiles take one quad more
+    unsigned int start = 0;
+    for(unsigned int tile = 0; tile < tiles; ++tile){
+        starts.push_back(start);
+        start += quads / tiles + (tile < quads % tiles ? 1 : 0);
+    }
+    starts.push_back(quads);
+    return starts;
+}
@@ -0,0 +1,330 @@
+#include "HashGradientNoise.hpp"
+#include "NoiseMath.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    #define HASHNOISE_X86
+    #include <immintrin.h>
+    #define HASHNOISE_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+using namespace NoiseMath;
+
+// ========================= Scalar kernel =========================
+
+// Hashes a corner down to one of 8 gradients (the same ones siv::PerlinNoise uses)
+static inline std::uint32_t Hash(std::uint32_t seed, std::uint32_t ix, std::uint32_t iy){
+    std::uint32_t h = seed ^ (ix * PrimeX) ^ (iy * PrimeY);
+    h ^= h >> 13;
+    h *= Mix;
+    h ^= h >> 15;
+    return h >> 29;
+}
+
+static inline float Grad2D(std::uint32_t h, float x, float y){
+    const float u = h < 6 ? x : y;
+    const float v = h < 4 ? y : 0.0f;
+    return ((h & 1) == 0 ? u : -u) + ((h & 2) == 0 ? v : -v);
+}
+
+static inline float ScalarNoise2D(std::uint32_t seed, float x, float y){
+    const std::int32_t _x = FastFloor(x);
+    const std::int32_t _y = FastFloor(y);
+
+    const std::uint32_t ix = static_cast<std::uint32_t>(_x);
+    const std::uint32_t iy = static_cast<std::uint32_t>(_y);
+
+    const float fx = x - static_cast<float>(_x);
+    const float fy = y - static_cast<float>(_y);
+
+    const float p0 = Grad2D(Hash(seed, ix, iy), fx, fy);
+    const float p1 = Grad2D(Hash(seed, ix + 1, iy), fx - 1.0f, fy);
+    const float p2 = Grad2D(Hash(seed, ix, iy + 1), fx, fy - 1.0f);
+    const float p3 = Grad2D(Hash(seed, ix + 1, iy + 1), fx - 1.0f, fy - 1.0f);
+
+    const float u = Fade(fx);
+    return Lerp(Lerp(p0, p1, u), Lerp(p2, p3, u), Fade(fy));
+}
+
+static inline float FadeDerivative(float t){
+    return t * t * (t * (t * 30.0f - 60.0f) + 30.0f);
+}
+
+// ScalarNoise2D plus its derivatives, the same way as siv::BasicPerlinNoise::noise2DGradient
+static inline float ScalarNoise2DGradient(std::uint32_t seed, float x, float y, float& dx, float& dy){
+    const std::int32_t _x = FastFloor(x);
+    const std::int32_t _y = FastFloor(y);
+
+    const std::uint32_t ix = static_cast<std::uint32_t>(_x);
+    const std::uint32_t iy = static_cast<std::uint32_t>(_y);
+
+    const float fx = x - static_cast<float>(_x);
+    const float fy = y - static_cast<float>(_y);
+
+    const std::uint32_t h0 = Hash(seed, ix, iy);
+    const std::uint32_t h1 = Hash(seed, ix + 1, iy);
+    const std::uint32_t h2 = Hash(seed, ix, iy + 1);
+    const std::uint32_t h3 = Hash(seed, ix + 1, iy + 1);
+
+    const float p0 = Grad2D(h0, fx, fy);
+    const float p1 = Grad2D(h1, fx - 1.0f, fy);
+    const float p2 = Grad2D(h2, fx, fy - 1.0f);
+    const float p3 = Grad2D(h3, fx - 1.0f, fy - 1.0f);
+
+    const float u = Fade(fx);
+    const float v = Fade(fy);
+    const float q0 = Lerp(p0, p1, u);
+    const float q1 = Lerp(p2, p3, u);
+
+    dx = Lerp(Lerp(Grad2D(h0, 1.0f, 0.0f), Grad2D(h1, 1.0f, 0.0f), u), Lerp(Grad2D(h2, 1.0f, 0.0f), Grad2D(h3, 1.0f, 0.0f), u), v)
+       + FadeDerivative(fx) * Lerp(p1 - p0, p3 - p2, v);
+    dy = Lerp(Lerp(Grad2D(h0, 0.0f, 1.0f), Grad2D(h1, 0.0f, 1.0f), u), Lerp(Grad2D(h2, 0.0f, 1.0f), Grad2D(h3, 0.0f, 1.0f), u), v)
+       + FadeDerivative(fy) * (q1 - q0);
+
+    return Lerp(q0, q1, v);
+}
+
+static void ScalarRow(std::uint32_t seed, float xStart, float xScale, float y, std::size_t begin, std::size_t count, float* out){
+    for(std::size_t i = begin; i < count; ++i){
+        out[i] = ScalarNoise2D(seed, (xStart + static_cast<float>(i)) * xScale, y);
+    }
+}
+
+static void ScalarPoints(std::uint32_t seed, const float* xs, const float* ys, std::size_t begin, std::size_t count, float* out){
+    for(std::size_t i = begin; i < count; ++i){
+        out[i] = ScalarNoise2D(seed, xs[i], ys[i]);
+    }
+}
+
+#ifdef HASHNOISE_X86
+
+// ========================= AVX2 kernel (8 lanes) =========================
+// Every corner is hashed in registers, the only memory traffic is the output.
+
+HASHNOISE_TARGET("avx2")
+static inline __m256i Hash8(__m256i seed, __m256i hx, __m256i hy){
+    __m256i h = _mm256_xor_si256(seed, _mm256_xor_si256(hx, hy));
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 13));
+    h = _mm256_mullo_epi32(h, _mm256_set1_epi32((std::int32_t)Mix));
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 15));
+    return _mm256_srli_epi32(h, 29);
+}
+
+HASHNOISE_TARGET("avx2")
+static inline __m256 Grad8(__m256i h, __m256 x, __m256 y){
+    const __m256 lt6 = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(6), h));
+    const __m256 lt4 = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(4), h));
+    const __m256 u = _mm256_blendv_ps(y, x, lt6);
+    const __m256 v = _mm256_and_ps(lt4, y);
+    const __m256 signU = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(1)), 31));
+    const __m256 signV = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(2)), 30));
+    return _mm256_add_ps(_mm256_xor_ps(u, signU), _mm256_xor_ps(v, signV));
+}
+
+HASHNOISE_TARGET("avx2")
+static inline __m256 Fade8(__m256 t){
+    __m256 r = _mm256_sub_ps(_mm256_mul_ps(t, _mm256_set1_ps(6.0f)), _mm256_set1_ps(15.0f));
+    r = _mm256_add_ps(_mm256_mul_ps(t, r), _mm256_set1_ps(10.0f));
+    return _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(t, t), t), r);
+}
+
+HASHNOISE_TARGET("avx2")
+static inline __m256 Lerp8(__m256 a, __m256 b, __m256 t){
+    return _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), t));
+}
+
+HASHNOISE_TARGET("avx2")
+static inline __m256 Noise8(__m256i seed, __m256 x, __m256 y){
+    const __m256 xf = _mm256_floor_ps(x);
+    const __m256 yf = _mm256_floor_ps(y);
+
+    // The x and y terms of the hash, for both corners on each axis
+    const __m256i ix = _mm256_cvttps_epi32(xf);
+    const __m256i iy = _mm256_cvttps_epi32(yf);
+    const __m256i hx0 = _mm256_mullo_epi32(ix, _mm256_set1_epi32((std::int32_t)PrimeX));
+    const __m256i hx1 = _mm256_add_epi32(hx0, _mm256_set1_epi32((std::int32_t)PrimeX));
+    const __m256i hy0 = _mm256_mullo_epi32(iy, _mm256_set1_epi32((std::int32_t)PrimeY));
+    const __m256i hy1 = _mm256_add_epi32(hy0, _mm256_set1_epi32((std::int32_t)PrimeY));
+
+    const __m256 fx = _mm256_sub_ps(x, xf);
+    const __m256 fy = _mm256_sub_ps(y, yf);
+    const __m256 fx1 = _mm256_sub_ps(fx, _mm256_set1_ps(1.0f));
+    const __m256 fy1 = _mm256_sub_ps(fy, _mm256_set1_ps(1.0f));
+
+    const __m256 p0 = Grad8(Hash8(seed, hx0, hy0), fx, fy);
+    const __m256 p1 = Grad8(Hash8(seed, hx1, hy0), fx1, fy);
+    const __m256 p2 = Grad8(Hash8(seed, hx0, hy1), fx, fy1);
+    const __m256 p3 = Grad8(Hash8(seed, hx1, hy1), fx1, fy1);
+
+    const __m256 u = Fade8(fx);
+    return Lerp8(Lerp8(p0, p1, u), Lerp8(p2, p3, u), Fade8(fy));
+}
+
+HASHNOISE_TARGET("avx2")
+static void AVX2Row(std::uint32_t seed, float xStart, float xScale, float y, std::size_t count, float* out){
+    const __m256i vseed = _mm256_set1_epi32((std::int32_t)seed);
+    const __m256 start = _mm256_set1_ps(xStart);
+    const __m256 scale = _mm256_set1_ps(xScale);
+    const __m256 vy = _mm256_set1_ps(y);
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    std::size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        const __m256 index = _mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_set1_epi32((std::int32_t)i), lanes));
+        const __m256 x = _mm256_mul_ps(_mm256_add_ps(start, index), scale);
+        _mm256_storeu_ps(out + i, Noise8(vseed, x, vy));
+    }
+    ScalarRow(seed, xStart, xScale, y, i, count, out);
+}
+
+HASHNOISE_TARGET("avx2")
+static void AVX2Points(std::uint32_t seed, const float* xs, const float* ys, std::size_t count, float* out){
+    const __m256i vseed = _mm256_set1_epi32((std::int32_t)seed);
+    std::size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        _mm256_storeu_ps(out + i, Noise8(vseed, _mm256_loadu_ps(xs + i), _mm256_loadu_ps(ys + i)));
+    }
+    ScalarPoints(seed, xs, ys, i, count, out);
+}
+
+// ========================= AVX-512 kernel (16 lanes) =========================
+
+HASHNOISE_TARGET("avx512f")
+static inline __m512i Hash16(__m512i seed, __m512i hx, __m512i hy){
+    __m512i h = _mm512_xor_si512(seed, _mm512_xor_si512(hx, hy));
+    h = _mm512_xor_si512(h, _mm512_srli_epi32(h, 13));
+    h = _mm512_mullo_epi32(h, _mm512_set1_epi32((std::int32_t)Mix));
+    h = _mm512_xor_si512(h, _mm512_srli_epi32(h, 15));
+    return _mm512_srli_epi32(h, 29);
+}
+
+HASHNOISE_TARGET("avx512f")
+static inline __m512 Grad16(__m512i h, __m512 x, __m512 y){
+    const __mmask16 lt6 = _mm512_cmplt_epi32_mask(h, _mm512_set1_epi32(6));
+    const __mmask16 lt4 = _mm512_cmplt_epi32_mask(h, _mm512_set1_epi32(4));
+    const __m512i u = _mm512_castps_si512(_mm512_mask_blend_ps(lt6, y, x));
+    const __m512i v = _mm512_castps_si512(_mm512_maskz_mov_ps(lt4, y));
+    const __m512i signU = _mm512_slli_epi32(_mm512_and_si512(h, _mm512_set1_epi32(1)), 31);
+    const __m512i signV = _mm512_slli_epi32(_mm512_and_si512(h, _mm512_set1_epi32(2)), 30);
+    return _mm512_add_ps(_mm512_castsi512_ps(_mm512_xor_si512(u, signU)), _mm512_castsi512_ps(_mm512_xor_si512(v, signV)));
+}
+
+HASHNOISE_TARGET("avx512f")
+static inline __m512 Fade16(__m512 t){
+    __m512 r = _mm512_sub_ps(_mm512_mul_ps(t, _mm512_set1_ps(6.0f)), _mm512_set1_ps(15.0f));
+    r = _mm512_add_ps(_mm512_mul_ps(t, r), _mm512_set1_ps(10.0f));
+    return _mm512_mul_ps(_mm512_mul_ps(_mm512_mul_ps(t, t), t), r);
+}
+
+HASHNOISE_TARGET("avx512f")
+static inline __m512 Lerp16(__m512 a, __m512 b, __m512 t){
+    return _mm512_add_ps(a, _mm512_mul_ps(_mm512_sub_ps(b, a), t));
+}
+
+HASHNOISE_TARGET("avx512f")
+static inline __m512 Noise16(__m512i seed, __m512 x, __m512 y){
+    const __m512 xf = _mm512_roundscale_ps(x, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+    const __m512 yf = _mm512_roundscale_ps(y, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+
+    const __m512i ix = _mm512_cvttps_epi32(xf);
+    const __m512i iy = _mm512_cvttps_epi32(yf);
+    const __m512i hx0 = _mm512_mullo_epi32(ix, _mm512_set1_epi32((std::int32_t)PrimeX));
+    const __m512i hx1 = _mm512_add_epi32(hx0, _mm512_set1_epi32((std::int32_t)PrimeX));
+    const __m512i hy0 = _mm512_mullo_epi32(iy, _mm512_set1_epi32((std::int32_t)PrimeY));
+    const __m512i hy1 = _mm512_add_epi32(hy0, _mm512_set1_epi32((std::int32_t)PrimeY));
+
+    const __m512 fx = _mm512_sub_ps(x, xf);
+    const __m512 fy = _mm512_sub_ps(y, yf);
+    const __m512 fx1 = _mm512_sub_ps(fx, _mm512_set1_ps(1.0f));
+    const __m512 fy1 = _mm512_sub_ps(fy, _mm512_set1_ps(1.0f));
+
+    const __m512 p0 = Grad16(Hash16(seed, hx0, hy0), fx, fy);
+    const __m512 p1 = Grad16(Hash16(seed, hx1, hy0), fx1, fy);
+    const __m512 p2 = Grad16(Hash16(seed, hx0, hy1), fx, fy1);
+    const __m512 p3 = Grad16(Hash16(seed, hx1, hy1), fx1, fy1);
+
+    const __m512 u = Fade16(fx);
+    return Lerp16(Lerp16(p0, p1, u), Lerp16(p2, p3, u), Fade16(fy));
+}
+
+HASHNOISE_TARGET("avx512f")
+static void AVX512Row(std::uint32_t seed, float xStart, float xScale, float y, std::size_t count, float* out){
+    const __m512i vseed = _mm512_set1_epi32((std::int32_t)seed);
+    const __m512 start = _mm512_set1_ps(xStart);
+    const __m512 scale = _mm512_set1_ps(xScale);
+    const __m512 vy = _mm512_set1_ps(y);
+    const __m512i lanes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    std::size_t i = 0;
+    for(; i + 16 <= count; i += 16){
+        const __m512 index = _mm512_cvtepi32_ps(_mm512_add_epi32(_mm512_set1_epi32((std::int32_t)i), lanes));
+        const __m512 x = _mm512_mul_ps(_mm512_add_ps(start, index), scale);
+        _mm512_storeu_ps(out + i, Noise16(vseed, x, vy));
+    }
+    ScalarRow(seed, xStart, xScale, y, i, count, out);
+}
+
+HASHNOISE_TARGET("avx512f")
+static void AVX512Points(std::uint32_t seed, const float* xs, const float* ys, std::size_t count, float* out){
+    const __m512i vseed = _mm512_set1_epi32((std::int32_t)seed);
+    std::size_t i = 0;
+    for(; i + 16 <= count; i += 16){
+        _mm512_storeu_ps(out + i, Noise16(vseed, _mm512_loadu_ps(xs + i), _mm512_loadu_ps(ys + i)));
+    }
+    ScalarPoints(seed, xs, ys, i, count, out);
+}
+
+#endif // HASHNOISE_X86
+
+// ========================= HashGradientNoise =========================
+
+// Constructor
+HashGradientNoise::HashGradientNoise(std::uint32_t seed) : HashGradientNoise(seed, PerlinNoiseBatch::GetBestKernel()){
+
+}
+
+HashGradientNoise::HashGradientNoise(std::uint32_t seed, PerlinNoiseBatch::Kernel kernel) : m_seed(seed){
+    // SSE2 has no 32 bit multiply, so it gets the scalar kernel
+    if(kernel == PerlinNoiseBatch::SSE2 || !PerlinNoiseBatch::IsSupported(kernel)){
+        kernel = PerlinNoiseBatch::Scalar;
+    }
+    m_kernel = kernel;
+}
+
+// Destructor
+HashGradientNoise::~HashGradientNoise(){
+
+}
+
+float HashGradientNoise::Noise2D(float x, float y) const{
+    return ScalarNoise2D(m_seed, x, y);
+}
+
+void HashGradientNoise::Noise2DRow(float xStart, float xScale, float y, std::size_t count, float* out) const{
+    switch(m_kernel){
+#ifdef HASHNOISE_X86
+        case PerlinNoiseBatch::AVX512: AVX512Row(m_seed, xStart, xScale, y, count, out); return;
+        case PerlinNoiseBatch::AVX2:   AVX2Row(m_seed, xStart, xScale, y, count, out); return;
+#endif
+        default:                       ScalarRow(m_seed, xStart, xScale, y, 0, count, out); return;
+    }
+}
+
+void HashGradientNoise::Noise2DPoints(const float* xs, const float* ys, std::size_t count, float* out) const{
+    switch(m_kernel){
+#ifdef HASHNOISE_X86
+        case PerlinNoiseBatch::AVX512: AVX512Points(m_seed, xs, ys, count, out); return;
+        case PerlinNoiseBatch::AVX2:   AVX2Points(m_seed, xs, ys, count, out); return;
+#endif
+        default:                       ScalarPoints(m_seed, xs, ys, 0, count, out); return;
+    }
+}
+
+float HashGradientNoise::Noise2DGradient(float x, float y, float& dx, float& dy) const{
+    return ScalarNoise2DGradient(m_seed, x, y, dx, dy);
+}
+
+NoiseBackend HashGradientNoise::GetBackend() const{
+    return NoiseBackend::HashGradient;
+}
+
+PerlinNoiseBatch::Kernel HashGradientNoise::GetKernel() const{
+    return m_kernel;
+}
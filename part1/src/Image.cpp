@@ -4,6 +4,10 @@
 #include <string.h>
 #include <stdio.h>
 #include <memory>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <iterator>
 
 // Constructor
 Image::Image(std::string filepath) : m_filepath(filepath){
@@ -53,79 +57,103 @@ void Image::savePPM(std::string outputFileName){
 
 // Little function for loading the pixel data
 // from a PPM image.
-// TODO: Expects a very specific version of PPM!
+// The whole file is read at once and parsed from memory.
 //
 // flip - Will flip the pixels upside down in the data
 //        If you use this be consistent.
 void Image::LoadPPM(bool flip){
 
   // Open an input file stream for reading a file
-  std::ifstream ppmFile(m_filepath.c_str());
+  std::ifstream ppmFile(m_filepath.c_str(), std::ios::binary);
   // If our file successfully opens, begin to process it.
   if (ppmFile.is_open()){
-      // line will store one line of input
-      std::string line;
-      // Our loop invariant is to continue reading input until
-      // we reach the end of the file and it reads in a NULL character
       std::cout << "Reading in ppm file: " << m_filepath << std::endl;
-      unsigned int iteration = 0;
-      unsigned int pos = 0;
-      while ( getline (ppmFile,line) ){
-         // Ignore comments in the file
-         if (line[0]=='#'){
-            continue;
-         }
-         if(line[0]=='P'){
-            magicNumber = line;
-         }else if(iteration==1){
-            // Returns first token 
-            char *token = strtok((char*)line.c_str(), " "); 
-            m_width = atoi(token);
-            token = strtok(NULL, " ");
-            m_height = atoi(token);
-            std::cout << "PPM width,height=" << m_width << "," << m_height << "\n";	
-            if(m_width > 0 && m_height > 0){
-                m_pixelData = new uint8_t[m_width*m_height*3];
-                if(m_pixelData==NULL){
-                    std::cout << "Unable to allocate memory for ppm" << std::endl;
-                    exit(1);
-                 }
-             }else{
-                std::cout << "PPM not parsed correctly, width and/or height dimensions are 0" << std::endl;
-                exit(1);
-             }
-         }else if(iteration==2){
-            // max color range is stored here
-            // TODO: Can be stored optionally
-         }else{
-            m_pixelData[pos] = (uint8_t)atoi(line.c_str());
-            ++pos;
-         }
-          iteration++;
-    }             
-    ppmFile.close();
+      const std::string contents((std::istreambuf_iterator<char>(ppmFile)), std::istreambuf_iterator<char>());
+      ppmFile.close();
+      if(!ParsePPM(contents, flip)){
+          exit(1);
+      }
   }
   else{
       std::cout << "Unable to open ppm file:" << m_filepath << std::endl;
   } 
+}
 
-    // Flip all of the pixels
-    if(flip){
-        // Copy all of the data to a temporary stack-allocated array
-        uint8_t* copyData = new uint8_t[m_width*m_height*3];
-        for(int i =0; i < m_width*m_height*3; ++i){
-            copyData[i]=m_pixelData[i];
+bool Image::ParsePPM(const std::string& contents, bool flip){
+    const char* p = contents.c_str();
+    const char* const end = p + contents.size();
+    // Whitespace and comments, up to the next value
+    auto skip = [&p, end](){
+        while(p < end){
+            if(*p == '#'){
+                while(p < end && *p != '\n'){
+                    ++p;
+                }
+            }else if(isspace(static_cast<unsigned char>(*p))){
+                ++p;
+            }else{
+                break;
+            }
+        }
+    };
+    auto number = [&p, &skip](int& value){
+        skip();
+        char* next;
+        const long parsed = strtol(p, &next, 10);
+        if(next == p){
+            return false;
+        }
+        value = static_cast<int>(parsed);
+        p = next;
+        return true;
+    };
+
+    skip();
+    const char* magicEnd = p;
+    while(magicEnd < end && !isspace(static_cast<unsigned char>(*magicEnd))){
+        ++magicEnd;
+    }
+    magicNumber.assign(p, magicEnd);
+    p = magicEnd;
+    int maxValue = 0;
+    if((magicNumber != "P3" && magicNumber != "P6") || !number(m_width) || !number(m_height) || !number(maxValue)){
+        std::cout << "PPM not parsed correctly, expected a P3 or P6 header" << std::endl;
+        return false;
+    }
+    std::cout << "PPM width,height=" << m_width << "," << m_height << "\n";	
+    if(m_width <= 0 || m_height <= 0){
+        std::cout << "PPM not parsed correctly, width and/or height dimensions are 0" << std::endl;
+        return false;
+    }
+
+    const std::size_t size = static_cast<std::size_t>(m_width) * m_height * 3;
+    delete[] m_pixelData;
+    m_pixelData = new uint8_t[size]();
+    if(magicNumber == "P6"){
+        // One whitespace, then the bytes
+        ++p;
+        if(p < end){
+            memcpy(m_pixelData, p, std::min(size, static_cast<std::size_t>(end - p)));
+        }
+    }else{
+        int value;
+        for(std::size_t i = 0; i < size && number(value); ++i){
+            m_pixelData[i] = static_cast<uint8_t>(value);
         }
-        //memcpy(copyData,m_pixelData,(m_width*m_height*3)*sizeof(uint8_t));
-        unsigned int pos = (m_width*m_height*3)-1;
-        for(int i =0; i < m_width*m_height*3; i+=3){
-            m_pixelData[pos]=copyData[i+2];
-            m_pixelData[pos-1]=copyData[i+1];
-            m_pixelData[pos-2]=copyData[i];
-            pos-=3;
+    }
+
+    // Flip all of the pixels: the last pixel comes first, each keeping its channel order
+    if(flip){
+        const std::size_t pixels = size / 3;
+        for(std::size_t i = 0; i < pixels / 2; ++i){
+            uint8_t* a = m_pixelData + i * 3;
+            uint8_t* b = m_pixelData + (pixels - 1 - i) * 3;
+            std::swap(a[0], b[0]);
+            std::swap(a[1], b[1]);
+            std::swap(a[2], b[2]);
         }
-        delete[] copyData;
     }
+    return true;
 }
 
 /*  ===============================================
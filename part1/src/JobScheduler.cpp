@@ -0,0 +1,234 @@
+#include "JobScheduler.hpp"
+#include "Clock.hpp"
+
+#include <algorithm>
+
+// Heap order with the lowest priority at the front
+static bool RunsLater(const float a, const float b){
+    return a > b;
+}
+
+// ========================= Job =========================
+
+void JobScheduler::Job::SetPriority(float priority){
+    m_priority.store(priority);
+}
+
+float JobScheduler::Job::GetPriority() const{
+    return m_priority.load();
+}
+
+bool JobScheduler::Job::IsCancelled() const{
+    return m_cancelled.load();
+}
+
+JobScheduler::Job::State JobScheduler::Job::GetState() const{
+    return static_cast<State>(m_state.load());
+}
+
+double JobScheduler::Job::GetLatency() const{
+    return m_latency;
+}
+
+// ========================= JobScheduler =========================
+
+// Constructor
+JobScheduler::JobScheduler(unsigned int threadCount){
+    if(threadCount == 0){
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    for(unsigned int i = 0; i < threadCount; ++i){
+        m_queues.emplace_back(new Queue());
+    }
+    for(unsigned int i = 0; i < threadCount; ++i){
+        m_workers.emplace_back(&JobScheduler::WorkerLoop, this, i);
+    }
+}
+
+// Destructor
+JobScheduler::~JobScheduler(){
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for(std::thread& worker : m_workers){
+        worker.join();
+    }
+    // Whatever is left never runs
+    for(std::unique_ptr<Queue>& queue : m_queues){
+        for(Entry& entry : queue->entries){
+            Cancel(entry.job);
+        }
+    }
+}
+
+unsigned int JobScheduler::GetThreadCount() const{
+    return static_cast<unsigned int>(m_workers.size());
+}
+
+JobScheduler::JobHandle JobScheduler::Submit(std::function<void(Job&)> work, float priority){
+    JobHandle job = std::make_shared<Job>();
+    job->m_work = std::move(work);
+    job->m_priority.store(priority);
+    job->m_submitTime = Clock::Now();
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        ++m_stats.queued;
+    }
+
+    Queue& queue = *m_queues[m_nextQueue.fetch_add(1) % m_queues.size()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.entries.push_back({ priority, job });
+        std::push_heap(queue.entries.begin(), queue.entries.end(),
+                       [](const Entry& a, const Entry& b){ return RunsLater(a.priority, b.priority); });
+    }
+    m_queued.fetch_add(1);
+
+    // Taking the lock makes sure a worker about to sleep sees the job
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+    }
+    m_wake.notify_one();
+    return job;
+}
+
+bool JobScheduler::Cancel(const JobHandle& job){
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    job->m_cancelled.store(true);
+    switch(job->GetState()){
+        case Job::Queued:
+            // Still in a queue, the worker that pops it drops it
+            job->m_state.store(Job::Cancelled);
+            --m_stats.queued;
+            ++m_stats.cancelledQueued;
+            return true;
+        case Job::Finished:
+            // Done, but nobody is going to use the result
+            job->m_state.store(Job::Cancelled);
+            --m_stats.finished;
+            ++m_stats.cancelledRunning;
+            m_stats.wastedSeconds += job->m_runSeconds;
+            return false;
+        default:
+            // Running jobs are counted when they end, cancelled ones already were
+            return true;
+    }
+}
+
+void JobScheduler::Resort(){
+    for(std::unique_ptr<Queue>& queue : m_queues){
+        std::lock_guard<std::mutex> lock(queue->mutex);
+        for(Entry& entry : queue->entries){
+            entry.priority = entry.job->GetPriority();
+        }
+        std::make_heap(queue->entries.begin(), queue->entries.end(),
+                       [](const Entry& a, const Entry& b){ return RunsLater(a.priority, b.priority); });
+    }
+}
+
+void JobScheduler::Wait(const JobHandle& job){
+    std::unique_lock<std::mutex> lock(m_statsMutex);
+    m_jobDone.wait(lock, [&job]{
+        const Job::State state = job->GetState();
+        return state == Job::Finished || state == Job::Cancelled;
+    });
+}
+
+JobScheduler::Stats JobScheduler::GetStats() const{
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    return m_stats;
+}
+
+JobScheduler::JobHandle JobScheduler::PopBest(Queue& queue){
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if(queue.entries.empty()){
+        return nullptr;
+    }
+    std::pop_heap(queue.entries.begin(), queue.entries.end(),
+                  [](const Entry& a, const Entry& b){ return RunsLater(a.priority, b.priority); });
+    JobHandle job = std::move(queue.entries.back().job);
+    queue.entries.pop_back();
+    m_queued.fetch_sub(1);
+    return job;
+}
+
+JobScheduler::JobHandle JobScheduler::TakeJob(unsigned int index){
+    JobHandle job = PopBest(*m_queues[index]);
+    if(job != nullptr){
+        return job;
+    }
+
+    // Steal the best job any other worker has waiting
+    Queue* victim = nullptr;
+    float best = 0.0f;
+    for(std::size_t i = 1; i < m_queues.size(); ++i){
+        Queue& queue = *m_queues[(index + i) % m_queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if(!queue.entries.empty() && (victim == nullptr || RunsLater(best, queue.entries.front().priority))){
+            victim = &queue;
+            best = queue.entries.front().priority;
+        }
+    }
+    if(victim == nullptr){
+        return nullptr;
+    }
+    job = PopBest(*victim);
+    if(job != nullptr){
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        ++m_stats.steals;
+    }
+    return job;
+}
+
+void JobScheduler::Run(const JobHandle& job){
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        if(job->GetState() != Job::Queued){
+            // Cancelled while it waited
+            job->m_work = nullptr;
+            return;
+        }
+        job->m_state.store(Job::Running);
+        --m_stats.queued;
+        ++m_stats.running;
+    }
+
+    const double start = Clock::Now();
+    job->m_work(*job);
+    const double end = Clock::Now();
+    // Let go of whatever the work captured
+    job->m_work = nullptr;
+
+    std::unique_lock<std::mutex> lock(m_statsMutex);
+    job->m_runSeconds = end - start;
+    job->m_latency = end - job->m_submitTime;
+    --m_stats.running;
+    if(job->m_cancelled.load()){
+        job->m_state.store(Job::Cancelled);
+        ++m_stats.cancelledRunning;
+        m_stats.wastedSeconds += job->m_runSeconds;
+    }else{
+        job->m_state.store(Job::Finished);
+        ++m_stats.finished;
+    }
+    lock.unlock();
+    m_jobDone.notify_all();
+}
+
+void JobScheduler::WorkerLoop(unsigned int index){
+    for(;;){
+        JobHandle job = TakeJob(index);
+        if(job != nullptr){
+            Run(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wake.wait(lock, [this]{ return m_stop || m_queued.load() > 0; });
+        if(m_stop){
+            return;
+        }
+    }
+}
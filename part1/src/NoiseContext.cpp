@@ -0,0 +1,78 @@
+#include "NoiseContext.hpp"
+#include "SimplexNoise.hpp"
+#include "HashGradientNoise.hpp"
+#include "WorleyNoise.hpp"
+
+#include <map>
+#include <mutex>
+
+// The permutation table of a seed, and every noise backend built from it
+struct NoiseContext::SeedTables{
+    SeedTables(siv::PerlinNoise::seed_type seed) : perlin(seed), batch(perlin), simplex(perlin), hash(seed), worley(seed){}
+
+    siv::PerlinNoise perlin;
+    PerlinNoiseBatch batch;
+    SimplexNoise simplex;
+    HashGradientNoise hash;
+    WorleyNoise worley;
+};
+
+// The registry of tables, one entry per seed.
+// Chunks can be built from several threads so every access is locked,
+// but that only happens when a context is created, never per sample.
+static std::mutex s_registryMutex;
+static std::map<siv::PerlinNoise::seed_type, std::shared_ptr<const NoiseContext::SeedTables>> s_registry;
+
+// Constructor
+NoiseContext::NoiseContext(const NoiseSettings& settings) : m_settings(settings){
+    m_tables = AcquireTables(m_settings.seed);
+}
+
+// Destructor
+NoiseContext::~NoiseContext(){
+
+}
+
+const siv::PerlinNoise& NoiseContext::GetPerlin() const{
+    return m_tables->perlin;
+}
+
+const PerlinNoiseBatch& NoiseContext::GetPerlinBatch() const{
+    return m_tables->batch;
+}
+
+const NoiseSource& NoiseContext::GetSource() const{
+    return GetSource(m_settings.backend);
+}
+
+const NoiseSource& NoiseContext::GetSource(NoiseBackend backend) const{
+    switch(backend){
+        case NoiseBackend::Simplex:      return m_tables->simplex;
+        case NoiseBackend::HashGradient: return m_tables->hash;
+        case NoiseBackend::Worley:       return m_tables->worley;
+        default:                         return m_tables->batch;
+    }
+}
+
+const NoiseSettings& NoiseContext::GetSettings() const{
+    return m_settings;
+}
+
+std::size_t NoiseContext::GetRegistrySize(){
+    std::lock_guard<std::mutex> lock(s_registryMutex);
+    return s_registry.size();
+}
+
+std::shared_ptr<const NoiseContext::SeedTables> NoiseContext::AcquireTables(siv::PerlinNoise::seed_type seed){
+    std::lock_guard<std::mutex> lock(s_registryMutex);
+
+    auto found = s_registry.find(seed);
+    if(found != s_registry.end()){
+        return found->second;
+    }
+
+    // First time we see this seed, so pay for the shuffle once.
+    std::shared_ptr<const SeedTables> tables = std::make_shared<const SeedTables>(seed);
+    s_registry[seed] = tables;
+    return tables;
+}
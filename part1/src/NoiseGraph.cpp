@@ -0,0 +1,636 @@
+#include "NoiseGraph.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <tuple>
+
+// Samples per inner loop, a fixed trip count the compiler can vectorize
+static constexpr std::size_t BlockSize = 8;
+// Registers every program starts with: the sample coordinates
+static constexpr int CoordinateX = 0;
+static constexpr int CoordinateY = 1;
+// Scratch floats per sample a source needs: scaled x, scaled y, noise, ridged weight
+static constexpr std::size_t ScratchPerSample = 4;
+
+// Clamps to [0, 1], written so the loops calling it stay branch free
+static inline float Saturate(float v){
+    v = v > 0.0f ? v : 0.0f;
+    return v < 1.0f ? v : 1.0f;
+}
+
+// out[i] = function(a[i], b[i], c[i]) for every i < count, in blocks of BlockSize.
+// The compiler never lets an instruction write a register it reads, so nothing aliases.
+// Ops with fewer inputs pass one of them again.
+template<typename Function>
+static inline void MapSamples(const float* __restrict a, const float* __restrict b, const float* __restrict c,
+                              std::size_t count, float* __restrict out, Function function){
+    std::size_t i = 0;
+    for(; i + BlockSize <= count; i += BlockSize){
+        for(std::size_t k = 0; k < BlockSize; ++k){
+            out[i + k] = function(a[i + k], b[i + k], c[i + k]);
+        }
+    }
+    for(; i < count; ++i){
+        out[i] = function(a[i], b[i], c[i]);
+    }
+}
+
+// inout[i] = function(inout[i], a[i]) for every i < count, in blocks of BlockSize
+template<typename Function>
+static inline void UpdateSamples(const float* __restrict a, std::size_t count, float* __restrict inout, Function function){
+    std::size_t i = 0;
+    for(; i + BlockSize <= count; i += BlockSize){
+        for(std::size_t k = 0; k < BlockSize; ++k){
+            inout[i + k] = function(inout[i + k], a[i + k]);
+        }
+    }
+    for(; i < count; ++i){
+        inout[i] = function(inout[i], a[i]);
+    }
+}
+
+// One octave of libnoise's RidgedMulti. Each octave is weighted by the one before
+// it, so the ridges get detail and the valleys stay smooth.
+static void RidgedOctave(const float* __restrict noise, float offset, float gain, float amplitude,
+                         std::size_t count, float* __restrict weight, float* __restrict out){
+    std::size_t i = 0;
+    for(; i + BlockSize <= count; i += BlockSize){
+        for(std::size_t k = 0; k < BlockSize; ++k){
+            float signal = offset - std::fabs(noise[i + k]);
+            signal *= signal * weight[i + k];
+            weight[i + k] = Saturate(signal * gain);
+            out[i + k] += signal * amplitude;
+        }
+    }
+    for(; i < count; ++i){
+        float signal = offset - std::fabs(noise[i]);
+        signal *= signal * weight[i];
+        weight[i] = Saturate(signal * gain);
+        out[i] += signal * amplitude;
+    }
+}
+
+NoiseGraph::NoiseGraph(){
+}
+
+NoiseGraph::~NoiseGraph(){
+}
+
+NoiseGraph::Node NoiseGraph::AddModule(const Module& module, int inputCount){
+    // Inputs added before the module also keep the graph free of cycles
+    for(int i = 0; i < inputCount; ++i){
+        if(module.inputs[i] < 0 || module.inputs[i] >= static_cast<Node>(m_modules.size())){
+            return Reject("module " + std::to_string(m_modules.size()) + " reads node " + std::to_string(module.inputs[i])
+                          + ", which is not a module added before it");
+        }
+    }
+    m_modules.push_back(module);
+    m_output = static_cast<Node>(m_modules.size()) - 1;
+    return m_output;
+}
+
+NoiseGraph::Node NoiseGraph::Reject(const std::string& error){
+    if(m_error.empty()){
+        m_error = error;
+    }
+    return InvalidNode;
+}
+
+// Returns a module of the given op with no inputs, parameters or points
+static NoiseGraph::Module MakeModule(NoiseGraph::Op op, NoiseGraph::Node a = -1, NoiseGraph::Node b = -1, NoiseGraph::Node c = -1){
+    NoiseGraph::Module module;
+    module.op = op;
+    module.inputs[0] = a;
+    module.inputs[1] = b;
+    module.inputs[2] = c;
+    std::fill(module.params, module.params + 4, 0.0f);
+    module.backend = NoiseBackend::Perlin;
+    module.octaves = 0;
+    return module;
+}
+
+NoiseGraph::Node NoiseGraph::Constant(float value){
+    Module module = MakeModule(Op::Constant);
+    module.params[0] = value;
+    return AddModule(module, 0);
+}
+
+NoiseGraph::Node NoiseGraph::Fractal(NoiseBackend backend, float frequency, int octaves, float gain, float lacunarity){
+    Module module = MakeModule(Op::Fractal);
+    module.backend = backend;
+    module.octaves = std::max(octaves, 1);
+    module.params[0] = frequency;
+    module.params[1] = gain;
+    module.params[2] = lacunarity;
+    return AddModule(module, 0);
+}
+
+NoiseGraph::Node NoiseGraph::Ridged(NoiseBackend backend, float frequency, int octaves, float gain, float lacunarity){
+    Module module = MakeModule(Op::Ridged);
+    module.backend = backend;
+    module.octaves = std::max(octaves, 1);
+    module.params[0] = frequency;
+    module.params[1] = gain;
+    module.params[2] = lacunarity;
+    // libnoise's offset
+    module.params[3] = 1.0f;
+    return AddModule(module, 0);
+}
+
+NoiseGraph::Node NoiseGraph::Add(Node a, Node b){
+    return AddModule(MakeModule(Op::Add, a, b), 2);
+}
+
+NoiseGraph::Node NoiseGraph::Multiply(Node a, Node b){
+    return AddModule(MakeModule(Op::Multiply, a, b), 2);
+}
+
+NoiseGraph::Node NoiseGraph::Min(Node a, Node b){
+    return AddModule(MakeModule(Op::Min, a, b), 2);
+}
+
+NoiseGraph::Node NoiseGraph::Max(Node a, Node b){
+    return AddModule(MakeModule(Op::Max, a, b), 2);
+}
+
+NoiseGraph::Node NoiseGraph::ScaleBias(Node a, float scale, float bias){
+    Module module = MakeModule(Op::ScaleBias, a);
+    module.params[0] = scale;
+    module.params[1] = bias;
+    return AddModule(module, 1);
+}
+
+NoiseGraph::Node NoiseGraph::Abs(Node a){
+    return AddModule(MakeModule(Op::Abs, a), 1);
+}
+
+NoiseGraph::Node NoiseGraph::Clamp(Node a, float lower, float upper){
+    Module module = MakeModule(Op::Clamp, a);
+    module.params[0] = lower;
+    module.params[1] = upper;
+    return AddModule(module, 1);
+}
+
+NoiseGraph::Node NoiseGraph::Blend(Node a, Node b, Node mask){
+    return AddModule(MakeModule(Op::Blend, a, b, mask), 3);
+}
+
+NoiseGraph::Node NoiseGraph::Select(Node a, Node b, Node control, float threshold, float falloff){
+    Module module = MakeModule(Op::Select, a, b, control);
+    module.params[0] = threshold;
+    module.params[1] = std::max(falloff, 0.0f);
+    return AddModule(module, 3);
+}
+
+NoiseGraph::Node NoiseGraph::Curve(Node a, const std::vector<std::pair<float, float>>& points){
+    if(points.empty()){
+        return Reject("a curve needs at least one control point");
+    }
+    if(!std::is_sorted(points.begin(), points.end(), [](const std::pair<float, float>& p, const std::pair<float, float>& q){ return p.first < q.first; })){
+        return Reject("the control points of a curve must be sorted by input");
+    }
+    Module module = MakeModule(Op::Curve, a);
+    for(const std::pair<float, float>& point : points){
+        module.points.push_back(point.first);
+        module.points.push_back(point.second);
+    }
+    return AddModule(module, 1);
+}
+
+NoiseGraph::Node NoiseGraph::Terrace(Node a, const std::vector<float>& levels){
+    if(levels.empty()){
+        return Reject("a terrace needs at least one level");
+    }
+    if(!std::is_sorted(levels.begin(), levels.end())){
+        return Reject("the levels of a terrace must be sorted from low to high");
+    }
+    Module module = MakeModule(Op::Terrace, a);
+    module.points = levels;
+    return AddModule(module, 1);
+}
+
+NoiseGraph::Node NoiseGraph::Warp(Node a, Node dx, Node dy, float strength){
+    Module module = MakeModule(Op::Warp, a, dx, dy);
+    module.params[0] = strength;
+    return AddModule(module, 3);
+}
+
+bool NoiseGraph::SetOutput(Node node){
+    if(node < 0 || node >= static_cast<Node>(m_modules.size())){
+        return false;
+    }
+    m_output = node;
+    return true;
+}
+
+NoiseGraph::Node NoiseGraph::GetOutput() const{
+    return m_output;
+}
+
+bool NoiseGraph::IsValid() const{
+    return m_error.empty();
+}
+
+const std::string& NoiseGraph::GetError() const{
+    return m_error;
+}
+
+std::size_t NoiseGraph::GetModuleCount() const{
+    return m_modules.size();
+}
+
+const NoiseGraph::Module& NoiseGraph::GetModule(Node node) const{
+    return m_modules[node];
+}
+
+// Turns the graph into a program over virtual registers, one register per instruction.
+// A module is emitted once per set of coordinates it is read at, so a module under a
+// warp and outside of it is two instructions, and everything else is shared.
+struct GraphCompiler{
+    typedef CompiledNoiseGraph::Instruction Instruction;
+
+    const NoiseGraph& graph;
+    const NoiseContext& noise;
+    std::vector<Instruction>& program;
+    std::vector<float>& points;
+    std::map<std::tuple<NoiseGraph::Node, int, int>, int> emitted;
+    int registerCount = 2;
+
+    // Appends instruction, giving it a new register
+    int Push(Instruction instruction){
+        instruction.dst = registerCount++;
+        program.push_back(instruction);
+        return instruction.dst;
+    }
+
+    // Stores a piecewise function as its base value and, per segment, (start, 1 / width, rise)
+    void PushSegments(Instruction& instruction, const std::vector<float>& xs, const std::vector<float>& ys){
+        instruction.pointsOffset = static_cast<int>(points.size());
+        points.push_back(ys.front());
+        for(std::size_t k = 0; k + 1 < xs.size(); ++k){
+            // Sorted when the module was added
+            const float width = xs[k + 1] - xs[k];
+            points.push_back(xs[k]);
+            // Two points at the same input are a step: a ramp too steep to see
+            points.push_back(width > 0.0f ? 1.0f / width : 1.0e30f);
+            points.push_back(ys[k + 1] - ys[k]);
+        }
+        instruction.pointsCount = static_cast<int>(points.size() - instruction.pointsOffset - 1) / 3;
+    }
+
+    // Emits node at coordinates (x, y) and returns the register holding it
+    int Emit(NoiseGraph::Node node, int x, int y){
+        const NoiseGraph::Module& module = graph.GetModule(node);
+        // Constants do not depend on where they are read
+        if(module.op == NoiseGraph::Op::Constant){
+            x = y = -1;
+        }
+        const std::tuple<NoiseGraph::Node, int, int> key(node, x, y);
+        const auto found = emitted.find(key);
+        if(found != emitted.end()){
+            return found->second;
+        }
+
+        Instruction instruction;
+        instruction.op = module.op;
+        instruction.axis = 0;
+        instruction.dst = -1;
+        instruction.a = instruction.b = instruction.c = -1;
+        instruction.x = instruction.y = -1;
+        std::copy(module.params, module.params + 4, instruction.params);
+        instruction.source = nullptr;
+        instruction.octaves = module.octaves;
+        instruction.pointsOffset = 0;
+        instruction.pointsCount = 0;
+
+        int result = -1;
+        switch(module.op){
+            case NoiseGraph::Op::Constant:
+                result = Push(instruction);
+                break;
+            case NoiseGraph::Op::Fractal:
+            case NoiseGraph::Op::Ridged:
+                instruction.x = x;
+                instruction.y = y;
+                instruction.source = &noise.GetSource(module.backend);
+                result = Push(instruction);
+                break;
+            case NoiseGraph::Op::Curve:
+            case NoiseGraph::Op::Terrace:{
+                instruction.a = Emit(module.inputs[0], x, y);
+                std::vector<float> xs, ys;
+                if(module.op == NoiseGraph::Op::Curve){
+                    for(std::size_t k = 0; k + 1 < module.points.size(); k += 2){
+                        xs.push_back(module.points[k]);
+                        ys.push_back(module.points[k + 1]);
+                    }
+                }else{
+                    xs = ys = module.points;
+                }
+                PushSegments(instruction, xs, ys);
+                result = Push(instruction);
+                break;
+            }
+            case NoiseGraph::Op::Warp:{
+                const int dx = Emit(module.inputs[1], x, y);
+                const int dy = Emit(module.inputs[2], x, y);
+                Instruction warp = instruction;
+                warp.a = x;
+                warp.b = dx;
+                const int warpedX = Push(warp);
+                warp.axis = 1;
+                warp.a = y;
+                warp.b = dy;
+                const int warpedY = Push(warp);
+                result = Emit(module.inputs[0], warpedX, warpedY);
+                break;
+            }
+            default:
+                instruction.a = Emit(module.inputs[0], x, y);
+                if(module.inputs[1] >= 0){
+                    instruction.b = Emit(module.inputs[1], x, y);
+                }
+                if(module.inputs[2] >= 0){
+                    instruction.c = Emit(module.inputs[2], x, y);
+                }
+                result = Push(instruction);
+                break;
+        }
+        emitted[key] = result;
+        return result;
+    }
+};
+
+CompiledNoiseGraph::CompiledNoiseGraph(const NoiseGraph& graph, const NoiseContext& noise) : m_noise(noise){
+    // An empty or invalid graph has nothing to evaluate, it is compiled as 0 everywhere
+    const bool usable = graph.GetOutput() >= 0 && graph.IsValid();
+    NoiseGraph zero;
+    if(!usable){
+        zero.Constant(0.0f);
+    }
+    const NoiseGraph& source = usable ? graph : zero;
+    GraphCompiler compiler{source, m_noise, m_virtual, m_points, {}};
+    m_outputVirtual = compiler.Emit(source.GetOutput(), CoordinateX, CoordinateY);
+    m_virtualCount = compiler.registerCount;
+
+    // Last instruction reading each virtual register. The output is read after the program.
+    const int end = static_cast<int>(m_virtual.size());
+    std::vector<int> lastRead(m_virtualCount, -1);
+    for(int i = 0; i < end; ++i){
+        const Instruction& instruction = m_virtual[i];
+        for(int reg : { instruction.a, instruction.b, instruction.c, instruction.x, instruction.y }){
+            if(reg >= 0){
+                lastRead[reg] = i;
+            }
+        }
+    }
+    lastRead[m_outputVirtual] = end;
+
+    // Linear scan: the destination is picked before the inputs are released, so an
+    // instruction never writes a register it reads and the loops can assume no aliasing
+    std::vector<int> physical(m_virtualCount, -1);
+    std::vector<int> released;
+    physical[CoordinateX] = CoordinateX;
+    physical[CoordinateY] = CoordinateY;
+    m_registerCount = 2;
+    for(int i = 0; i < end; ++i){
+        Instruction instruction = m_virtual[i];
+        int dst;
+        if(!released.empty()){
+            dst = released.back();
+            released.pop_back();
+        }else{
+            dst = m_registerCount++;
+        }
+        physical[instruction.dst] = dst;
+        instruction.dst = dst;
+
+        int* const operands[5] = { &instruction.a, &instruction.b, &instruction.c, &instruction.x, &instruction.y };
+        for(int* operand : operands){
+            if(*operand < 0){
+                continue;
+            }
+            const int virtualRegister = *operand;
+            *operand = physical[virtualRegister];
+            if(lastRead[virtualRegister] == i && std::find(released.begin(), released.end(), *operand) == released.end()){
+                released.push_back(*operand);
+            }
+        }
+        // Nothing reads it (an unused warp coordinate): free it right away
+        if(lastRead[m_virtual[i].dst] < 0){
+            released.push_back(dst);
+        }
+        m_fused.push_back(instruction);
+    }
+    m_outputRegister = physical[m_outputVirtual];
+}
+
+CompiledNoiseGraph::~CompiledNoiseGraph(){
+}
+
+std::size_t CompiledNoiseGraph::GetInstructionCount() const{
+    return m_virtual.size();
+}
+
+std::size_t CompiledNoiseGraph::GetRegisterCount() const{
+    return static_cast<std::size_t>(m_registerCount);
+}
+
+void CompiledNoiseGraph::Execute(const Instruction& instruction, float* const* registers, std::size_t count, float* scratch) const{
+    float* dst = registers[instruction.dst];
+    const float* a = instruction.a >= 0 ? registers[instruction.a] : nullptr;
+    const float* b = instruction.b >= 0 ? registers[instruction.b] : a;
+    const float* c = instruction.c >= 0 ? registers[instruction.c] : a;
+    const float* const params = instruction.params;
+
+    switch(instruction.op){
+        case NoiseGraph::Op::Constant:
+            std::fill(dst, dst + count, params[0]);
+            break;
+        case NoiseGraph::Op::Fractal:
+        case NoiseGraph::Op::Ridged:{
+            const float* x = registers[instruction.x];
+            const float* y = registers[instruction.y];
+            float* sx = scratch;
+            float* sy = scratch + count;
+            float* noise = scratch + 2 * count;
+            float* weight = scratch + 3 * count;
+            const bool ridged = instruction.op == NoiseGraph::Op::Ridged;
+            const float gain = params[1];
+            const float lacunarity = params[2];
+            const float offset = params[3];
+            float frequency = params[0];
+            float amplitude = 1.0f;
+            float amplitudeSum = 0.0f;
+            std::fill(dst, dst + count, 0.0f);
+            std::fill(weight, weight + count, 1.0f);
+            for(int k = 0; k < instruction.octaves; ++k){
+                const float f = frequency;
+                MapSamples(x, x, x, count, sx, [f](float v, float, float){ return v * f; });
+                MapSamples(y, y, y, count, sy, [f](float v, float, float){ return v * f; });
+                instruction.source->Noise2DPoints(sx, sy, count, noise);
+                if(ridged){
+                    RidgedOctave(noise, offset, gain, amplitude, count, weight, dst);
+                    amplitude /= lacunarity;
+                }else{
+                    const float amp = amplitude;
+                    UpdateSamples(noise, count, dst, [amp](float sum, float n){ return sum + n * amp; });
+                    amplitudeSum += amplitude;
+                    amplitude *= gain;
+                }
+                frequency *= lacunarity;
+            }
+            // Ridged: libnoise's rescale to about [-1, 1]. Fractal: divide by the amplitudes.
+            const float scale = ridged ? 1.25f : 1.0f / amplitudeSum;
+            const float bias = ridged ? -1.0f : 0.0f;
+            std::copy(dst, dst + count, sx);
+            MapSamples(sx, sx, sx, count, dst, [scale, bias](float v, float, float){ return v * scale + bias; });
+            break;
+        }
+        case NoiseGraph::Op::Add:
+            MapSamples(a, b, c, count, dst, [](float u, float v, float){ return u + v; });
+            break;
+        case NoiseGraph::Op::Multiply:
+            MapSamples(a, b, c, count, dst, [](float u, float v, float){ return u * v; });
+            break;
+        case NoiseGraph::Op::Min:
+            MapSamples(a, b, c, count, dst, [](float u, float v, float){ return std::min(u, v); });
+            break;
+        case NoiseGraph::Op::Max:
+            MapSamples(a, b, c, count, dst, [](float u, float v, float){ return std::max(u, v); });
+            break;
+        case NoiseGraph::Op::ScaleBias:{
+            const float scale = params[0];
+            const float bias = params[1];
+            MapSamples(a, b, c, count, dst, [scale, bias](float u, float, float){ return u * scale + bias; });
+            break;
+        }
+        case NoiseGraph::Op::Abs:
+            MapSamples(a, b, c, count, dst, [](float u, float, float){ return std::fabs(u); });
+            break;
+        case NoiseGraph::Op::Clamp:{
+            const float lower = params[0];
+            const float upper = params[1];
+            MapSamples(a, b, c, count, dst, [lower, upper](float u, float, float){ return std::min(std::max(u, lower), upper); });
+            break;
+        }
+        case NoiseGraph::Op::Blend:
+            MapSamples(a, b, c, count, dst, [](float u, float v, float mask){
+                const float t = mask * 0.5f + 0.5f;
+                return u + t * (v - u);
+            });
+            break;
+        case NoiseGraph::Op::Select:{
+            // A hard edge is a ramp so steep that anything off the threshold saturates.
+            // The ramp goes through scratch: clamping and using the result in one loop
+            // leaves a branch the compiler does not vectorize.
+            const float lower = params[0] - params[1];
+            const float inverseWidth = params[1] > 0.0f ? 0.5f / params[1] : 1.0e30f;
+            float* ramp = scratch;
+            MapSamples(c, c, c, count, ramp, [lower, inverseWidth](float control, float, float){
+                return Saturate((control - lower) * inverseWidth);
+            });
+            MapSamples(a, b, ramp, count, dst, [](float u, float v, float t){
+                t = t * t * (3.0f - 2.0f * t);
+                return u + t * (v - u);
+            });
+            break;
+        }
+        case NoiseGraph::Op::Curve:
+        case NoiseGraph::Op::Terrace:{
+            // Below segment k it adds nothing, above it adds its whole rise, so summing
+            // every segment needs no search for the one the sample is in
+            const float* segments = &m_points[instruction.pointsOffset];
+            float* ramp = scratch;
+            std::fill(dst, dst + count, segments[0]);
+            const bool terrace = instruction.op == NoiseGraph::Op::Terrace;
+            for(int k = 0; k < instruction.pointsCount; ++k){
+                const float start = segments[1 + 3 * k];
+                const float inverseWidth = segments[2 + 3 * k];
+                const float rise = segments[3 + 3 * k];
+                MapSamples(a, a, a, count, ramp, [start, inverseWidth](float u, float, float){
+                    return Saturate((u - start) * inverseWidth);
+                });
+                if(terrace){
+                    UpdateSamples(ramp, count, dst, [rise](float sum, float t){ return sum + rise * (t * t); });
+                }else{
+                    UpdateSamples(ramp, count, dst, [rise](float sum, float t){ return sum + rise * t; });
+                }
+            }
+            break;
+        }
+        case NoiseGraph::Op::Warp:{
+            const float strength = params[0];
+            MapSamples(a, b, c, count, dst, [strength](float u, float d, float){ return u + strength * d; });
+            break;
+        }
+    }
+}
+
+void CompiledNoiseGraph::EvaluatePoints(const float* xs, const float* ys, std::size_t count, float* out) const{
+    std::vector<float> storage((m_registerCount + ScratchPerSample) * TileSize);
+    std::vector<float*> registers(m_registerCount);
+    for(int r = 0; r < m_registerCount; ++r){
+        registers[r] = &storage[r * TileSize];
+    }
+    float* scratch = &storage[m_registerCount * TileSize];
+
+    for(std::size_t first = 0; first < count; first += TileSize){
+        const std::size_t tile = std::min(TileSize, count - first);
+        std::copy(xs + first, xs + first + tile, registers[CoordinateX]);
+        std::copy(ys + first, ys + first + tile, registers[CoordinateY]);
+        for(const Instruction& instruction : m_fused){
+            Execute(instruction, registers.data(), tile, scratch);
+        }
+        std::copy(registers[m_outputRegister], registers[m_outputRegister] + tile, out + first);
+    }
+}
+
+void CompiledNoiseGraph::EvaluateGrid(float xStart, float yStart, float step, unsigned int width, unsigned int height, float* out) const{
+    std::vector<float> storage((m_registerCount + ScratchPerSample) * TileSize);
+    std::vector<float*> registers(m_registerCount);
+    for(int r = 0; r < m_registerCount; ++r){
+        registers[r] = &storage[r * TileSize];
+    }
+    float* scratch = &storage[m_registerCount * TileSize];
+
+    // Tiles run along the rows and may wrap onto the next one
+    const std::size_t count = static_cast<std::size_t>(width) * height;
+    unsigned int i = 0;
+    unsigned int j = 0;
+    for(std::size_t first = 0; first < count; first += TileSize){
+        const std::size_t tile = std::min(TileSize, count - first);
+        for(std::size_t s = 0; s < tile; ++s){
+            registers[CoordinateX][s] = xStart + i * step;
+            registers[CoordinateY][s] = yStart + j * step;
+            if(++i == width){
+                i = 0;
+                ++j;
+            }
+        }
+        for(const Instruction& instruction : m_fused){
+            Execute(instruction, registers.data(), tile, scratch);
+        }
+        std::copy(registers[m_outputRegister], registers[m_outputRegister] + tile, out + first);
+    }
+}
+
+void CompiledNoiseGraph::EvaluateNodeByNode(const float* xs, const float* ys, std::size_t count, float* out) const{
+    std::vector<std::vector<float>> buffers(m_virtualCount);
+    std::vector<float*> registers(m_virtualCount);
+    buffers[CoordinateX].assign(xs, xs + count);
+    buffers[CoordinateY].assign(ys, ys + count);
+    std::vector<float> scratch(ScratchPerSample * count);
+    for(const Instruction& instruction : m_virtual){
+        buffers[instruction.dst].resize(count);
+    }
+    for(int r = 0; r < m_virtualCount; ++r){
+        registers[r] = buffers[r].data();
+    }
+
+    for(const Instruction& instruction : m_virtual){
+        Execute(instruction, registers.data(), count, scratch.data());
+    }
+    std::copy(buffers[m_outputVirtual].begin(), buffers[m_outputVirtual].end(), out);
+}
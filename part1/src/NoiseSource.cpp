@@ -0,0 +1,44 @@
+#include "NoiseSource.hpp"
+
+// Destructor
+NoiseSource::~NoiseSource(){
+
+}
+
+// Backends without a row kernel evaluate one point at a time
+void NoiseSource::Noise2DRow(float xStart, float xScale, float y, std::size_t count, float* out) const{
+    for(std::size_t i = 0; i < count; ++i){
+        out[i] = Noise2D((xStart + static_cast<float>(i)) * xScale, y);
+    }
+}
+
+void NoiseSource::Noise2DPoints(const float* xs, const float* ys, std::size_t count, float* out) const{
+    for(std::size_t i = 0; i < count; ++i){
+        out[i] = Noise2D(xs[i], ys[i]);
+    }
+}
+
+void NoiseSource::Noise2DRowGradient(float xStart, float xScale, float y, std::size_t count, float* out, float* dx, float* dy) const{
+    for(std::size_t i = 0; i < count; ++i){
+        out[i] = Noise2DGradient((xStart + static_cast<float>(i)) * xScale, y, dx[i], dy[i]);
+    }
+}
+
+const char* NoiseSource::GetBackendName(NoiseBackend backend){
+    switch(backend){
+        case NoiseBackend::Simplex:      return "simplex";
+        case NoiseBackend::HashGradient: return "hash";
+        case NoiseBackend::Worley:       return "worley";
+        default:                         return "perlin";
+    }
+}
+
+bool NoiseSource::ParseBackend(const std::string& name, NoiseBackend& backend){
+    for(int i = 0; i < static_cast<int>(NoiseBackend::Count); ++i){
+        if(name == GetBackendName(static_cast<NoiseBackend>(i))){
+            backend = static_cast<NoiseBackend>(i);
+            return true;
+        }
+    }
+    return false;
+}
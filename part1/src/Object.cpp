@@ -136,3 +136,7 @@ void Object::Render(){
                                                 // nullptr because we are currently bound
 }
 
+// Nothing beyond what the scene node sets
+void Object::SetUniforms(Shader& shader){
+
+}
@@ -0,0 +1,122 @@
+#include "OctaveCache.hpp"
+
+#include <tuple>
+
+OctavePlanes::OctavePlanes(int octaveCount, unsigned int chunkSize) :
+    m_octaveCount(octaveCount), m_chunkSize(chunkSize),
+    m_data(static_cast<std::size_t>(3 * octaveCount) * chunkSize * chunkSize),
+    m_strides(octaveCount, 1){
+
+}
+
+bool OctavePlanes::IsWithinStrides(const std::vector<unsigned int>& strides) const{
+    for(int i = 0; i < m_octaveCount; ++i){
+        const unsigned int allowed = i < static_cast<int>(strides.size()) ? strides[i] : 1;
+        if(m_strides[i] > allowed){
+            return false;
+        }
+    }
+    return true;
+}
+
+bool OctaveCache::Key::operator<(const Key& other) const{
+    return std::tie(seed, backend, frequency, chunkSize, xOffset, zOffset, octaveCount, gridStride)
+         < std::tie(other.seed, other.backend, other.frequency, other.chunkSize, other.xOffset, other.zOffset, other.octaveCount, other.gridStride);
+}
+
+// Constructor
+OctaveCache::OctaveCache(std::size_t maxBytes) : m_maxBytes(maxBytes){
+
+}
+
+// Destructor
+OctaveCache::~OctaveCache(){
+
+}
+
+std::shared_ptr<const OctavePlanes> OctaveCache::Find(const Key& key){
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_index.find(key);
+    if(it == m_index.end()){
+        ++m_misses;
+        return nullptr;
+    }
+    ++m_hits;
+    // Move it to the front
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return it->second->second;
+}
+
+void OctaveCache::Insert(const Key& key, std::shared_ptr<const OctavePlanes> planes){
+    if(planes == nullptr){
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const std::size_t bytes = planes->GetBytes();
+    if(bytes > m_maxBytes){
+        return;
+    }
+
+    // Replace an older copy of the same chunk
+    auto it = m_index.find(key);
+    if(it != m_index.end()){
+        m_bytes -= it->second->second->GetBytes();
+        m_entries.erase(it->second);
+        m_index.erase(it);
+    }
+
+    EvictTo(m_maxBytes - bytes);
+    m_entries.emplace_front(key, std::move(planes));
+    m_index[key] = m_entries.begin();
+    m_bytes += bytes;
+}
+
+void OctaveCache::Clear(){
+    std::lock_guard<std::mutex> lock(m_mutex);
+    EvictTo(0);
+}
+
+void OctaveCache::SetMaxBytes(std::size_t maxBytes){
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_maxBytes = maxBytes;
+    EvictTo(m_maxBytes);
+}
+
+std::size_t OctaveCache::GetMaxBytes() const{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_maxBytes;
+}
+
+std::size_t OctaveCache::GetBytes() const{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_bytes;
+}
+
+std::size_t OctaveCache::GetEntryCount() const{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
+
+std::size_t OctaveCache::GetHits() const{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_hits;
+}
+
+std::size_t OctaveCache::GetMisses() const{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_misses;
+}
+
+OctaveCache::Key OctaveCache::MakeKey(const NoiseSettings& settings, float frequency, unsigned int chunkSize, float xOffset, float zOffset, int octaveCount,
+                                      unsigned int gridStride){
+    return Key{ settings.seed, settings.backend, frequency, chunkSize, xOffset, zOffset, octaveCount, gridStride };
+}
+
+void OctaveCache::EvictTo(std::size_t maxBytes){
+    // Chunks still in use keep their planes alive through the shared_ptr
+    while(m_bytes > maxBytes && !m_entries.empty()){
+        m_bytes -= m_entries.back().second->GetBytes();
+        m_index.erase(m_entries.back().first);
+        m_entries.pop_back();
+    }
+}
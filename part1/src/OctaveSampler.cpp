@@ -0,0 +1,163 @@
+#include "OctaveSampler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// Points lerped together, so the inner loop has a fixed trip count the compiler can vectorize
+static constexpr std::size_t BlockSize = 8;
+
+// out[x] = row0[x] + t * (row1[x] - row0[x])
+static void LerpRow(const float* __restrict row0, const float* __restrict row1, float t, std::size_t count, float* __restrict out){
+    std::size_t x = 0;
+    for(; x + BlockSize <= count; x += BlockSize){
+        for(std::size_t b = 0; b < BlockSize; ++b){
+            out[x + b] = row0[x + b] + t * (row1[x + b] - row0[x + b]);
+        }
+    }
+    for(; x < count; ++x){
+        out[x] = row0[x] + t * (row1[x] - row0[x]);
+    }
+}
+
+// Worst bilinear error over h * h, measured on 20000 cells for h from 1/16 to 1/2
+// (./lab --bench prints the measured error next to these), rounded up
+float GetInterpolationErrorScale(NoiseBackend backend){
+    switch(backend){
+        case NoiseBackend::Simplex:      return 10.0f;
+        case NoiseBackend::HashGradient: return 2.5f;
+        // F1 has creases and cones, so the h * h model only holds roughly
+        case NoiseBackend::Worley:       return 20.0f;
+        default:                         return 2.5f;
+    }
+}
+
+std::vector<unsigned int> ChooseOctaveStrides(const siv::BasicFractalLayers<float>& layers, NoiseBackend backend,
+                                              float scale, float tolerance, unsigned int chunkSize){
+    const int octaveCount = layers.sampleCount();
+    std::vector<unsigned int> strides(octaveCount, 1);
+    if(tolerance <= 0.0f || layers.layerCount() == 0){
+        return strides;
+    }
+
+    // How much an error in each octave moves the height: the weights it is summed
+    // with, times the slope of the remap (1/2), over the sum of the amplitudes
+    std::vector<float> influence(octaveCount, 0.0f);
+    for(int i = 0; i < layers.layerCount(); ++i){
+        for(int k = 0; k < layers.startOctave() + i; ++k){
+            influence[i + k] += 0.5f * std::fabs(layers.amplitude(i) * layers.weight(i, k));
+        }
+    }
+
+    // The octaves that could be interpolated at all (nodes two vertices apart still within
+    // half a noise cell) get an equal share of the tolerance. The others are not smooth over
+    // even two vertices, so they are always sampled at every vertex.
+    int smoothOctaves = 0;
+    for(int i = 0; i < octaveCount; ++i){
+        smoothOctaves += (2.0f * std::ldexp(scale, i) <= 0.5f) ? 1 : 0;
+    }
+    if(smoothOctaves == 0){
+        return strides;
+    }
+    const float errorScale = GetInterpolationErrorScale(backend);
+    const float octaveTolerance = tolerance / smoothOctaves;
+    float octaveScale = scale;
+    for(int i = 0; i < octaveCount; ++i){
+        const float allowed = octaveTolerance * layers.weightSum() / std::max(influence[i], 1.0e-12f);
+        // Largest node spacing h (in noise units) with errorScale * h * h <= allowed
+        const float spacing = std::sqrt(allowed / errorScale);
+        unsigned int stride = 1;
+        while(stride < MaxOctaveStride && 2 * stride < chunkSize && 2 * stride * octaveScale <= spacing){
+            stride *= 2;
+        }
+        strides[i] = stride;
+        octaveScale *= 2.0f;
+    }
+    return strides;
+}
+
+OctaveRowSampler::OctaveRowSampler(const NoiseSource& source, float xOffset, float zOffset, float scale,
+                                   const std::vector<unsigned int>& strides, unsigned int chunkSize) :
+    m_source(source), m_xOffset(xOffset), m_zOffset(zOffset), m_chunkSize(chunkSize),
+    m_octaveScales(strides.size()), m_octaves(strides.size()){
+    float octaveScale = scale;
+    for(std::size_t i = 0; i < strides.size(); ++i){
+        m_octaveScales[i] = octaveScale;
+        octaveScale *= 2.0f;
+
+        CoarseOctave& octave = m_octaves[i];
+        octave.stride = std::max(strides[i], 1u);
+        if(octave.stride > 1){
+            // Nodes every stride vertices, plus one past the edge when the chunk does not end on a node
+            octave.nodes = (chunkSize - 1 + octave.stride - 1) / octave.stride + 1;
+            octave.nodeRows.resize(6 * static_cast<std::size_t>(chunkSize));
+            octave.nodes3.resize(3 * static_cast<std::size_t>(octave.nodes));
+        }
+    }
+}
+
+void OctaveRowSampler::SampleNodeRow(int octave, unsigned int k, int slot){
+    CoarseOctave& coarse = m_octaves[octave];
+    const unsigned int nodes = coarse.nodes;
+    float* values = coarse.nodes3.data();
+    // The stride is a power of two, so the node coordinates round exactly like the vertex ones
+    const float octaveScale = m_octaveScales[octave];
+    m_source.Noise2DRowGradient(m_xOffset / coarse.stride, coarse.stride * octaveScale, (k * coarse.stride + m_zOffset) * octaveScale,
+                                nodes, values, values + nodes, values + 2 * nodes);
+    m_evaluations += nodes;
+
+    // Fill the vertices between each pair of nodes
+    const float inverseStride = 1.0f / coarse.stride;
+    for(int p = 0; p < 3; ++p){
+        const float* line = values + p * nodes;
+        float* out = &coarse.nodeRows[static_cast<std::size_t>(3 * slot + p) * m_chunkSize];
+        for(unsigned int j = 0; j + 1 < nodes; ++j){
+            const float a = line[j];
+            const float slope = (line[j + 1] - a) * inverseStride;
+            const unsigned int first = j * coarse.stride;
+            const unsigned int count = std::min(coarse.stride, m_chunkSize - first);
+            for(unsigned int q = 0; q < count; ++q){
+                out[first + q] = a + slope * q;
+            }
+        }
+        // The last vertex is a node when the chunk ends on one
+        if((m_chunkSize - 1) % coarse.stride == 0){
+            out[m_chunkSize - 1] = line[nodes - 1];
+        }
+    }
+}
+
+void OctaveRowSampler::SampleRow(unsigned int z, float* const* rows, float* const* dxRows, float* const* dyRows){
+    for(std::size_t i = 0; i < m_octaves.size(); ++i){
+        CoarseOctave& octave = m_octaves[i];
+        if(octave.stride == 1){
+            m_source.Noise2DRowGradient(m_xOffset, m_octaveScales[i], (z + m_zOffset) * m_octaveScales[i], m_chunkSize, rows[i], dxRows[i], dyRows[i]);
+            m_evaluations += m_chunkSize;
+            continue;
+        }
+
+        // Bring node rows k and k + 1 into the slots, usually by moving down one:
+        // the upper slot becomes the lower one and only k + 1 is sampled
+        const unsigned int k = z / octave.stride;
+        if(!octave.primed || k != octave.firstNode){
+            if(octave.primed && k == octave.firstNode + 1){
+                octave.lowerSlot ^= 1;
+            }else{
+                SampleNodeRow(static_cast<int>(i), k, octave.lowerSlot);
+            }
+            SampleNodeRow(static_cast<int>(i), k + 1, octave.lowerSlot ^ 1);
+            octave.firstNode = k;
+            octave.primed = true;
+        }
+
+        // One lerp between the node rows
+        const float t = (z - k * octave.stride) / static_cast<float>(octave.stride);
+        float* const outputs[3] = { rows[i], dxRows[i], dyRows[i] };
+        const std::size_t lower = static_cast<std::size_t>(3 * octave.lowerSlot) * m_chunkSize;
+        const std::size_t upper = static_cast<std::size_t>(3 * (octave.lowerSlot ^ 1)) * m_chunkSize;
+        for(int p = 0; p < 3; ++p){
+            const float* row0 = &octave.nodeRows[lower + static_cast<std::size_t>(p) * m_chunkSize];
+            const float* row1 = &octave.nodeRows[upper + static_cast<std::size_t>(p) * m_chunkSize];
+            LerpRow(row0, row1, t, m_chunkSize, outputs[p]);
+        }
+    }
+}
@@ -0,0 +1,662 @@
+#include "PerlinNoiseBatch.hpp"
+#include "NoiseMath.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    #define PERLINBATCH_X86
+    #include <immintrin.h>
+    // Lets us compile each kernel for its own instruction set,
+    // while the rest of the program stays at the baseline.
+    #define PERLINBATCH_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+// ========================= Scalar kernel =========================
+// A float copy of siv::BasicPerlinNoise::noise2D, used on other
+// platforms and for the samples left over at the end of a row.
+
+using namespace NoiseMath;
+
+static inline float Grad2D(std::int32_t hash, float x, float y){
+    const std::int32_t h = hash & 7;
+    const float u = h < 6 ? x : y;
+    const float v = h < 4 ? y : 0.0f;
+    return ((h & 1) == 0 ? u : -u) + ((h & 2) == 0 ? v : -v);
+}
+
+static inline float ScalarNoise2D(const std::int32_t* perm, float x, float y){
+    const std::int32_t _x = FastFloor(x);
+    const std::int32_t _y = FastFloor(y);
+
+    const std::int32_t ix = _x & 255;
+    const std::int32_t iy = _y & 255;
+
+    const float fx = x - static_cast<float>(_x);
+    const float fy = y - static_cast<float>(_y);
+
+    const float u = Fade(fx);
+    const float v = Fade(fy);
+
+    const std::int32_t A = perm[ix] + iy;
+    const std::int32_t B = perm[ix + 1] + iy;
+
+    const float p0 = Grad2D(perm[A], fx, fy);
+    const float p1 = Grad2D(perm[B], fx - 1.0f, fy);
+    const float p2 = Grad2D(perm[A + 1], fx, fy - 1.0f);
+    const float p3 = Grad2D(perm[B + 1], fx - 1.0f, fy - 1.0f);
+
+    return Lerp(Lerp(p0, p1, u), Lerp(p2, p3, u), v);
+}
+
+static inline float FadeDerivative(float t){
+    return t * t * (t * (t * 30.0f - 60.0f) + 30.0f);
+}
+
+// ScalarNoise2D plus its derivatives, see siv::BasicPerlinNoise::noise2DGradient
+static inline float ScalarNoise2DGradient(const std::int32_t* perm, float x, float y, float& dx, float& dy){
+    const std::int32_t _x = FastFloor(x);
+    const std::int32_t _y = FastFloor(y);
+
+    const std::int32_t ix = _x & 255;
+    const std::int32_t iy = _y & 255;
+
+    const float fx = x - static_cast<float>(_x);
+    const float fy = y - static_cast<float>(_y);
+
+    const float u = Fade(fx);
+    const float v = Fade(fy);
+
+    const std::int32_t A = perm[ix] + iy;
+    const std::int32_t B = perm[ix + 1] + iy;
+
+    const std::int32_t h0 = perm[A], h1 = perm[B], h2 = perm[A + 1], h3 = perm[B + 1];
+
+    const float p0 = Grad2D(h0, fx, fy);
+    const float p1 = Grad2D(h1, fx - 1.0f, fy);
+    const float p2 = Grad2D(h2, fx, fy - 1.0f);
+    const float p3 = Grad2D(h3, fx - 1.0f, fy - 1.0f);
+
+    const float q0 = Lerp(p0, p1, u);
+    const float q1 = Lerp(p2, p3, u);
+
+    dx = Lerp(Lerp(Grad2D(h0, 1.0f, 0.0f), Grad2D(h1, 1.0f, 0.0f), u), Lerp(Grad2D(h2, 1.0f, 0.0f), Grad2D(h3, 1.0f, 0.0f), u), v)
+       + FadeDerivative(fx) * Lerp(p1 - p0, p3 - p2, v);
+    dy = Lerp(Lerp(Grad2D(h0, 0.0f, 1.0f), Grad2D(h1, 0.0f, 1.0f), u), Lerp(Grad2D(h2, 0.0f, 1.0f), Grad2D(h3, 0.0f, 1.0f), u), v)
+       + FadeDerivative(fy) * (q1 - q0);
+
+    return Lerp(q0, q1, v);
+}
+
+static void ScalarRow(const std::int32_t* perm, float xStart, float xScale, float y, std::size_t begin, std::size_t count, float* out){
+    for(std::size_t i = begin; i < count; ++i){
+        out[i] = ScalarNoise2D(perm, (xStart + static_cast<float>(i)) * xScale, y);
+    }
+}
+
+static void ScalarPoints(const std::int32_t* perm, const float* xs, const float* ys, std::size_t begin, std::size_t count, float* out){
+    for(std::size_t i = begin; i < count; ++i){
+        out[i] = ScalarNoise2D(perm, xs[i], ys[i]);
+    }
+}
+
+static void ScalarRowGradient(const std::int32_t* perm, float xStart, float xScale, float y, std::size_t begin, std::size_t count, float* out, float* dx, float* dy){
+    for(std::size_t i = begin; i < count; ++i){
+        out[i] = ScalarNoise2DGradient(perm, (xStart + static_cast<float>(i)) * xScale, y, dx[i], dy[i]);
+    }
+}
+
+#ifdef PERLINBATCH_X86
+
+// ========================= SSE2 kernel (4 lanes) =========================
+// SSE2 has no gather, floor or blend, so those are done by hand.
+
+PERLINBATCH_TARGET("sse2")
+static inline __m128 Floor4(__m128 x){
+    const __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(x));
+    return _mm_sub_ps(t, _mm_and_ps(_mm_cmplt_ps(x, t), _mm_set1_ps(1.0f)));
+}
+
+PERLINBATCH_TARGET("sse2")
+static inline __m128i Gather4(const std::int32_t* perm, __m128i index){
+    alignas(16) std::int32_t i[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(i), index);
+    return _mm_set_epi32(perm[i[3]], perm[i[2]], perm[i[1]], perm[i[0]]);
+}
+
+PERLINBATCH_TARGET("sse2")
+static inline __m128 Fade4(__m128 t){
+    __m128 r = _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.0f)), _mm_set1_ps(15.0f));
+    r = _mm_add_ps(_mm_mul_ps(t, r), _mm_set1_ps(10.0f));
+    return _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(t, t), t), r);
+}
+
+PERLINBATCH_TARGET("sse2")
+static inline __m128 Lerp4(__m128 a, __m128 b, __m128 t){
+    return _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t));
+}
+
+PERLINBATCH_TARGET("sse2")
+static inline __m128 Grad4(__m128i hash, __m128 x, __m128 y){
+    const __m128i h = _mm_and_si128(hash, _mm_set1_epi32(7));
+    const __m128 lt6 = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(6)));
+    const __m128 lt4 = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(4)));
+    const __m128 u = _mm_or_ps(_mm_and_ps(lt6, x), _mm_andnot_ps(lt6, y));
+    const __m128 v = _mm_and_ps(lt4, y);
+    const __m128 signU = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(1)), 31));
+    const __m128 signV = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(2)), 30));
+    return _mm_add_ps(_mm_xor_ps(u, signU), _mm_xor_ps(v, signV));
+}
+
+PERLINBATCH_TARGET("sse2")
+static inline __m128 Noise4(const std::int32_t* perm, __m128 x, __m128 y){
+    const __m128 xf = Floor4(x);
+    const __m128 yf = Floor4(y);
+    const __m128i mask = _mm_set1_epi32(255);
+    const __m128i one = _mm_set1_epi32(1);
+
+    const __m128i ix = _mm_and_si128(_mm_cvttps_epi32(xf), mask);
+    const __m128i iy = _mm_and_si128(_mm_cvttps_epi32(yf), mask);
+
+    const __m128 fx = _mm_sub_ps(x, xf);
+    const __m128 fy = _mm_sub_ps(y, yf);
+    const __m128 fx1 = _mm_sub_ps(fx, _mm_set1_ps(1.0f));
+    const __m128 fy1 = _mm_sub_ps(fy, _mm_set1_ps(1.0f));
+
+    const __m128i A = _mm_add_epi32(Gather4(perm, ix), iy);
+    const __m128i B = _mm_add_epi32(Gather4(perm, _mm_add_epi32(ix, one)), iy);
+
+    const __m128 p0 = Grad4(Gather4(perm, A), fx, fy);
+    const __m128 p1 = Grad4(Gather4(perm, B), fx1, fy);
+    const __m128 p2 = Grad4(Gather4(perm, _mm_add_epi32(A, one)), fx, fy1);
+    const __m128 p3 = Grad4(Gather4(perm, _mm_add_epi32(B, one)), fx1, fy1);
+
+    const __m128 u = Fade4(fx);
+    return Lerp4(Lerp4(p0, p1, u), Lerp4(p2, p3, u), Fade4(fy));
+}
+
+PERLINBATCH_TARGET("sse2")
+static inline __m128 FadeDerivative4(__m128 t){
+    __m128 r = _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(30.0f)), _mm_set1_ps(60.0f));
+    r = _mm_add_ps(_mm_mul_ps(t, r), _mm_set1_ps(30.0f));
+    return _mm_mul_ps(_mm_mul_ps(t, t), r);
+}
+
+// Noise4 plus its derivatives
+PERLINBATCH_TARGET("sse2")
+static inline __m128 NoiseGradient4(const std::int32_t* perm, __m128 x, __m128 y, __m128& dx, __m128& dy){
+    const __m128 xf = Floor4(x);
+    const __m128 yf = Floor4(y);
+    const __m128i mask = _mm_set1_epi32(255);
+    const __m128i one = _mm_set1_epi32(1);
+
+    const __m128i ix = _mm_and_si128(_mm_cvttps_epi32(xf), mask);
+    const __m128i iy = _mm_and_si128(_mm_cvttps_epi32(yf), mask);
+
+    const __m128 fx = _mm_sub_ps(x, xf);
+    const __m128 fy = _mm_sub_ps(y, yf);
+    const __m128 fx1 = _mm_sub_ps(fx, _mm_set1_ps(1.0f));
+    const __m128 fy1 = _mm_sub_ps(fy, _mm_set1_ps(1.0f));
+
+    const __m128i A = _mm_add_epi32(Gather4(perm, ix), iy);
+    const __m128i B = _mm_add_epi32(Gather4(perm, _mm_add_epi32(ix, one)), iy);
+
+    const __m128i h0 = Gather4(perm, A);
+    const __m128i h1 = Gather4(perm, B);
+    const __m128i h2 = Gather4(perm, _mm_add_epi32(A, one));
+    const __m128i h3 = Gather4(perm, _mm_add_epi32(B, one));
+
+    const __m128 p0 = Grad4(h0, fx, fy);
+    const __m128 p1 = Grad4(h1, fx1, fy);
+    const __m128 p2 = Grad4(h2, fx, fy1);
+    const __m128 p3 = Grad4(h3, fx1, fy1);
+
+    const __m128 u = Fade4(fx);
+    const __m128 v = Fade4(fy);
+    const __m128 q0 = Lerp4(p0, p1, u);
+    const __m128 q1 = Lerp4(p2, p3, u);
+
+    // The gradient vectors, Grad4(h, 1, 0) and Grad4(h, 0, 1)
+    const __m128 o = _mm_set1_ps(1.0f);
+    const __m128 z = _mm_setzero_ps();
+    dx = _mm_add_ps(Lerp4(Lerp4(Grad4(h0, o, z), Grad4(h1, o, z), u), Lerp4(Grad4(h2, o, z), Grad4(h3, o, z), u), v),
+                    _mm_mul_ps(FadeDerivative4(fx), Lerp4(_mm_sub_ps(p1, p0), _mm_sub_ps(p3, p2), v)));
+    dy = _mm_add_ps(Lerp4(Lerp4(Grad4(h0, z, o), Grad4(h1, z, o), u), Lerp4(Grad4(h2, z, o), Grad4(h3, z, o), u), v),
+                    _mm_mul_ps(FadeDerivative4(fy), _mm_sub_ps(q1, q0)));
+
+    return Lerp4(q0, q1, v);
+}
+
+PERLINBATCH_TARGET("sse2")
+static void SSE2Row(const std::int32_t* perm, float xStart, float xScale, float y, std::size_t count, float* out){
+    const __m128 start = _mm_set1_ps(xStart);
+    const __m128 scale = _mm_set1_ps(xScale);
+    const __m128 vy = _mm_set1_ps(y);
+    std::size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        const __m128 index = _mm_cvtepi32_ps(_mm_add_epi32(_mm_set1_epi32((std::int32_t)i), _mm_set_epi32(3, 2, 1, 0)));
+        const __m128 x = _mm_mul_ps(_mm_add_ps(start, index), scale);
+        _mm_storeu_ps(out + i, Noise4(perm, x, vy));
+    }
+    ScalarRow(perm, xStart, xScale, y, i, count, out);
+}
+
+PERLINBATCH_TARGET("sse2")
+static void SSE2Points(const std::int32_t* perm, const float* xs, const float* ys, std::size_t count, float* out){
+    std::size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        _mm_storeu_ps(out + i, Noise4(perm, _mm_loadu_ps(xs + i), _mm_loadu_ps(ys + i)));
+    }
+    ScalarPoints(perm, xs, ys, i, count, out);
+}
+
+PERLINBATCH_TARGET("sse2")
+static void SSE2RowGradient(const std::int32_t* perm, float xStart, float xScale, float y, std::size_t count, float* out, float* dx, float* dy){
+    const __m128 start = _mm_set1_ps(xStart);
+    const __m128 scale = _mm_set1_ps(xScale);
+    const __m128 vy = _mm_set1_ps(y);
+    std::size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        const __m128 index = _mm_cvtepi32_ps(_mm_add_epi32(_mm_set1_epi32((std::int32_t)i), _mm_set_epi32(3, 2, 1, 0)));
+        const __m128 x = _mm_mul_ps(_mm_add_ps(start, index), scale);
+        __m128 gx, gy;
+        _mm_storeu_ps(out + i, NoiseGradient4(perm, x, vy, gx, gy));
+        _mm_storeu_ps(dx + i, gx);
+        _mm_storeu_ps(dy + i, gy);
+    }
+    ScalarRowGradient(perm, xStart, xScale, y, i, count, out, dx, dy);
+}
+
+// ========================= AVX2 kernel (8 lanes) =========================
+
+PERLINBATCH_TARGET("avx2")
+static inline __m256 Fade8(__m256 t){
+    __m256 r = _mm256_sub_ps(_mm256_mul_ps(t, _mm256_set1_ps(6.0f)), _mm256_set1_ps(15.0f));
+    r = _mm256_add_ps(_mm256_mul_ps(t, r), _mm256_set1_ps(10.0f));
+    return _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(t, t), t), r);
+}
+
+PERLINBATCH_TARGET("avx2")
+static inline __m256 Lerp8(__m256 a, __m256 b, __m256 t){
+    return _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), t));
+}
+
+PERLINBATCH_TARGET("avx2")
+static inline __m256 Grad8(__m256i hash, __m256 x, __m256 y){
+    const __m256i h = _mm256_and_si256(hash, _mm256_set1_epi32(7));
+    const __m256 lt6 = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(6), h));
+    const __m256 lt4 = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(4), h));
+    const __m256 u = _mm256_blendv_ps(y, x, lt6);
+    const __m256 v = _mm256_and_ps(lt4, y);
+    const __m256 signU = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(1)), 31));
+    const __m256 signV = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(2)), 30));
+    return _mm256_add_ps(_mm256_xor_ps(u, signU), _mm256_xor_ps(v, signV));
+}
+
+PERLINBATCH_TARGET("avx2")
+static inline __m256 Noise8(const std::int32_t* perm, __m256 x, __m256 y){
+    const __m256 xf = _mm256_floor_ps(x);
+    const __m256 yf = _mm256_floor_ps(y);
+    const __m256i mask = _mm256_set1_epi32(255);
+    const __m256i one = _mm256_set1_epi32(1);
+
+    const __m256i ix = _mm256_and_si256(_mm256_cvttps_epi32(xf), mask);
+    const __m256i iy = _mm256_and_si256(_mm256_cvttps_epi32(yf), mask);
+
+    const __m256 fx = _mm256_sub_ps(x, xf);
+    const __m256 fy = _mm256_sub_ps(y, yf);
+    const __m256 fx1 = _mm256_sub_ps(fx, _mm256_set1_ps(1.0f));
+    const __m256 fy1 = _mm256_sub_ps(fy, _mm256_set1_ps(1.0f));
+
+    const __m256i A = _mm256_add_epi32(_mm256_i32gather_epi32(perm, ix, 4), iy);
+    const __m256i B = _mm256_add_epi32(_mm256_i32gather_epi32(perm, _mm256_add_epi32(ix, one), 4), iy);
+
+    const __m256 p0 = Grad8(_mm256_i32gather_epi32(perm, A, 4), fx, fy);
+    const __m256 p1 = Grad8(_mm256_i32gather_epi32(perm, B, 4), fx1, fy);
+    const __m256 p2 = Grad8(_mm256_i32gather_epi32(perm, _mm256_add_epi32(A, one), 4), fx, fy1);
+    const __m256 p3 = Grad8(_mm256_i32gather_epi32(perm, _mm256_add_epi32(B, one), 4), fx1, fy1);
+
+    const __m256 u = Fade8(fx);
+    return Lerp8(Lerp8(p0, p1, u), Lerp8(p2, p3, u), Fade8(fy));
+}
+
+PERLINBATCH_TARGET("avx2")
+static inline __m256 FadeDerivative8(__m256 t){
+    __m256 r = _mm256_sub_ps(_mm256_mul_ps(t, _mm256_set1_ps(30.0f)), _mm256_set1_ps(60.0f));
+    r = _mm256_add_ps(_mm256_mul_ps(t, r), _mm256_set1_ps(30.0f));
+    return _mm256_mul_ps(_mm256_mul_ps(t, t), r);
+}
+
+// Noise8 plus its derivatives
+PERLINBATCH_TARGET("avx2")
+static inline __m256 NoiseGradient8(const std::int32_t* perm, __m256 x, __m256 y, __m256& dx, __m256& dy){
+    const __m256 xf = _mm256_floor_ps(x);
+    const __m256 yf = _mm256_floor_ps(y);
+    const __m256i mask = _mm256_set1_epi32(255);
+    const __m256i one = _mm256_set1_epi32(1);
+
+    const __m256i ix = _mm256_and_si256(_mm256_cvttps_epi32(xf), mask);
+    const __m256i iy = _mm256_and_si256(_mm256_cvttps_epi32(yf), mask);
+
+    const __m256 fx = _mm256_sub_ps(x, xf);
+    const __m256 fy = _mm256_sub_ps(y, yf);
+    const __m256 fx1 = _mm256_sub_ps(fx, _mm256_set1_ps(1.0f));
+    const __m256 fy1 = _mm256_sub_ps(fy, _mm256_set1_ps(1.0f));
+
+    const __m256i A = _mm256_add_epi32(_mm256_i32gather_epi32(perm, ix, 4), iy);
+    const __m256i B = _mm256_add_epi32(_mm256_i32gather_epi32(perm, _mm256_add_epi32(ix, one), 4), iy);
+
+    const __m256i h0 = _mm256_i32gather_epi32(perm, A, 4);
+    const __m256i h1 = _mm256_i32gather_epi32(perm, B, 4);
+    const __m256i h2 = _mm256_i32gather_epi32(perm, _mm256_add_epi32(A, one), 4);
+    const __m256i h3 = _mm256_i32gather_epi32(perm, _mm256_add_epi32(B, one), 4);
+
+    const __m256 p0 = Grad8(h0, fx, fy);
+    const __m256 p1 = Grad8(h1, fx1, fy);
+    const __m256 p2 = Grad8(h2, fx, fy1);
+    const __m256 p3 = Grad8(h3, fx1, fy1);
+
+    const __m256 u = Fade8(fx);
+    const __m256 v = Fade8(fy);
+    const __m256 q0 = Lerp8(p0, p1, u);
+    const __m256 q1 = Lerp8(p2, p3, u);
+
+    // The gradient vectors, Grad8(h, 1, 0) and Grad8(h, 0, 1)
+    const __m256 o = _mm256_set1_ps(1.0f);
+    const __m256 z = _mm256_setzero_ps();
+    dx = _mm256_add_ps(Lerp8(Lerp8(Grad8(h0, o, z), Grad8(h1, o, z), u), Lerp8(Grad8(h2, o, z), Grad8(h3, o, z), u), v),
+                       _mm256_mul_ps(FadeDerivative8(fx), Lerp8(_mm256_sub_ps(p1, p0), _mm256_sub_ps(p3, p2), v)));
+    dy = _mm256_add_ps(Lerp8(Lerp8(Grad8(h0, z, o), Grad8(h1, z, o), u), Lerp8(Grad8(h2, z, o), Grad8(h3, z, o), u), v),
+                       _mm256_mul_ps(FadeDerivative8(fy), _mm256_sub_ps(q1, q0)));
+
+    return Lerp8(q0, q1, v);
+}
+
+PERLINBATCH_TARGET("avx2")
+static void AVX2RowGradient(const std::int32_t* perm, float xStart, float xScale, float y, std::size_t count, float* out, float* dx, float* dy){
+    const __m256 start = _mm256_set1_ps(xStart);
+    const __m256 scale = _mm256_set1_ps(xScale);
+    const __m256 vy = _mm256_set1_ps(y);
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    std::size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        const __m256 index = _mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_set1_epi32((std::int32_t)i), lanes));
+        const __m256 x = _mm256_mul_ps(_mm256_add_ps(start, index), scale);
+        __m256 gx, gy;
+        _mm256_storeu_ps(out + i, NoiseGradient8(perm, x, vy, gx, gy));
+        _mm256_storeu_ps(dx + i, gx);
+        _mm256_storeu_ps(dy + i, gy);
+    }
+    ScalarRowGradient(perm, xStart, xScale, y, i, count, out, dx, dy);
+}
+
+PERLINBATCH_TARGET("avx2")
+static void AVX2Row(const std::int32_t* perm, float xStart, float xScale, float y, std::size_t count, float* out){
+    const __m256 start = _mm256_set1_ps(xStart);
+    const __m256 scale = _mm256_set1_ps(xScale);
+    const __m256 vy = _mm256_set1_ps(y);
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    std::size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        const __m256 index = _mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_set1_epi32((std::int32_t)i), lanes));
+        const __m256 x = _mm256_mul_ps(_mm256_add_ps(start, index), scale);
+        _mm256_storeu_ps(out + i, Noise8(perm, x, vy));
+    }
+    ScalarRow(perm, xStart, xScale, y, i, count, out);
+}
+
+PERLINBATCH_TARGET("avx2")
+static void AVX2Points(const std::int32_t* perm, const float* xs, const float* ys, std::size_t count, float* out){
+    std::size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        _mm256_storeu_ps(out + i, Noise8(perm, _mm256_loadu_ps(xs + i), _mm256_loadu_ps(ys + i)));
+    }
+    ScalarPoints(perm, xs, ys, i, count, out);
+}
+
+// ========================= AVX-512 kernel (16 lanes) =========================
+
+PERLINBATCH_TARGET("avx512f")
+static inline __m512 Fade16(__m512 t){
+    __m512 r = _mm512_sub_ps(_mm512_mul_ps(t, _mm512_set1_ps(6.0f)), _mm512_set1_ps(15.0f));
+    r = _mm512_add_ps(_mm512_mul_ps(t, r), _mm512_set1_ps(10.0f));
+    return _mm512_mul_ps(_mm512_mul_ps(_mm512_mul_ps(t, t), t), r);
+}
+
+PERLINBATCH_TARGET("avx512f")
+static inline __m512 Lerp16(__m512 a, __m512 b, __m512 t){
+    return _mm512_add_ps(a, _mm512_mul_ps(_mm512_sub_ps(b, a), t));
+}
+
+PERLINBATCH_TARGET("avx512f")
+static inline __m512 Grad16(__m512i hash, __m512 x, __m512 y){
+    const __m512i h = _mm512_and_si512(hash, _mm512_set1_epi32(7));
+    const __mmask16 lt6 = _mm512_cmplt_epi32_mask(h, _mm512_set1_epi32(6));
+    const __mmask16 lt4 = _mm512_cmplt_epi32_mask(h, _mm512_set1_epi32(4));
+    const __m512i u = _mm512_castps_si512(_mm512_mask_blend_ps(lt6, y, x));
+    const __m512i v = _mm512_castps_si512(_mm512_maskz_mov_ps(lt4, y));
+    const __m512i signU = _mm512_slli_epi32(_mm512_and_si512(h, _mm512_set1_epi32(1)), 31);
+    const __m512i signV = _mm512_slli_epi32(_mm512_and_si512(h, _mm512_set1_epi32(2)), 30);
+    return _mm512_add_ps(_mm512_castsi512_ps(_mm512_xor_si512(u, signU)), _mm512_castsi512_ps(_mm512_xor_si512(v, signV)));
+}
+
+PERLINBATCH_TARGET("avx512f")
+static inline __m512 Noise16(const std::int32_t* perm, __m512 x, __m512 y){
+    const __m512 xf = _mm512_roundscale_ps(x, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+    const __m512 yf = _mm512_roundscale_ps(y, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+    const __m512i mask = _mm512_set1_epi32(255);
+    const __m512i one = _mm512_set1_epi32(1);
+
+    const __m512i ix = _mm512_and_si512(_mm512_cvttps_epi32(xf), mask);
+    const __m512i iy = _mm512_and_si512(_mm512_cvttps_epi32(yf), mask);
+
+    const __m512 fx = _mm512_sub_ps(x, xf);
+    const __m512 fy = _mm512_sub_ps(y, yf);
+    const __m512 fx1 = _mm512_sub_ps(fx, _mm512_set1_ps(1.0f));
+    const __m512 fy1 = _mm512_sub_ps(fy, _mm512_set1_ps(1.0f));
+
+    const __m512i A = _mm512_add_epi32(_mm512_i32gather_epi32(ix, perm, 4), iy);
+    const __m512i B = _mm512_add_epi32(_mm512_i32gather_epi32(_mm512_add_epi32(ix, one), perm, 4), iy);
+
+    const __m512 p0 = Grad16(_mm512_i32gather_epi32(A, perm, 4), fx, fy);
+    const __m512 p1 = Grad16(_mm512_i32gather_epi32(B, perm, 4), fx1, fy);
+    const __m512 p2 = Grad16(_mm512_i32gather_epi32(_mm512_add_epi32(A, one), perm, 4), fx, fy1);
+    const __m512 p3 = Grad16(_mm512_i32gather_epi32(_mm512_add_epi32(B, one), perm, 4), fx1, fy1);
+
+    const __m512 u = Fade16(fx);
+    return Lerp16(Lerp16(p0, p1, u), Lerp16(p2, p3, u), Fade16(fy));
+}
+
+PERLINBATCH_TARGET("avx512f")
+static inline __m512 FadeDerivative16(__m512 t){
+    __m512 r = _mm512_sub_ps(_mm512_mul_ps(t, _mm512_set1_ps(30.0f)), _mm512_set1_ps(60.0f));
+    r = _mm512_add_ps(_mm512_mul_ps(t, r), _mm512_set1_ps(30.0f));
+    return _mm512_mul_ps(_mm512_mul_ps(t, t), r);
+}
+
+// Noise16 plus its derivatives
+PERLINBATCH_TARGET("avx512f")
+static inline __m512 NoiseGradient16(const std::int32_t* perm, __m512 x, __m512 y, __m512& dx, __m512& dy){
+    const __m512 xf = _mm512_roundscale_ps(x, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+    const __m512 yf = _mm512_roundscale_ps(y, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+    const __m512i mask = _mm512_set1_epi32(255);
+    const __m512i one = _mm512_set1_epi32(1);
+
+    const __m512i ix = _mm512_and_si512(_mm512_cvttps_epi32(xf), mask);
+    const __m512i iy = _mm512_and_si512(_mm512_cvttps_epi32(yf), mask);
+
+    const __m512 fx = _mm512_sub_ps(x, xf);
+    const __m512 fy = _mm512_sub_ps(y, yf);
+    const __m512 fx1 = _mm512_sub_ps(fx, _mm512_set1_ps(1.0f));
+    const __m512 fy1 = _mm512_sub_ps(fy, _mm512_set1_ps(1.0f));
+
+    const __m512i A = _mm512_add_epi32(_mm512_i32gather_epi32(ix, perm, 4), iy);
+    const __m512i B = _mm512_add_epi32(_mm512_i32gather_epi32(_mm512_add_epi32(ix, one), perm, 4), iy);
+
+    const __m512i h0 = _mm512_i32gather_epi32(A, perm, 4);
+    const __m512i h1 = _mm512_i32gather_epi32(B, perm, 4);
+    const __m512i h2 = _mm512_i32gather_epi32(_mm512_add_epi32(A, one), perm, 4);
+    const __m512i h3 = _mm512_i32gather_epi32(_mm512_add_epi32(B, one), perm, 4);
+
+    const __m512 p0 = Grad16(h0, fx, fy);
+    const __m512 p1 = Grad16(h1, fx1, fy);
+    const __m512 p2 = Grad16(h2, fx, fy1);
+    const __m512 p3 = Grad16(h3, fx1, fy1);
+
+    const __m512 u = Fade16(fx);
+    const __m512 v = Fade16(fy);
+    const __m512 q0 = Lerp16(p0, p1, u);
+    const __m512 q1 = Lerp16(p2, p3, u);
+
+    const __m512 o = _mm512_set1_ps(1.0f);
+    const __m512 z = _mm512_setzero_ps();
+    dx = _mm512_add_ps(Lerp16(Lerp16(Grad16(h0, o, z), Grad16(h1, o, z), u), Lerp16(Grad16(h2, o, z), Grad16(h3, o, z), u), v),
+                       _mm512_mul_ps(FadeDerivative16(fx), Lerp16(_mm512_sub_ps(p1, p0), _mm512_sub_ps(p3, p2), v)));
+    dy = _mm512_add_ps(Lerp16(Lerp16(Grad16(h0, z, o), Grad16(h1, z, o), u), Lerp16(Grad16(h2, z, o), Grad16(h3, z, o), u), v),
+                       _mm512_mul_ps(FadeDerivative16(fy), _mm512_sub_ps(q1, q0)));
+
+    return Lerp16(q0, q1, v);
+}
+
+PERLINBATCH_TARGET("avx512f")
+static void AVX512RowGradient(const std::int32_t* perm, float xStart, float xScale, float y, std::size_t count, float* out, float* dx, float* dy){
+    const __m512 start = _mm512_set1_ps(xStart);
+    const __m512 scale = _mm512_set1_ps(xScale);
+    const __m512 vy = _mm512_set1_ps(y);
+    const __m512i lanes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    std::size_t i = 0;
+    for(; i + 16 <= count; i += 16){
+        const __m512 index = _mm512_cvtepi32_ps(_mm512_add_epi32(_mm512_set1_epi32((std::int32_t)i), lanes));
+        const __m512 x = _mm512_mul_ps(_mm512_add_ps(start, index), scale);
+        __m512 gx, gy;
+        _mm512_storeu_ps(out + i, NoiseGradient16(perm, x, vy, gx, gy));
+        _mm512_storeu_ps(dx + i, gx);
+        _mm512_storeu_ps(dy + i, gy);
+    }
+    ScalarRowGradient(perm, xStart, xScale, y, i, count, out, dx, dy);
+}
+
+PERLINBATCH_TARGET("avx512f")
+static void AVX512Row(const std::int32_t* perm, float xStart, float xScale, float y, std::size_t count, float* out){
+    const __m512 start = _mm512_set1_ps(xStart);
+    const __m512 scale = _mm512_set1_ps(xScale);
+    const __m512 vy = _mm512_set1_ps(y);
+    const __m512i lanes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    std::size_t i = 0;
+    for(; i + 16 <= count; i += 16){
+        const __m512 index = _mm512_cvtepi32_ps(_mm512_add_epi32(_mm512_set1_epi32((std::int32_t)i), lanes));
+        const __m512 x = _mm512_mul_ps(_mm512_add_ps(start, index), scale);
+        _mm512_storeu_ps(out + i, Noise16(perm, x, vy));
+    }
+    ScalarRow(perm, xStart, xScale, y, i, count, out);
+}
+
+PERLINBATCH_TARGET("avx512f")
+static void AVX512Points(const std::int32_t* perm, const float* xs, const float* ys, std::size_t count, float* out){
+    std::size_t i = 0;
+    for(; i + 16 <= count; i += 16){
+        _mm512_storeu_ps(out + i, Noise16(perm, _mm512_loadu_ps(xs + i), _mm512_loadu_ps(ys + i)));
+    }
+    ScalarPoints(perm, xs, ys, i, count, out);
+}
+
+#endif // PERLINBATCH_X86
+
+// ========================= PerlinNoiseBatch =========================
+
+// Constructor
+PerlinNoiseBatch::PerlinNoiseBatch(const siv::PerlinNoise& perlin) : PerlinNoiseBatch(perlin, GetBestKernel()){
+
+}
+
+PerlinNoiseBatch::PerlinNoiseBatch(const siv::PerlinNoise& perlin, Kernel kernel){
+    const siv::PerlinNoise::state_type& state = perlin.serialize();
+    for(int i = 0; i < 512; ++i){
+        m_permutation[i] = state[i & 255];
+    }
+    // Fall back to the scalar kernel rather than crash on an illegal instruction
+    m_kernel = IsSupported(kernel) ? kernel : Scalar;
+}
+
+// Destructor
+PerlinNoiseBatch::~PerlinNoiseBatch(){
+
+}
+
+float PerlinNoiseBatch::Noise2D(float x, float y) const{
+    return ScalarNoise2D(m_permutation, x, y);
+}
+
+void PerlinNoiseBatch::Noise2DRow(float xStart, float xScale, float y, std::size_t count, float* out) const{
+    switch(m_kernel){
+#ifdef PERLINBATCH_X86
+        case AVX512: AVX512Row(m_permutation, xStart, xScale, y, count, out); return;
+        case AVX2:   AVX2Row(m_permutation, xStart, xScale, y, count, out); return;
+        case SSE2:   SSE2Row(m_permutation, xStart, xScale, y, count, out); return;
+#endif
+        default:     ScalarRow(m_permutation, xStart, xScale, y, 0, count, out); return;
+    }
+}
+
+void PerlinNoiseBatch::Noise2DPoints(const float* xs, const float* ys, std::size_t count, float* out) const{
+    switch(m_kernel){
+#ifdef PERLINBATCH_X86
+        case AVX512: AVX512Points(m_permutation, xs, ys, count, out); return;
+        case AVX2:   AVX2Points(m_permutation, xs, ys, count, out); return;
+        case SSE2:   SSE2Points(m_permutation, xs, ys, count, out); return;
+#endif
+        default:     ScalarPoints(m_permutation, xs, ys, 0, count, out); return;
+    }
+}
+
+float PerlinNoiseBatch::Noise2DGradient(float x, float y, float& dx, float& dy) const{
+    return ScalarNoise2DGradient(m_permutation, x, y, dx, dy);
+}
+
+void PerlinNoiseBatch::Noise2DRowGradient(float xStart, float xScale, float y, std::size_t count, float* out, float* dx, float* dy) const{
+    switch(m_kernel){
+#ifdef PERLINBATCH_X86
+        case AVX512: AVX512RowGradient(m_permutation, xStart, xScale, y, count, out, dx, dy); return;
+        case AVX2:   AVX2RowGradient(m_permutation, xStart, xScale, y, count, out, dx, dy); return;
+        case SSE2:   SSE2RowGradient(m_permutation, xStart, xScale, y, count, out, dx, dy); return;
+#endif
+        default:     ScalarRowGradient(m_permutation, xStart, xScale, y, 0, count, out, dx, dy); return;
+    }
+}
+
+NoiseBackend PerlinNoiseBatch::GetBackend() const{
+    return NoiseBackend::Perlin;
+}
+
+PerlinNoiseBatch::Kernel PerlinNoiseBatch::GetKernel() const{
+    return m_kernel;
+}
+
+bool PerlinNoiseBatch::IsSupported(Kernel kernel){
+#ifdef PERLINBATCH_X86
+    // Reads CPUID (and checks the OS saves the wider registers)
+    __builtin_cpu_init();
+    switch(kernel){
+        case AVX512: return __builtin_cpu_supports("avx512f");
+        case AVX2:   return __builtin_cpu_supports("avx2");
+        case SSE2:   return __builtin_cpu_supports("sse2");
+        default:     return true;
+    }
+#else
+    return kernel == Scalar;
+#endif
+}
+
+PerlinNoiseBatch::Kernel PerlinNoiseBatch::GetBestKernel(){
+    // Detected the first time we are asked, then reused
+    static const Kernel best = IsSupported(AVX512) ? AVX512 :
+                               IsSupported(AVX2)   ? AVX2 :
+                               IsSupported(SSE2)   ? SSE2 : Scalar;
+    return best;
+}
+
+const char* PerlinNoiseBatch::GetKernelName(Kernel kernel){
+    switch(kernel){
+        case AVX512: return "AVX-512 (16 lanes)";
+        case AVX2:   return "AVX2 (8 lanes)";
+        case SSE2:   return "SSE2 (4 lanes)";
+        default:     return "scalar";
+    }
+}
@@ -0,0 +1,189 @@
+#include "RegionBaker.hpp"
+#include "Clock.hpp"
+#include "TerrainBuilder.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if defined(LINUX) || defined(MAC) || defined(__unix__) || defined(__APPLE__)
+    #include <sys/resource.h>
+#endif
+
+// A generated chunk waiting to be written
+struct BakedChunk{
+    std::size_t tile;
+    std::unique_ptr<TerrainBuilder> builder;
+    double generateSeconds;
+};
+
+// Constructor
+RegionBaker::RegionBaker(JobScheduler& scheduler, const NoiseContext& noise, const TerrainRamp& ramp) :
+    m_scheduler(scheduler), m_noise(noise), m_ramp(ramp){
+
+}
+
+bool RegionBaker::Bake(const BakeSettings& settings, Stats& stats){
+    namespace fs = std::filesystem;
+    stats = Stats();
+    const double start = Clock::Now();
+
+    const std::size_t tileCount = static_cast<std::size_t>(settings.chunksX) * settings.chunksZ;
+    const std::size_t tileValues = static_cast<std::size_t>(settings.chunkSize) * settings.chunkSize;
+    const fs::path directory(settings.outputDirectory);
+    const fs::path heightPath = directory / "heights.f32";
+    const fs::path colorPath = directory / "colors.rgba";
+
+    // Both files at their final size up front, chunks are written into them in any order
+    std::error_code error;
+    fs::create_directories(directory, error);
+    {
+        std::ofstream heights(heightPath, std::ios::binary | std::ios::trunc);
+        std::ofstream colors(colorPath, std::ios::binary | std::ios::trunc);
+        if(!heights || !colors){
+            std::cout << "Could not create the bake files in '" << settings.outputDirectory << "'\n";
+            return false;
+        }
+    }
+    fs::resize_file(heightPath, tileCount * tileValues * sizeof(float), error);
+    if(!error){
+        fs::resize_file(colorPath, tileCount * tileValues * sizeof(std::uint32_t), error);
+    }
+    std::fstream heights(heightPath, std::ios::binary | std::ios::in | std::ios::out);
+    std::fstream colors(colorPath, std::ios::binary | std::ios::in | std::ios::out);
+    if(error || !heights || !colors || !WriteDescription(settings)){
+        std::cout << "Could not size the bake files in '" << settings.outputDirectory << "'\n";
+        return false;
+    }
+
+    // Finished chunks, handed from the workers to this thread
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::deque<BakedChunk> done;
+
+    const std::size_t maxInFlight = settings.maxInFlight > 0 ? settings.maxInFlight : 2 * m_scheduler.GetThreadCount();
+    std::size_t submitted = 0, written = 0, inFlight = 0;
+    std::size_t nextReport = tileCount / 10;
+    bool ok = true;
+    while(written < tileCount){
+        // Keep the workers busy, in row order, without holding more than maxInFlight chunks
+        while(submitted < tileCount && inFlight < maxInFlight){
+            const std::size_t tile = submitted++;
+            const int x = settings.originX + static_cast<int>(tile % settings.chunksX);
+            const int z = settings.originZ + static_cast<int>(tile / settings.chunksX);
+            const unsigned int chunkSize = settings.chunkSize;
+            m_scheduler.Submit([this, tile, x, z, chunkSize, &mutex, &finished, &done](JobScheduler::Job&){
+                const double generateStart = Clock::Now();
+                std::unique_ptr<TerrainBuilder> builder(new TerrainBuilder(chunkSize, static_cast<float>(x), static_cast<float>(z),
+                                                                           m_noise, nullptr, &m_ramp));
+                builder->GenerateNoiseMap();
+                BakedChunk chunk{ tile, std::move(builder), Clock::Now() - generateStart };
+                // Notified under the lock, Bake() may return as soon as it has the last chunk
+                std::lock_guard<std::mutex> lock(mutex);
+                done.push_back(std::move(chunk));
+                finished.notify_one();
+            }, static_cast<float>(tile));
+            ++inFlight;
+            stats.maxInFlight = std::max(stats.maxInFlight, inFlight);
+        }
+
+        BakedChunk chunk;
+        {
+            const double waitStart = Clock::Now();
+            std::unique_lock<std::mutex> lock(mutex);
+            finished.wait(lock, [&done]{ return !done.empty(); });
+            chunk = std::move(done.front());
+            done.pop_front();
+            stats.waitSeconds += Clock::Now() - waitStart;
+        }
+
+        // Each plane of the chunk is one block of its file
+        const double writeStart = Clock::Now();
+        heights.seekp(static_cast<std::streamoff>(chunk.tile * tileValues * sizeof(float)));
+        heights.write(reinterpret_cast<const char*>(chunk.builder->GetHeightData()), tileValues * sizeof(float));
+        colors.seekp(static_cast<std::streamoff>(chunk.tile * tileValues * sizeof(std::uint32_t)));
+        colors.write(reinterpret_cast<const char*>(chunk.builder->GetColorData()), tileValues * sizeof(std::uint32_t));
+        ok = ok && heights.good() && colors.good();
+        chunk.builder.reset();
+        stats.writeSeconds += Clock::Now() - writeStart;
+        stats.generateSeconds += chunk.generateSeconds;
+        stats.bytesWritten += tileValues * (sizeof(float) + sizeof(std::uint32_t));
+        --inFlight;
+        ++written;
+
+        if(settings.reportProgress && written >= nextReport && written < tileCount){
+            const double elapsed = Clock::Now() - start;
+            std::printf("  %zu / %zu chunks, %.1f chunks/s\n", written, tileCount, written / elapsed);
+            nextReport += std::max<std::size_t>(tileCount / 10, 1);
+        }
+    }
+    heights.flush();
+    colors.flush();
+    ok = ok && heights.good() && colors.good();
+
+    stats.chunks = written;
+    stats.seconds = Clock::Now() - start;
+    stats.peakResidentBytes = GetPeakResidentBytes();
+    if(!ok){
+        std::cout << "Writing the bake files in '" << settings.outputDirectory << "' failed\n";
+    }
+    return ok;
+}
+
+bool RegionBaker::WriteDescription(const BakeSettings& settings) const{
+    std::ofstream file(std::filesystem::path(settings.outputDirectory) / "region.txt");
+    const NoiseSettings& noise = m_noise.GetSettings();
+    file << "chunk_size " << settings.chunkSize << "\n"
+         << "chunks_x " << settings.chunksX << "\n"
+         << "chunks_z " << settings.chunksZ << "\n"
+         << "origin_x " << settings.originX << "\n"
+         << "origin_z " << settings.originZ << "\n"
+         << "noise " << NoiseSource::GetBackendName(noise.backend) << "\n"
+         << "seed " << noise.seed << "\n"
+         << "heights heights.f32 float32\n"
+         << "colors colors.rgba rgba8\n"
+         << "# chunk (i, j) is tile j * chunks_x + i, chunk_size^2 values a tile, rows in order\n"
+         << "# neighbouring chunks share their edge row and column, chunk (i, j) starts at vertex (i, j) * (chunk_size - 1)\n";
+    return file.good();
+}
+
+std::size_t RegionBaker::GetPeakResidentBytes(){
+#if defined(LINUX) || defined(MAC) || defined(__unix__) || defined(__APPLE__)
+    rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) != 0){
+        return 0;
+    }
+    #if defined(MAC) || defined(__APPLE__)
+        // Bytes on macOS
+        return static_cast<std::size_t>(usage.ru_maxrss);
+    #else
+        // Kilobytes on Linux
+        return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+    #endif
+#else
+    return 0;
+#endif
+}
+
+void RegionBaker::PrintStats(const Stats& stats){
+    const double megabytes = 1024.0 * 1024.0;
+    std::printf("Baked %zu chunks in %.2f s, %.1f chunks/s, %.1f MB written\n", stats.chunks, stats.seconds,
+                stats.chunks / std::max(stats.seconds, 1.0e-9), stats.bytesWritten / megabytes);
+    std::printf("  generate: %.2f s over the workers, %.1f ms a chunk\n", stats.generateSeconds,
+                stats.generateSeconds * 1000.0 / std::max<std::size_t>(stats.chunks, 1));
+    std::printf("  write:    %.2f s, %.1f MB/s\n", stats.writeSeconds, stats.bytesWritten / megabytes / std::max(stats.writeSeconds, 1.0e-9));
+    std::printf("  wait:     %.2f s for chunks to finish, at most %zu in flight\n", stats.waitSeconds, stats.maxInFlight);
+    if(stats.peakResidentBytes > 0){
+        std::printf("  peak RSS: %.1f MB\n", stats.peakResidentBytes / megabytes);
+    }
+    else{
+        std::printf("  peak RSS: unknown on this platform\n");
+    }
+}
@@ -0,0 +1,246 @@
+#include "RenderThread.hpp"
+#include "Clock.hpp"
+#include "Terrain.hpp"
+#include "ClipmapTerrain.hpp"
+
+#include "imgui_impl_opengl3.h"
+
+#include <chrono>
+
+// Constructor
+RenderThread::RenderThread(SDL_Window* window, SDL_GLContext context, Renderer* renderer, UploadQueue& uploads,
+                           unsigned int chunkSize) :
+    m_window(window), m_context(context), m_renderer(renderer), m_uploads(uploads), m_chunkSize(chunkSize),
+    m_commands(256){
+
+}
+
+// Destructor
+RenderThread::~RenderThread(){
+    Stop();
+}
+
+void RenderThread::SetShader(std::shared_ptr<Shader> shader){
+    m_shader = std::move(shader);
+}
+
+void RenderThread::SetClipmapShader(std::shared_ptr<Shader> shader){
+    m_clipmapShader = std::move(shader);
+}
+
+void RenderThread::AddChunkNow(ReadyChunk&& chunk){
+    AddChunk(std::move(chunk), nullptr);
+}
+
+void RenderThread::Start(){
+    m_stop.store(false);
+    m_thread = std::thread(&RenderThread::Run, this);
+}
+
+void RenderThread::Stop(){
+    if(m_thread.joinable()){
+        m_stop.store(true);
+        m_thread.join();
+    }
+}
+
+SceneSnapshot& RenderThread::GetSnapshot(){
+    return m_snapshots.GetWriteSlot();
+}
+
+void RenderThread::Publish(){
+    SceneSnapshot& snapshot = m_snapshots.GetWriteSlot();
+    snapshot.publishTime = Clock::Now();
+    m_snapshots.Publish();
+
+    // Retry whatever did not fit last time
+    while(!m_unsent.empty() && m_commands.TryPush(std::move(m_unsent.front()))){
+        m_unsent.pop_front();
+    }
+}
+
+void RenderThread::Send(Command&& command){
+    // Behind older unsent commands, to keep the order
+    if(!m_unsent.empty() || !m_commands.TryPush(std::move(command))){
+        m_unsent.push_back(std::move(command));
+    }
+}
+
+const RenderThread::Stats& RenderThread::GetStats(){
+    m_stats.Acquire();
+    return m_stats.GetReadSlot();
+}
+
+void RenderThread::Run(){
+    SDL_GL_MakeCurrent(m_window, m_context);
+
+    while(!m_stop.load()){
+        const double start = Clock::Now();
+        ProcessCommands();
+        const bool uploading = m_uploads.GetStats().pendingBytes > 0;
+        m_uploads.Drain();
+
+        const bool fresh = m_snapshots.Acquire();
+        SceneSnapshot& snapshot = m_snapshots.GetReadSlot();
+        // Draw when there is something new to show: a snapshot, or chunks that
+        // may have finished uploading
+        if(snapshot.frame != 0 && (fresh || uploading)){
+            if(fresh){
+                if(m_lastFrame != 0){
+                    m_renderStats.snapshotsSkipped += snapshot.frame - m_lastFrame - 1;
+                }
+                m_lastFrame = snapshot.frame;
+                m_renderStats.snapshotAge = start - snapshot.publishTime;
+            }
+            DrawFrame(snapshot);
+            SDL_GL_SwapWindow(m_window);
+            if(m_renderStats.framesDrawn == 0){
+                m_renderStats.firstFrameTime = Clock::Now();
+            }
+            ++m_renderStats.framesDrawn;
+            m_renderStats.frameSeconds = Clock::Now() - start;
+        }else{
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        m_renderStats.chunks = m_chunks.size();
+        m_renderStats.chunksUploading = 0;
+        for(const auto& chunk : m_chunks){
+            m_renderStats.chunksUploading += chunk.second.terrain->IsUploaded() ? 0 : 1;
+        }
+        m_renderStats.uploads = m_uploads.GetStats();
+        m_stats.GetWriteSlot() = m_renderStats;
+        m_stats.Publish();
+    }
+
+    // Chunks still queued are dropped with the queue, the staging ring goes right after
+    ClearChunks();
+    m_gridIndices.Clear();
+    SDL_GL_MakeCurrent(m_window, nullptr);
+}
+
+void RenderThread::ProcessCommands(){
+    Command command;
+    while(m_commands.TryPop(command)){
+        switch(command.type){
+            case Command::AddChunk:
+                AddChunk(std::move(command.chunk), &m_uploads);
+                break;
+            case Command::RemoveChunk:{
+                auto it = m_chunks.find(command.coord);
+                if(it != m_chunks.end()){
+                    DropPrevious(it->second);
+                    delete it->second.node;
+                    delete it->second.terrain;
+                    m_chunks.erase(it);
+                }
+                break;
+            }
+            case Command::SetUploadBudget:
+                m_uploads.SetBytesPerFrame(command.uploadBudget);
+                break;
+            case Command::UpdateClipmap:
+                UpdateClipmap(command.clipmap);
+                break;
+        }
+    }
+}
+
+void RenderThread::AddChunk(ReadyChunk&& chunk, UploadQueue* uploads){
+    const ChunkCoord coord = chunk.coord;
+    if(uploads == nullptr){
+        // Uploaded from the chunk's own memory, the staged copy is not needed
+        m_uploads.GetRing().Release(chunk.staged);
+        chunk.staged = StagingRing::Span();
+    }
+    Terrain* terrain = new Terrain(std::move(chunk), m_gridIndices, uploads);
+    SceneNode* node = m_shader != nullptr ? new SceneNode(terrain, m_shader) : new SceneNode(terrain);
+    // Neighbours share their edge vertices
+    const float pitch = static_cast<float>(m_chunkSize - 1);
+    node->GetLocalTransform().Translate(coord.x * pitch, 0, coord.z * pitch);
+
+    auto it = m_chunks.find(coord);
+    if(it == m_chunks.end()){
+        m_chunks[coord] = Chunk{ terrain, node };
+        return;
+    }
+    // A new level of detail, or new noise. The newest older one that can be drawn stays until this one is uploaded.
+    Chunk& replaced = it->second;
+    if(replaced.terrain->IsUploaded()){
+        DropPrevious(replaced);
+        replaced.previousTerrain = replaced.terrain;
+        replaced.previousNode = replaced.node;
+    }else{
+        delete replaced.node;
+        delete replaced.terrain;
+    }
+    replaced.terrain = terrain;
+    replaced.node = node;
+}
+
+void RenderThread::DropPrevious(Chunk& chunk){
+    delete chunk.previousNode;
+    delete chunk.previousTerrain;
+    chunk.previousNode = nullptr;
+    chunk.previousTerrain = nullptr;
+}
+
+void RenderThread::UpdateClipmap(const ClipmapFrame& frame){
+    const unsigned int levelCount = static_cast<unsigned int>(frame.levels.size());
+    if(m_clipmap == nullptr || m_clipmap->GetSize() != frame.size || m_clipmap->GetLevelCount() != levelCount){
+        delete m_clipmapNode;
+        delete m_clipmap;
+        // A new clipmap samples every level whole, so the empty textures are filled right below
+        m_clipmap = new ClipmapTerrain(frame.size, levelCount, m_gridIndices);
+        m_clipmapNode = m_clipmapShader != nullptr ? new SceneNode(m_clipmap, m_clipmapShader) : new SceneNode(m_clipmap);
+    }
+    m_clipmap->Apply(frame);
+}
+
+void RenderThread::DrawFrame(SceneSnapshot& snapshot){
+    m_renderer->Update(snapshot);
+    m_renderer->Render(snapshot);
+
+    // The clipmap already sits in world space
+    if(m_clipmapNode != nullptr){
+        m_clipmapNode->Update(snapshot);
+        m_clipmapNode->Draw();
+    }
+
+    // The chunks the simulation wants drawn, once all their data is on the GPU
+    for(const ChunkCoord& coord : snapshot.chunks){
+        auto it = m_chunks.find(coord);
+        if(it == m_chunks.end()){
+            continue;
+        }
+        Chunk& chunk = it->second;
+        SceneNode* node = chunk.node;
+        if(!chunk.terrain->IsUploaded()){
+            // The level it replaces, if there is one, fills in meanwhile
+            if(chunk.previousNode == nullptr){
+                continue;
+            }
+            node = chunk.previousNode;
+        }else if(chunk.previousNode != nullptr){
+            DropPrevious(chunk);
+        }
+        node->Update(snapshot);
+        node->Draw();
+    }
+
+    // Render dear imgui into screen
+    ImGui_ImplOpenGL3_RenderDrawData(snapshot.ui.GetDrawData());
+}
+
+void RenderThread::ClearChunks(){
+    for(auto& chunk : m_chunks){
+        DropPrevious(chunk.second);
+        delete chunk.second.node;
+        delete chunk.second.terrain;
+    }
+    m_chunks.clear();
+    delete m_clipmapNode;
+    delete m_clipmap;
+    m_clipmapNode = nullptr;
+    m_clipmap = nullptr;
+}
@@ -24,27 +24,47 @@ Renderer::~Renderer(){
     }
 }
 
-void Renderer::Update(){
+void Renderer::FillSnapshot(SceneSnapshot& snapshot){
+    Camera* camera = m_cameras[0];
     // Here we apply the projection matrix which creates perspective.
     // The first argument is 'field of view'
     // Then perspective
     // Then the near and far clipping plane.
-    // Note I cannot see anything closer than 0.1f units from the screen.
-    m_projectionMatrix = glm::perspective(glm::radians(45.0f),((float)m_screenWidth)/((float)m_screenHeight),0.1f,512.0f);
+    // Note I cannot see anything closer than m_nearPlane units from the screen.
+    m_projectionMatrix = glm::perspective(glm::radians(45.0f),((float)m_screenWidth)/((float)m_screenHeight),m_nearPlane,m_farPlane);
+    snapshot.projection = m_projectionMatrix;
+    snapshot.view = camera->GetWorldToViewmatrix();
+    snapshot.eye = glm::vec3(camera->GetEyeXPosition(), camera->GetEyeYPosition(), camera->GetEyeZPosition());
 
+    // One light just in front of the camera, and a second one mirrored below the terrain
+    const glm::vec3 front = snapshot.eye + glm::vec3(camera->GetViewXDirection(), camera->GetViewYDirection(), camera->GetViewZDirection());
+    snapshot.lights[0] = PointLight();
+    snapshot.lights[0].position = front;
+    snapshot.lights[1] = PointLight();
+    snapshot.lights[1].position = glm::vec3(front.x, -front.y, -front.z);
+    // The default attenuation is for a 512 far plane, further terrain would go black
+    for(PointLight& light : snapshot.lights){
+        light.linear *= 512.0f / m_farPlane;
+    }
+
+    // Nice way to debug your scene in wireframe!
+    // Test to see if the 'w' key is pressed for a quick view to toggle
+    // the wireframe view.
+    const Uint8* currentKeyStates = SDL_GetKeyboardState( NULL );
+    snapshot.wireframe = currentKeyStates[ SDL_SCANCODE_W ] != 0;
+}
+
+void Renderer::Update(const SceneSnapshot& snapshot){
     // Perform the update
     if(m_root!=nullptr){
-        // TODO: By default, we will only have one camera
-        //       You may otherwise not want to hardcode
-        //       a value of '0' here.
-        m_root->Update(m_projectionMatrix, m_cameras[0]);
+        m_root->Update(snapshot);
     }
 }
 
 // Initialize clear color
 // Setup our OpenGL State machine
 // Then render the scene
-void Renderer::Render(){
+void Renderer::Render(const SceneSnapshot& snapshot){
 
     // What we are doing, is telling opengl to create a depth(or Z-buffer) 
     // for us that is stored every frame.
@@ -59,11 +79,8 @@ void Renderer::Render(){
     // and we have to do this every frame!
     glClear(GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
 
-    // Nice way to debug your scene in wireframe!
-    // Test to see if the 'w' key is pressed for a quick view to toggle
-    // the wireframe view.
-    const Uint8* currentKeyStates = SDL_GetKeyboardState( NULL );
-    if( currentKeyStates[ SDL_SCANCODE_W ] )
+    // Wireframe while the 'w' key was held in the simulated frame
+    if( snapshot.wireframe )
     {
         glPolygonMode(GL_FRONT_AND_BACK,GL_LINE);
     }else{
@@ -76,6 +93,11 @@ void Renderer::Render(){
     }
 }
 
+void Renderer::SetClipPlanes(float nearPlane, float farPlane){
+    m_nearPlane = nearPlane;
+    m_farPlane = farPlane;
+}
+
 // Determines what the root is of the renderer, so the
 // scene can be drawn.
 void Renderer::setRoot(SceneNode* startingNode){
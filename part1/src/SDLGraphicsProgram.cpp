@@ -1,13 +1,23 @@
 #include "SDLGraphicsProgram.hpp"
+#include "Clock.hpp"
 #include "Camera.hpp"
 #include "Terrain.hpp"
+#include "OctaveCache.hpp"
+#include "ChunkStreamer.hpp"
+#include "UploadQueue.hpp"
+#include "RenderThread.hpp"
+#include "Shader.hpp"
 #include "glm/vec2.hpp"
 
 #include "imgui.h"
 #include "imgui_impl_opengl3.h"
 #include "imgui_impl_sdl.h"
 
+#include <algorithm>
+#include <limits>
+#include <memory>
 #include <iostream>
+#include <set>
 #include <string>
 #include <vector>
 #include <sstream>
@@ -16,13 +26,19 @@
 // Initialization function
 // Returns a true or false value based on successful completion of setup.
 // Takes in dimensions of window.
-SDLGraphicsProgram::SDLGraphicsProgram(int w, int h){
+// threadCount is shared between the two pools: whichever the terrain is built on gets all of it,
+// the other one only the thread that calls it (the pool) or one worker (the scheduler, for files).
+SDLGraphicsProgram::SDLGraphicsProgram(int w, int h, const NoiseSettings& noiseSettings, const std::vector<RampStop>& rampStops, unsigned int threadCount, std::size_t uploadBudget, TerrainDrawPath drawPath, float lodDistance, unsigned int clipmapLevels) :
+    m_noiseSettings(noiseSettings), m_terrainRamp(rampStops), m_threadPool(clipmapLevels > 0 ? threadCount : 1),
+    m_jobScheduler(clipmapLevels > 0 ? 1 : threadCount), m_uploadBudget(uploadBudget),
+    m_drawPath(drawPath), m_lodDistance(lodDistance), m_clipmapLevels(clipmapLevels){
 	// Initialization flag
 	bool success = true;
 	// String to hold any errors that occur.
 	std::stringstream errorStream;
 	// The window we'll be rendering to
 	m_window = NULL;
+	const std::size_t contextStep = m_startup.Begin("SDL window and OpenGL context");
 
 	// Initialize SDL
 	if(SDL_Init(SDL_INIT_VIDEO)< 0){
@@ -83,6 +99,7 @@ SDLGraphicsProgram::SDLGraphicsProgram(int w, int h){
 
 	// SDL_LogSetAllPriority(SDL_LOG_PRIORITY_WARN); // Uncomment to enable extra debug support!
 	GetOpenGLVersionInfo();
+	m_startup.End(contextStep);
 
 
     // Setup our Renderer
@@ -117,53 +134,170 @@ bool SDLGraphicsProgram::InitGL(){
 
 
 
-//Loops forever!
-void SDLGraphicsProgram::Loop(){
+// Reads a shader file on a worker
+static Task<std::string> ReadShaderSource(JobScheduler& jobs, StartupTimeline& timeline, std::string path){
+    co_await ResumeOnJobs{ jobs };
+    const std::size_t step = timeline.Begin("read " + path);
+    std::string source = Shader::LoadShader(path);
+    timeline.End(step);
+    co_return source;
+}
+
+Task<void> SDLGraphicsProgram::Startup(MainThreadQueue& mainThread, ChunkStreamer& streamer, RenderThread& renderThread,
+                                       std::set<ChunkCoord>& resident, Clipmap* clipmap){
+    // Both files are read while the rest goes on
+    // Height texture chunks pull their vertices in a shader of their own, and so does the clipmap
+    const char* vertexPath = m_drawPath == TerrainDrawPath::HeightTexture ? "./shaders/heightfield_vert.glsl" : "./shaders/vert.glsl";
+    if(clipmap != nullptr){
+        vertexPath = "./shaders/clipmap_vert.glsl";
+    }
+    Task<std::string> vertexSource = ReadShaderSource(m_jobScheduler, m_startup, vertexPath);
+    Task<std::string> fragmentSource = ReadShaderSource(m_jobScheduler, m_startup, "./shaders/frag.glsl");
+
+    // and so are the chunks around the camera, nearest first
+    Camera* camera = m_renderer->GetCamera(0);
+    const glm::vec3 eye(camera->GetEyeXPosition(), camera->GetEyeYPosition(), camera->GetEyeZPosition());
+    const ChunkCoord nearest = streamer.GetChunk(eye);
+    const double requested = Clock::Now();
+    if(clipmap == nullptr){
+        streamer.Update(eye);
+    }
 
+    // The GL steps run here in the meantime
+    std::size_t step = m_startup.Begin("Dear ImGui context and device objects");
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
-    ImGuiIO &io = ImGui::GetIO();
     // Setup Platform/Renderer bindings
     ImGui_ImplSDL2_InitForOpenGL(m_window, m_openGLContext);
     ImGui_ImplOpenGL3_Init("#version 410");
     // Setup Dear ImGui style
     ImGui::StyleColorsDark();
+    // Creates the font texture and shaders while this thread still has the context
+    ImGui_ImplOpenGL3_NewFrame();
+    m_startup.End(step);
+
+    // One program for every chunk, compiled once both files are in
+    const std::string vertex = co_await vertexSource;
+    const std::string fragment = co_await fragmentSource;
+    co_await mainThread;
+    step = m_startup.Begin("compile terrain shader");
+    std::shared_ptr<Shader> shader = std::make_shared<Shader>();
+    shader->CreateShader(vertex, fragment);
+    if(clipmap != nullptr){
+        renderThread.SetClipmapShader(shader);
+    }else{
+        renderThread.SetShader(shader);
+    }
+    m_startup.End(step);
+
+    if(clipmap != nullptr){
+        // Every level whole, on the thread pool; the render thread makes the textures from it
+        step = m_startup.Begin("sample the clipmap");
+        clipmap->Update(eye);
+        RenderThread::Command command;
+        command.type = RenderThread::Command::UpdateClipmap;
+        command.clipmap = clipmap->TakeFrame();
+        renderThread.Send(std::move(command));
+        m_startup.End(step);
+        co_return;
+    }
 
-    int terrainChunkSize = 512;
-    std::vector<Terrain*> terrains;
-    std::vector<SceneNode*> scenenodes;
-
-    std::vector<glm::vec2> offsets = {
-        glm::vec2(0,0),
-        glm::vec2(1,0),
-        glm::vec2(1,1),
-        glm::vec2(0,1),
-        glm::vec2(-1,1),
-        glm::vec2(-1,0),
-        glm::vec2(-1,-1),
-        glm::vec2(0,-1),
-        glm::vec2(1,-1)
-    };
-
-    for (int i = 0; i < offsets.size(); i++)
-    {
-        Terrain* t = new Terrain(terrainChunkSize, 0, offsets[i].x, offsets[i].y);
-        terrains.push_back(t);
-        t->LoadPerlinTexture();
-        SceneNode* tn = new SceneNode(t);
-        scenenodes.push_back(tn);
+    // The first frame only waits for the chunk under the camera
+    bool nearestReady = false;
+    while(!nearestReady){
+        for(ReadyChunk& ready : streamer.TakeReady(std::numeric_limits<std::size_t>::max())){
+            resident.insert(ready.coord);
+            if(ready.coord.x == nearest.x && ready.coord.z == nearest.z){
+                m_startup.Record("generate nearest chunk", requested, Clock::Now(), "jobs");
+                step = m_startup.Begin("upload nearest chunk");
+                renderThread.AddChunkNow(std::move(ready));
+                m_startup.End(step);
+                nearestReady = true;
+            }
+            else{
+                // The render thread uploads the rest once it runs
+                RenderThread::Command command;
+                command.type = RenderThread::Command::AddChunk;
+                command.chunk = std::move(ready);
+                renderThread.Send(std::move(command));
+            }
+        }
+        if(!nearestReady){
+            co_await mainThread;
+        }
     }
-     
-    m_renderer->setRoot(scenenodes.at(0));
-    
-    
-    for (int i = 1; i < offsets.size(); i++){
-        scenenodes.at(0)->AddChild(scenenodes.at(i));
+}
+
+//Loops forever!
+void SDLGraphicsProgram::Loop(){
+
+    // 512 quads a side, so every level of detail down to every 16th vertex fits the chunk
+    const int terrainChunkSize = 513;
+    // Chunks whose buffers are created per frame, the upload queue fills them over the next frames
+    const std::size_t maxUploadsPerFrame = 2;
+    // Room for a few chunks in flight, about 17 MB each
+    const std::size_t stagingBytes = 64u << 20;
+    // Input, camera and streaming run at this pace. The render thread draws each new snapshot
+    // (and again while uploads are pending), so it never draws faster than this either.
+    const Uint32 simulationStepMs = 16;
+
+    // One seeded noise context shared by every chunk
+    NoiseSettings noiseSettings = m_noiseSettings;
+    NoiseContext noise(noiseSettings);
+    // Octave samples of every chunk, so tuning the weights only re-blends them
+    OctaveCache octaveCache;
+    std::cout << "Terrain noise: " << NoiseSource::GetBackendName(m_noiseSettings.backend) << "\n";
+    std::cout << "Terrain threads: " << (m_clipmapLevels > 0 ? m_threadPool.GetThreadCount() : m_jobScheduler.GetThreadCount()) << "\n";
+
+    // Workers stage finished chunks in a persistently mapped ring when the driver has
+    // GL_ARB_buffer_storage, in plain memory otherwise
+    UploadQueue::BufferStorageFunction bufferStorage = nullptr;
+    if(SDL_GL_ExtensionSupported("GL_ARB_buffer_storage")){
+        bufferStorage = reinterpret_cast<UploadQueue::BufferStorageFunction>(SDL_GL_GetProcAddress("glBufferStorage"));
+    }
+    std::size_t step = m_startup.Begin("map the staging ring");
+    UploadQueue uploads(stagingBytes, m_uploadBudget, bufferStorage);
+    m_startup.End(step);
+    std::cout << "Chunk uploads: " << (uploads.IsPersistent() ? "persistent mapped ring" : "CPU staging") << ", "
+              << (m_uploadBudget >> 20) << " MB per frame\n";
+
+    // Chunks around the camera are built by jobs, nearest first, and uploaded on the render thread
+    ChunkStreamer streamer(m_jobScheduler, terrainChunkSize, noise, &octaveCache, &m_terrainRamp);
+    streamer.SetStagingRing(&uploads.GetRing());
+    streamer.SetDrawPath(m_drawPath);
+    streamer.SetLODDistance(m_lodDistance);
+    // Chunks handed to the render thread, the draw list of every snapshot
+    std::set<ChunkCoord> resident;
+    std::size_t uploadBudget = m_uploadBudget;
+
+    // Or nested windows around the camera, sampled at the chunks' noise scale, which see much further
+    std::unique_ptr<Clipmap> clipmap;
+    if(m_clipmapLevels > 0){
+        clipmap.reset(new Clipmap(m_clipmapLevels, Clipmap::DefaultSize, terrainChunkSize, noise, &m_terrainRamp, &m_threadPool));
+        // Near is pushed out too, to keep some depth precision that far
+        m_renderer->SetClipPlanes(1.0f, clipmap->GetViewDistance());
+        std::cout << "Terrain clipmap: " << clipmap->GetLevelCount() << " levels of " << clipmap->GetSize() << "^2, "
+                  << clipmap->GetViewDistance() << " units away\n";
     }
 
     // Set a default position for our camera
     m_renderer->GetCamera(0)->SetCameraEyePosition(0.0f,100.0f,100.0f);
 
+    RenderThread renderThread(m_window, m_openGLContext, m_renderer, uploads, terrainChunkSize);
+    {
+        // Runs the startup graph, this thread takes the steps that need the context
+        MainThreadQueue mainThread;
+        Task<void> startup = Startup(mainThread, streamer, renderThread, resident, clipmap.get());
+        mainThread.RunUntilDone(startup);
+        startup.await_resume();
+    }
+
+    // From here on the render thread owns the context, this thread simulates
+    // and publishes a snapshot of each frame for it
+    SDL_GL_MakeCurrent(m_window, nullptr);
+    renderThread.Start();
+    std::uint64_t frame = 0;
+
     // Main loop flag
     // If this is quit = 'true' then the program terminates.
     bool quit = false;
@@ -181,10 +315,10 @@ void SDLGraphicsProgram::Loop(){
     const Uint8* keyboardState = SDL_GetKeyboardState(NULL);    
     // While application is running
     while(!quit){
+        const Uint32 frameStart = SDL_GetTicks();
 
         // For our terrain setup the identity transform each frame
         // TODO maybe move this
-        ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplSDL2_NewFrame();
         ImGui::NewFrame();
         //Handle events on queue
@@ -223,32 +357,167 @@ void SDLGraphicsProgram::Loop(){
             }
         } // End SDL_PollEvent loop.
 		
-        for (int i = 0; i < offsets.size(); i++){
-            scenenodes.at(i)->GetLocalTransform().LoadIdentity();
-            scenenodes.at(i)->GetLocalTransform().Translate(offsets[i].x * terrainChunkSize,0, offsets[i].y * terrainChunkSize);
+        // Stream the chunks around the camera, or slide the clipmap's windows
+        Camera* camera = m_renderer->GetCamera(0);
+        const glm::vec3 eye(camera->GetEyeXPosition(), camera->GetEyeYPosition(), camera->GetEyeZPosition());
+        if(clipmap != nullptr){
+            clipmap->Update(eye);
+            RenderThread::Command command;
+            command.type = RenderThread::Command::UpdateClipmap;
+            command.clipmap = clipmap->TakeFrame();
+            renderThread.Send(std::move(command));
+        }else{
+            streamer.Update(eye);
+        }
+        for(const ChunkCoord& coord : streamer.TakeUnloaded()){
+            RenderThread::Command command;
+            command.type = RenderThread::Command::RemoveChunk;
+            command.coord = coord;
+            renderThread.Send(std::move(command));
+            resident.erase(coord);
+        }
+        for(ReadyChunk& ready : streamer.TakeReady(maxUploadsPerFrame)){
+            resident.insert(ready.coord);
+            RenderThread::Command command;
+            command.type = RenderThread::Command::AddChunk;
+            command.chunk = std::move(ready);
+            renderThread.Send(std::move(command));
+        }
+
+        ImGui::Begin("Chunk streaming");
+        int radius = streamer.GetRadius();
+        if(ImGui::SliderInt("radius (chunks)", &radius, 0, 6)){
+            streamer.SetRadius(radius);
+        }
+        // Only chunks built from now on, or that cross a level boundary, pick it up
+        float lodDistance = streamer.GetLODDistance();
+        if(ImGui::SliderFloat("LOD distance", &lodDistance, 0.0f, 4096.0f)){
+            streamer.SetLODDistance(lodDistance);
+        }
+        const JobScheduler::Stats jobStats = m_jobScheduler.GetStats();
+        const ChunkStreamer::Stats streamStats = streamer.GetStats();
+        ImGui::Text("%zu resident, %zu pending, %zu requested, %zu level changes, %zu regenerated", streamStats.resident,
+                    streamStats.pending, streamStats.requested, streamStats.levelChanges, streamStats.regenerations);
+        ImGui::Text("queue depth %zu, %zu running, %zu steals", jobStats.queued, jobStats.running, jobStats.steals);
+        ImGui::Text("request to ready: %.1f ms average, %.1f ms worst", streamStats.averageLatency * 1000.0, streamStats.maxLatency * 1000.0);
+        ImGui::Text("cancelled: %zu queued, %zu started, %.1f ms wasted", jobStats.cancelledQueued, jobStats.cancelledRunning,
+                    jobStats.wastedSeconds * 1000.0);
+        int uploadBudgetMB = static_cast<int>(uploadBudget >> 20);
+        if(ImGui::SliderInt("upload budget (MB/frame)", &uploadBudgetMB, 1, 64)){
+            uploadBudget = static_cast<std::size_t>(uploadBudgetMB) << 20;
+            RenderThread::Command command;
+            command.type = RenderThread::Command::SetUploadBudget;
+            command.uploadBudget = uploadBudget;
+            renderThread.Send(std::move(command));
         }
+        const RenderThread::Stats& renderStats = renderThread.GetStats();
+        const UploadQueue::Stats& uploadStats = renderStats.uploads;
+        const StagingRing& ring = uploads.GetRing();
+        ImGui::Text("uploads (%s): %.1f MB last frame, %.1f MB queued, %zu fences",
+                    uploadStats.persistent ? "mapped ring" : "CPU staging", uploadStats.lastFrameBytes / (1024.0 * 1024.0),
+                    uploadStats.pendingBytes / (1024.0 * 1024.0), uploadStats.fencesInFlight);
+        ImGui::Text("staging %.1f / %.1f MB, %zu full, %.1f MB unstaged", ring.GetUsedBytes() / (1024.0 * 1024.0),
+                    ring.GetCapacity() / (1024.0 * 1024.0), ring.GetFailedReserves(), uploadStats.unstagedBytes / (1024.0 * 1024.0));
+        ImGui::Text("render thread: %llu frames, %.1f ms last, snapshot %.1f ms old, %llu skipped",
+                    static_cast<unsigned long long>(renderStats.framesDrawn), renderStats.frameSeconds * 1000.0,
+                    renderStats.snapshotAge * 1000.0, static_cast<unsigned long long>(renderStats.snapshotsSkipped));
+        ImGui::Text("%zu chunks on the GPU, %zu uploading", renderStats.chunks, renderStats.chunksUploading);
+        ImGui::End();
 
-        // Update our scene through our renderer
-        m_renderer->Update();
-        // Render our scene using our selected renderer
-        m_renderer->Render();
+        if(clipmap != nullptr){
+            // The same vertices every frame, the texels follow how far the camera went
+            ImGui::Begin("Clipmap");
+            const Clipmap::Stats& clipmapStats = clipmap->GetStats();
+            ImGui::Text("%u levels of %u^2, %.0f units away", clipmap->GetLevelCount(), clipmap->GetSize(), clipmap->GetViewDistance());
+            ImGui::Text("last update: %zu texels in %zu rectangles, %zu levels moved, %.2f ms", clipmapStats.texels,
+                        clipmapStats.updates, clipmapStats.levelsMoved, clipmapStats.seconds * 1000.0);
+            ImGui::End();
+        }
 
-        ImGui::Begin("Demo window");
-        ImGui::SliderInt("terrainChunkSize", &terrainChunkSize, 0, 512);
+        // Live noise tuning. Persistence, amplitude and gain only re-blend the
+        // cached octaves, seed, frequency and octave count sample them again.
+        ImGui::Begin("Terrain noise");
+        bool noiseChanged = false;
+        const char* backendNames[static_cast<int>(NoiseBackend::Count)];
+        for(int b = 0; b < static_cast<int>(NoiseBackend::Count); ++b){
+            backendNames[b] = NoiseSource::GetBackendName(static_cast<NoiseBackend>(b));
+        }
+        int backend = static_cast<int>(noiseSettings.backend);
+        if(ImGui::Combo("noise", &backend, backendNames, static_cast<int>(NoiseBackend::Count))){
+            noiseSettings.backend = static_cast<NoiseBackend>(backend);
+            noiseChanged = true;
+        }
+        noiseChanged |= ImGui::SliderFloat("persistence", &noiseSettings.persistence, 0.0f, 1.0f);
+        noiseChanged |= ImGui::SliderFloat("persistence step", &noiseSettings.persistenceStep, -0.2f, 0.2f);
+        noiseChanged |= ImGui::SliderFloat("amplitude", &noiseSettings.amplitude, 0.0f, 2.0f);
+        noiseChanged |= ImGui::SliderFloat("gain", &noiseSettings.gain, 0.0f, 1.0f);
+        noiseChanged |= ImGui::SliderFloat("frequency", &noiseSettings.frequency, 0.5f, 16.0f);
+        noiseChanged |= ImGui::SliderInt("octaves", &noiseSettings.numOctaves, 1, 8);
+        // seed_type is not 32 bits everywhere, but the seeds are
+        ImU32 seed = static_cast<ImU32>(noiseSettings.seed);
+        if(ImGui::InputScalar("seed", ImGuiDataType_U32, &seed)){
+            noiseSettings.seed = seed;
+            noiseChanged = true;
+        }
+        int octaveCacheMB = static_cast<int>(octaveCache.GetMaxBytes() >> 20);
+        if(ImGui::SliderInt("octave cache (MB)", &octaveCacheMB, 0, 1024)){
+            octaveCache.SetMaxBytes(static_cast<std::size_t>(octaveCacheMB) << 20);
+        }
+        ImGui::Text("%zu chunks cached, %.1f MB, %zu hits, %zu misses", octaveCache.GetEntryCount(),
+                    octaveCache.GetBytes() / (1024.0 * 1024.0), octaveCache.GetHits(), octaveCache.GetMisses());
         ImGui::End();
 
-        // Render dear imgui into screen
+        // Resident chunks are rebuilt as jobs and swapped in like level changes, the render
+        // thread never generates anything. Dragging a slider only keeps the newest settings.
+        if(noiseChanged){
+            noise = NoiseContext(noiseSettings);
+            streamer.SetNoise(noise);
+            if(clipmap != nullptr){
+                clipmap->SetNoise(noise);
+            }
+        }
+
         ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
-        // Delay to slow things down just a bit!
-        SDL_Delay(25);  // TODO: You can change this or implement a frame
-                        // independent movement method if you like.
-      	//Update screen of our specified window
-      	SDL_GL_SwapWindow(GetSDLWindow());
+        // Hand the frame to the render thread
+        SceneSnapshot& snapshot = renderThread.GetSnapshot();
+        snapshot.frame = ++frame;
+        m_renderer->FillSnapshot(snapshot);
+        // Nearest first, so the depth test rejects more of the far chunks
+        snapshot.chunks.assign(resident.begin(), resident.end());
+        auto distance = [eye = snapshot.eye, terrainChunkSize](const ChunkCoord& c){
+            const float dx = (c.x + 0.5f) * (terrainChunkSize - 1) - eye.x;
+            const float dz = (c.z + 0.5f) * (terrainChunkSize - 1) - eye.z;
+            return dx * dx + dz * dz;
+        };
+        std::sort(snapshot.chunks.begin(), snapshot.chunks.end(), [&distance](const ChunkCoord& a, const ChunkCoord& b){
+            return distance(a) < distance(b);
+        });
+        snapshot.ui.Capture(ImGui::GetDrawData());
+        renderThread.Publish();
+
+        // Startup ends once the render thread swapped its first frame
+        if(!m_startup.HasFirstFrame()){
+            const RenderThread::Stats& stats = renderThread.GetStats();
+            if(stats.framesDrawn > 0){
+                m_startup.MarkFirstFrame(stats.firstFrameTime);
+                m_startup.Report();
+            }
+        }
+
+        // Keep the simulation at its own pace, whatever the draws cost
+        const Uint32 elapsed = SDL_GetTicks() - frameStart;
+        if(elapsed < simulationStepMs){
+            SDL_Delay(simulationStepMs - elapsed);
+        }
 	}
     
 
+    // The render thread deletes the chunks, then this thread takes the context back
+    // for the rest. The streamer and upload queue go at the end of the scope.
+    renderThread.Stop();
+    SDL_GL_MakeCurrent(m_window, m_openGLContext);
+
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplSDL2_Shutdown();
     ImGui::DestroyContext();
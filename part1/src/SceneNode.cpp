@@ -13,13 +13,20 @@ SceneNode::SceneNode(Object* ob){
 	// then there is no parent.
 	m_parent = nullptr;
 	std::string vertexShader, fragmentShader;
-	vertexShader = m_shader.LoadShader("./shaders/vert.glsl");
-	fragmentShader = m_shader.LoadShader("./shaders/frag.glsl");
+	vertexShader = Shader::LoadShader("./shaders/vert.glsl");
+	fragmentShader = Shader::LoadShader("./shaders/frag.glsl");
 
 	// Setup shaders for the node.
 	
 	// Actually create our shader
-	m_shader.CreateShader(vertexShader,fragmentShader);       
+	m_shader = std::make_shared<Shader>();
+	m_shader->CreateShader(vertexShader,fragmentShader);       
+}
+
+// A node drawn with a shader that was compiled once for many nodes
+SceneNode::SceneNode(Object* ob, std::shared_ptr<Shader> shader) : m_shader(std::move(shader)){
+	m_object = ob;
+	m_parent = nullptr;
 }
 
 // The destructor 
@@ -42,78 +49,81 @@ void SceneNode::AddChild(SceneNode* n){
 	m_children.push_back(n);
 }
 
+// Detaches a child node, which the caller now owns.
+void SceneNode::RemoveChild(SceneNode* n){
+	for(unsigned int i =0; i < m_children.size(); ++i){
+		if(m_children[i] == n){
+			m_children.erase(m_children.begin() + i);
+			n->m_parent = nullptr;
+			return;
+		}
+	}
+}
+
 // Draw simply draws the current nodes
 // object and all of its children. This is done by calling directly
 // the objects draw method.
 void SceneNode::Draw(){
 	// Bind the shader for this node or series of nodes
-	m_shader.Bind();
+	m_shader->Bind();
 	// Render our object
 	if(m_object!=nullptr){
 		// Render our object
 		m_object->Render();
-		// For any 'child nodes' also call the drawing routine.
-		for(int i =0; i < m_children.size(); ++i){
-			m_children[i]->Draw();
-		}
-	}	
+	}
+	// For any 'child nodes' also call the drawing routine.
+	// A node without an object just groups its children.
+	for(int i =0; i < m_children.size(); ++i){
+		m_children[i]->Draw();
+	}
 }
 
 // Update simply updates the current nodes
 // object. This is done by calling directly
 // the objects update method.
-// TODO: Consider not passting projection and camera here
-void SceneNode::Update(glm::mat4 projectionMatrix, Camera* camera){
-    if(m_object!=nullptr){
-
-		if(m_parent != nullptr){
-			m_worldTransform = m_parent->m_worldTransform * m_localTransform;
-		}
-		else {
-			m_worldTransform = m_localTransform;
-		}	
+void SceneNode::Update(const SceneSnapshot& snapshot){
+	if(m_parent != nullptr){
+		m_worldTransform = m_parent->m_worldTransform * m_localTransform;
+	}
+	else {
+		m_worldTransform = m_localTransform;
+	}
 
+    if(m_object!=nullptr){
     	// Now apply our shader 
-		m_shader.Bind();
+		m_shader->Bind();
     	// Set the uniforms in our current shader
 
         // For our object, we apply the texture in the following way
         // Note that we set the value to 0, because we have bound
         // our texture to slot 0.
-        m_shader.SetUniform1i("u_DiffuseMap",0);  
+        m_shader->SetUniform1i("u_DiffuseMap",0);  
         // Set the MVP Matrix for our object
         // Send it into our shader
-        m_shader.SetUniformMatrix4fv("model", &m_worldTransform.GetInternalMatrix()[0][0]);
-        m_shader.SetUniformMatrix4fv("view", &camera->GetWorldToViewmatrix()[0][0]);
-        m_shader.SetUniformMatrix4fv("projection", &projectionMatrix[0][0]);
-
-        m_shader.SetUniform3f("pointLights[0].lightColor",1.0f,1.0f,1.0f);
-        m_shader.SetUniform3f("pointLights[0].lightPos",
-           camera->GetEyeXPosition() + camera->GetViewXDirection(),
-           camera->GetEyeYPosition() + camera->GetViewYDirection(),
-           camera->GetEyeZPosition() + camera->GetViewZDirection());
-        m_shader.SetUniform1f("pointLights[0].ambientIntensity",1.0f);
-        m_shader.SetUniform1f("pointLights[0].specularStrength",0.5f);
-        m_shader.SetUniform1f("pointLights[0].constant",1.0f);
-        m_shader.SetUniform1f("pointLights[0].linear",0.003f);
-        m_shader.SetUniform1f("pointLights[0].quadratic",0.0f);
-		
-		// Create a second light
-        m_shader.SetUniform3f("pointLights[1].lightColor",1.0f,1.0f,1.0f);
-        m_shader.SetUniform3f("pointLights[1].lightPos",
-           (camera->GetEyeXPosition() + camera->GetViewXDirection()),
-           -(camera->GetEyeYPosition() + camera->GetViewYDirection()),
-           -(camera->GetEyeZPosition() + camera->GetViewZDirection()));
-        m_shader.SetUniform1f("pointLights[1].ambientIntensity",1.0f);
-        m_shader.SetUniform1f("pointLights[1].specularStrength",0.5f);
-        m_shader.SetUniform1f("pointLights[1].constant",1.0f);
-        m_shader.SetUniform1f("pointLights[1].linear",0.003f);
-        m_shader.SetUniform1f("pointLights[1].quadratic",0.0f);
-	
-		// Iterate through all of the children
-		for(int i =0; i < m_children.size(); ++i){
-			m_children[i]->Update(projectionMatrix, camera);
-		}
+        m_shader->SetUniformMatrix4fv("model", &m_worldTransform.GetInternalMatrix()[0][0]);
+        m_shader->SetUniformMatrix4fv("view", &snapshot.view[0][0]);
+        m_shader->SetUniformMatrix4fv("projection", &snapshot.projection[0][0]);
+
+        // The lights the simulation placed
+        for(int i = 0; i < SceneSnapshot::LightCount; ++i){
+            const PointLight& light = snapshot.lights[i];
+            const std::string name = "pointLights[" + std::to_string(i) + "].";
+            m_shader->SetUniform3f((name + "lightColor").c_str(), light.color.x, light.color.y, light.color.z);
+            m_shader->SetUniform3f((name + "lightPos").c_str(), light.position.x, light.position.y, light.position.z);
+            m_shader->SetUniform1f((name + "ambientIntensity").c_str(), light.ambientIntensity);
+            m_shader->SetUniform1f((name + "specularStrength").c_str(), light.specularStrength);
+            m_shader->SetUniform1f((name + "constant").c_str(), light.constant);
+            m_shader->SetUniform1f((name + "linear").c_str(), light.linear);
+            m_shader->SetUniform1f((name + "quadratic").c_str(), light.quadratic);
+        }
+
+        // Anything particular to the object, like how its vertices are packed
+        m_object->SetUniforms(*m_shader);
+	}
+
+	// Iterate through all of the children, a node without an object just groups them
+	for(int i =0; i < m_children.size(); ++i){
+		m_children[i]->Update(snapshot);
 	}
 }
 
@@ -0,0 +1,37 @@
+#include "SceneSnapshot.hpp"
+
+#include <cstring>
+
+// Resizes dst to src and copies it, without freeing what dst already holds
+template<typename T>
+static void CopyVector(ImVector<T>& dst, const ImVector<T>& src){
+    dst.resize(src.Size);
+    if(src.Size > 0){
+        std::memcpy(dst.Data, src.Data, static_cast<std::size_t>(src.Size) * sizeof(T));
+    }
+}
+
+void UiSnapshot::Capture(const ImDrawData* drawData){
+    const int count = drawData->CmdListsCount;
+    while(static_cast<int>(m_lists.size()) < count){
+        m_lists.emplace_back(new ImDrawList(drawData->CmdLists[m_lists.size()]->_Data));
+    }
+    m_listPointers.resize(count);
+    for(int i = 0; i < count; ++i){
+        // Only what the renderer reads
+        const ImDrawList* source = drawData->CmdLists[i];
+        ImDrawList* copy = m_lists[i].get();
+        CopyVector(copy->CmdBuffer, source->CmdBuffer);
+        CopyVector(copy->IdxBuffer, source->IdxBuffer);
+        CopyVector(copy->VtxBuffer, source->VtxBuffer);
+        copy->Flags = source->Flags;
+        m_listPointers[i] = copy;
+    }
+
+    m_drawData = *drawData;
+    m_drawData.CmdLists = m_listPointers.data();
+}
+
+ImDrawData* UiSnapshot::GetDrawData(){
+    return &m_drawData;
+}
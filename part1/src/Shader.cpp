@@ -4,7 +4,7 @@
 #include <fstream>
 
 // Constructor
-Shader::Shader(){}
+Shader::Shader() : m_shaderID(0){}
 
 // Destructor
 Shader::~Shader(){
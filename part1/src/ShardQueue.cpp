@@ -0,0 +1,166 @@
+#include "ShardQueue.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+// Constructor
+ShardQueue::ShardQueue(const std::string& directory) : m_directory(directory){
+
+}
+
+bool ShardQueue::Create(const std::vector<Shard>& shards){
+    std::error_code error;
+    for(const char* state : { "pending", "claimed", "done", "failed" }){
+        const fs::path path = fs::path(m_directory) / state;
+        fs::remove_all(path, error);
+        fs::create_directories(path, error);
+        if(error){
+            return false;
+        }
+    }
+    for(const Shard& shard : shards){
+        if(!WriteShard((fs::path(m_directory) / "pending" / GetName(shard.index)).string(), shard)){
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ShardQueue::Claim(const std::string& worker, Shard& shard){
+    const fs::path pending = fs::path(m_directory) / "pending";
+    std::vector<std::string> names;
+    std::error_code error;
+    for(const fs::directory_entry& entry : fs::directory_iterator(pending, error)){
+        const std::string name = entry.path().filename().string();
+        // Files still being written start with a dot
+        if(name[0] != '.'){
+            names.push_back(name);
+        }
+    }
+    // Lowest index first, the names sort like the indices
+    std::sort(names.begin(), names.end());
+    for(const std::string& name : names){
+        const fs::path claimed = fs::path(m_directory) / "claimed" / (name + "." + worker);
+        // Only one worker's rename finds the file, the others move on to the next
+        fs::rename(pending / name, claimed, error);
+        if(!error && ReadShard(claimed.string(), shard)){
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ShardQueue::Complete(const Shard& shard, const std::string& worker, const std::string& result){
+    const std::string name = GetName(shard.index);
+    const fs::path claimed = fs::path(m_directory) / "claimed" / (name + "." + worker);
+    {
+        std::ofstream file(claimed, std::ios::app);
+        file << result << "\n";
+        if(!file.good()){
+            return false;
+        }
+    }
+    std::error_code error;
+    fs::rename(claimed, fs::path(m_directory) / "done" / name, error);
+    return !error;
+}
+
+std::size_t ShardQueue::Requeue(const std::string& worker, unsigned int maxAttempts){
+    const fs::path claimedDirectory = fs::path(m_directory) / "claimed";
+    const std::string suffix = "." + worker;
+    std::vector<fs::path> held;
+    std::error_code error;
+    for(const fs::directory_entry& entry : fs::directory_iterator(claimedDirectory, error)){
+        const std::string name = entry.path().filename().string();
+        if(name.size() > suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0){
+            held.push_back(entry.path());
+        }
+    }
+    for(const fs::path& path : held){
+        Shard shard;
+        if(!ReadShard(path.string(), shard)){
+            continue;
+        }
+        ++shard.attempts;
+        const std::string name = GetName(shard.index);
+        if(shard.attempts >= maxAttempts){
+            WriteShard((fs::path(m_directory) / "failed" / name).string(), shard);
+        }
+        else{
+            // Written aside and renamed in, so no worker claims half a file
+            const fs::path staging = fs::path(m_directory) / "pending" / ("." + name);
+            if(WriteShard(staging.string(), shard)){
+                fs::rename(staging, fs::path(m_directory) / "pending" / name, error);
+            }
+        }
+        fs::remove(path, error);
+    }
+    return held.size();
+}
+
+ShardQueue::Counts ShardQueue::GetCounts() const{
+    auto count = [this](const char* state){
+        std::size_t files = 0;
+        std::error_code error;
+        for(const fs::directory_entry& entry : fs::directory_iterator(fs::path(m_directory) / state, error)){
+            files += entry.path().filename().string()[0] != '.';
+        }
+        return files;
+    };
+    Counts counts;
+    counts.pending = count("pending");
+    counts.claimed = count("claimed");
+    counts.done = count("done");
+    counts.failed = count("failed");
+    return counts;
+}
+
+std::vector<std::pair<Shard, std::string>> ShardQueue::GetDone() const{
+    std::vector<std::pair<Shard, std::string>> done;
+    std::error_code error;
+    for(const fs::directory_entry& entry : fs::directory_iterator(fs::path(m_directory) / "done", error)){
+        std::pair<Shard, std::string> shard;
+        if(ReadShard(entry.path().string(), shard.first, &shard.second)){
+            done.push_back(shard);
+        }
+    }
+    std::sort(done.begin(), done.end(), [](const std::pair<Shard, std::string>& a, const std::pair<Shard, std::string>& b){
+        return a.first.index < b.first.index;
+    });
+    return done;
+}
+
+std::string ShardQueue::GetName(unsigned int index){
+    char name[32];
+    std::snprintf(name, sizeof(name), "shard_%06u", index);
+    return name;
+}
+
+bool ShardQueue::WriteShard(const std::string& path, const Shard& shard){
+    std::ofstream file(path, std::ios::trunc);
+    file << shard.index << " " << shard.originX << " " << shard.originZ << " " << shard.chunksX << " " << shard.chunksZ << " "
+         << shard.chunkSize << " " << shard.attempts << "\n";
+    return file.good();
+}
+
+bool ShardQueue::ReadShard(const std::string& path, Shard& shard, std::string* result){
+    std::ifstream file(path);
+    std::string line;
+    if(!std::getline(file, line)){
+        return false;
+    }
+    std::istringstream fields(line);
+    fields >> shard.index >> shard.originX >> shard.originZ >> shard.chunksX >> shard.chunksZ >> shard.chunkSize >> shard.attempts;
+    if(fields.fail()){
+        return false;
+    }
+    if(result != nullptr){
+        std::getline(file, *result);
+    }
+    return true;
+}
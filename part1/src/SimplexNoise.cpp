@@ -0,0 +1,130 @@
+#include "SimplexNoise.hpp"
+#include "NoiseMath.hpp"
+
+#include <cmath>
+
+using namespace NoiseMath;
+
+// Skews (x, y) onto the triangle grid, and back again
+static const float F2 = 0.36602540378f;     // (sqrt(3) - 1) / 2
+static const float G2 = 0.21132486540f;     // (3 - sqrt(3)) / 6
+
+// Normalizes the sum of the 3 corners to [-1, 1]
+static const float Scale = 99.2043f;
+
+// 12 unit gradients, 30 degrees apart
+static const float Gradients[12][2] = {
+    { 1.0f,        0.0f       }, { 0.8660254f,  0.5f       }, { 0.5f,        0.8660254f },
+    { 0.0f,        1.0f       }, {-0.5f,        0.8660254f }, {-0.8660254f,  0.5f       },
+    {-1.0f,        0.0f       }, {-0.8660254f, -0.5f       }, {-0.5f,       -0.8660254f },
+    { 0.0f,       -1.0f       }, { 0.5f,       -0.8660254f }, { 0.8660254f, -0.5f       }
+};
+
+// Contribution of one corner, falling off to 0 at a distance of sqrt(0.5)
+static inline float Corner(std::uint8_t gradient, float x, float y){
+    float t = 0.5f - x * x - y * y;
+    if(t <= 0.0f){
+        return 0.0f;
+    }
+    t *= t;
+    return t * t * (Gradients[gradient][0] * x + Gradients[gradient][1] * y);
+}
+
+// Corner() plus its derivatives: t^4 g - 8 t^3 (g.d) d
+static inline float CornerGradient(std::uint8_t gradient, float x, float y, float& dx, float& dy){
+    const float t = 0.5f - x * x - y * y;
+    if(t <= 0.0f){
+        dx = 0.0f;
+        dy = 0.0f;
+        return 0.0f;
+    }
+    const float gx = Gradients[gradient][0];
+    const float gy = Gradients[gradient][1];
+    const float dot = gx * x + gy * y;
+    const float t2 = t * t;
+    const float t4 = t2 * t2;
+    const float falloff = 8.0f * t2 * t * dot;
+    dx = t4 * gx - falloff * x;
+    dy = t4 * gy - falloff * y;
+    return t4 * dot;
+}
+
+// Constructor
+SimplexNoise::SimplexNoise(const siv::PerlinNoise& perlin){
+    const siv::PerlinNoise::state_type& state = perlin.serialize();
+    for(int i = 0; i < 512; ++i){
+        m_permutation[i] = state[i & 255];
+        m_gradientIndex[i] = m_permutation[i] % 12;
+    }
+}
+
+// Destructor
+SimplexNoise::~SimplexNoise(){
+
+}
+
+float SimplexNoise::Noise2D(float x, float y) const{
+    // Which skewed cell are we in
+    const float s = (x + y) * F2;
+    const std::int32_t i = FastFloor(x + s);
+    const std::int32_t j = FastFloor(y + s);
+
+    // Distance from the cell origin, back in (x, y) space
+    const float t = static_cast<float>(i + j) * G2;
+    const float x0 = x - (static_cast<float>(i) - t);
+    const float y0 = y - (static_cast<float>(j) - t);
+
+    // The cell is split along its diagonal, pick the triangle
+    const std::int32_t i1 = (x0 > y0) ? 1 : 0;
+    const std::int32_t j1 = 1 - i1;
+
+    const float x1 = x0 - static_cast<float>(i1) + G2;
+    const float y1 = y0 - static_cast<float>(j1) + G2;
+    const float x2 = x0 - 1.0f + 2.0f * G2;
+    const float y2 = y0 - 1.0f + 2.0f * G2;
+
+    const std::int32_t ii = i & 255;
+    const std::int32_t jj = j & 255;
+
+    const float n0 = Corner(m_gradientIndex[ii + m_permutation[jj]], x0, y0);
+    const float n1 = Corner(m_gradientIndex[ii + i1 + m_permutation[jj + j1]], x1, y1);
+    const float n2 = Corner(m_gradientIndex[ii + 1 + m_permutation[jj + 1]], x2, y2);
+
+    return Scale * (n0 + n1 + n2);
+}
+
+float SimplexNoise::Noise2DGradient(float x, float y, float& dx, float& dy) const{
+    // Same lattice walk as Noise2D()
+    const float s = (x + y) * F2;
+    const std::int32_t i = FastFloor(x + s);
+    const std::int32_t j = FastFloor(y + s);
+
+    const float t = static_cast<float>(i + j) * G2;
+    const float x0 = x - (static_cast<float>(i) - t);
+    const float y0 = y - (static_cast<float>(j) - t);
+
+    const std::int32_t i1 = (x0 > y0) ? 1 : 0;
+    const std::int32_t j1 = 1 - i1;
+
+    const float x1 = x0 - static_cast<float>(i1) + G2;
+    const float y1 = y0 - static_cast<float>(j1) + G2;
+    const float x2 = x0 - 1.0f + 2.0f * G2;
+    const float y2 = y0 - 1.0f + 2.0f * G2;
+
+    const std::int32_t ii = i & 255;
+    const std::int32_t jj = j & 255;
+
+    // The corner offsets move one for one with (x, y), so their derivatives add up directly
+    float dx0, dy0, dx1, dy1, dx2, dy2;
+    const float n0 = CornerGradient(m_gradientIndex[ii + m_permutation[jj]], x0, y0, dx0, dy0);
+    const float n1 = CornerGradient(m_gradientIndex[ii + i1 + m_permutation[jj + j1]], x1, y1, dx1, dy1);
+    const float n2 = CornerGradient(m_gradientIndex[ii + 1 + m_permutation[jj + 1]], x2, y2, dx2, dy2);
+
+    dx = Scale * (dx0 + dx1 + dx2);
+    dy = Scale * (dy0 + dy1 + dy2);
+    return Scale * (n0 + n1 + n2);
+}
+
+NoiseBackend SimplexNoise::GetBackend() const{
+    return NoiseBackend::Simplex;
+}
@@ -0,0 +1,92 @@
+#include "StagingRing.hpp"
+
+// Constructor
+StagingRing::StagingRing(std::uint8_t* memory, std::size_t capacity) : m_memory(memory), m_capacity(capacity){
+
+}
+
+// Destructor
+StagingRing::~StagingRing(){
+
+}
+
+bool StagingRing::Reserve(std::size_t size, Span& span){
+    // Keep every span aligned by rounding the sizes
+    const std::size_t rounded = (size + Alignment - 1) / Alignment * Alignment;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::size_t offset = m_capacity;
+    if(m_blocks.empty()){
+        m_head = 0;
+        if(rounded <= m_capacity){
+            offset = 0;
+        }
+    }else{
+        const std::size_t tail = m_blocks.front().offset;
+        if(m_head > tail){
+            // Live blocks in [tail, head), free at the end and before tail
+            if(rounded <= m_capacity - m_head){
+                offset = m_head;
+            }else if(rounded <= tail){
+                // The end of the ring is too short, skip it
+                if(m_head < m_capacity){
+                    m_blocks.push_back({ m_head, m_capacity - m_head, true });
+                }
+                offset = 0;
+            }
+        }else if(rounded <= tail - m_head){
+            // Wrapped, free in [head, tail)
+            offset = m_head;
+        }
+    }
+
+    if(offset == m_capacity){
+        ++m_failedReserves;
+        return false;
+    }
+    m_blocks.push_back({ offset, rounded, false });
+    m_head = offset + rounded;
+
+    span.offset = offset;
+    span.size = size;
+    span.data = m_memory + offset;
+    return true;
+}
+
+void StagingRing::Release(const Span& span){
+    if(span.size == 0){
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for(Block& block : m_blocks){
+        if(block.offset == span.offset && !block.released){
+            block.released = true;
+            break;
+        }
+    }
+    // The space is free once everything older is
+    while(!m_blocks.empty() && m_blocks.front().released){
+        m_blocks.pop_front();
+    }
+    if(m_blocks.empty()){
+        m_head = 0;
+    }
+}
+
+std::size_t StagingRing::GetCapacity() const{
+    return m_capacity;
+}
+
+std::size_t StagingRing::GetUsedBytes() const{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(m_blocks.empty()){
+        return 0;
+    }
+    const std::size_t tail = m_blocks.front().offset;
+    return m_head > tail ? m_head - tail : m_capacity - tail + m_head;
+}
+
+std::size_t StagingRing::GetFailedReserves() const{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_failedReserves;
+}
@@ -0,0 +1,86 @@
+#include "StartupTimeline.hpp"
+#include "Clock.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+// Constructor
+StartupTimeline::StartupTimeline() : m_origin(Clock::Now()), m_mainThread(std::this_thread::get_id()){
+
+}
+
+std::size_t StartupTimeline::Begin(const std::string& name){
+    const double start = Clock::Now();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_steps.push_back(Step{ name, GetThreadName(), start, start });
+    return m_steps.size() - 1;
+}
+
+void StartupTimeline::End(std::size_t step){
+    const double end = Clock::Now();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_steps[step].end = end;
+}
+
+void StartupTimeline::Record(const std::string& name, double start, double end, const std::string& thread){
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_steps.push_back(Step{ name, thread, start, end });
+}
+
+void StartupTimeline::MarkFirstFrame(double time){
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_firstFrame = time;
+}
+
+bool StartupTimeline::HasFirstFrame() const{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_firstFrame >= 0.0;
+}
+
+std::string StartupTimeline::GetThreadName(){
+    const std::thread::id id = std::this_thread::get_id();
+    if(id == m_mainThread){
+        return "main";
+    }
+    auto it = std::find(m_workers.begin(), m_workers.end(), id);
+    if(it == m_workers.end()){
+        m_workers.push_back(id);
+        it = m_workers.end() - 1;
+    }
+    return "worker " + std::to_string(it - m_workers.begin());
+}
+
+void StartupTimeline::Report() const{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<Step> steps = m_steps;
+    std::sort(steps.begin(), steps.end(), [](const Step& a, const Step& b){ return a.start < b.start; });
+
+    double last = m_firstFrame;
+    double busy = 0.0;
+    for(const Step& step : steps){
+        last = std::max(last, step.end);
+        busy += step.end - step.start;
+    }
+    const double span = std::max(last - m_origin, 1.0e-6);
+    const int barWidth = 40;
+
+    std::printf("Startup timeline (ms)\n");
+    std::printf("  %8s %8s %8s  %-9s  %-*s  %s\n", "start", "end", "time", "thread", barWidth + 2, "", "step");
+    for(const Step& step : steps){
+        const double start = step.start - m_origin;
+        const double end = step.end - m_origin;
+        const int from = static_cast<int>(start / span * barWidth);
+        const int to = std::max(static_cast<int>(end / span * barWidth), from + 1);
+        std::string bar(barWidth, ' ');
+        for(int i = from; i < std::min(to, barWidth); ++i){
+            bar[i] = '#';
+        }
+        std::printf("  %8.1f %8.1f %8.1f  %-9s  |%s|  %s\n", start * 1000.0, end * 1000.0, (end - start) * 1000.0,
+                    step.thread.c_str(), bar.c_str(), step.name.c_str());
+    }
+    if(m_firstFrame >= 0.0){
+        const double firstFrame = m_firstFrame - m_origin;
+        std::printf("  time to first frame: %.1f ms, %.1f ms of steps, %.2fx overlap\n", firstFrame * 1000.0, busy * 1000.0,
+                    busy / std::max(firstFrame, 1.0e-6));
+    }
+}
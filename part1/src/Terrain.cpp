@@ -1,253 +1,142 @@
 #include "Terrain.hpp"
 #include "Image.hpp"
-#include "PerlinNoise.hpp"
 
 #include <glad/glad.h>
-#include <memory>
 #include <iostream>
 
-// Constructor for our object
-// Calls the initialization method
-Terrain::Terrain(unsigned int chunkSize, unsigned int LOD, float xOffset, float zOffset) : m_chunkSize(chunkSize){
-    std::cout << "(Terrain.cpp) Constructor called \n";
-    
-
-    // WIP Level of Detail
-    if (LOD == 0){
-        m_LOD = 1;
-    } else {
-        m_LOD = 2*LOD;
-    }
-
-    m_scaledSize = m_chunkSize / m_LOD;
-
-    m_xOffset = m_chunkSize * xOffset;
-    m_zOffset = m_chunkSize * zOffset;
+Terrain::Terrain(ReadyChunk&& chunk, GridIndexCache& gridIndices, UploadQueue* uploads) :
+    m_builder(std::move(chunk.builder)), m_gridIndices(gridIndices){
+    m_xOffset = m_builder->GetXOffset();
+    m_zOffset = m_builder->GetZOffset();
 
-    // Initiliaze height data
-    m_noiseData = new float[m_scaledSize*m_scaledSize];
+    m_mesh = std::move(chunk.mesh);
+    if(uploads == nullptr){
+        Upload();
+        LoadPerlinTexture();
+        return;
+    }
 
-    
-    Init();
+    // Allocate the buffers and textures empty, the queue fills them
+    const unsigned int gridSize = m_builder->GetGridSize();
+    m_textureDiffuse.LoadPerlinTexture(gridSize, nullptr);
+
+    // Unstaged data comes straight from this chunk, which outlives the ticket
+    std::vector<UploadQueue::Copy> copies(2);
+    if(UsesHeightTexture()){
+        m_vertexBufferLayout.CreateAttributelessLayout();
+        m_heightTexture.LoadHeightTexture(gridSize, nullptr);
+        copies[0].texture = m_heightTexture.GetID();
+        copies[0].textureWidth = gridSize;
+        copies[0].textureFormat = GL_RG_INTEGER;
+        copies[0].textureType = GL_UNSIGNED_SHORT;
+        copies[0].textureMipmaps = false;
+        copies[0].size = m_mesh.GetTexelBytes();
+        copies[0].source = reinterpret_cast<const std::uint8_t*>(m_mesh.texels.data());
+    }else{
+        m_vertexBufferLayout.CreateTerrainBufferLayout(m_mesh.vertices.size(), nullptr);
+        copies[0].buffer = m_vertexBufferLayout.GetVertexBuffer();
+        copies[0].size = m_mesh.GetVertexBytes();
+        copies[0].source = reinterpret_cast<const std::uint8_t*>(m_mesh.vertices.data());
+    }
+    copies[1].texture = m_textureDiffuse.GetID();
+    copies[1].textureWidth = gridSize;
+    copies[1].size = static_cast<std::size_t>(gridSize) * gridSize * sizeof(std::uint32_t);
+    copies[1].stagedOffset = chunk.texelOffset;
+    copies[1].source = reinterpret_cast<const std::uint8_t*>(m_builder->GetColorData());
+    m_uploads = uploads;
+    m_uploadTicket = uploads->Upload(chunk.staged, copies);
 }
 
 // Destructor
 Terrain::~Terrain(){
-    // Delete our allocatted higheithmap data
-    if(m_noiseData!=nullptr){
-        delete m_noiseData;
-    }
-
-    if(m_terrainColor!=nullptr){
-        delete m_terrainColor;
-    }
+    CancelUpload();
 }
 
-// For creating a height curve
-float noiseToHeight(float noiseval){
-    // Noise	 	Color				Terrain
-    // 0		 	0, 0, 128, 255		Deep	
-    // 0.0375		0, 0, 255, 255		Shallow
-    // 0.5			0, 128, 255, 255	shore
-    // 0.53125		240, 240, 64, 255	sand
-    // 0.5625		32, 160, 0, 255		grass
-    // 0.6875		224, 224, 0, 255	dirt
-    // 0.875		128, 128, 128, 255	rock
-    // 1			255, 255, 255, 255	snow
-    
-    
-    float height;
-    // level height at sea level
-    if (noiseval <= 0.5f) {
-        height = 50;
-    } 
-    // deep to shallow
-    else {
-         height = noiseval * 100;
+void Terrain::Upload(){
+    if(UsesHeightTexture()){
+        // Nothing per vertex, the shader fetches everything from the texture
+        m_vertexBufferLayout.CreateAttributelessLayout();
+        m_heightTexture.LoadHeightTexture(m_builder->GetGridSize(), m_mesh.texels.data());
+        return;
     }
-
-    return height;
+    // Create a buffer and set the stride of information
+    m_vertexBufferLayout.CreateTerrainBufferLayout(m_mesh.vertices.size(), m_mesh.vertices.data());
 }
 
-void Terrain::Init(){
-    // Create the initial grid of vertices.
-    GenerateNoiseMap();
-    // TODO: (Inclass) Build grid of vertices! 
-    for(unsigned int z = 0; z < m_chunkSize; ++z){
-        for(unsigned int x = 0; x < m_chunkSize; ++x){
-
-
-            float v = ((float) z / (float) m_chunkSize);
-            float u = ((float) x / (float) m_chunkSize);
-
-            float noise = m_noiseData[x+(z*m_chunkSize)];
-
-            float y = noiseToHeight(noise);
-            
-            m_geometry.AddVertex((float) x, y, (float) z, u, v);
-            
-        }   
-    }
-    
-    // TODO: (Inclass) Build triangle strip
-
-    for (unsigned int z=0; z < m_chunkSize-1; ++z){
-        for (unsigned int x =0; x < m_chunkSize-1; ++x) {
-
-            m_geometry.AddIndex(x+(z*m_chunkSize));  // 0 = 0
-            m_geometry.AddIndex(x+(z*m_chunkSize) + m_chunkSize); // 1 = m_chunkSize
-            m_geometry.AddIndex(x+(z*m_chunkSize) + 1); // 2 = 1
-
-            m_geometry.AddIndex(x+(z*m_chunkSize) + 1);
-            m_geometry.AddIndex(x+(z*m_chunkSize) + m_chunkSize);
-            m_geometry.AddIndex(x+(z*m_chunkSize) + m_chunkSize+1);
+void Terrain::Render(){
+    if(!UsesHeightTexture()){
+        Bind();
+        // Every tile of a size has the same indices, counted from its first vertex
+        for(const TerrainTile& tile : m_mesh.tiles){
+            m_gridIndices.Draw(tile.verticesX, tile.verticesZ, static_cast<GLint>(tile.firstVertex));
         }
+        return;
     }
 
-   // Finally generate a simple 'array of bytes' that contains
-   // everything for our buffer to work with.
-   m_geometry.Gen();  
-   // Create a buffer and set the stride of information
-   m_vertexBufferLayout.CreateNormalBufferLayout(m_geometry.GetBufferDataSize(),
-                                        m_geometry.GetIndicesSize(),
-                                        m_geometry.GetBufferDataPtr(),
-                                        m_geometry.GetIndicesDataPtr());
+    // Bound first, so Bind() leaves texture unit 0 active
+    m_heightTexture.Bind(1);
+    Bind();
+    // The indices count vertices within the tile, the shader turns them into
+    // a grid position from the tile's origin, width and steps
+    for(const TerrainTile& tile : m_mesh.tiles){
+        glUniform2i(m_tileUniforms.origin, static_cast<GLint>(tile.x), static_cast<GLint>(tile.z));
+        glUniform1i(m_tileUniforms.verticesX, static_cast<GLint>(tile.verticesX));
+        glUniform2i(m_tileUniforms.step, tile.alongZ ? 0 : 1, tile.alongZ ? 1 : 0);
+        // A skirt's second row is its first one again, lowered
+        glUniform2i(m_tileUniforms.rowStep, 0, tile.skirt ? 0 : 1);
+        glUniform1f(m_tileUniforms.rowDrop, tile.skirt ? m_mesh.skirtDepth : 0.0f);
+        m_gridIndices.Draw(tile.verticesX, tile.verticesZ, 0);
+    }
 }
 
-// Loads an image and uses it to set the heights of the terrain.
-void Terrain::LoadHeightMap(Image image){
-
+void Terrain::SetUniforms(Shader& shader){
+    // Texture coordinates are the grid position over the chunk size
+    shader.SetUniform1f("u_chunkSize", static_cast<float>(m_builder->GetChunkSize()));
+    // The heights the unorm16 0 and 1 stand for, different for every chunk
+    shader.SetUniform1f("u_minHeight", m_mesh.minHeight);
+    shader.SetUniform1f("u_maxHeight", m_mesh.maxHeight);
+    if(UsesHeightTexture()){
+        shader.SetUniform1i("u_HeightMap", 1);
+        // Grid vertices are this many chunk vertices apart
+        shader.SetUniform1i("u_gridStride", static_cast<int>(m_builder->GetGridStride()));
+        // Render() sets these once per tile, right after
+        m_tileUniforms.origin = glGetUniformLocation(shader.GetID(), "u_tileOrigin");
+        m_tileUniforms.verticesX = glGetUniformLocation(shader.GetID(), "u_tileVerticesX");
+        m_tileUniforms.step = glGetUniformLocation(shader.GetID(), "u_tileStep");
+        m_tileUniforms.rowStep = glGetUniformLocation(shader.GetID(), "u_tileRowStep");
+        m_tileUniforms.rowDrop = glGetUniformLocation(shader.GetID(), "u_tileRowDrop");
+    }
 }
 
-void Terrain::LoadPerlinTexture(){
-   m_textureDiffuse.LoadPerlinTexture(m_chunkSize, m_terrainColor);
+bool Terrain::UsesHeightTexture() const{
+    return !m_mesh.texels.empty();
 }
 
-glm::uvec3 interpolateColor(float noiseval, float noiseFloor, float noiseCeiling, glm::vec3 baseCol, glm::vec3 ceilingCol){
-    float frac = (noiseval - noiseFloor) / (noiseCeiling - noiseFloor);
-    return glm::uvec3(((ceilingCol - baseCol) * frac) + baseCol);
+unsigned int Terrain::GetLOD() const{
+    return m_builder->GetLOD();
 }
 
-
-glm::uvec3 noiseToColor(float noiseval){
-     // Noise	 	Color				Terrain
-    // 0		 	0, 0, 128, 255		Deep	
-    // 0.0375		0, 0, 255, 255		Shallow
-    // 0.5			0, 128, 255, 255	shore
-    // 0.53125		240, 240, 64, 255	sand
-    // 0.5625		32, 160, 0, 255		grass
-    // 0.6875		224, 224, 0, 255	dirt
-    // 0.875		128, 128, 128, 255	rock
-    // 1			255, 255, 255, 255	snow
-
-    static glm::vec3 deepCol = glm::vec3(0.0, 0.0, 128.0);
-    static glm::vec3 shallowCol = glm::vec3(0.0, 0.0, 255.0);    
-    static glm::vec3 shoreCol = glm::vec3(0.0, 128.0, 255.0);
-    static glm::vec3 sandCol = glm::vec3(240.0, 240.0, 64.0);
-    static glm::vec3 grassCol = glm::vec3(32.0, 160.0, 0.0);
-    static glm::vec3 dirtCol = glm::vec3(64.0, 64.0, 64.0);
-    static glm::vec3 rockCol = glm::vec3(128.0, 128.0, 128.0);
-    static glm::vec3 snowCol = glm::vec3(255.0, 255.0, 255.0);
-
-    glm::uvec3 interpolatedCol;
-
-    // Rock to snow
-    if (noiseval >= 0.875f){
-        interpolatedCol = interpolateColor(noiseval, 0.875f, 1.0f, rockCol, snowCol);
-    } 
-    // Dirt to rock
-    else if (noiseval >= 0.6875f) {
-        interpolatedCol = interpolateColor(noiseval, 0.6875f, 0.875f, dirtCol, rockCol);
-    } 
-    // Grass to dirt
-    else if (noiseval >= 0.5625f) {
-        interpolatedCol = interpolateColor(noiseval, 0.5625f, 0.6875f, grassCol, dirtCol);
-    } 
-    // Sand to grass
-    else if (noiseval >= 0.53125f) {
-        interpolatedCol = interpolateColor(noiseval, 0.53125f, 0.5625f, sandCol, grassCol);
-    } 
-    // shore to sand
-    else if (noiseval >= 0.5f) {
-        interpolatedCol = interpolateColor(noiseval, 0.5f, 0.53125f, shoreCol, sandCol);
-    } 
-    // shallow to shore
-    else if (noiseval >= 0.0375f) {
-        interpolatedCol = interpolateColor(noiseval, 0.0375f, 0.5f, shallowCol, shoreCol);
-    } 
-    // deep to shallow
-    else {
-        interpolatedCol = interpolateColor(noiseval, 0.0f, 0.0375f, deepCol, shallowCol);
-    }
-
-    return interpolatedCol;
+bool Terrain::IsUploaded() const{
+    return m_uploadTicket == 0 || m_uploads->IsComplete(m_uploadTicket);
 }
 
-float Terrain::LayerPerlinNoise(float x, float z, int numOctaves, int startOctave = 1){
-    float result = 0;
-    
-    float persistence = 0.3f;
-    float amplitude = 1.0f;
-    float frequency = 4.0f;
-    float noiseWeight = amplitude;
-    
-    const siv::PerlinNoise::seed_type seed = 123456u;
-	const siv::PerlinNoise perlin{ seed };
-    
-    for (int i = (startOctave - 1); i < numOctaves; ++i){
-
-        
-
-        float sampleX = (x + m_xOffset) * (frequency / m_chunkSize);  // m_chunkSize = width
-        float sampleY = (z + m_zOffset) * (frequency / m_chunkSize);  // m_chunkSize = height
-   
-        result += amplitude * perlin.octave2D_01(sampleX, sampleY, (i + 1),  persistence);
-
-        if (i == numOctaves - 1){
-           break;
-        }
-          
-        persistence += 0.05f;
-        frequency *= 2.0f;
-        amplitude *= 0.5f;
-        noiseWeight += amplitude;
+void Terrain::CancelUpload(){
+    if(m_uploadTicket != 0){
+        m_uploads->Cancel(m_uploadTicket);
+        m_uploadTicket = 0;
     }
-
-    result = result/noiseWeight;
-
-    // if(result < 0.1f){
-    //     result = 0.1f;
-    // }
-
-    return result; 
 }
 
+// Loads an image and uses it to set the heights of the terrain.
+void Terrain::LoadHeightMap(Image image){
 
+}
 
-void Terrain::GenerateNoiseMap(){
-
-    m_terrainColor = new uint8_t[m_chunkSize*m_chunkSize*3];
-
-    for(unsigned int z = 0; z < m_chunkSize; ++z){
-        for(unsigned int x = 0; x < m_chunkSize; ++x){
-
-
-            float noiseval = LayerPerlinNoise(x, z, 6, 1);
-            
-            m_noiseData[x+(z*m_chunkSize)] = noiseval;
-
-            glm::uvec3 interpolatedCol = noiseToColor(noiseval);
-             
-            m_terrainColor[3*(x+(z*m_chunkSize))    ] = interpolatedCol.r;
-            m_terrainColor[3*(x+(z*m_chunkSize)) + 1] = interpolatedCol.g;
-            m_terrainColor[3*(x+(z*m_chunkSize)) + 2] = interpolatedCol.b;
-
-        }
-    }
-
-
-    std::cout <<"noise generated" <<std::endl;
-
+void Terrain::LoadPerlinTexture(){
+   m_textureDiffuse.LoadPerlinTexture(m_builder->GetGridSize(), reinterpret_cast<const uint8_t*>(m_builder->GetColorData()));
 }
 
+float Terrain::LayerPerlinNoise(float x, float z, int numOctaves, int startOctave){
+    return m_builder->LayerPerlinNoise(x, z, numOctaves, startOctave);
+}
 
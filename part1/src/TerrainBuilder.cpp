@@ -0,0 +1,471 @@
+#include "TerrainBuilder.hpp"
+#include "OctaveSampler.hpp"
+#include "GridIndices.hpp"
+#include "glm/glm.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+// Shared by every chunk created without a ramp
+static const TerrainRamp& GetDefaultRamp(){
+    static const TerrainRamp ramp(TerrainRamp::GetDefaultStops());
+    return ramp;
+}
+
+// Constructor
+TerrainBuilder::TerrainBuilder(unsigned int chunkSize, float xOffset, float zOffset, const NoiseContext& noise,
+                               OctaveCache* octaveCache, const TerrainRamp* ramp, ThreadPool* threadPool, unsigned int lod) :
+    m_chunkSize(chunkSize), m_lod(std::min(lod, GetMaxLOD(chunkSize))), m_gridStride(1u << m_lod),
+    m_gridSize((chunkSize-1) / m_gridStride + 1),
+    m_xOffset((chunkSize-1) * xOffset), m_zOffset((chunkSize-1) * zOffset), m_noise(noise),
+    m_octaveCache(octaveCache), m_ramp(ramp), m_threadPool(threadPool){
+    // Without a ramp of its own the chunk uses the original colours and heights
+    if(m_ramp == nullptr){
+        m_ramp = &GetDefaultRamp();
+    }
+    SetNoise(noise);
+
+    const std::size_t vertexCount = static_cast<std::size_t>(m_gridSize)*m_gridSize;
+    m_noiseData.resize(vertexCount);
+    m_noiseDx.resize(vertexCount);
+    m_noiseDz.resize(vertexCount);
+    m_heightData.resize(vertexCount);
+    m_heightSlope.resize(vertexCount);
+    m_terrainColor.resize(vertexCount);
+}
+
+// Destructor
+TerrainBuilder::~TerrainBuilder(){
+
+}
+
+void TerrainBuilder::SetNoise(const NoiseContext& noise){
+    m_noise = noise;
+    m_frequency = m_noise.GetSettings().frequency;
+}
+
+unsigned int TerrainBuilder::GetMaxLOD(unsigned int chunkSize){
+    // Every level's grid has to land on the last vertex
+    unsigned int lod = 0;
+    while(lod < MaxLOD && chunkSize > 1 && (chunkSize-1) % (2u << lod) == 0){
+        ++lod;
+    }
+    return lod;
+}
+
+void TerrainBuilder::SetSkirtStride(unsigned int stride){
+    m_skirtStride = stride;
+}
+
+unsigned int TerrainBuilder::GetChunkSize() const{
+    return m_chunkSize;
+}
+
+unsigned int TerrainBuilder::GetLOD() const{
+    return m_lod;
+}
+
+unsigned int TerrainBuilder::GetGridStride() const{
+    return m_gridStride;
+}
+
+unsigned int TerrainBuilder::GetGridSize() const{
+    return m_gridSize;
+}
+
+float TerrainBuilder::GetXOffset() const{
+    return m_xOffset;
+}
+
+float TerrainBuilder::GetZOffset() const{
+    return m_zOffset;
+}
+
+const float* TerrainBuilder::GetNoiseData() const{
+    return m_noiseData.data();
+}
+
+const float* TerrainBuilder::GetNoiseDx() const{
+    return m_noiseDx.data();
+}
+
+const float* TerrainBuilder::GetNoiseDz() const{
+    return m_noiseDz.data();
+}
+
+const float* TerrainBuilder::GetHeightData() const{
+    return m_heightData.data();
+}
+
+const std::uint32_t* TerrainBuilder::GetColorData() const{
+    return m_terrainColor.data();
+}
+
+void TerrainBuilder::ForEachRowBand(const ThreadPool::RangeFunction& body, unsigned int rowsPerBand) const{
+    if(m_threadPool == nullptr){
+        body(0, m_gridSize);
+        return;
+    }
+    m_threadPool->ParallelFor(m_gridSize, rowsPerBand, body);
+}
+
+// Mirrors the original octave loop: every layer is one octave higher,
+// with its own amplitude and persistence.
+template <class Layers>
+Layers TerrainBuilder::BuildFractalLayers(const NoiseSettings& settings, int numOctaves, int startOctave){
+    Layers layers(startOctave);
+
+    float persistence = settings.persistence;
+    float amplitude = settings.amplitude;
+
+    for (int i = (startOctave - 1); i < numOctaves; ++i){
+        layers.addLayer(amplitude, persistence);
+
+        persistence += settings.persistenceStep;
+        amplitude *= settings.gain;
+    }
+
+    return layers;
+}
+
+// The two schedules the chunks and the clipmap use
+template siv::FractalLayers TerrainBuilder::BuildFractalLayers<siv::FractalLayers>(const NoiseSettings&, int, int);
+template siv::BasicFractalLayers<float> TerrainBuilder::BuildFractalLayers<siv::BasicFractalLayers<float>>(const NoiseSettings&, int, int);
+
+void TerrainBuilder::SampleOctaveRows(const NoiseSource& source, const FractalKernel* kernel, int octaveCount, float xStart, float scale,
+                                      float y, std::size_t count, float* const* rows, float* const* dxRows, float* const* dyRows){
+    if(kernel != nullptr){
+        // Unrolled for this octave count
+        kernel->sampleRowsGradient(source, xStart, scale, y, count, rows, dxRows, dyRows);
+        return;
+    }
+    // Each octave doubles the previous one
+    for(int i = 0; i < octaveCount; ++i){
+        source.Noise2DRowGradient(xStart, scale, y, count, rows[i], dxRows[i], dyRows[i]);
+        y *= 2.0f;
+        scale *= 2.0f;
+    }
+}
+
+void TerrainBuilder::BlendOctaveRows(const siv::BasicFractalLayers<float>& layers, const FractalKernel* kernel, const float* const* rows,
+                                     const float* const* dxRows, const float* const* dyRows, std::size_t count,
+                                     float* noise, float* noiseDx, float* noiseDz){
+    if(kernel != nullptr){
+        kernel->blendRowsGradient(layers, rows, dxRows, dyRows, count, noise, noiseDx, noiseDz);
+    }else{
+        layers.blendRowsGradient(rows, dxRows, dyRows, count, noise, noiseDx, noiseDz);
+    }
+}
+
+glm::vec2 TerrainBuilder::GetHeightGradient(float heightSlope, float noiseDx, float noiseDz, float noiseScale){
+    const float slope = heightSlope * noiseScale;
+    return glm::vec2(slope * noiseDx, slope * noiseDz);
+}
+
+void TerrainBuilder::EncodeGradientNormal(const glm::vec2& gradient, std::int8_t normal[2]){
+    TerrainMesh::EncodeNormal(glm::normalize(glm::vec3(-gradient.x, 1.0f, -gradient.y)), normal);
+}
+
+float TerrainBuilder::LayerPerlinNoise(float x, float z, int numOctaves, int startOctave){
+    if (numOctaves != m_fractalOctaves || startOctave != m_fractalStartOctave){
+        m_fractalLayers = BuildFractalLayers<siv::FractalLayers>(m_noise.GetSettings(), numOctaves, startOctave);
+        m_fractalKernel = FindFractalKernel(m_fractalLayers.layerCount(), m_fractalLayers.startOctave());
+        m_fractalOctaves = numOctaves;
+        m_fractalStartOctave = startOctave;
+    }
+
+    if (m_fractalLayers.layerCount() == 0){
+        return 0.0f;
+    }
+
+    // Only the first octave needs scaling, the layers double it from there
+    const float scale = m_frequency / m_chunkSize;  // m_chunkSize = width = height
+    float sampleX = (x + m_xOffset) * scale;
+    float sampleY = (z + m_zOffset) * scale;
+
+    // Each octave is sampled once and blended by the schedule
+    if (m_noise.GetSettings().backend == NoiseBackend::Perlin){
+        // The permutation table is built once per seed and shared
+        const siv::PerlinNoise& perlin = m_noise.GetPerlin();
+        if (m_fractalKernel != nullptr){
+            return m_fractalKernel->layeredNoise(perlin, sampleX, sampleY, m_fractalLayers);
+        }
+        return perlin.layeredOctave2D_01(sampleX, sampleY, m_fractalLayers);
+    }
+
+    // Any other backend goes through the NoiseSource interface
+    const NoiseSource& source = m_noise.GetSource();
+    double samples[siv::FractalLayers::MaxSamples];
+    for (int i = 0; i < m_fractalLayers.sampleCount(); ++i){
+        samples[i] = source.Noise2D(sampleX, sampleY);
+        sampleX *= 2.0f;
+        sampleY *= 2.0f;
+    }
+    return m_fractalLayers.blend(samples);
+}
+
+void TerrainBuilder::GenerateNoiseMap(){
+    const NoiseSettings& settings = m_noise.GetSettings();
+
+    // Pick up any change to persistence or amplitude
+    m_fractalLayers = BuildFractalLayers<siv::FractalLayers>(settings, settings.numOctaves, settings.startOctave);
+    m_fractalKernel = FindFractalKernel(m_fractalLayers.layerCount(), m_fractalLayers.startOctave());
+    m_fractalOctaves = settings.numOctaves;
+    m_fractalStartOctave = settings.startOctave;
+
+    // The grid is sampled a row at a time by the selected backend, in float
+    const siv::BasicFractalLayers<float> rowLayers = BuildFractalLayers<siv::BasicFractalLayers<float>>(settings, settings.numOctaves, settings.startOctave);
+    const NoiseSource& source = m_noise.GetSource();
+
+    const int octaveCount = rowLayers.sampleCount();
+
+    // Grid vertices are m_gridStride vertices of a full resolution chunk apart, and the
+    // sample points are counted in grid vertices: the same points as level 0, every stride-th one
+    const float scale = m_frequency / m_chunkSize * m_gridStride;
+    const float xOrigin = m_xOffset / m_gridStride;
+    const float zOrigin = m_zOffset / m_gridStride;
+
+    // Smooth octaves may be sampled on a coarser grid, within the error bound
+    const std::vector<unsigned int> strides = ChooseOctaveStrides(rowLayers, settings.backend, scale, settings.multiresTolerance, m_gridSize);
+    const unsigned int coarsestStride = strides.empty() ? 1 : *std::max_element(strides.begin(), strides.end());
+    const bool multires = coarsestStride > 1;
+
+    // The octave samples do not depend on persistence or amplitude, so a cached
+    // chunk only needs the blend, as long as it was sampled fine enough for the new weights.
+    // On a miss the rows are sampled straight into new planes.
+    std::shared_ptr<const OctavePlanes> cachedPlanes;
+    std::shared_ptr<OctavePlanes> sampledPlanes;
+    OctaveCache::Key cacheKey{};
+    if(m_octaveCache != nullptr && rowLayers.layerCount() > 0){
+        cacheKey = OctaveCache::MakeKey(settings, m_frequency, m_chunkSize, m_xOffset, m_zOffset, octaveCount, m_gridStride);
+        cachedPlanes = m_octaveCache->Find(cacheKey);
+        if(cachedPlanes != nullptr && !cachedPlanes->IsWithinStrides(strides)){
+            cachedPlanes = nullptr;
+        }
+        if(cachedPlanes == nullptr){
+            sampledPlanes = std::make_shared<OctavePlanes>(octaveCount, m_gridSize);
+            for(int i = 0; i < octaveCount; ++i){
+                sampledPlanes->SetStride(i, strides[i]);
+            }
+        }
+    }
+
+    // Rows are sampled from an aligned column, and as many columns as make whole blocks of SampleAlignment.
+    // Every sample is then made by the SIMD body of the kernels and ramp, never by their scalar tail,
+    // so the vertices two chunks share come out bit-identical whatever their level or offset.
+    const int rowX = static_cast<int>(std::floor(xOrigin / SampleAlignment)) * static_cast<int>(SampleAlignment);
+    const unsigned int skip = static_cast<unsigned int>(static_cast<int>(xOrigin) - rowX);
+    const std::size_t rowWidth = (skip + m_gridSize + SampleAlignment - 1) / SampleAlignment * SampleAlignment;
+
+    // Every band has its own row buffers, and its own multires node rows. Bands start on a node
+    // row of every octave, so a band's node rows are only sampled again at its last row.
+    const unsigned int rowsPerBand = std::max(RowsPerBand, coarsestStride);
+    ForEachRowBand([&](std::size_t bandBegin, std::size_t bandEnd){
+        const unsigned int zBegin = static_cast<unsigned int>(bandBegin);
+        const unsigned int zEnd = static_cast<unsigned int>(bandEnd);
+
+        // One aligned row of samples per octave, and their derivatives
+        std::vector<float> octaveRows(3*octaveCount*rowWidth);
+        std::vector<float*> writeRows(3*octaveCount);
+        for(int i = 0; i < 3*octaveCount; ++i){
+            writeRows[i] = &octaveRows[i*rowWidth];
+        }
+        std::vector<const float*> rows(3*octaveCount);
+        float* const* writeDx = writeRows.data() + octaveCount;
+        float* const* writeDy = writeRows.data() + 2*octaveCount;
+        const float* const* dxRows = rows.data() + octaveCount;
+        const float* const* dyRows = rows.data() + 2*octaveCount;
+        OctaveRowSampler multiresSampler(source, static_cast<float>(rowX), zOrigin, scale, strides, static_cast<unsigned int>(rowWidth));
+        // The ramp's input and outputs for the aligned row
+        std::vector<float> noiseRow(rowWidth, 0.0f), heightRow(rowWidth), slopeRow(rowWidth);
+        std::vector<std::uint32_t> colorRow(rowWidth);
+
+        for(unsigned int z = zBegin; z < zEnd; ++z){
+            float* noise = &m_noiseData[z*m_gridSize];
+            float* noiseDx = &m_noiseDx[z*m_gridSize];
+            float* noiseDz = &m_noiseDz[z*m_gridSize];
+
+            if(rowLayers.layerCount() == 0){
+                std::fill_n(noise, m_gridSize, 0.0f);
+                std::fill_n(noiseDx, m_gridSize, 0.0f);
+                std::fill_n(noiseDz, m_gridSize, 0.0f);
+            }else{
+                const std::size_t rowStart = static_cast<std::size_t>(z)*m_gridSize;
+                if(cachedPlanes == nullptr){
+                    // Same sample points as LayerPerlinNoise, each octave doubles the previous one
+                    float sampleY = (z + zOrigin) * scale;
+                    if(multires){
+                        // Coarse octaves upsampled from their nodes, the rest sampled per vertex
+                        multiresSampler.SampleRow(z, writeRows.data(), writeDx, writeDy);
+                    }else{
+                        SampleOctaveRows(source, m_fractalKernel, octaveCount, static_cast<float>(rowX), scale, sampleY, rowWidth,
+                                         writeRows.data(), writeDx, writeDy);
+                    }
+                    // The chunk's columns are kept for the next blend
+                    if(sampledPlanes != nullptr){
+                        for(int i = 0; i < octaveCount; ++i){
+                            std::copy_n(writeRows[i] + skip, m_gridSize, sampledPlanes->Value(i) + rowStart);
+                            std::copy_n(writeDx[i] + skip, m_gridSize, sampledPlanes->Dx(i) + rowStart);
+                            std::copy_n(writeDy[i] + skip, m_gridSize, sampledPlanes->Dy(i) + rowStart);
+                        }
+                    }
+                }
+                for(int i = 0; i < octaveCount; ++i){
+                    if(cachedPlanes != nullptr){
+                        rows[i] = cachedPlanes->Value(i) + rowStart;
+                        rows[octaveCount + i] = cachedPlanes->Dx(i) + rowStart;
+                        rows[2*octaveCount + i] = cachedPlanes->Dy(i) + rowStart;
+                    }else{
+                        rows[i] = writeRows[i] + skip;
+                        rows[octaveCount + i] = writeDx[i] + skip;
+                        rows[2*octaveCount + i] = writeDy[i] + skip;
+                    }
+                }
+
+                // The gradient comes out of the same noise evaluations as the value.
+                // It is with respect to the first octave's coordinates, GetHeightGradient() scales it to vertices.
+                // The blend is plain C++ and the same for every column, it needs no alignment.
+                BlendOctaveRows(rowLayers, m_fractalKernel, rows.data(), dxRows, dyRows, m_gridSize, noise, noiseDx, noiseDz);
+            }
+
+            // Heights and colours for the row while it is still in cache, over the aligned row
+            std::copy_n(noise, m_gridSize, &noiseRow[skip]);
+            m_ramp->Apply(noiseRow.data(), rowWidth, heightRow.data(), slopeRow.data(), colorRow.data());
+            std::copy_n(&heightRow[skip], m_gridSize, &m_heightData[z*m_gridSize]);
+            std::copy_n(&slopeRow[skip], m_gridSize, &m_heightSlope[z*m_gridSize]);
+            std::copy_n(&colorRow[skip], m_gridSize, &m_terrainColor[z*m_gridSize]);
+        }
+    }, rowsPerBand);
+
+    if(sampledPlanes != nullptr){
+        m_octaveCache->Insert(cacheKey, std::move(sampledPlanes));
+    }
+}
+
+glm::vec2 TerrainBuilder::GetHeightGradient(std::size_t vertex) const{
+    // Height and its slope against the noise come from the ramp pass,
+    // the noise gradient is per first-octave unit and scaled to vertices here
+    return GetHeightGradient(m_heightSlope[vertex], m_noiseDx[vertex], m_noiseDz[vertex], m_frequency / m_chunkSize);
+}
+
+float TerrainBuilder::GetSkirtDepth() const{
+    if(m_skirtStride <= 1){
+        return 0.0f;
+    }
+    // A coarser neighbour's edge is the chord between its samples, m_skirtStride apart at most.
+    // The height strays at most half the steepest slope along the edge times that from the chord,
+    // the skirt hangs twice as deep.
+    float maxSlope = 0.0f;
+    const std::size_t last = m_gridSize-1;
+    for(std::size_t i = 0; i < m_gridSize; ++i){
+        maxSlope = std::max(maxSlope, std::abs(GetHeightGradient(i).x));
+        maxSlope = std::max(maxSlope, std::abs(GetHeightGradient(i + last*m_gridSize).x));
+        maxSlope = std::max(maxSlope, std::abs(GetHeightGradient(i*m_gridSize).y));
+        maxSlope = std::max(maxSlope, std::abs(GetHeightGradient(last + i*m_gridSize).y));
+    }
+    return maxSlope * m_skirtStride;
+}
+
+std::size_t TerrainBuilder::LayoutTiles(TerrainMesh& mesh, bool withVertices) const{
+    // Tiles small enough for 16-bit indices, the same cut along x and z
+    const std::vector<unsigned int> starts = GridIndices::SplitSide(m_gridSize-1);
+    const std::size_t tilesPerSide = starts.size()-1;
+    mesh.tiles.clear();
+    std::size_t vertexCount = 0;
+    auto addTile = [&](TerrainTile tile){
+        tile.firstVertex = withVertices ? static_cast<unsigned int>(vertexCount) : 0;
+        mesh.tiles.push_back(tile);
+        vertexCount += tile.verticesX*tile.verticesZ;
+    };
+    for(std::size_t tz = 0; tz < tilesPerSide; ++tz){
+        for(std::size_t tx = 0; tx < tilesPerSide; ++tx){
+            addTile(TerrainTile{ 0, starts[tx], starts[tz], starts[tx+1]-starts[tx]+1, starts[tz+1]-starts[tz]+1 });
+        }
+    }
+
+    // Heights are stored over the ramp's range, the same for every chunk and the clipmap,
+    // so a vertex on a shared edge encodes to the same value on both sides
+    mesh.minHeight = m_ramp->GetMinHeight();
+    mesh.maxHeight = m_ramp->GetMaxHeight();
+
+    // Two rows along every edge: the edge, and the edge lowered, cut like the tiles.
+    // The lowered row clamps at the bottom of the range, no edge of a neighbour goes below it.
+    mesh.skirtDepth = GetSkirtDepth();
+    if(mesh.skirtDepth > 0.0f){
+        const unsigned int last = m_gridSize-1;
+        for(std::size_t t = 0; t < tilesPerSide; ++t){
+            const unsigned int count = starts[t+1]-starts[t]+1;
+            addTile(TerrainTile{ 0, starts[t], 0, count, 2, true, false });
+            addTile(TerrainTile{ 0, starts[t], last, count, 2, true, false });
+            addTile(TerrainTile{ 0, 0, starts[t], count, 2, true, true });
+            addTile(TerrainTile{ 0, last, starts[t], count, 2, true, true });
+        }
+    }
+    return vertexCount;
+}
+
+void TerrainBuilder::EncodeVertex(std::size_t vertex, const TerrainMesh& mesh, std::uint16_t& height, std::int8_t normal[2]) const{
+    EncodeGradientNormal(GetHeightGradient(vertex), normal);
+    height = TerrainMesh::EncodeHeight(m_heightData[vertex], mesh.minHeight, mesh.maxHeight);
+}
+
+void TerrainBuilder::BuildMesh(TerrainMesh& mesh) const{
+    mesh.vertices.resize(LayoutTiles(mesh, true));
+    mesh.texels.clear();
+
+    ForEachRowBand([&](std::size_t zBegin, std::size_t zEnd){
+        // A whole row, then copied into every tile it runs through
+        std::vector<TerrainVertex> row(m_gridSize);
+        for(unsigned int z = zBegin; z < zEnd; ++z){
+            for(unsigned int x = 0; x < m_gridSize; ++x){
+                // Texture coordinates follow from x and z
+                TerrainVertex& out = row[x];
+                out.x = static_cast<std::uint16_t>(x*m_gridStride);
+                out.z = static_cast<std::uint16_t>(z*m_gridStride);
+                EncodeVertex(x+(static_cast<std::size_t>(z)*m_gridSize), mesh, out.height, out.normal);
+            }
+            // A row on the edge between two tile rows goes into both
+            for(const TerrainTile& tile : mesh.tiles){
+                if(tile.skirt || z < tile.z || z >= tile.z+tile.verticesZ){
+                    continue;
+                }
+                std::copy_n(&row[tile.x], tile.verticesX, &mesh.vertices[tile.firstVertex + (z-tile.z)*tile.verticesX]);
+            }
+        }
+    });
+
+    // The skirts are a few edges' worth of vertices, not worth a band
+    for(const TerrainTile& tile : mesh.tiles){
+        if(!tile.skirt){
+            continue;
+        }
+        for(unsigned int i = 0; i < tile.verticesX; ++i){
+            const unsigned int x = tile.alongZ ? tile.x : tile.x+i;
+            const unsigned int z = tile.alongZ ? tile.z+i : tile.z;
+            const std::size_t vertex = x+(static_cast<std::size_t>(z)*m_gridSize);
+            TerrainVertex& edge = mesh.vertices[tile.firstVertex + i];
+            edge.x = static_cast<std::uint16_t>(x*m_gridStride);
+            edge.z = static_cast<std::uint16_t>(z*m_gridStride);
+            EncodeVertex(vertex, mesh, edge.height, edge.normal);
+            TerrainVertex& lowered = mesh.vertices[tile.firstVertex + tile.verticesX + i];
+            lowered = edge;
+            lowered.height = TerrainMesh::EncodeHeight(m_heightData[vertex] - mesh.skirtDepth, mesh.minHeight, mesh.maxHeight);
+        }
+    }
+}
+
+void TerrainBuilder::BuildHeightTexels(TerrainMesh& mesh) const{
+    LayoutTiles(mesh, false);
+    mesh.vertices.clear();
+    // One texel per grid position, the tiles share their edges by reading the same ones
+    // and the skirts are lowered in the shader
+    mesh.texels.resize(static_cast<std::size_t>(m_gridSize)*m_gridSize);
+
+    ForEachRowBand([&](std::size_t zBegin, std::size_t zEnd){
+        for(std::size_t vertex = zBegin*m_gridSize; vertex < zEnd*m_gridSize; ++vertex){
+            TerrainTexel& out = mesh.texels[vertex];
+            EncodeVertex(vertex, mesh, out.height, out.normal);
+        }
+    });
+}
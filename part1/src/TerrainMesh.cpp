@@ -0,0 +1,68 @@
+#include "TerrainMesh.hpp"
+#include "glm/glm.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+// -1 or 1, 0 counts as positive so the fold has a side for it
+static float SignNotZero(float value){
+    return value < 0.0f ? -1.0f : 1.0f;
+}
+
+std::size_t TerrainMesh::GetVertexBytes() const{
+    return vertices.size() * sizeof(TerrainVertex);
+}
+
+std::size_t TerrainMesh::GetTexelBytes() const{
+    return texels.size() * sizeof(TerrainTexel);
+}
+
+std::size_t TerrainMesh::GetQuadCount() const{
+    std::size_t quads = 0;
+    for(const TerrainTile& tile : tiles){
+        quads += static_cast<std::size_t>(tile.verticesX - 1) * (tile.verticesZ - 1);
+    }
+    return quads;
+}
+
+std::uint16_t TerrainMesh::EncodeHeight(float height, float minHeight, float maxHeight){
+    if(maxHeight <= minHeight){
+        return 0;
+    }
+    const float unorm = std::clamp((height - minHeight) / (maxHeight - minHeight), 0.0f, 1.0f);
+    return static_cast<std::uint16_t>(std::lround(unorm * 65535.0f));
+}
+
+float TerrainMesh::DecodeHeight(std::uint16_t height, float minHeight, float maxHeight){
+    // Same as the mix() in vert.glsl
+    const float unorm = height / 65535.0f;
+    return minHeight * (1.0f - unorm) + maxHeight * unorm;
+}
+
+void TerrainMesh::EncodeNormal(const glm::vec3& normal, std::int8_t encoded[2]){
+    // Project onto the octahedron |x| + |y| + |z| = 1, then onto the xz plane
+    const float l1 = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    float x = normal.x / l1;
+    float z = normal.z / l1;
+    // The lower half folds over the diagonals
+    if(normal.y < 0.0f){
+        const float foldedX = (1.0f - std::abs(z)) * SignNotZero(x);
+        const float foldedZ = (1.0f - std::abs(x)) * SignNotZero(z);
+        x = foldedX;
+        z = foldedZ;
+    }
+    encoded[0] = static_cast<std::int8_t>(std::lround(std::clamp(x, -1.0f, 1.0f) * 127.0f));
+    encoded[1] = static_cast<std::int8_t>(std::lround(std::clamp(z, -1.0f, 1.0f) * 127.0f));
+}
+
+glm::vec3 TerrainMesh::DecodeNormal(const std::int8_t encoded[2]){
+    // Mirrors the decode in vert.glsl
+    const float x = std::max(encoded[0] / 127.0f, -1.0f);
+    const float z = std::max(encoded[1] / 127.0f, -1.0f);
+    glm::vec3 normal(x, 1.0f - std::abs(x) - std::abs(z), z);
+    if(normal.y < 0.0f){
+        normal.x = (1.0f - std::abs(z)) * SignNotZero(x);
+        normal.z = (1.0f - std::abs(x)) * SignNotZero(z);
+    }
+    return glm::normalize(normal);
+}
@@ -0,0 +1,274 @@
+#include "TerrainRamp.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    #define TERRAINRAMP_X86
+    #include <immintrin.h>
+    #define TERRAINRAMP_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+// The tables a kernel reads
+struct RampTables{
+    const float* heights;
+    const float* slopes;
+    const std::uint32_t* colors;
+};
+
+// ========================= Scalar kernel =========================
+
+// Maps noise[begin, end) through the tables, with no branches on the noise value
+static void ScalarApply(const RampTables& tables, const float* noise, std::size_t begin, std::size_t end,
+                        float* heights, float* slopes, std::uint32_t* colors){
+    const float top = static_cast<float>(TerrainRamp::Resolution);
+    const std::int32_t last = static_cast<std::int32_t>(TerrainRamp::Resolution) - 1;
+    for(std::size_t i = begin; i < end; ++i){
+        float t = noise[i] * top;
+        t = t > 0.0f ? t : 0.0f;
+        t = t < top ? t : top;
+        std::int32_t entry = static_cast<std::int32_t>(t);
+        entry = entry < last ? entry : last;
+        const float frac = t - static_cast<float>(entry);
+        const float h0 = tables.heights[entry];
+        heights[i] = h0 + frac * (tables.heights[entry + 1] - h0);
+        slopes[i] = tables.slopes[entry];
+        colors[i] = tables.colors[static_cast<std::int32_t>(t + 0.5f)];
+    }
+}
+
+#ifdef TERRAINRAMP_X86
+
+// ========================= AVX2 kernel =========================
+
+TERRAINRAMP_TARGET("avx2")
+static void AVX2Apply(const RampTables& tables, const float* noise, std::size_t count,
+                      float* heights, float* slopes, std::uint32_t* colors){
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 top = _mm256_set1_ps(static_cast<float>(TerrainRamp::Resolution));
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256i last = _mm256_set1_epi32(static_cast<int>(TerrainRamp::Resolution) - 1);
+    const __m256i one = _mm256_set1_epi32(1);
+    const int* colorTable = reinterpret_cast<const int*>(tables.colors);
+
+    std::size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        __m256 t = _mm256_mul_ps(_mm256_loadu_ps(noise + i), top);
+        t = _mm256_min_ps(_mm256_max_ps(t, zero), top);
+        const __m256i entry = _mm256_min_epi32(_mm256_cvttps_epi32(t), last);
+        const __m256 frac = _mm256_sub_ps(t, _mm256_cvtepi32_ps(entry));
+        const __m256 h0 = _mm256_i32gather_ps(tables.heights, entry, 4);
+        const __m256 h1 = _mm256_i32gather_ps(tables.heights, _mm256_add_epi32(entry, one), 4);
+        _mm256_storeu_ps(heights + i, _mm256_add_ps(h0, _mm256_mul_ps(frac, _mm256_sub_ps(h1, h0))));
+        _mm256_storeu_ps(slopes + i, _mm256_i32gather_ps(tables.slopes, entry, 4));
+        const __m256i nearest = _mm256_cvttps_epi32(_mm256_add_ps(t, half));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(colors + i), _mm256_i32gather_epi32(colorTable, nearest, 4));
+    }
+    ScalarApply(tables, noise, i, count, heights, slopes, colors);
+}
+
+// ========================= AVX-512 kernel =========================
+
+TERRAINRAMP_TARGET("avx512f")
+static void AVX512Apply(const RampTables& tables, const float* noise, std::size_t count,
+                        float* heights, float* slopes, std::uint32_t* colors){
+    const __m512 zero = _mm512_setzero_ps();
+    const __m512 top = _mm512_set1_ps(static_cast<float>(TerrainRamp::Resolution));
+    const __m512 half = _mm512_set1_ps(0.5f);
+    const __m512i last = _mm512_set1_epi32(static_cast<int>(TerrainRamp::Resolution) - 1);
+    const __m512i one = _mm512_set1_epi32(1);
+
+    std::size_t i = 0;
+    for(; i + 16 <= count; i += 16){
+        __m512 t = _mm512_mul_ps(_mm512_loadu_ps(noise + i), top);
+        t = _mm512_min_ps(_mm512_max_ps(t, zero), top);
+        const __m512i entry = _mm512_min_epi32(_mm512_cvttps_epi32(t), last);
+        const __m512 frac = _mm512_sub_ps(t, _mm512_cvtepi32_ps(entry));
+        const __m512 h0 = _mm512_i32gather_ps(entry, tables.heights, 4);
+        const __m512 h1 = _mm512_i32gather_ps(_mm512_add_epi32(entry, one), tables.heights, 4);
+        _mm512_storeu_ps(heights + i, _mm512_add_ps(h0, _mm512_mul_ps(frac, _mm512_sub_ps(h1, h0))));
+        _mm512_storeu_ps(slopes + i, _mm512_i32gather_ps(entry, tables.slopes, 4));
+        const __m512i nearest = _mm512_cvttps_epi32(_mm512_add_ps(t, half));
+        _mm512_storeu_si512(colors + i, _mm512_i32gather_epi32(nearest, tables.colors, 4));
+    }
+    ScalarApply(tables, noise, i, count, heights, slopes, colors);
+}
+
+#endif // TERRAINRAMP_X86
+
+// ========================= TerrainRamp =========================
+
+// Constructor
+TerrainRamp::TerrainRamp(const std::vector<RampStop>& stops) : TerrainRamp(stops, PerlinNoiseBatch::GetBestKernel()){
+
+}
+
+TerrainRamp::TerrainRamp(const std::vector<RampStop>& stops, PerlinNoiseBatch::Kernel kernel){
+    // The gathers need AVX2, SSE2 gets the scalar kernel
+    if(kernel == PerlinNoiseBatch::SSE2 || !PerlinNoiseBatch::IsSupported(kernel)){
+        kernel = PerlinNoiseBatch::Scalar;
+    }
+    m_kernel = kernel;
+    SetStops(stops);
+}
+
+// Destructor
+TerrainRamp::~TerrainRamp(){
+
+}
+
+void TerrainRamp::SetStops(const std::vector<RampStop>& stops){
+    m_stops = stops.empty() ? GetDefaultStops() : stops;
+    m_minHeight = m_maxHeight = m_stops.front().height;
+    for(const RampStop& stop : m_stops){
+        m_minHeight = std::min(m_minHeight, stop.height);
+        m_maxHeight = std::max(m_maxHeight, stop.height);
+    }
+    BuildTables();
+}
+
+const std::vector<RampStop>& TerrainRamp::GetStops() const{
+    return m_stops;
+}
+
+float TerrainRamp::GetMinHeight() const{
+    return m_minHeight;
+}
+
+float TerrainRamp::GetMaxHeight() const{
+    return m_maxHeight;
+}
+
+PerlinNoiseBatch::Kernel TerrainRamp::GetKernel() const{
+    return m_kernel;
+}
+
+float TerrainRamp::Height(float noise) const{
+    if(noise <= m_stops.front().noise){
+        return m_stops.front().height;
+    }
+    for(std::size_t k = 0; k + 1 < m_stops.size(); ++k){
+        const RampStop& a = m_stops[k];
+        const RampStop& b = m_stops[k + 1];
+        if(noise <= b.noise){
+            const float width = b.noise - a.noise;
+            return width > 0.0f ? a.height + (noise - a.noise) / width * (b.height - a.height) : b.height;
+        }
+    }
+    return m_stops.back().height;
+}
+
+float TerrainRamp::HeightSlope(float noise) const{
+    // A stop belongs to the segment below it, so the sea up to 0.5 is flat
+    if(noise <= m_stops.front().noise){
+        return 0.0f;
+    }
+    for(std::size_t k = 0; k + 1 < m_stops.size(); ++k){
+        const RampStop& a = m_stops[k];
+        const RampStop& b = m_stops[k + 1];
+        if(noise <= b.noise){
+            const float width = b.noise - a.noise;
+            return width > 0.0f ? (b.height - a.height) / width : 0.0f;
+        }
+    }
+    return 0.0f;
+}
+
+void TerrainRamp::BuildTables(){
+    m_heights.resize(Resolution + 1);
+    m_slopes.resize(Resolution);
+    m_colors.resize(Resolution + 1);
+
+    std::size_t k = 0;
+    for(unsigned int i = 0; i <= Resolution; ++i){
+        const float noise = static_cast<float>(i) / Resolution;
+        m_heights[i] = Height(noise);
+        // Entry i covers [i, i + 1) / Resolution, it takes the slope of its middle
+        if(i < Resolution){
+            m_slopes[i] = HeightSlope((i + 0.5f) / Resolution);
+        }
+
+        // Colours truncate like the glm::uvec3 conversion they replace
+        while(k + 1 < m_stops.size() && noise > m_stops[k + 1].noise){
+            ++k;
+        }
+        const RampStop& a = m_stops[k];
+        const RampStop& b = m_stops[std::min(k + 1, m_stops.size() - 1)];
+        const float width = b.noise - a.noise;
+        float frac = width > 0.0f ? (noise - a.noise) / width : 1.0f;
+        frac = std::min(std::max(frac, 0.0f), 1.0f);
+        const std::uint32_t r = static_cast<std::uint32_t>(a.r + (b.r - a.r) * frac);
+        const std::uint32_t g = static_cast<std::uint32_t>(a.g + (b.g - a.g) * frac);
+        const std::uint32_t bl = static_cast<std::uint32_t>(a.b + (b.b - a.b) * frac);
+        m_colors[i] = r | (g << 8) | (bl << 16) | (255u << 24);
+    }
+}
+
+void TerrainRamp::Apply(const float* noise, std::size_t count, float* heights, float* slopes, std::uint32_t* colors) const{
+    const RampTables tables{ m_heights.data(), m_slopes.data(), m_colors.data() };
+    switch(m_kernel){
+#ifdef TERRAINRAMP_X86
+        case PerlinNoiseBatch::AVX512: AVX512Apply(tables, noise, count, heights, slopes, colors); return;
+        case PerlinNoiseBatch::AVX2:   AVX2Apply(tables, noise, count, heights, slopes, colors); return;
+#endif
+        default:                       ScalarApply(tables, noise, 0, count, heights, slopes, colors); return;
+    }
+}
+
+std::vector<RampStop> TerrainRamp::GetDefaultStops(){
+    // Noise    Height  Colour          Terrain
+    // 0        50      0, 0, 128       Deep
+    // 0.0375   50      0, 0, 255       Shallow
+    // 0.5      50      0, 128, 255     Shore
+    // 0.53125  53.125  240, 240, 64    Sand
+    // 0.5625   56.25   32, 160, 0      Grass
+    // 0.6875   68.75   64, 64, 64      Dirt
+    // 0.875    87.5    128, 128, 128   Rock
+    // 1        100     255, 255, 255   Snow
+    return {
+        { 0.0f,     50.0f,   0,   0,   128 },
+        { 0.0375f,  50.0f,   0,   0,   255 },
+        { 0.5f,     50.0f,   0,   128, 255 },
+        { 0.53125f, 53.125f, 240, 240, 64  },
+        { 0.5625f,  56.25f,  32,  160, 0   },
+        { 0.6875f,  68.75f,  64,  64,  64  },
+        { 0.875f,   87.5f,   128, 128, 128 },
+        { 1.0f,     100.0f,  255, 255, 255 }
+    };
+}
+
+bool TerrainRamp::LoadStops(const std::string& path, std::vector<RampStop>& stops){
+    std::ifstream file(path);
+    if(!file){
+        return false;
+    }
+
+    std::vector<RampStop> loaded;
+    std::string line;
+    while(std::getline(file, line)){
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        RampStop stop;
+        unsigned int r, g, b;
+        if(!(fields >> stop.noise)){
+            // Blank or comment line
+            continue;
+        }
+        if(!(fields >> stop.height >> r >> g >> b) || r > 255 || g > 255 || b > 255){
+            return false;
+        }
+        if(!loaded.empty() && stop.noise < loaded.back().noise){
+            return false;
+        }
+        stop.r = static_cast<std::uint8_t>(r);
+        stop.g = static_cast<std::uint8_t>(g);
+        stop.b = static_cast<std::uint8_t>(b);
+        loaded.push_back(stop);
+    }
+    if(loaded.empty()){
+        return false;
+    }
+    stops = loaded;
+    return true;
+}
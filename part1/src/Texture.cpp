@@ -34,7 +34,7 @@ Texture::~Texture(){
 
 }
 
-void Texture::LoadPerlinTexture(unsigned int m_chunkSize, uint8_t* m_noiseData){
+void Texture::LoadPerlinTexture(unsigned int m_chunkSize, const uint8_t* m_noiseData){
 
     glEnable(GL_TEXTURE_2D); 
 	// Generate a buffer for our texture
@@ -56,11 +56,11 @@ void Texture::LoadPerlinTexture(unsigned int m_chunkSize, uint8_t* m_noiseData){
 	// At this point, we are now ready to load and send some data to OpenGL.
 	glTexImage2D(GL_TEXTURE_2D,
 							0 ,
-						GL_RGB,
+						GL_RGBA,
                         m_chunkSize,
                         m_chunkSize,
 						0,
-						GL_RGB,
+						GL_RGBA,
 						GL_UNSIGNED_BYTE,
 						m_noiseData); // Here is the raw pixel data
     // We are done with our texture data so we can unbind.
@@ -70,6 +70,44 @@ void Texture::LoadPerlinTexture(unsigned int m_chunkSize, uint8_t* m_noiseData){
 	glBindTexture(GL_TEXTURE_2D, 0);
 }
 
+void Texture::LoadHeightTexture(unsigned int chunkSize, const void* texels){
+    glGenTextures(1,&m_textureID);
+    glBindTexture(GL_TEXTURE_2D, m_textureID);
+    // Integer textures cannot be filtered, and the shader reads exact texels anyway
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    // Red is the height, green the two bytes of the normal
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RG16UI, chunkSize, chunkSize, 0, GL_RG_INTEGER, GL_UNSIGNED_SHORT, texels);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void Texture::LoadClipmapTexture(unsigned int size){
+    glGenTextures(1,&m_textureID);
+    glBindTexture(GL_TEXTURE_2D, m_textureID);
+    // Texture coordinates run on past the edge and wrap, like the texels do.
+    // Mipmaps would have to be rebuilt after every strip, the coarser levels stand in for them.
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void Texture::UpdateRegion(unsigned int x, unsigned int y, unsigned int width, unsigned int height,
+                           GLenum format, GLenum type, const void* pixels){
+    glBindTexture(GL_TEXTURE_2D, m_textureID);
+    // Rows of 4 byte pixels, but a strip can be any width
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, format, type, pixels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
 void Texture::LoadCubemapTexture(){
 	std::vector<std::string> faces = {
 		"skybox/right.ppm",
@@ -172,4 +210,8 @@ void Texture::Unbind(){
 	glBindTexture(GL_TEXTURE_2D, 0);
 }
 
+GLuint Texture::GetID() const{
+	return m_textureID;
+}
+
 
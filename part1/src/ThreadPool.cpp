@@ -0,0 +1,94 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+// Constructor
+ThreadPool::ThreadPool(unsigned int threadCount){
+    if(threadCount == 0){
+        threadCount = GetHardwareThreads();
+    }
+    for(unsigned int i = 1; i < threadCount; ++i){
+        m_workers.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+}
+
+// Destructor
+ThreadPool::~ThreadPool(){
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for(std::thread& worker : m_workers){
+        worker.join();
+    }
+}
+
+unsigned int ThreadPool::GetThreadCount() const{
+    return static_cast<unsigned int>(m_workers.size()) + 1;
+}
+
+unsigned int ThreadPool::GetHardwareThreads(){
+    return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+void ThreadPool::ParallelFor(std::size_t count, std::size_t grain, const RangeFunction& body){
+    grain = std::max<std::size_t>(grain, 1);
+    if(count == 0){
+        return;
+    }
+    // Nothing to share
+    if(m_workers.empty() || count <= grain){
+        body(0, count);
+        return;
+    }
+
+    std::lock_guard<std::mutex> loopLock(m_loopMutex);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_body = &body;
+        m_count = count;
+        m_grain = grain;
+        m_next.store(0);
+        m_active = static_cast<unsigned int>(m_workers.size());
+        ++m_generation;
+    }
+    m_wake.notify_all();
+
+    RunChunks();
+
+    // Every worker has to leave the loop before body goes out of scope
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this]{ return m_active == 0; });
+    m_body = nullptr;
+}
+
+void ThreadPool::RunChunks(){
+    for(;;){
+        const std::size_t begin = m_next.fetch_add(m_grain);
+        if(begin >= m_count){
+            return;
+        }
+        (*m_body)(begin, std::min(begin + m_grain, m_count));
+    }
+}
+
+void ThreadPool::WorkerLoop(){
+    std::uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for(;;){
+        m_wake.wait(lock, [this, seen]{ return m_stop || m_generation != seen; });
+        if(m_stop){
+            return;
+        }
+        seen = m_generation;
+
+        lock.unlock();
+        RunChunks();
+        lock.lock();
+
+        if(--m_active == 0){
+            m_done.notify_all();
+        }
+    }
+}
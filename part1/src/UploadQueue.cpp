@@ -0,0 +1,215 @@
+#include "UploadQueue.hpp"
+
+#include <algorithm>
+
+// GL_ARB_buffer_storage, not in the 3.3 core loader
+#ifndef GL_MAP_PERSISTENT_BIT
+    #define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+    #define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+// Constructor
+UploadQueue::UploadQueue(std::size_t capacity, std::size_t bytesPerFrame, BufferStorageFunction bufferStorage) :
+    m_bytesPerFrame(bytesPerFrame){
+    if(bufferStorage != nullptr){
+        // Immutable storage mapped once for good. Coherent, so worker writes need no flush.
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glGenBuffers(1, &m_buffer);
+        glBindBuffer(GL_COPY_READ_BUFFER, m_buffer);
+        bufferStorage(GL_COPY_READ_BUFFER, static_cast<GLsizeiptr>(capacity), nullptr, flags);
+        m_mapped = static_cast<std::uint8_t*>(glMapBufferRange(GL_COPY_READ_BUFFER, 0, static_cast<GLsizeiptr>(capacity), flags));
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        if(m_mapped == nullptr){
+            glDeleteBuffers(1, &m_buffer);
+            m_buffer = 0;
+        }
+    }
+
+    if(m_mapped != nullptr){
+        m_ring.reset(new StagingRing(m_mapped, capacity));
+    }else{
+        m_memory.resize(capacity);
+        m_ring.reset(new StagingRing(m_memory.data(), capacity));
+    }
+    m_stats.persistent = m_mapped != nullptr;
+}
+
+// Destructor
+UploadQueue::~UploadQueue(){
+    // The GPU may still be reading the ring
+    for(Fence& fence : m_fences){
+        glClientWaitSync(fence.sync, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+        glDeleteSync(fence.sync);
+    }
+    if(m_buffer != 0){
+        glBindBuffer(GL_COPY_READ_BUFFER, m_buffer);
+        glUnmapBuffer(GL_COPY_READ_BUFFER);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glDeleteBuffers(1, &m_buffer);
+    }
+}
+
+StagingRing& UploadQueue::GetRing(){
+    return *m_ring;
+}
+
+bool UploadQueue::IsPersistent() const{
+    return m_mapped != nullptr;
+}
+
+void UploadQueue::SetBytesPerFrame(std::size_t bytesPerFrame){
+    m_bytesPerFrame = bytesPerFrame;
+}
+
+std::size_t UploadQueue::GetBytesPerFrame() const{
+    return m_bytesPerFrame;
+}
+
+UploadQueue::Ticket UploadQueue::Upload(const StagingRing::Span& staged, const std::vector<Copy>& copies){
+    const Ticket ticket = m_nextTicket++;
+    m_uploads.push_back(PendingUpload{ ticket, staged, copies, 0, 0, false });
+    for(const Copy& copy : copies){
+        m_stats.pendingBytes += copy.size;
+        if(staged.size == 0){
+            m_stats.unstagedBytes += copy.size;
+        }
+    }
+    return ticket;
+}
+
+bool UploadQueue::IsComplete(Ticket ticket) const{
+    for(const PendingUpload& upload : m_uploads){
+        if(upload.ticket == ticket){
+            return false;
+        }
+    }
+    return ticket < m_nextTicket;
+}
+
+void UploadQueue::Cancel(Ticket ticket){
+    for(auto it = m_uploads.begin(); it != m_uploads.end(); ++it){
+        if(it->ticket == ticket){
+            for(std::size_t i = it->copyIndex; i < it->copies.size(); ++i){
+                m_stats.pendingBytes -= it->copies[i].size;
+            }
+            m_stats.pendingBytes += it->copied;
+            Retire(it->staged, it->started);
+            m_uploads.erase(it);
+            return;
+        }
+    }
+}
+
+void UploadQueue::Retire(const StagingRing::Span& span, bool started){
+    if(span.size == 0){
+        return;
+    }
+    // Copies out of plain memory are done when the call returns
+    if(!started || !IsPersistent()){
+        m_ring->Release(span);
+        return;
+    }
+    m_retired.push_back(span);
+}
+
+std::size_t UploadQueue::RunCopy(PendingUpload& upload, std::size_t budget){
+    const Copy& copy = upload.copies[upload.copyIndex];
+    const bool fromRing = upload.staged.size != 0;
+    const std::size_t sourceOffset = upload.staged.offset + copy.stagedOffset + upload.copied;
+    // Ring copies read the mapped buffer on the GPU, everything else is a pointer
+    const bool gpuCopy = fromRing && IsPersistent();
+    const std::uint8_t* source = fromRing ? upload.staged.data + copy.stagedOffset + upload.copied : copy.source + upload.copied;
+
+    std::size_t bytes = std::min(budget, copy.size - upload.copied);
+    if(copy.texture != 0){
+        // Whole rows only, at least one so a narrow budget still gets somewhere
+        const std::size_t rowBytes = static_cast<std::size_t>(copy.textureWidth) * 4;
+        const std::size_t rows = std::max<std::size_t>(bytes / rowBytes, 1);
+        bytes = std::min(rows * rowBytes, copy.size - upload.copied);
+        const GLint firstRow = static_cast<GLint>(upload.copied / rowBytes);
+
+        glBindTexture(GL_TEXTURE_2D, copy.texture);
+        if(gpuCopy){
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_buffer);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, firstRow, copy.textureWidth, static_cast<GLsizei>(bytes / rowBytes),
+                            copy.textureFormat, copy.textureType, reinterpret_cast<const void*>(sourceOffset));
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }else{
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, firstRow, copy.textureWidth, static_cast<GLsizei>(bytes / rowBytes),
+                            copy.textureFormat, copy.textureType, source);
+        }
+        if(copy.textureMipmaps && upload.copied + bytes == copy.size){
+            glGenerateMipmap(GL_TEXTURE_2D);
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }else{
+        // The copy targets leave the VAO and its element buffer alone
+        glBindBuffer(GL_COPY_WRITE_BUFFER, copy.buffer);
+        if(gpuCopy){
+            glBindBuffer(GL_COPY_READ_BUFFER, m_buffer);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(sourceOffset),
+                                static_cast<GLintptr>(upload.copied), static_cast<GLsizeiptr>(bytes));
+            glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        }else{
+            glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(upload.copied), static_cast<GLsizeiptr>(bytes), source);
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+    upload.started = true;
+    upload.copied += bytes;
+    if(upload.copied == copy.size){
+        ++upload.copyIndex;
+        upload.copied = 0;
+    }
+    return bytes;
+}
+
+void UploadQueue::PollFences(){
+    while(!m_fences.empty()){
+        const GLenum status = glClientWaitSync(m_fences.front().sync, 0, 0);
+        if(status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED){
+            // Fences pass in order, the rest are not done either
+            break;
+        }
+        glDeleteSync(m_fences.front().sync);
+        for(const StagingRing::Span& span : m_fences.front().spans){
+            m_ring->Release(span);
+        }
+        m_fences.pop_front();
+    }
+}
+
+void UploadQueue::Drain(){
+    PollFences();
+
+    std::size_t budget = m_bytesPerFrame;
+    std::size_t copied = 0;
+    while(!m_uploads.empty() && budget > 0){
+        PendingUpload& upload = m_uploads.front();
+        const std::size_t bytes = RunCopy(upload, budget);
+        copied += bytes;
+        budget -= std::min(budget, bytes);
+        if(upload.copyIndex == upload.copies.size()){
+            Retire(upload.staged, true);
+            m_uploads.pop_front();
+        }
+    }
+
+    // One fence covers every span that finished this frame
+    if(!m_retired.empty()){
+        m_fences.push_back(Fence{ glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), std::move(m_retired) });
+        m_retired.clear();
+    }
+
+    m_stats.lastFrameBytes = copied;
+    m_stats.totalBytes += copied;
+    m_stats.pendingBytes -= copied;
+    m_stats.fencesInFlight = m_fences.size();
+}
+
+UploadQueue::Stats UploadQueue::GetStats() const{
+    return m_stats;
+}
@@ -1,4 +1,5 @@
 #include "VertexBufferLayout.hpp"
+#include <cstddef>
 #include <iostream>
 
 
@@ -265,3 +266,48 @@ void VertexBufferLayout::CreateNormalBufferLayout(unsigned int vcount,unsigned i
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBufferObject);
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, icount*sizeof(unsigned int), idata,GL_STATIC_DRAW);
     }
+
+// The compact terrain layout
+//
+// x,z,height: three unsigned shorts
+// normal: two signed bytes, octahedral
+// No index buffer
+void VertexBufferLayout::CreateTerrainBufferLayout(unsigned int vcount, const TerrainVertex* vdata){
+        // The stride is in bytes here, a vertex is not a whole number of floats
+        m_stride = sizeof(TerrainVertex);
+
+        glGenVertexArrays(1, &m_VAOId);
+        glBindVertexArray(m_VAOId);
+
+        glGenBuffers(1, &m_vertexPositionBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, m_vertexPositionBuffer);
+        glBufferData(GL_ARRAY_BUFFER, vcount*sizeof(TerrainVertex), vdata, GL_STATIC_DRAW);
+
+        // Integer attributes (glVertexAttribIPointer) reach the shader unconverted,
+        // it scales them itself, so there is no question of how snorm8 maps to -1
+        glEnableVertexAttribArray(0);
+        glVertexAttribIPointer(0, 3, GL_UNSIGNED_SHORT, m_stride, (char*)offsetof(TerrainVertex, x));
+
+        glEnableVertexAttribArray(1);
+        glVertexAttribIPointer(1, 2, GL_BYTE, m_stride, (char*)offsetof(TerrainVertex, normal));
+
+        // The indices are shared between chunks, not part of the layout
+        m_indexBufferObject = 0;
+}
+
+void VertexBufferLayout::CreateAttributelessLayout(){
+        // Core profiles still want a vertex array bound to draw
+        glGenVertexArrays(1, &m_VAOId);
+        glBindVertexArray(m_VAOId);
+        m_vertexPositionBuffer = 0;
+        m_indexBufferObject = 0;
+        m_stride = 0;
+}
+
+GLuint VertexBufferLayout::GetVertexBuffer() const{
+        return m_vertexPositionBuffer;
+}
+
+GLuint VertexBufferLayout::GetIndexBuffer() const{
+        return m_indexBufferObject;
+}
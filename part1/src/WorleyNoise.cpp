@@ -0,0 +1,432 @@
+#include "WorleyNoise.hpp"
+#include "NoiseMath.hpp"
+
+#include <cmath>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    #define WORLEYNOISE_X86
+    #include <immintrin.h>
+    #define WORLEYNOISE_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+using namespace NoiseMath;
+
+// Turns 16 bits of the hash into a position in the cell
+static const float JitterScale = 1.0f / 65536.0f;
+
+// Larger than any squared distance the 3x3 search can find
+static const float FarAway = 16.0f;
+
+// ========================= Scalar kernel =========================
+
+// Hashes a cell to 32 bits: the low half places the feature point along x, the high half along y
+static inline std::uint32_t Hash(std::uint32_t seed, std::uint32_t hx, std::uint32_t hy){
+    std::uint32_t h = seed ^ hx ^ hy;
+    h ^= h >> 13;
+    h *= Mix;
+    h ^= h >> 15;
+    h *= Mix;
+    h ^= h >> 16;
+    return h;
+}
+
+// Squared F1 and F2, and the offset from (x, y) to the closest feature point
+static inline void ScalarCellular(std::uint32_t seed, float x, float y, float& f1, float& f2, float& nx, float& ny){
+    const std::int32_t _x = FastFloor(x);
+    const std::int32_t _y = FastFloor(y);
+
+    const float fx = x - static_cast<float>(_x);
+    const float fy = y - static_cast<float>(_y);
+
+    const std::uint32_t hx = static_cast<std::uint32_t>(_x) * PrimeX;
+    const std::uint32_t hy = static_cast<std::uint32_t>(_y) * PrimeY;
+
+    f1 = FarAway;
+    f2 = FarAway;
+    nx = 0.0f;
+    ny = 0.0f;
+    for(int oy = -1; oy <= 1; ++oy){
+        for(int ox = -1; ox <= 1; ++ox){
+            const std::uint32_t h = Hash(seed, hx + static_cast<std::uint32_t>(ox) * PrimeX, hy + static_cast<std::uint32_t>(oy) * PrimeY);
+            const float px = (static_cast<float>(ox) - fx) + static_cast<float>(h & 0xffffu) * JitterScale;
+            const float py = (static_cast<float>(oy) - fy) + static_cast<float>(h >> 16) * JitterScale;
+            const float d = px * px + py * py;
+            f2 = std::fmin(f2, std::fmax(f1, d));
+            if(d < f1){
+                nx = px;
+                ny = py;
+            }
+            f1 = std::fmin(f1, d);
+        }
+    }
+}
+
+static inline float ScalarNoise2D(std::uint32_t seed, float x, float y){
+    float f1, f2, nx, ny;
+    ScalarCellular(seed, x, y, f1, f2, nx, ny);
+    return 2.0f * std::sqrt(f1) - 1.0f;
+}
+
+// F1 grows away from the closest feature point
+static inline float ScalarNoise2DGradient(std::uint32_t seed, float x, float y, float& dx, float& dy){
+    float f1, f2, nx, ny;
+    ScalarCellular(seed, x, y, f1, f2, nx, ny);
+    const float distance = std::sqrt(f1);
+    dx = distance > 0.0f ? (-2.0f * nx) / distance : 0.0f;
+    dy = distance > 0.0f ? (-2.0f * ny) / distance : 0.0f;
+    return 2.0f * distance - 1.0f;
+}
+
+static void ScalarRow(std::uint32_t seed, float xStart, float xScale, float y, std::size_t begin, std::size_t count, float* out){
+    for(std::size_t i = begin; i < count; ++i){
+        out[i] = ScalarNoise2D(seed, (xStart + static_cast<float>(i)) * xScale, y);
+    }
+}
+
+static void ScalarPoints(std::uint32_t seed, const float* xs, const float* ys, std::size_t begin, std::size_t count, float* out){
+    for(std::size_t i = begin; i < count; ++i){
+        out[i] = ScalarNoise2D(seed, xs[i], ys[i]);
+    }
+}
+
+static void ScalarRowGradient(std::uint32_t seed, float xStart, float xScale, float y, std::size_t begin, std::size_t count, float* out, float* dx, float* dy){
+    for(std::size_t i = begin; i < count; ++i){
+        out[i] = ScalarNoise2DGradient(seed, (xStart + static_cast<float>(i)) * xScale, y, dx[i], dy[i]);
+    }
+}
+
+static void ScalarCellularRow(std::uint32_t seed, float xStart, float xScale, float y, std::size_t begin, std::size_t count, float* f1, float* f2){
+    for(std::size_t i = begin; i < count; ++i){
+        float nx, ny;
+        ScalarCellular(seed, (xStart + static_cast<float>(i)) * xScale, y, f1[i], f2[i], nx, ny);
+        f1[i] = std::sqrt(f1[i]);
+        f2[i] = std::sqrt(f2[i]);
+    }
+}
+
+#ifdef WORLEYNOISE_X86
+
+// ========================= AVX2 kernel (8 lanes) =========================
+// One sample per lane, every lane walks the same 9 cells, so the distances to
+// the 9 feature points are computed 8 samples at a time without any branches.
+
+WORLEYNOISE_TARGET("avx2")
+static inline __m256i Hash8(__m256i seed, __m256i hx, __m256i hy){
+    __m256i h = _mm256_xor_si256(seed, _mm256_xor_si256(hx, hy));
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 13));
+    h = _mm256_mullo_epi32(h, _mm256_set1_epi32((std::int32_t)Mix));
+    h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 15));
+    h = _mm256_mullo_epi32(h, _mm256_set1_epi32((std::int32_t)Mix));
+    return _mm256_xor_si256(h, _mm256_srli_epi32(h, 16));
+}
+
+WORLEYNOISE_TARGET("avx2")
+static inline void Cellular8(__m256i seed, __m256 x, __m256 y, __m256& f1, __m256& f2, __m256& nx, __m256& ny){
+    const __m256 xf = _mm256_floor_ps(x);
+    const __m256 yf = _mm256_floor_ps(y);
+    const __m256 fx = _mm256_sub_ps(x, xf);
+    const __m256 fy = _mm256_sub_ps(y, yf);
+    const __m256i hx = _mm256_mullo_epi32(_mm256_cvttps_epi32(xf), _mm256_set1_epi32((std::int32_t)PrimeX));
+    const __m256i hy = _mm256_mullo_epi32(_mm256_cvttps_epi32(yf), _mm256_set1_epi32((std::int32_t)PrimeY));
+    const __m256 jitterScale = _mm256_set1_ps(JitterScale);
+    const __m256i low = _mm256_set1_epi32(0xffff);
+
+    f1 = _mm256_set1_ps(FarAway);
+    f2 = f1;
+    nx = _mm256_setzero_ps();
+    ny = _mm256_setzero_ps();
+    for(int oy = -1; oy <= 1; ++oy){
+        const __m256i hyo = _mm256_add_epi32(hy, _mm256_set1_epi32((std::int32_t)(static_cast<std::uint32_t>(oy) * PrimeY)));
+        const __m256 dy = _mm256_sub_ps(_mm256_set1_ps(static_cast<float>(oy)), fy);
+        for(int ox = -1; ox <= 1; ++ox){
+            const __m256i hxo = _mm256_add_epi32(hx, _mm256_set1_epi32((std::int32_t)(static_cast<std::uint32_t>(ox) * PrimeX)));
+            const __m256i h = Hash8(seed, hxo, hyo);
+            const __m256 px = _mm256_add_ps(_mm256_sub_ps(_mm256_set1_ps(static_cast<float>(ox)), fx),
+                                            _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(h, low)), jitterScale));
+            const __m256 py = _mm256_add_ps(dy, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(h, 16)), jitterScale));
+            const __m256 d = _mm256_add_ps(_mm256_mul_ps(px, px), _mm256_mul_ps(py, py));
+            const __m256 closer = _mm256_cmp_ps(d, f1, _CMP_LT_OQ);
+            f2 = _mm256_min_ps(f2, _mm256_max_ps(f1, d));
+            f1 = _mm256_min_ps(f1, d);
+            nx = _mm256_blendv_ps(nx, px, closer);
+            ny = _mm256_blendv_ps(ny, py, closer);
+        }
+    }
+}
+
+WORLEYNOISE_TARGET("avx2")
+static inline __m256 RowX8(__m256 start, __m256 scale, std::size_t i){
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256 index = _mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_set1_epi32((std::int32_t)i), lanes));
+    return _mm256_mul_ps(_mm256_add_ps(start, index), scale);
+}
+
+WORLEYNOISE_TARGET("avx2")
+static inline __m256 Noise8(__m256i seed, __m256 x, __m256 y){
+    __m256 f1, f2, nx, ny;
+    Cellular8(seed, x, y, f1, f2, nx, ny);
+    return _mm256_sub_ps(_mm256_mul_ps(_mm256_set1_ps(2.0f), _mm256_sqrt_ps(f1)), _mm256_set1_ps(1.0f));
+}
+
+WORLEYNOISE_TARGET("avx2")
+static void AVX2Row(std::uint32_t seed, float xStart, float xScale, float y, std::size_t count, float* out){
+    const __m256i vseed = _mm256_set1_epi32((std::int32_t)seed);
+    const __m256 start = _mm256_set1_ps(xStart);
+    const __m256 scale = _mm256_set1_ps(xScale);
+    const __m256 vy = _mm256_set1_ps(y);
+    std::size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        _mm256_storeu_ps(out + i, Noise8(vseed, RowX8(start, scale, i), vy));
+    }
+    ScalarRow(seed, xStart, xScale, y, i, count, out);
+}
+
+WORLEYNOISE_TARGET("avx2")
+static void AVX2Points(std::uint32_t seed, const float* xs, const float* ys, std::size_t count, float* out){
+    const __m256i vseed = _mm256_set1_epi32((std::int32_t)seed);
+    std::size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        _mm256_storeu_ps(out + i, Noise8(vseed, _mm256_loadu_ps(xs + i), _mm256_loadu_ps(ys + i)));
+    }
+    ScalarPoints(seed, xs, ys, i, count, out);
+}
+
+WORLEYNOISE_TARGET("avx2")
+static void AVX2RowGradient(std::uint32_t seed, float xStart, float xScale, float y, std::size_t count, float* out, float* dx, float* dy){
+    const __m256i vseed = _mm256_set1_epi32((std::int32_t)seed);
+    const __m256 start = _mm256_set1_ps(xStart);
+    const __m256 scale = _mm256_set1_ps(xScale);
+    const __m256 vy = _mm256_set1_ps(y);
+    const __m256 minusTwo = _mm256_set1_ps(-2.0f);
+    std::size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        __m256 f1, f2, nx, ny;
+        Cellular8(vseed, RowX8(start, scale, i), vy, f1, f2, nx, ny);
+        const __m256 distance = _mm256_sqrt_ps(f1);
+        const __m256 away = _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_GT_OQ);
+        _mm256_storeu_ps(out + i, _mm256_sub_ps(_mm256_mul_ps(_mm256_set1_ps(2.0f), distance), _mm256_set1_ps(1.0f)));
+        _mm256_storeu_ps(dx + i, _mm256_and_ps(away, _mm256_div_ps(_mm256_mul_ps(minusTwo, nx), distance)));
+        _mm256_storeu_ps(dy + i, _mm256_and_ps(away, _mm256_div_ps(_mm256_mul_ps(minusTwo, ny), distance)));
+    }
+    ScalarRowGradient(seed, xStart, xScale, y, i, count, out, dx, dy);
+}
+
+WORLEYNOISE_TARGET("avx2")
+static void AVX2CellularRow(std::uint32_t seed, float xStart, float xScale, float y, std::size_t count, float* f1Out, float* f2Out){
+    const __m256i vseed = _mm256_set1_epi32((std::int32_t)seed);
+    const __m256 start = _mm256_set1_ps(xStart);
+    const __m256 scale = _mm256_set1_ps(xScale);
+    const __m256 vy = _mm256_set1_ps(y);
+    std::size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        __m256 f1, f2, nx, ny;
+        Cellular8(vseed, RowX8(start, scale, i), vy, f1, f2, nx, ny);
+        _mm256_storeu_ps(f1Out + i, _mm256_sqrt_ps(f1));
+        _mm256_storeu_ps(f2Out + i, _mm256_sqrt_ps(f2));
+    }
+    ScalarCellularRow(seed, xStart, xScale, y, i, count, f1Out, f2Out);
+}
+
+// ========================= AVX-512 kernel (16 lanes) =========================
+
+WORLEYNOISE_TARGET("avx512f")
+static inline __m512i Hash16(__m512i seed, __m512i hx, __m512i hy){
+    __m512i h = _mm512_xor_si512(seed, _mm512_xor_si512(hx, hy));
+    h = _mm512_xor_si512(h, _mm512_srli_epi32(h, 13));
+    h = _mm512_mullo_epi32(h, _mm512_set1_epi32((std::int32_t)Mix));
+    h = _mm512_xor_si512(h, _mm512_srli_epi32(h, 15));
+    h = _mm512_mullo_epi32(h, _mm512_set1_epi32((std::int32_t)Mix));
+    return _mm512_xor_si512(h, _mm512_srli_epi32(h, 16));
+}
+
+WORLEYNOISE_TARGET("avx512f")
+static inline void Cellular16(__m512i seed, __m512 x, __m512 y, __m512& f1, __m512& f2, __m512& nx, __m512& ny){
+    const __m512 xf = _mm512_roundscale_ps(x, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+    const __m512 yf = _mm512_roundscale_ps(y, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+    const __m512 fx = _mm512_sub_ps(x, xf);
+    const __m512 fy = _mm512_sub_ps(y, yf);
+    const __m512i hx = _mm512_mullo_epi32(_mm512_cvttps_epi32(xf), _mm512_set1_epi32((std::int32_t)PrimeX));
+    const __m512i hy = _mm512_mullo_epi32(_mm512_cvttps_epi32(yf), _mm512_set1_epi32((std::int32_t)PrimeY));
+    const __m512 jitterScale = _mm512_set1_ps(JitterScale);
+    const __m512i low = _mm512_set1_epi32(0xffff);
+
+    f1 = _mm512_set1_ps(FarAway);
+    f2 = f1;
+    nx = _mm512_setzero_ps();
+    ny = _mm512_setzero_ps();
+    for(int oy = -1; oy <= 1; ++oy){
+        const __m512i hyo = _mm512_add_epi32(hy, _mm512_set1_epi32((std::int32_t)(static_cast<std::uint32_t>(oy) * PrimeY)));
+        const __m512 dy = _mm512_sub_ps(_mm512_set1_ps(static_cast<float>(oy)), fy);
+        for(int ox = -1; ox <= 1; ++ox){
+            const __m512i hxo = _mm512_add_epi32(hx, _mm512_set1_epi32((std::int32_t)(static_cast<std::uint32_t>(ox) * PrimeX)));
+            const __m512i h = Hash16(seed, hxo, hyo);
+            const __m512 px = _mm512_add_ps(_mm512_sub_ps(_mm512_set1_ps(static_cast<float>(ox)), fx),
+                                            _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_and_si512(h, low)), jitterScale));
+            const __m512 py = _mm512_add_ps(dy, _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_srli_epi32(h, 16)), jitterScale));
+            const __m512 d = _mm512_add_ps(_mm512_mul_ps(px, px), _mm512_mul_ps(py, py));
+            const __mmask16 closer = _mm512_cmp_ps_mask(d, f1, _CMP_LT_OQ);
+            f2 = _mm512_min_ps(f2, _mm512_max_ps(f1, d));
+            f1 = _mm512_min_ps(f1, d);
+            nx = _mm512_mask_blend_ps(closer, nx, px);
+            ny = _mm512_mask_blend_ps(closer, ny, py);
+        }
+    }
+}
+
+WORLEYNOISE_TARGET("avx512f")
+static inline __m512 RowX16(__m512 start, __m512 scale, std::size_t i){
+    const __m512i lanes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m512 index = _mm512_cvtepi32_ps(_mm512_add_epi32(_mm512_set1_epi32((std::int32_t)i), lanes));
+    return _mm512_mul_ps(_mm512_add_ps(start, index), scale);
+}
+
+WORLEYNOISE_TARGET("avx512f")
+static inline __m512 Noise16(__m512i seed, __m512 x, __m512 y){
+    __m512 f1, f2, nx, ny;
+    Cellular16(seed, x, y, f1, f2, nx, ny);
+    return _mm512_sub_ps(_mm512_mul_ps(_mm512_set1_ps(2.0f), _mm512_sqrt_ps(f1)), _mm512_set1_ps(1.0f));
+}
+
+WORLEYNOISE_TARGET("avx512f")
+static void AVX512Row(std::uint32_t seed, float xStart, float xScale, float y, std::size_t count, float* out){
+    const __m512i vseed = _mm512_set1_epi32((std::int32_t)seed);
+    const __m512 start = _mm512_set1_ps(xStart);
+    const __m512 scale = _mm512_set1_ps(xScale);
+    const __m512 vy = _mm512_set1_ps(y);
+    std::size_t i = 0;
+    for(; i + 16 <= count; i += 16){
+        _mm512_storeu_ps(out + i, Noise16(vseed, RowX16(start, scale, i), vy));
+    }
+    ScalarRow(seed, xStart, xScale, y, i, count, out);
+}
+
+WORLEYNOISE_TARGET("avx512f")
+static void AVX512Points(std::uint32_t seed, const float* xs, const float* ys, std::size_t count, float* out){
+    const __m512i vseed = _mm512_set1_epi32((std::int32_t)seed);
+    std::size_t i = 0;
+    for(; i + 16 <= count; i += 16){
+        _mm512_storeu_ps(out + i, Noise16(vseed, _mm512_loadu_ps(xs + i), _mm512_loadu_ps(ys + i)));
+    }
+    ScalarPoints(seed, xs, ys, i, count, out);
+}
+
+WORLEYNOISE_TARGET("avx512f")
+static void AVX512RowGradient(std::uint32_t seed, float xStart, float xScale, float y, std::size_t count, float* out, float* dx, float* dy){
+    const __m512i vseed = _mm512_set1_epi32((std::int32_t)seed);
+    const __m512 start = _mm512_set1_ps(xStart);
+    const __m512 scale = _mm512_set1_ps(xScale);
+    const __m512 vy = _mm512_set1_ps(y);
+    const __m512 minusTwo = _mm512_set1_ps(-2.0f);
+    std::size_t i = 0;
+    for(; i + 16 <= count; i += 16){
+        __m512 f1, f2, nx, ny;
+        Cellular16(vseed, RowX16(start, scale, i), vy, f1, f2, nx, ny);
+        const __m512 distance = _mm512_sqrt_ps(f1);
+        const __mmask16 away = _mm512_cmp_ps_mask(distance, _mm512_setzero_ps(), _CMP_GT_OQ);
+        _mm512_storeu_ps(out + i, _mm512_sub_ps(_mm512_mul_ps(_mm512_set1_ps(2.0f), distance), _mm512_set1_ps(1.0f)));
+        _mm512_storeu_ps(dx + i, _mm512_maskz_div_ps(away, _mm512_mul_ps(minusTwo, nx), distance));
+        _mm512_storeu_ps(dy + i, _mm512_maskz_div_ps(away, _mm512_mul_ps(minusTwo, ny), distance));
+    }
+    ScalarRowGradient(seed, xStart, xScale, y, i, count, out, dx, dy);
+}
+
+WORLEYNOISE_TARGET("avx512f")
+static void AVX512CellularRow(std::uint32_t seed, float xStart, float xScale, float y, std::size_t count, float* f1Out, float* f2Out){
+    const __m512i vseed = _mm512_set1_epi32((std::int32_t)seed);
+    const __m512 start = _mm512_set1_ps(xStart);
+    const __m512 scale = _mm512_set1_ps(xScale);
+    const __m512 vy = _mm512_set1_ps(y);
+    std::size_t i = 0;
+    for(; i + 16 <= count; i += 16){
+        __m512 f1, f2, nx, ny;
+        Cellular16(vseed, RowX16(start, scale, i), vy, f1, f2, nx, ny);
+        _mm512_storeu_ps(f1Out + i, _mm512_sqrt_ps(f1));
+        _mm512_storeu_ps(f2Out + i, _mm512_sqrt_ps(f2));
+    }
+    ScalarCellularRow(seed, xStart, xScale, y, i, count, f1Out, f2Out);
+}
+
+#endif // WORLEYNOISE_X86
+
+// ========================= WorleyNoise =========================
+
+// Constructor
+WorleyNoise::WorleyNoise(std::uint32_t seed) : WorleyNoise(seed, PerlinNoiseBatch::GetBestKernel()){
+
+}
+
+WorleyNoise::WorleyNoise(std::uint32_t seed, PerlinNoiseBatch::Kernel kernel) : m_seed(seed){
+    // SSE2 has no 32 bit multiply, so it gets the scalar kernel
+    if(kernel == PerlinNoiseBatch::SSE2 || !PerlinNoiseBatch::IsSupported(kernel)){
+        kernel = PerlinNoiseBatch::Scalar;
+    }
+    m_kernel = kernel;
+}
+
+// Destructor
+WorleyNoise::~WorleyNoise(){
+
+}
+
+float WorleyNoise::Noise2D(float x, float y) const{
+    return ScalarNoise2D(m_seed, x, y);
+}
+
+void WorleyNoise::Noise2DRow(float xStart, float xScale, float y, std::size_t count, float* out) const{
+    switch(m_kernel){
+#ifdef WORLEYNOISE_X86
+        case PerlinNoiseBatch::AVX512: AVX512Row(m_seed, xStart, xScale, y, count, out); return;
+        case PerlinNoiseBatch::AVX2:   AVX2Row(m_seed, xStart, xScale, y, count, out); return;
+#endif
+        default:                       ScalarRow(m_seed, xStart, xScale, y, 0, count, out); return;
+    }
+}
+
+void WorleyNoise::Noise2DPoints(const float* xs, const float* ys, std::size_t count, float* out) const{
+    switch(m_kernel){
+#ifdef WORLEYNOISE_X86
+        case PerlinNoiseBatch::AVX512: AVX512Points(m_seed, xs, ys, count, out); return;
+        case PerlinNoiseBatch::AVX2:   AVX2Points(m_seed, xs, ys, count, out); return;
+#endif
+        default:                       ScalarPoints(m_seed, xs, ys, 0, count, out); return;
+    }
+}
+
+float WorleyNoise::Noise2DGradient(float x, float y, float& dx, float& dy) const{
+    return ScalarNoise2DGradient(m_seed, x, y, dx, dy);
+}
+
+void WorleyNoise::Noise2DRowGradient(float xStart, float xScale, float y, std::size_t count, float* out, float* dx, float* dy) const{
+    switch(m_kernel){
+#ifdef WORLEYNOISE_X86
+        case PerlinNoiseBatch::AVX512: AVX512RowGradient(m_seed, xStart, xScale, y, count, out, dx, dy); return;
+        case PerlinNoiseBatch::AVX2:   AVX2RowGradient(m_seed, xStart, xScale, y, count, out, dx, dy); return;
+#endif
+        default:                       ScalarRowGradient(m_seed, xStart, xScale, y, 0, count, out, dx, dy); return;
+    }
+}
+
+NoiseBackend WorleyNoise::GetBackend() const{
+    return NoiseBackend::Worley;
+}
+
+PerlinNoiseBatch::Kernel WorleyNoise::GetKernel() const{
+    return m_kernel;
+}
+
+void WorleyNoise::Cellular2D(float x, float y, float& f1, float& f2) const{
+    float nx, ny;
+    ScalarCellular(m_seed, x, y, f1, f2, nx, ny);
+    f1 = std::sqrt(f1);
+    f2 = std::sqrt(f2);
+}
+
+void WorleyNoise::Cellular2DRow(float xStart, float xScale, float y, std::size_t count, float* f1, float* f2) const{
+    switch(m_kernel){
+#ifdef WORLEYNOISE_X86
+        case PerlinNoiseBatch::AVX512: AVX512CellularRow(m_seed, xStart, xScale, y, count, f1, f2); return;
+        case PerlinNoiseBatch::AVX2:   AVX2CellularRow(m_seed, xStart, xScale, y, count, f1, f2); return;
+#endif
+        default:                       ScalarCellularRow(m_seed, xStart, xScale, y, 0, count, f1, f2); return;
+    }
+}
@@ -4,11 +4,193 @@
 
 // Functionality that we created
 #include "SDLGraphicsProgram.hpp"
+#include "Benchmark.hpp"
+#include "NoiseContext.hpp"
+#include "TerrainRamp.hpp"
+#include "RegionBaker.hpp"
+#include "BakeCoordinator.hpp"
+#include "JobScheduler.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Reads the whole number after the first prefix characters of argument into value, which has to be
+// from min to max. Prints what was expected and returns false if it is not.
+static bool ParseOption(const std::string& argument, std::size_t prefix, unsigned int min, unsigned int max, unsigned int& value){
+	const char* text = argument.c_str() + prefix;
+	char* end = nullptr;
+	errno = 0;
+	const unsigned long parsed = std::strtoul(text, &end, 10);
+	// strtoul takes a sign, and wraps a negative number around
+	if(*text < '0' || *text > '9' || *end != '\0' || errno == ERANGE || parsed < min || parsed > max){
+		std::cout << "Expected " << argument.substr(0, prefix) << "N with N from " << min << " to " << max << ", got '" << argument << "'\n";
+		return false;
+	}
+	value = static_cast<unsigned int>(parsed);
+	return true;
+}
+
+// The same for a number with a fraction, which has to be from min to max
+static bool ParseOption(const std::string& argument, std::size_t prefix, float min, float max, float& value){
+	const char* text = argument.c_str() + prefix;
+	char* end = nullptr;
+	const float parsed = std::strtof(text, &end);
+	// NaN fails both comparisons
+	if(end == text || *end != '\0' || !(parsed >= min && parsed <= max)){
+		std::cout << "Expected " << argument.substr(0, prefix) << "X with X from " << min << " to " << max << ", got '" << argument << "'\n";
+		return false;
+	}
+	value = parsed;
+	return true;
+}
 
 int main(int argc, char** argv){
 
+	NoiseSettings noiseSettings;
+	std::vector<RampStop> rampStops = TerrainRamp::GetDefaultStops();
+	unsigned int threadCount = 0;
+	std::size_t uploadBudget = 8u << 20;
+	TerrainDrawPath drawPath = TerrainDrawPath::VertexBuffer;
+	float lodDistance = 768.0f;
+	unsigned int clipmapLevels = 0;
+	bool bake = false;
+	BakeSettings bakeSettings;
+	unsigned int bakeWorkers = 0;
+	unsigned int bakeShardSize = 4;
+	std::string bakeWorkerDirectory;
+	// What worker processes are started with, everything but the bake layout
+	std::vector<std::string> workerArguments;
+
+	for(int i = 1; i < argc; ++i){
+		std::string argument = argv[i];
+		if(argument.compare(0, 6, "--bake") != 0){
+			workerArguments.push_back(argument);
+		}
+		// ./lab --bench runs the generation benchmarks without opening a window,
+		// and exits with 1 if any of their checks failed
+		if(argument == "--bench"){
+			return Benchmark::RunAll() ? 0 : 1;
+		}
+		// ./lab --bake=16x8 writes a 16 by 8 chunk region to disk without opening a window
+		if(argument.compare(0, 7, "--bake=") == 0){
+			if(std::sscanf(argument.c_str() + 7, "%ux%u", &bakeSettings.chunksX, &bakeSettings.chunksZ) != 2
+			   || bakeSettings.chunksX == 0 || bakeSettings.chunksZ == 0){
+				std::cout << "Expected --bake=NxM, got '" << argument << "'\n";
+				return 1;
+			}
+			bake = true;
+		}
+		// ./lab --bake-dir=out puts the baked region in out, "bake" by default
+		if(argument.compare(0, 11, "--bake-dir=") == 0){
+			bakeSettings.outputDirectory = argument.substr(11);
+		}
+		// ./lab --bake=64x64 --bake-workers=4 bakes shards of the region in 4 processes
+		if(argument.compare(0, 15, "--bake-workers=") == 0){
+			if(!ParseOption(argument, 15, 0u, 256u, bakeWorkers)){
+				return 1;
+			}
+		}
+		// ./lab --bake-shard=8 makes the shards 8x8 chunks, 4x4 by default
+		if(argument.compare(0, 13, "--bake-shard=") == 0){
+			if(!ParseOption(argument, 13, 1u, 1024u, bakeShardSize)){
+				return 1;
+			}
+		}
+		// Started by the coordinator: bakes the shards queued in a directory
+		if(argument.compare(0, 14, "--bake-worker=") == 0){
+			bakeWorkerDirectory = argument.substr(14);
+		}
+		// ./lab --palette=ramp.txt loads the height and colour stops, one "noise height r g b" per line
+		if(argument.compare(0, 10, "--palette=") == 0){
+			if(!TerrainRamp::LoadStops(argument.substr(10), rampStops)){
+				std::cout << "Could not read palette '" << argument.substr(10) << "'\n";
+				return 1;
+			}
+		}
+		// ./lab --threads=4 generates the chunks on 4 threads, the default is every hardware thread
+		if(argument.compare(0, 10, "--threads=") == 0){
+			if(!ParseOption(argument, 10, 0u, 1024u, threadCount)){
+				return 1;
+			}
+		}
+		// ./lab --upload-budget=4 copies at most 4 MB of new chunks to the GPU each frame
+		if(argument.compare(0, 16, "--upload-budget=") == 0){
+			// Above 0, or nothing would ever reach the GPU
+			float megabytes = 0.0f;
+			if(!ParseOption(argument, 16, 0.0625f, 1024.0f, megabytes)){
+				return 1;
+			}
+			uploadBudget = static_cast<std::size_t>(megabytes * (1 << 20));
+		}
+		// ./lab --vertex-pulling uploads a height texture per chunk instead of a vertex buffer
+		if(argument == "--vertex-pulling"){
+			drawPath = TerrainDrawPath::HeightTexture;
+		}
+		// ./lab --lod-distance=1024 builds chunks over 1024 units away coarser, 0 keeps every chunk at full resolution
+		if(argument.compare(0, 15, "--lod-distance=") == 0){
+			if(!ParseOption(argument, 15, 0.0f, 1.0e6f, lodDistance)){
+				return 1;
+			}
+		}
+		// ./lab --clipmap draws the terrain as a geometry clipmap instead of chunks, seeing much further
+		if(argument == "--clipmap"){
+			clipmapLevels = Clipmap::DefaultLevels;
+		}
+		// ./lab --clipmap-levels=8 draws a clipmap of 8 levels, each twice as wide as the one inside it
+		if(argument.compare(0, 17, "--clipmap-levels=") == 0){
+			if(!ParseOption(argument, 17, 1u, Clipmap::MaxLevels, clipmapLevels)){
+				return 1;
+			}
+		}
+		// ./lab --noise=simplex picks the noise the terrain is built from
+		if(argument.compare(0, 8, "--noise=") == 0){
+			if(!NoiseSource::ParseBackend(argument.substr(8), noiseSettings.backend)){
+				std::cout << "Unknown noise '" << argument.substr(8) << "', expected perlin, simplex, hash or worley\n";
+				return 1;
+			}
+		}
+	}
+
+	if(!bakeWorkerDirectory.empty()){
+		JobScheduler scheduler(threadCount);
+		TerrainRamp ramp(rampStops);
+		return BakeCoordinator::RunWorker(bakeWorkerDirectory, scheduler, NoiseContext(noiseSettings), ramp) ? 0 : 1;
+	}
+	if(bake && bakeWorkers > 0){
+		std::cout << "Baking " << bakeSettings.chunksX << "x" << bakeSettings.chunksZ << " chunks of " << bakeSettings.chunkSize
+		          << " into '" << bakeSettings.outputDirectory << "' with " << bakeWorkers << " worker processes\n";
+		// The hardware threads are split between the workers, unless --threads says otherwise
+		const unsigned int hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+		workerArguments.insert(workerArguments.begin(), "--threads=" + std::to_string(std::max(hardwareThreads / bakeWorkers, 1u)));
+		std::error_code error;
+		std::string executable = std::filesystem::exists("/proc/self/exe", error) ? std::filesystem::read_symlink("/proc/self/exe", error).string() : argv[0];
+		if(error || executable.empty()){
+			executable = argv[0];
+		}
+		BakeCoordinator coordinator(bakeSettings, bakeShardSize, bakeWorkers);
+		return coordinator.Run(executable, workerArguments) ? 0 : 1;
+	}
+	if(bake){
+		std::cout << "Baking " << bakeSettings.chunksX << "x" << bakeSettings.chunksZ << " chunks of " << bakeSettings.chunkSize
+		          << " into '" << bakeSettings.outputDirectory << "'\n";
+		JobScheduler scheduler(threadCount);
+		TerrainRamp ramp(rampStops);
+		RegionBaker baker(scheduler, NoiseContext(noiseSettings), ramp);
+		RegionBaker::Stats stats;
+		const bool baked = baker.Bake(bakeSettings, stats);
+		RegionBaker::PrintStats(stats);
+		return baked ? 0 : 1;
+	}
+
 	// Create an instance of an object for a SDLGraphicsProgram
-	SDLGraphicsProgram mySDLGraphicsProgram(1920,1080);
+	SDLGraphicsProgram mySDLGraphicsProgram(1920,1080,noiseSettings,rampStops,threadCount,uploadBudget,drawPath,lodDistance,clipmapLevels);
 	// Run our program forever
 	mySDLGraphicsProgram.Loop();
 	// When our program ends, it will exit scope, the